@@ -63,6 +63,17 @@ void AsyncFileStorage::store(const QString &fileName, const QByteArray &data)
 #endif
 }
 
+void AsyncFileStorage::append(const QString &fileName, const QByteArray &data)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+    QMetaObject::invokeMethod(this, [this, data, fileName]() { append_impl(fileName, data); }
+                              , Qt::QueuedConnection);
+#else
+    QMetaObject::invokeMethod(this, "append_impl", Qt::QueuedConnection
+                              , Q_ARG(QString, fileName), Q_ARG(QByteArray, data));
+#endif
+}
+
 QDir AsyncFileStorage::storageDir() const
 {
     return m_storageDir;
@@ -81,3 +92,14 @@ void AsyncFileStorage::store_impl(const QString &fileName, const QByteArray &dat
         }
     }
 }
+
+void AsyncFileStorage::append_impl(const QString &fileName, const QByteArray &data)
+{
+    const QString filePath = m_storageDir.absoluteFilePath(fileName);
+    QFile file(filePath);
+    qDebug() << "AsyncFileStorage: Appending data to" << filePath;
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || (file.write(data) != data.size())) {
+        qDebug() << "AsyncFileStorage: Failed to append data";
+        emit failed(filePath, file.errorString());
+    }
+}
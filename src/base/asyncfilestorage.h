@@ -50,6 +50,7 @@ public:
     ~AsyncFileStorage() override;
 
     void store(const QString &fileName, const QByteArray &data);
+    void append(const QString &fileName, const QByteArray &data);
 
     QDir storageDir() const;
 
@@ -58,6 +59,7 @@ signals:
 
 private:
     Q_INVOKABLE void store_impl(const QString &fileName, const QByteArray &data);
+    Q_INVOKABLE void append_impl(const QString &fileName, const QByteArray &data);
 
     QDir m_storageDir;
     QFile m_lockFile;
@@ -1,6 +1,7 @@
 HEADERS += \
     $$PWD/algorithm.h \
     $$PWD/asyncfilestorage.h \
+    $$PWD/bitfield.h \
     $$PWD/bittorrent/addtorrentparams.h \
     $$PWD/bittorrent/bandwidthscheduler.h \
     $$PWD/bittorrent/cachestatus.h \
@@ -16,21 +17,27 @@ HEADERS += \
     $$PWD/bittorrent/peeraddress.h \
     $$PWD/bittorrent/peerinfo.h \
     $$PWD/bittorrent/portforwarderimpl.h \
+    $$PWD/bittorrent/resumedatajournal.h \
+    $$PWD/bittorrent/resumedataloader.h \
     $$PWD/bittorrent/resumedatasavingmanager.h \
     $$PWD/bittorrent/session.h \
     $$PWD/bittorrent/sessionstatus.h \
     $$PWD/bittorrent/speedmonitor.h \
     $$PWD/bittorrent/statistics.h \
+    $$PWD/bittorrent/torrentcreationmanager.h \
     $$PWD/bittorrent/torrentcreatorthread.h \
+    $$PWD/bittorrent/torrentdetailscache.h \
     $$PWD/bittorrent/torrenthandle.h \
     $$PWD/bittorrent/torrenthandleimpl.h \
     $$PWD/bittorrent/torrentinfo.h \
     $$PWD/bittorrent/tracker.h \
     $$PWD/bittorrent/trackerentry.h \
+    $$PWD/bittorrent/transferhistory.h \
     $$PWD/exceptions.h \
     $$PWD/filesystemwatcher.h \
     $$PWD/global.h \
     $$PWD/http/connection.h \
+    $$PWD/http/contentstream.h \
     $$PWD/http/httperror.h \
     $$PWD/http/irequesthandler.h \
     $$PWD/http/requestparser.h \
@@ -56,6 +63,7 @@ HEADERS += \
     $$PWD/rss/rss_article.h \
     $$PWD/rss/rss_autodownloader.h \
     $$PWD/rss/rss_autodownloadrule.h \
+    $$PWD/rss/rss_autodownloadruleindex.h \
     $$PWD/rss/rss_feed.h \
     $$PWD/rss/rss_folder.h \
     $$PWD/rss/rss_item.h \
@@ -77,15 +85,18 @@ HEADERS += \
     $$PWD/utils/fs.h \
     $$PWD/utils/gzip.h \
     $$PWD/utils/io.h \
+    $$PWD/utils/latencyhistogram.h \
     $$PWD/utils/misc.h \
     $$PWD/utils/net.h \
     $$PWD/utils/password.h \
     $$PWD/utils/random.h \
     $$PWD/utils/string.h \
+    $$PWD/utils/timeseriesstore.h \
     $$PWD/utils/version.h
 
 SOURCES += \
     $$PWD/asyncfilestorage.cpp \
+    $$PWD/bitfield.cpp \
     $$PWD/bittorrent/bandwidthscheduler.cpp \
     $$PWD/bittorrent/customstorage.cpp \
     $$PWD/bittorrent/downloadpriority.cpp \
@@ -97,16 +108,21 @@ SOURCES += \
     $$PWD/bittorrent/peeraddress.cpp \
     $$PWD/bittorrent/peerinfo.cpp \
     $$PWD/bittorrent/portforwarderimpl.cpp \
+    $$PWD/bittorrent/resumedatajournal.cpp \
+    $$PWD/bittorrent/resumedataloader.cpp \
     $$PWD/bittorrent/resumedatasavingmanager.cpp \
     $$PWD/bittorrent/session.cpp \
     $$PWD/bittorrent/speedmonitor.cpp \
     $$PWD/bittorrent/statistics.cpp \
+    $$PWD/bittorrent/torrentcreationmanager.cpp \
     $$PWD/bittorrent/torrentcreatorthread.cpp \
+    $$PWD/bittorrent/torrentdetailscache.cpp \
     $$PWD/bittorrent/torrenthandle.cpp \
     $$PWD/bittorrent/torrenthandleimpl.cpp \
     $$PWD/bittorrent/torrentinfo.cpp \
     $$PWD/bittorrent/tracker.cpp \
     $$PWD/bittorrent/trackerentry.cpp \
+    $$PWD/bittorrent/transferhistory.cpp \
     $$PWD/exceptions.cpp \
     $$PWD/filesystemwatcher.cpp \
     $$PWD/http/connection.cpp \
@@ -132,6 +148,7 @@ SOURCES += \
     $$PWD/rss/rss_article.cpp \
     $$PWD/rss/rss_autodownloader.cpp \
     $$PWD/rss/rss_autodownloadrule.cpp \
+    $$PWD/rss/rss_autodownloadruleindex.cpp \
     $$PWD/rss/rss_feed.cpp \
     $$PWD/rss/rss_folder.cpp \
     $$PWD/rss/rss_item.cpp \
@@ -150,8 +167,15 @@ SOURCES += \
     $$PWD/utils/fs.cpp \
     $$PWD/utils/gzip.cpp \
     $$PWD/utils/io.cpp \
+    $$PWD/utils/latencyhistogram.cpp \
     $$PWD/utils/misc.cpp \
     $$PWD/utils/net.cpp \
     $$PWD/utils/password.cpp \
     $$PWD/utils/random.cpp \
-    $$PWD/utils/string.cpp
+    $$PWD/utils/string.cpp \
+    $$PWD/utils/timeseriesstore.cpp
+
+io_uring {
+    HEADERS += $$PWD/bittorrent/iouringstorage.h
+    SOURCES += $$PWD/bittorrent/iouringstorage.cpp
+}
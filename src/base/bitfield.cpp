@@ -0,0 +1,145 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "bitfield.h"
+
+#include <QtAlgorithms>
+
+namespace
+{
+    const int WORD_BITS = 64;
+
+    int wordCount(const int size)
+    {
+        return ((size + WORD_BITS - 1) / WORD_BITS);
+    }
+
+    // Mask of the bits below `size` in its word
+    quint64 lowBitsMask(const int size)
+    {
+        const int bits = size % WORD_BITS;
+        return ((bits == 0) ? ~quint64 {0} : ((quint64 {1} << bits) - 1));
+    }
+
+    quint8 reverseBits(quint8 byte)
+    {
+        byte = static_cast<quint8>(((byte & 0xF0) >> 4) | ((byte & 0x0F) << 4));
+        byte = static_cast<quint8>(((byte & 0xCC) >> 2) | ((byte & 0x33) << 2));
+        byte = static_cast<quint8>(((byte & 0xAA) >> 1) | ((byte & 0x55) << 1));
+        return byte;
+    }
+}
+
+Bitfield::Bitfield(const int size)
+    : m_size {size}
+    , m_words(wordCount(size), 0)
+{
+    Q_ASSERT(size >= 0);
+}
+
+Bitfield Bitfield::fromRawData(const char *data, const int size)
+{
+    Bitfield bitfield {size};
+    if (bitfield.isEmpty())
+        return bitfield;
+
+    quint64 *words = bitfield.m_words.data();
+    const int byteCount = ((size + 7) / 8);
+    for (int i = 0; i < byteCount; ++i) {
+        // the first bit of each byte is the most significant one
+        const quint64 byte = reverseBits(static_cast<quint8>(data[i]));
+        words[i / 8] |= (byte << ((i % 8) * 8));
+    }
+    // keep the bits past the end unset, counting functions rely on it
+    bitfield.m_words.last() &= lowBitsMask(size);
+
+    return bitfield;
+}
+
+int Bitfield::size() const
+{
+    return m_size;
+}
+
+bool Bitfield::isEmpty() const
+{
+    return (m_size == 0);
+}
+
+bool Bitfield::testBit(const int i) const
+{
+    Q_ASSERT((i >= 0) && (i < m_size));
+    return ((m_words[i / WORD_BITS] >> (i % WORD_BITS)) & 1);
+}
+
+void Bitfield::setBit(const int i)
+{
+    Q_ASSERT((i >= 0) && (i < m_size));
+    m_words[i / WORD_BITS] |= (quint64 {1} << (i % WORD_BITS));
+}
+
+int Bitfield::count() const
+{
+    int result = 0;
+    for (const quint64 word : m_words)
+        result += qPopulationCount(word);
+    return result;
+}
+
+int Bitfield::count(const int from, const int to) const
+{
+    Q_ASSERT((from >= 0) && (to <= m_size));
+    if (from >= to)
+        return 0;
+
+    const int firstWord = from / WORD_BITS;
+    const int lastWord = (to - 1) / WORD_BITS;
+    const quint64 firstMask = (~quint64 {0} << (from % WORD_BITS));
+    const quint64 lastMask = lowBitsMask(to);
+
+    if (firstWord == lastWord)
+        return qPopulationCount(m_words[firstWord] & firstMask & lastMask);
+
+    int result = qPopulationCount(m_words[firstWord] & firstMask);
+    for (int i = (firstWord + 1); i < lastWord; ++i)
+        result += qPopulationCount(m_words[i]);
+    result += qPopulationCount(m_words[lastWord] & lastMask);
+    return result;
+}
+
+int Bitfield::countAndNot(const Bitfield &mask) const
+{
+    const int commonWords = qMin(m_words.size(), mask.m_words.size());
+
+    int result = 0;
+    for (int i = 0; i < commonWords; ++i)
+        result += qPopulationCount(m_words[i] & ~mask.m_words[i]);
+    for (int i = commonWords; i < m_words.size(); ++i)
+        result += qPopulationCount(m_words[i]);
+    return result;
+}
@@ -0,0 +1,63 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+
+// Fixed size array of bits stored in 64-bit words so that
+// counting operations can process a whole word at once
+class Bitfield
+{
+public:
+    Bitfield() = default;
+    explicit Bitfield(int size);
+
+    // Bits are read starting from the most significant bit of each byte,
+    // i.e. in the order used by the BitTorrent protocol and libtorrent
+    static Bitfield fromRawData(const char *data, int size);
+
+    int size() const;
+    bool isEmpty() const;
+
+    bool testBit(int i) const;
+    void setBit(int i);
+
+    // Number of set bits
+    int count() const;
+    // Number of set bits in range [from, to)
+    int count(int from, int to) const;
+    // Number of bits set in this bitfield but not in `mask`,
+    // missing bits of a shorter `mask` are treated as unset
+    int countAndNot(const Bitfield &mask) const;
+
+private:
+    int m_size = 0;
+    QVector<quint64> m_words;
+};
@@ -35,9 +35,17 @@
 #include "base/utils/fs.h"
 #include "common.h"
 
+#ifdef QBT_USES_IO_URING
+#include "iouringstorage.h"
+#endif
+
 lt::storage_interface *customStorageConstructor(const lt::storage_params &params, lt::file_pool &pool)
 {
+#ifdef QBT_USES_IO_URING
+    return new IOUringStorage {params, pool};
+#else
     return new CustomStorage {params, pool};
+#endif
 }
 
 CustomStorage::CustomStorage(const lt::storage_params &params, lt::file_pool &filePool)
@@ -72,6 +80,16 @@ lt::status_t CustomStorage::move_storage(const std::string &savePath, lt::move_f
     return ret;
 }
 
+QString CustomStorage::savePath() const
+{
+    return m_savePath;
+}
+
+bool CustomStorage::isFileWanted(const lt::file_index_t fileIndex) const
+{
+    return ((m_filePriorities.end_index() <= fileIndex) || (m_filePriorities[fileIndex] != lt::dont_download));
+}
+
 void CustomStorage::handleCompleteFiles(const QString &savePath)
 {
     const QDir saveDir {savePath};
@@ -79,7 +97,7 @@ void CustomStorage::handleCompleteFiles(const QString &savePath)
     const lt::file_storage &fileStorage = files();
     for (const lt::file_index_t fileIndex : fileStorage.file_range()) {
         // ignore files that have priority 0
-        if ((m_filePriorities.end_index() > fileIndex) && (m_filePriorities[fileIndex] == lt::dont_download))
+        if (!isFileWanted(fileIndex))
             continue;
 
         // ignore pad files
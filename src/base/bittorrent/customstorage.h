@@ -36,7 +36,7 @@
 
 lt::storage_interface *customStorageConstructor(const lt::storage_params &params, lt::file_pool &pool);
 
-class CustomStorage final : public lt::default_storage
+class CustomStorage : public lt::default_storage
 {
 public:
     explicit CustomStorage(const lt::storage_params &params, lt::file_pool &filePool);
@@ -45,6 +45,10 @@ public:
     void set_file_priority(lt::aux::vector<lt::download_priority_t, lt::file_index_t> &priorities, lt::storage_error &ec) override;
     lt::status_t move_storage(const std::string &savePath, lt::move_flags_t flags, lt::storage_error &ec) override;
 
+protected:
+    QString savePath() const;
+    bool isFileWanted(lt::file_index_t fileIndex) const;
+
 private:
     void handleCompleteFiles(const QString &savePath);
 
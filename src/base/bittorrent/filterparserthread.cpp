@@ -28,14 +28,29 @@
 
 #include "filterparserthread.h"
 
+#include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstring>
+#include <memory>
+#include <vector>
 
 #include <libtorrent/error_code.hpp>
 
+#include <QCryptographicHash>
 #include <QDataStream>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QVector>
 
+#include "base/global.h"
 #include "base/logger.h"
+#include "base/profile.h"
+#include "base/utils/fs.h"
 
 namespace
 {
@@ -101,435 +116,611 @@ namespace
         return !ec;
     }
 
-    const int BUFFER_SIZE = 2 * 1024 * 1024; // 2 MiB
+    const int BLOCK_SIZE = 32 * 1024 * 1024; // 32 MiB
+    const int MIN_CHUNK_SIZE = 256 * 1024; // 256 KiB
     const int MAX_LOGGED_ERRORS = 5;
-}
 
-FilterParserThread::FilterParserThread(QObject *parent)
-    : QThread(parent)
-    , m_abort(false)
-{
-}
+    const char CACHE_FILENAME[] = "ipfilter.cache";
+    const char CACHE_MAGIC[8] = {'Q', 'B', 'T', 'I', 'P', 'F', 'L', 'T'};
+    const quint32 CACHE_VERSION = 1;
 
-FilterParserThread::~FilterParserThread()
-{
-    m_abort = true;
-    wait();
-}
+    // Ranges are kept in host byte order
+    struct IPv4Range
+    {
+        quint32 first;
+        quint32 last;
+    };
 
-// Parser for eMule ip filter in DAT format
-int FilterParserThread::parseDATFilterFile()
-{
-    int ruleCount = 0;
-    QFile file(m_filePath);
-    if (!file.exists()) return ruleCount;
+    using IPv6Bytes = std::array<unsigned char, 16>;
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
-        return ruleCount;
-    }
+    struct IPv6Range
+    {
+        IPv6Bytes first;
+        IPv6Bytes last;
+    };
+
+    // The cache file consists of this header followed by
+    // the IPv4 ranges and then the IPv6 ranges, both sorted and merged.
+    // It is written in host byte order, so a cache copied to
+    // a machine with another byte order is just rebuilt.
+    struct CacheHeader
+    {
+        char magic[8];
+        quint32 version;
+        quint32 ruleCount;
+        qint64 sourceSize;
+        qint64 sourceModified;
+        quint32 ipv4RangeCount;
+        quint32 ipv6RangeCount;
+        char sourcePathHash[20];
+        char reserved[4];
+    };
+
+    static_assert(sizeof(IPv4Range) == 8, "Unexpected IPv4Range layout");
+    static_assert(sizeof(IPv6Range) == 32, "Unexpected IPv6Range layout");
+    static_assert(sizeof(CacheHeader) == 64, "Unexpected CacheHeader layout");
 
-    std::vector<char> buffer(BUFFER_SIZE, 0); // seems a bit faster than QVector
-    qint64 bytesRead = 0;
-    int offset = 0;
-    int start = 0;
-    int endOfLine = -1;
-    int nbLine = 0;
-    int parseErrorCount = 0;
-    const auto addLog = [&parseErrorCount](const QString &msg)
+    struct ParseError
     {
-        if (parseErrorCount <= MAX_LOGGED_ERRORS)
-            LogMsg(msg, Log::CRITICAL);
+        int line;
+        QString message; // contains "%1" placeholder for the line number
     };
 
-    while (true) {
-        bytesRead = file.read(buffer.data() + offset, BUFFER_SIZE - offset - 1);
-        if (bytesRead < 0)
-            break;
-        const int dataSize = bytesRead + offset;
-        if ((bytesRead == 0) && (dataSize == 0))
-            break;
-
-        for (start = 0; start < dataSize; ++start) {
-            endOfLine = -1;
-            // The file might have ended without the last line having a newline
-            if (!((bytesRead == 0) && (dataSize > 0))) {
-                for (int i = start; i < dataSize; ++i) {
-                    if (buffer[i] == '\n') {
-                        endOfLine = i;
-                        // We need to NULL the newline in case the line has only an IP range.
-                        // In that case the parser won't work for the end IP, because it ends
-                        // with the newline and not with a number.
-                        buffer[i] = '\0';
-                        break;
-                    }
+    struct ParseResult
+    {
+        std::vector<IPv4Range> ipv4Ranges;
+        std::vector<IPv6Range> ipv6Ranges;
+        int ruleCount = 0;
+        int lineCount = 0;
+        int errorCount = 0;
+        QVector<ParseError> errors;
+
+        void addError(const QString &message)
+        {
+            ++errorCount;
+            if (errors.size() < MAX_LOGGED_ERRORS)
+                errors.append({lineCount, message});
+        }
+    };
+
+    int findAndNullDelimiter(char *const data, const char delimiter, const int start, const int end, const bool reverse = false)
+    {
+        if (!reverse) {
+            for (int i = start; i <= end; ++i) {
+                if (data[i] == delimiter) {
+                    data[i] = '\0';
+                    return i;
                 }
             }
-            else {
-                endOfLine = dataSize;
-                buffer[dataSize] = '\0';
+        }
+        else {
+            for (int i = end; i >= start; --i) {
+                if (data[i] == delimiter) {
+                    data[i] = '\0';
+                    return i;
+                }
             }
+        }
+
+        return -1;
+    }
+
+    int trim(char *const data, const int start, const int end)
+    {
+        if (start >= end) return start;
+        int newStart = start;
 
-            if (endOfLine == -1) {
-                // read the next chunk from file
-                // but first move(copy) the leftover data to the front of the buffer
-                offset = dataSize - start;
-                memmove(buffer.data(), buffer.data() + start, offset);
+        for (int i = start; i <= end; ++i) {
+            if (isspace(data[i]) != 0) {
+                data[i] = '\0';
+            }
+            else {
+                newStart = i;
                 break;
             }
+        }
 
-            ++nbLine;
+        for (int i = end; i >= start; --i) {
+            if (isspace(data[i]) != 0)
+                data[i] = '\0';
+            else
+                break;
+        }
 
-            if ((buffer[start] == '#')
-                || ((buffer[start] == '/') && ((start + 1 < dataSize) && (buffer[start + 1] == '/')))) {
-                start = endOfLine;
-                continue;
-            }
+        return newStart;
+    }
 
-            // Each line should follow this format:
-            // 001.009.096.105 - 001.009.096.105 , 000 , Some organization
-            // The 3rd entry is access level and if above 127 the IP range isn't blocked.
-            const int firstComma = findAndNullDelimiter(buffer.data(), ',', start, endOfLine);
-            if (firstComma != -1)
-                findAndNullDelimiter(buffer.data(), ',', firstComma + 1, endOfLine);
-
-            // Check if there is an access value (apparently not mandatory)
-            if (firstComma != -1) {
-                // There is possibly one
-                const long int nbAccess = strtol(buffer.data() + firstComma + 1, nullptr, 10);
-                // Ignoring this rule because access value is too high
-                if (nbAccess > 127L) {
-                    start = endOfLine;
-                    continue;
-                }
-            }
+    // Parses "<start IP> - <end IP>" where the delimiter is already nulled
+    void addRange(char *const data, const int startIPBegin, const int startIPEnd
+                  , const int endIPBegin, const int endIPEnd, ParseResult &result)
+    {
+        lt::address startAddr;
+        int newStart = trim(data, startIPBegin, startIPEnd);
+        if (!parseIPAddress(data + newStart, startAddr)) {
+            result.addError(FilterParserThread::tr("IP filter line %1 is malformed. Start IP of the range is malformed."));
+            return;
+        }
 
-            // IP Range should be split by a dash
-            const int endOfIPRange = ((firstComma == -1) ? (endOfLine - 1) : (firstComma - 1));
-            const int delimIP = findAndNullDelimiter(buffer.data(), '-', start, endOfIPRange);
-            if (delimIP == -1) {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        lt::address endAddr;
+        newStart = trim(data, endIPBegin, endIPEnd);
+        if (!parseIPAddress(data + newStart, endAddr)) {
+            result.addError(FilterParserThread::tr("IP filter line %1 is malformed. End IP of the range is malformed."));
+            return;
+        }
 
-            lt::address startAddr;
-            int newStart = trim(buffer.data(), start, delimIP - 1);
-            if (!parseIPAddress(buffer.data() + newStart, startAddr)) {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. Start IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        if ((startAddr.is_v4() != endAddr.is_v4())
+            || (startAddr.is_v6() != endAddr.is_v6())) {
+            result.addError(FilterParserThread::tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!"));
+            return;
+        }
 
-            lt::address endAddr;
-            newStart = trim(buffer.data(), delimIP + 1, endOfIPRange);
-            if (!parseIPAddress(buffer.data() + newStart, endAddr)) {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. End IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        if (endAddr < startAddr) {
+            result.addError(FilterParserThread::tr("IP filter line %1 is malformed."));
+            return;
+        }
 
-            if ((startAddr.is_v4() != endAddr.is_v4())
-                || (startAddr.is_v6() != endAddr.is_v6())) {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        if (startAddr.is_v4())
+            result.ipv4Ranges.push_back({startAddr.to_v4().to_uint(), endAddr.to_v4().to_uint()});
+        else
+            result.ipv6Ranges.push_back({startAddr.to_v6().to_bytes(), endAddr.to_v6().to_bytes()});
+        ++result.ruleCount;
+    }
 
-            start = endOfLine;
+    // Parser for eMule ip filter in DAT format
+    void parseDATLine(char *const data, const int start, const int endOfLine, ParseResult &result)
+    {
+        // Each line should follow this format:
+        // 001.009.096.105 - 001.009.096.105 , 000 , Some organization
+        // The 3rd entry is access level and if above 127 the IP range isn't blocked.
+        const int firstComma = findAndNullDelimiter(data, ',', start, endOfLine);
+        if (firstComma != -1)
+            findAndNullDelimiter(data, ',', firstComma + 1, endOfLine);
+
+        // Check if there is an access value (apparently not mandatory)
+        if (firstComma != -1) {
+            // There is possibly one
+            const long int nbAccess = strtol(data + firstComma + 1, nullptr, 10);
+            // Ignoring this rule because access value is too high
+            if (nbAccess > 127L)
+                return;
+        }
 
-            // Now Add to the filter
-            try {
-                m_filter.add_rule(startAddr, endAddr, lt::ip_filter::blocked);
-                ++ruleCount;
-            }
-            catch (const std::exception &e) {
-                ++parseErrorCount;
-                addLog(tr("IP filter exception thrown for line %1. Exception is: %2")
-                       .arg(nbLine).arg(QString::fromLocal8Bit(e.what())));
-            }
+        // IP Range should be split by a dash
+        const int endOfIPRange = ((firstComma == -1) ? (endOfLine - 1) : (firstComma - 1));
+        const int delimIP = findAndNullDelimiter(data, '-', start, endOfIPRange);
+        if (delimIP == -1) {
+            result.addError(FilterParserThread::tr("IP filter line %1 is malformed."));
+            return;
         }
 
-        if (start >= dataSize)
-            offset = 0;
+        addRange(data, start, (delimIP - 1), (delimIP + 1), endOfIPRange, result);
     }
 
-    if (parseErrorCount > MAX_LOGGED_ERRORS)
-        LogMsg(tr("%1 extra IP filter parsing errors occurred.", "513 extra IP filter parsing errors occurred.")
-               .arg(parseErrorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
-    return ruleCount;
-}
+    // Parser for PeerGuardian ip filter in p2p format
+    void parseP2PLine(char *const data, const int start, const int endOfLine, ParseResult &result)
+    {
+        // Each line should follow this format:
+        // Some organization:1.0.0.0-1.255.255.255
+        // The "Some organization" part might contain a ':' char itself so we find the last occurrence
+        const int partsDelimiter = findAndNullDelimiter(data, ':', start, endOfLine, true);
+        if (partsDelimiter == -1) {
+            result.addError(FilterParserThread::tr("IP filter line %1 is malformed."));
+            return;
+        }
 
-// Parser for PeerGuardian ip filter in p2p format
-int FilterParserThread::parseP2PFilterFile()
-{
-    int ruleCount = 0;
-    QFile file(m_filePath);
-    if (!file.exists()) return ruleCount;
+        // IP Range should be split by a dash
+        const int delimIP = findAndNullDelimiter(data, '-', (partsDelimiter + 1), endOfLine);
+        if (delimIP == -1) {
+            result.addError(FilterParserThread::tr("IP filter line %1 is malformed."));
+            return;
+        }
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
-        return ruleCount;
+        addRange(data, (partsDelimiter + 1), (delimIP - 1), (delimIP + 1), endOfLine, result);
     }
 
-    std::vector<char> buffer(BUFFER_SIZE, 0); // seems a bit faster than QVector
-    qint64 bytesRead = 0;
-    int offset = 0;
-    int start = 0;
-    int endOfLine = -1;
-    int nbLine = 0;
-    int parseErrorCount = 0;
-    const auto addLog = [&parseErrorCount](const QString &msg)
+    using LineParser = void (*)(char *, int, int, ParseResult &);
+
+    // Parses the lines of a chunk of text data. The byte past the end
+    // of the chunk must be writable since it gets nulled.
+    class ChunkParser final : public QRunnable
     {
-        if (parseErrorCount <= MAX_LOGGED_ERRORS)
-            LogMsg(msg, Log::CRITICAL);
+    public:
+        ChunkParser(char *data, const int size, const LineParser parseLine)
+            : m_data {data}
+            , m_size {size}
+            , m_parseLine {parseLine}
+        {
+            setAutoDelete(false);
+        }
+
+        void run() override
+        {
+            int start = 0;
+            while (start < m_size) {
+                const auto *newline = static_cast<const char *>(memchr(m_data + start, '\n', (m_size - start)));
+                const int nextStart = (newline ? static_cast<int>(newline - m_data) : m_size) + 1;
+                int endOfLine = nextStart - 1;
+                // The file is read in binary mode so handle CRLF line endings here
+                if ((endOfLine > start) && (m_data[endOfLine - 1] == '\r'))
+                    --endOfLine;
+                // We need to NULL the newline in case the line has only an IP range.
+                // In that case the parser won't work for the end IP, because it ends
+                // with the newline and not with a number.
+                m_data[endOfLine] = '\0';
+                ++m_result.lineCount;
+
+                if (!isIgnoredLine(start, endOfLine))
+                    m_parseLine(m_data, start, endOfLine, m_result);
+
+                start = nextStart;
+            }
+        }
+
+        const ParseResult &result() const
+        {
+            return m_result;
+        }
+
+    private:
+        bool isIgnoredLine(const int start, const int endOfLine) const
+        {
+            if ((m_data[start] == '#')
+                || ((m_data[start] == '/') && ((start + 1 < endOfLine) && (m_data[start + 1] == '/'))))
+                return true;
+
+            // blank line
+            for (int i = start; i < endOfLine; ++i) {
+                if (isspace(m_data[i]) == 0)
+                    return false;
+            }
+            return true;
+        }
+
+        char *m_data;
+        const int m_size;
+        const LineParser m_parseLine;
+        ParseResult m_result;
     };
 
-    while (true) {
-        bytesRead = file.read(buffer.data() + offset, BUFFER_SIZE - offset - 1);
-        if (bytesRead < 0)
-            break;
-        const int dataSize = bytesRead + offset;
-        if ((bytesRead == 0) && (dataSize == 0))
-            break;
-
-        for (start = 0; start < dataSize; ++start) {
-            endOfLine = -1;
-            // The file might have ended without the last line having a newline
-            if (!((bytesRead == 0) && (dataSize > 0))) {
-                for (int i = start; i < dataSize; ++i) {
-                    if (buffer[i] == '\n') {
-                        endOfLine = i;
-                        // We need to NULL the newline in case the line has only an IP range.
-                        // In that case the parser won't work for the end IP, because it ends
-                        // with the newline and not with a number.
-                        buffer[i] = '\0';
-                        break;
-                    }
+    int getlineInStream(QDataStream &stream, std::string &name, const char delim)
+    {
+        char c;
+        int totalRead = 0;
+        int read;
+        do {
+            read = stream.readRawData(&c, 1);
+            totalRead += read;
+            if (read > 0) {
+                if (c != delim) {
+                    name += c;
+                }
+                else {
+                    // Delim found
+                    return totalRead;
                 }
             }
-            else {
-                endOfLine = dataSize;
-                buffer[dataSize] = '\0';
-            }
+        }
+        while (read > 0);
+
+        return totalRead;
+    }
 
-            if (endOfLine == -1) {
-                // read the next chunk from file
-                // but first move(copy) the leftover data to the front of the buffer
-                offset = dataSize - start;
-                memmove(buffer.data(), buffer.data() + start, offset);
+    bool isAdjacentOrOverlapping(const IPv4Range &range, const IPv4Range &next)
+    {
+        return ((range.last == 0xFFFFFFFF) || (next.first <= (range.last + 1)));
+    }
+
+    bool isAdjacentOrOverlapping(const IPv6Range &range, const IPv6Range &next)
+    {
+        if (next.first <= range.last)
+            return true;
+
+        // check if `next` starts right after `range`
+        IPv6Bytes afterLast = range.last;
+        for (int i = (static_cast<int>(afterLast.size()) - 1); i >= 0; --i) {
+            if (++afterLast[i] != 0)
                 break;
-            }
+        }
+        return (next.first == afterLast);
+    }
 
-            ++nbLine;
+    template <typename Range>
+    void sortAndMerge(std::vector<Range> &ranges)
+    {
+        if (ranges.empty())
+            return;
 
-            if ((buffer[start] == '#')
-                || ((buffer[start] == '/') && ((start + 1 < dataSize) && (buffer[start + 1] == '/')))) {
-                start = endOfLine;
-                continue;
-            }
+        std::sort(ranges.begin(), ranges.end(), [](const Range &left, const Range &right)
+        {
+            return (left.first < right.first);
+        });
 
-            // Each line should follow this format:
-            // Some organization:1.0.0.0-1.255.255.255
-            // The "Some organization" part might contain a ':' char itself so we find the last occurrence
-            const int partsDelimiter = findAndNullDelimiter(buffer.data(), ':', start, endOfLine, true);
-            if (partsDelimiter == -1) {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
+        auto merged = ranges.begin();
+        for (auto it = std::next(ranges.begin()); it != ranges.end(); ++it) {
+            if (isAdjacentOrOverlapping(*merged, *it)) {
+                if (merged->last < it->last)
+                    merged->last = it->last;
             }
-
-            // IP Range should be split by a dash
-            const int delimIP = findAndNullDelimiter(buffer.data(), '-', partsDelimiter + 1, endOfLine);
-            if (delimIP == -1) {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
+            else {
+                *(++merged) = *it;
             }
+        }
+        ranges.erase(std::next(merged), ranges.end());
+    }
 
-            lt::address startAddr;
-            int newStart = trim(buffer.data(), partsDelimiter + 1, delimIP - 1);
-            if (!parseIPAddress(buffer.data() + newStart, startAddr)) {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. Start IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+    void parseTextFilterFile(const QString &filePath, const LineParser parseLine, const bool &abort, ParseResult &result)
+    {
+        QFile file(filePath);
+        if (!file.exists()) return;
 
-            lt::address endAddr;
-            newStart = trim(buffer.data(), delimIP + 1, endOfLine);
-            if (!parseIPAddress(buffer.data() + newStart, endAddr)) {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. End IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        if (!file.open(QIODevice::ReadOnly)) {
+            LogMsg(FilterParserThread::tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
+            return;
+        }
 
-            if ((startAddr.is_v4() != endAddr.is_v4())
-                || (startAddr.is_v6() != endAddr.is_v6())) {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!").arg(nbLine));
-                start = endOfLine;
+        QThreadPool threadPool;
+        const int maxChunkCount = qMax(1, QThread::idealThreadCount());
+        threadPool.setMaxThreadCount(maxChunkCount);
+
+        QByteArray buffer;
+        while (!abort) {
+            const QByteArray block = file.read(BLOCK_SIZE);
+            const bool atEnd = block.isEmpty();
+            buffer.append(block);
+
+            // Only complete lines are parsed unless the end of the file is reached
+            const int dataSize = atEnd ? buffer.size() : (buffer.lastIndexOf('\n') + 1);
+            if (dataSize <= 0) {
+                if (atEnd)
+                    break;
                 continue;
             }
 
-            start = endOfLine;
+            // Split the data into chunks ending at line boundaries and parse them in parallel
+            char *data = buffer.data();
+            const int chunkCount = qMin(maxChunkCount, ((dataSize / MIN_CHUNK_SIZE) + 1));
+            std::vector<std::unique_ptr<ChunkParser>> chunkParsers;
+            int chunkStart = 0;
+            while (chunkStart < dataSize) {
+                int chunkEnd = dataSize;
+                const int targetEnd = chunkStart + (dataSize / chunkCount);
+                if (targetEnd < dataSize) {
+                    const auto *newline = static_cast<const char *>(memchr(data + targetEnd, '\n', (dataSize - targetEnd)));
+                    if (newline)
+                        chunkEnd = static_cast<int>(newline - data) + 1;
+                }
 
-            try {
-                m_filter.add_rule(startAddr, endAddr, lt::ip_filter::blocked);
-                ++ruleCount;
+                // the last char of each chunk is either the newline or the terminating null of the buffer
+                chunkParsers.emplace_back(new ChunkParser((data + chunkStart), (chunkEnd - chunkStart), parseLine));
+                threadPool.start(chunkParsers.back().get());
+                chunkStart = chunkEnd;
             }
-            catch (const std::exception &e) {
-                ++parseErrorCount;
-                addLog(tr("IP filter exception thrown for line %1. Exception is: %2")
-                       .arg(nbLine).arg(QString::fromLocal8Bit(e.what())));
+            threadPool.waitForDone();
+
+            for (const std::unique_ptr<ChunkParser> &chunkParser : chunkParsers) {
+                const ParseResult &chunkResult = chunkParser->result();
+                result.ipv4Ranges.insert(result.ipv4Ranges.end(), chunkResult.ipv4Ranges.cbegin(), chunkResult.ipv4Ranges.cend());
+                result.ipv6Ranges.insert(result.ipv6Ranges.end(), chunkResult.ipv6Ranges.cbegin(), chunkResult.ipv6Ranges.cend());
+                result.ruleCount += chunkResult.ruleCount;
+
+                for (const ParseError &error : chunkResult.errors) {
+                    if (result.errors.size() < MAX_LOGGED_ERRORS)
+                        result.errors.append({(result.lineCount + error.line), error.message});
+                }
+                result.errorCount += chunkResult.errorCount;
+                result.lineCount += chunkResult.lineCount;
             }
+
+            buffer.remove(0, dataSize);
+            if (atEnd)
+                break;
         }
 
-        if (start >= dataSize)
-            offset = 0;
+        for (const ParseError &error : asConst(result.errors))
+            LogMsg(error.message.arg(error.line), Log::CRITICAL);
+        if (result.errorCount > MAX_LOGGED_ERRORS)
+            LogMsg(FilterParserThread::tr("%1 extra IP filter parsing errors occurred.", "513 extra IP filter parsing errors occurred.")
+                   .arg(result.errorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
     }
 
-    if (parseErrorCount > MAX_LOGGED_ERRORS)
-        LogMsg(tr("%1 extra IP filter parsing errors occurred.", "513 extra IP filter parsing errors occurred.")
-               .arg(parseErrorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
-    return ruleCount;
-}
+    // Parser for PeerGuardian ip filter in p2b format
+    void parseP2BFilterFile(const QString &filePath, const bool &abort, ParseResult &result)
+    {
+        QFile file(filePath);
+        if (!file.exists()) return;
 
-int FilterParserThread::getlineInStream(QDataStream &stream, std::string &name, const char delim)
-{
-    char c;
-    int totalRead = 0;
-    int read;
-    do {
-        read = stream.readRawData(&c, 1);
-        totalRead += read;
-        if (read > 0) {
-            if (c != delim) {
-                name += c;
-            }
-            else {
-                // Delim found
-                return totalRead;
-            }
+        if (!file.open(QIODevice::ReadOnly)) {
+            LogMsg(FilterParserThread::tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
+            return;
         }
-    }
-    while (read > 0);
 
-    return totalRead;
-}
+        QDataStream stream(&file);
+        // Read header
+        char buf[7];
+        unsigned char version;
+        if (!stream.readRawData(buf, sizeof(buf))
+            || memcmp(buf, "\xFF\xFF\xFF\xFFP2B", 7)
+            || !stream.readRawData(reinterpret_cast<char*>(&version), sizeof(version))) {
+            LogMsg(FilterParserThread::tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
+            return;
+        }
 
-// Parser for PeerGuardian ip filter in p2p format
-int FilterParserThread::parseP2BFilterFile()
-{
-    int ruleCount = 0;
-    QFile file(m_filePath);
-    if (!file.exists()) return ruleCount;
+        const auto addRule = [&result](const unsigned int start, const unsigned int end)
+        {
+            // Network byte order to Host byte order
+            const quint32 first = ntohl(start);
+            const quint32 last = ntohl(end);
+            if (first <= last) {
+                result.ipv4Ranges.push_back({first, last});
+                ++result.ruleCount;
+            }
+        };
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
-        return ruleCount;
-    }
+        if ((version == 1) || (version == 2)) {
+            qDebug ("p2b version 1 or 2");
+            unsigned int start, end;
 
-    QDataStream stream(&file);
-    // Read header
-    char buf[7];
-    unsigned char version;
-    if (!stream.readRawData(buf, sizeof(buf))
-        || memcmp(buf, "\xFF\xFF\xFF\xFFP2B", 7)
-        || !stream.readRawData(reinterpret_cast<char*>(&version), sizeof(version))) {
-        LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-        return ruleCount;
-    }
+            std::string name;
+            while (getlineInStream(stream, name, '\0') && !abort) {
+                if (!stream.readRawData(reinterpret_cast<char*>(&start), sizeof(start))
+                    || !stream.readRawData(reinterpret_cast<char*>(&end), sizeof(end))) {
+                    LogMsg(FilterParserThread::tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
+                    return;
+                }
 
-    if ((version == 1) || (version == 2)) {
-        qDebug ("p2b version 1 or 2");
-        unsigned int start, end;
+                addRule(start, end);
+            }
+        }
+        else if (version == 3) {
+            qDebug ("p2b version 3");
+            unsigned int namecount;
+            if (!stream.readRawData(reinterpret_cast<char*>(&namecount), sizeof(namecount))) {
+                LogMsg(FilterParserThread::tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
+                return;
+            }
+
+            namecount = ntohl(namecount);
+            // Reading names although, we don't really care about them
+            for (unsigned int i = 0; i < namecount; ++i) {
+                std::string name;
+                if (!getlineInStream(stream, name, '\0')) {
+                    LogMsg(FilterParserThread::tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
+                    return;
+                }
 
-        std::string name;
-        while (getlineInStream(stream, name, '\0') && !m_abort) {
-            if (!stream.readRawData(reinterpret_cast<char*>(&start), sizeof(start))
-                || !stream.readRawData(reinterpret_cast<char*>(&end), sizeof(end))) {
-                LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-                return ruleCount;
+                if (abort) return;
             }
 
-            // Network byte order to Host byte order
-            // asio address_v4 constructor expects it
-            // that way
-            const lt::address_v4 first(ntohl(start));
-            const lt::address_v4 last(ntohl(end));
-            // Apply to bittorrent session
-            try {
-                m_filter.add_rule(first, last, lt::ip_filter::blocked);
-                ++ruleCount;
+            // Reading the ranges
+            unsigned int rangecount;
+            if (!stream.readRawData(reinterpret_cast<char*>(&rangecount), sizeof(rangecount))) {
+                LogMsg(FilterParserThread::tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
+                return;
+            }
+
+            rangecount = ntohl(rangecount);
+            unsigned int name, start, end;
+            for (unsigned int i = 0; i < rangecount; ++i) {
+                if (!stream.readRawData(reinterpret_cast<char*>(&name), sizeof(name))
+                    || !stream.readRawData(reinterpret_cast<char*>(&start), sizeof(start))
+                    || !stream.readRawData(reinterpret_cast<char*>(&end), sizeof(end))) {
+                    LogMsg(FilterParserThread::tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
+                    return;
+                }
+
+                addRule(start, end);
+
+                if (abort) return;
             }
-            catch (const std::exception &) {}
         }
-    }
-    else if (version == 3) {
-        qDebug ("p2b version 3");
-        unsigned int namecount;
-        if (!stream.readRawData(reinterpret_cast<char*>(&namecount), sizeof(namecount))) {
-            LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-            return ruleCount;
+        else {
+            LogMsg(FilterParserThread::tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
         }
+    }
 
-        namecount = ntohl(namecount);
-        // Reading names although, we don't really care about them
-        for (unsigned int i = 0; i < namecount; ++i) {
-            std::string name;
-            if (!getlineInStream(stream, name, '\0')) {
-                LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-                return ruleCount;
-            }
+    QString cacheFilePath()
+    {
+        return Utils::Fs::expandPathAbs(specialFolderLocation(SpecialFolder::Cache) + QLatin1Char('/') + QLatin1String(CACHE_FILENAME));
+    }
 
-            if (m_abort) return ruleCount;
-        }
+    CacheHeader makeCacheHeader(const QString &sourcePath)
+    {
+        const QFileInfo sourceInfo {sourcePath};
+        const QByteArray pathHash = QCryptographicHash::hash(
+            Utils::Fs::toUniformPath(sourceInfo.absoluteFilePath()).toUtf8(), QCryptographicHash::Sha1);
+
+        CacheHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+        header.version = CACHE_VERSION;
+        header.sourceSize = sourceInfo.size();
+        header.sourceModified = sourceInfo.lastModified().toMSecsSinceEpoch();
+        memcpy(header.sourcePathHash, pathHash.constData(), sizeof(header.sourcePathHash));
+        return header;
+    }
 
-        // Reading the ranges
-        unsigned int rangecount;
-        if (!stream.readRawData(reinterpret_cast<char*>(&rangecount), sizeof(rangecount))) {
-            LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-            return ruleCount;
+    void saveCache(const QString &sourcePath, const ParseResult &result)
+    {
+        CacheHeader header = makeCacheHeader(sourcePath);
+        header.ruleCount = result.ruleCount;
+        header.ipv4RangeCount = static_cast<quint32>(result.ipv4Ranges.size());
+        header.ipv6RangeCount = static_cast<quint32>(result.ipv6Ranges.size());
+
+        QSaveFile cacheFile {cacheFilePath()};
+        if (!cacheFile.open(QIODevice::WriteOnly)
+            || (cacheFile.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header))
+            || (cacheFile.write(reinterpret_cast<const char *>(result.ipv4Ranges.data()), (result.ipv4Ranges.size() * sizeof(IPv4Range))) == -1)
+            || (cacheFile.write(reinterpret_cast<const char *>(result.ipv6Ranges.data()), (result.ipv6Ranges.size() * sizeof(IPv6Range))) == -1)
+            || !cacheFile.commit()) {
+            qDebug("Couldn't write IP filter cache: %s", qUtf8Printable(cacheFile.errorString()));
         }
+    }
+}
 
-        rangecount = ntohl(rangecount);
-        unsigned int name, start, end;
-        for (unsigned int i = 0; i < rangecount; ++i) {
-            if (!stream.readRawData(reinterpret_cast<char*>(&name), sizeof(name))
-                || !stream.readRawData(reinterpret_cast<char*>(&start), sizeof(start))
-                || !stream.readRawData(reinterpret_cast<char*>(&end), sizeof(end))) {
-                LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-                return ruleCount;
-            }
+FilterParserThread::FilterParserThread(QObject *parent)
+    : QThread(parent)
+    , m_abort(false)
+{
+}
 
-            // Network byte order to Host byte order
-            // asio address_v4 constructor expects it
-            // that way
-            const lt::address_v4 first(ntohl(start));
-            const lt::address_v4 last(ntohl(end));
-            // Apply to bittorrent session
-            try {
-                m_filter.add_rule(first, last, lt::ip_filter::blocked);
-                ++ruleCount;
-            }
-            catch (const std::exception &) {}
+FilterParserThread::~FilterParserThread()
+{
+    m_abort = true;
+    wait();
+}
+
+// Loads the ranges parsed previously from the same filter file
+bool FilterParserThread::loadCache(int &ruleCount)
+{
+    QFile cacheFile {cacheFilePath()};
+    if (!cacheFile.open(QIODevice::ReadOnly) || (cacheFile.size() < static_cast<qint64>(sizeof(CacheHeader))))
+        return false;
+
+    const uchar *data = cacheFile.map(0, cacheFile.size());
+    if (!data)
+        return false;
+
+    CacheHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    const CacheHeader expected = makeCacheHeader(m_filePath);
+    if ((memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0)
+        || (header.version != expected.version)
+        || (header.sourceSize != expected.sourceSize)
+        || (header.sourceModified != expected.sourceModified)
+        || (memcmp(header.sourcePathHash, expected.sourcePathHash, sizeof(header.sourcePathHash)) != 0)) {
+        return false;
+    }
+
+    const qint64 expectedSize = sizeof(CacheHeader)
+        + (static_cast<qint64>(header.ipv4RangeCount) * sizeof(IPv4Range))
+        + (static_cast<qint64>(header.ipv6RangeCount) * sizeof(IPv6Range));
+    if (cacheFile.size() != expectedSize)
+        return false;
 
-            if (m_abort) return ruleCount;
+    const uchar *ptr = data + sizeof(CacheHeader);
+    try {
+        for (quint32 i = 0; (i < header.ipv4RangeCount) && !m_abort; ++i, ptr += sizeof(IPv4Range)) {
+            IPv4Range range;
+            memcpy(&range, ptr, sizeof(range));
+            m_filter.add_rule(lt::address_v4(range.first), lt::address_v4(range.last), lt::ip_filter::blocked);
+        }
+        for (quint32 i = 0; (i < header.ipv6RangeCount) && !m_abort; ++i, ptr += sizeof(IPv6Range)) {
+            IPv6Range range;
+            memcpy(&range, ptr, sizeof(range));
+            m_filter.add_rule(lt::address_v6(range.first), lt::address_v6(range.last), lt::ip_filter::blocked);
         }
     }
-    else {
-        LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
+    catch (const std::exception &e) {
+        // Damaged cache is discarded so the filter file is parsed again
+        qDebug("IP filter cache is invalid: %s", e.what());
+        cacheFile.close();
+        cacheFile.remove();
+        return false;
     }
 
-    return ruleCount;
+    ruleCount = header.ruleCount;
+    return true;
 }
 
 // Process ip filter file
@@ -561,74 +752,60 @@ void FilterParserThread::run()
 {
     qDebug("Processing filter file");
     int ruleCount = 0;
-    if (m_filePath.endsWith(".p2p", Qt::CaseInsensitive)) {
-        // PeerGuardian p2p file
-        ruleCount = parseP2PFilterFile();
-    }
-    else if (m_filePath.endsWith(".p2b", Qt::CaseInsensitive)) {
-        // PeerGuardian p2b file
-        ruleCount = parseP2BFilterFile();
-    }
-    else if (m_filePath.endsWith(".dat", Qt::CaseInsensitive)) {
-        // eMule DAT format
-        ruleCount = parseDATFilterFile();
-    }
-
-    if (m_abort) return;
 
-    try {
-        emit IPFilterParsed(ruleCount);
+    if (QFile::exists(m_filePath) && loadCache(ruleCount)) {
+        qDebug("IP filter loaded from cache");
     }
-    catch (const std::exception &) {
-        emit IPFilterError();
-    }
-
-    qDebug("IP Filter thread: finished parsing, filter applied");
-}
+    else {
+        m_filter = lt::ip_filter();
 
-int FilterParserThread::findAndNullDelimiter(char *const data, const char delimiter, const int start, const int end, const bool reverse)
-{
-    if (!reverse) {
-        for (int i = start; i <= end; ++i) {
-            if (data[i] == delimiter) {
-                data[i] = '\0';
-                return i;
-            }
+        ParseResult result;
+        bool isParsed = true;
+        if (m_filePath.endsWith(".p2p", Qt::CaseInsensitive)) {
+            // PeerGuardian p2p file
+            parseTextFilterFile(m_filePath, parseP2PLine, m_abort, result);
         }
-    }
-    else {
-        for (int i = end; i >= start; --i) {
-            if (data[i] == delimiter) {
-                data[i] = '\0';
-                return i;
-            }
+        else if (m_filePath.endsWith(".p2b", Qt::CaseInsensitive)) {
+            // PeerGuardian p2b file
+            parseP2BFilterFile(m_filePath, m_abort, result);
+        }
+        else if (m_filePath.endsWith(".dat", Qt::CaseInsensitive)) {
+            // eMule DAT format
+            parseTextFilterFile(m_filePath, parseDATLine, m_abort, result);
+        }
+        else {
+            isParsed = false;
         }
-    }
 
-    return -1;
-}
+        if (m_abort) return;
 
-int FilterParserThread::trim(char *const data, const int start, const int end)
-{
-    if (start >= end) return start;
-    int newStart = start;
+        // Overlapping ranges are merged since all of them are blocked
+        sortAndMerge(result.ipv4Ranges);
+        sortAndMerge(result.ipv6Ranges);
+        if (isParsed && (result.ruleCount > 0))
+            saveCache(m_filePath, result);
 
-    for (int i = start; i <= end; ++i) {
-        if (isspace(data[i]) != 0) {
-            data[i] = '\0';
+        try {
+            for (const IPv4Range &range : result.ipv4Ranges)
+                m_filter.add_rule(lt::address_v4(range.first), lt::address_v4(range.last), lt::ip_filter::blocked);
+            for (const IPv6Range &range : result.ipv6Ranges)
+                m_filter.add_rule(lt::address_v6(range.first), lt::address_v6(range.last), lt::ip_filter::blocked);
         }
-        else {
-            newStart = i;
-            break;
+        catch (const std::exception &e) {
+            LogMsg(tr("IP filter exception thrown. Exception is: %1").arg(QString::fromLocal8Bit(e.what())), Log::CRITICAL);
         }
+
+        ruleCount = result.ruleCount;
     }
 
-    for (int i = end; i >= start; --i) {
-        if (isspace(data[i]) != 0)
-            data[i] = '\0';
-        else
-            break;
+    if (m_abort) return;
+
+    try {
+        emit IPFilterParsed(ruleCount);
+    }
+    catch (const std::exception &) {
+        emit IPFilterError();
     }
 
-    return newStart;
+    qDebug("IP Filter thread: finished parsing, filter applied");
 }
@@ -33,8 +33,6 @@
 
 #include <QThread>
 
-class QDataStream;
-
 class FilterParserThread final : public QThread
 {
     Q_OBJECT
@@ -53,12 +51,7 @@ protected:
     void run() override;
 
 private:
-    int findAndNullDelimiter(char *const data, char delimiter, int start, int end, bool reverse = false);
-    int trim(char *const data, int start, int end);
-    int parseDATFilterFile();
-    int parseP2PFilterFile();
-    int getlineInStream(QDataStream &stream, std::string &name, char delim);
-    int parseP2BFilterFile();
+    bool loadCache(int &ruleCount);
 
     bool m_abort;
     QString m_filePath;
@@ -0,0 +1,463 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "iouringstorage.h"
+
+#include <fcntl.h>
+#include <liburing.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include <libtorrent/error_code.hpp>
+#include <libtorrent/file_storage.hpp>
+#include <libtorrent/operations.hpp>
+
+#include <QtGlobal>
+
+namespace
+{
+    // Maximum number of requests submitted to the kernel at once
+    const unsigned int QUEUE_DEPTH = 64;
+    // The files are opened in addition to the ones in libtorrent file pool so their
+    // number is limited for all the torrents together, the requests to the files
+    // which can't be opened use the default storage
+    const std::size_t MAX_OPEN_FILES = 64;
+
+    class Ring
+    {
+        Q_DISABLE_COPY(Ring)
+
+    public:
+        Ring()
+        {
+            const int ret = io_uring_queue_init(QUEUE_DEPTH, &m_ring, 0);
+            m_isValid = (ret == 0);
+            if (!m_isValid)
+                qWarning("io_uring is unavailable, falling back to the default disk I/O. Error: %s", std::strerror(-ret));
+        }
+
+        ~Ring()
+        {
+            if (m_isValid)
+                io_uring_queue_exit(&m_ring);
+        }
+
+        io_uring *get()
+        {
+            return (m_isValid && !m_isBroken) ? &m_ring : nullptr;
+        }
+
+        // The ring can't be used anymore since it may contain requests that weren't submitted
+        void markBroken()
+        {
+            m_isBroken = true;
+        }
+
+    private:
+        io_uring m_ring;
+        bool m_isValid = false;
+        bool m_isBroken = false;
+    };
+
+    // Files opened by all the storages. The least recently used file which isn't
+    // used by a running transfer is closed when another file needs to be opened.
+    class FilePool
+    {
+        Q_DISABLE_COPY(FilePool)
+
+    public:
+        static FilePool &instance()
+        {
+            static FilePool pool;
+            return pool;
+        }
+
+        // Returns -1 if the file can't be opened, otherwise it must be released once the transfer is done
+        int acquire(const void *owner, const lt::file_index_t fileIndex, const std::string &path, const bool isWrite)
+        {
+            const std::lock_guard<std::mutex> lock {m_mutex};
+
+            const auto iter = std::find_if(m_entries.begin(), m_entries.end(), [owner, fileIndex](const Entry &entry)
+            {
+                return ((entry.owner == owner) && (entry.fileIndex == fileIndex) && !entry.isObsolete);
+            });
+            if (iter != m_entries.end()) {
+                if (isWrite && !iter->isWritable)
+                    return -1;
+
+                m_entries.splice(m_entries.begin(), m_entries, iter);
+                ++iter->useCount;
+                return iter->fd;
+            }
+
+            if (m_entries.size() >= MAX_OPEN_FILES) {
+                const auto unusedIter = std::find_if(m_entries.rbegin(), m_entries.rend(), [](const Entry &entry)
+                {
+                    return (entry.useCount == 0);
+                });
+                if (unusedIter == m_entries.rend())
+                    return -1;
+
+                ::close(unusedIter->fd);
+                m_entries.erase(std::next(unusedIter).base());
+            }
+
+            // the files that don't exist yet are created by the default storage
+            int fd = ::open(path.c_str(), (O_RDWR | O_CLOEXEC));
+            const bool isWritable = (fd >= 0);
+            if ((fd < 0) && !isWrite)
+                fd = ::open(path.c_str(), (O_RDONLY | O_CLOEXEC));
+            if (fd < 0)
+                return -1;
+
+            m_entries.push_front({owner, fileIndex, fd, isWritable, 1, false});
+            return fd;
+        }
+
+        void release(const int fd)
+        {
+            const std::lock_guard<std::mutex> lock {m_mutex};
+
+            const auto iter = std::find_if(m_entries.begin(), m_entries.end(), [fd](const Entry &entry)
+            {
+                return (entry.fd == fd);
+            });
+            Q_ASSERT(iter != m_entries.end());
+            if (iter == m_entries.end())
+                return;
+
+            --iter->useCount;
+            if (iter->isObsolete && (iter->useCount == 0)) {
+                ::close(iter->fd);
+                m_entries.erase(iter);
+            }
+        }
+
+        // The files used by running transfers are closed once they are released
+        void closeFiles(const void *owner)
+        {
+            const std::lock_guard<std::mutex> lock {m_mutex};
+
+            for (auto iter = m_entries.begin(); iter != m_entries.end();) {
+                if (iter->owner != owner) {
+                    ++iter;
+                    continue;
+                }
+
+                if (iter->useCount > 0) {
+                    iter->isObsolete = true;
+                    ++iter;
+                    continue;
+                }
+
+                ::close(iter->fd);
+                iter = m_entries.erase(iter);
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            const void *owner;
+            lt::file_index_t fileIndex;
+            int fd;
+            bool isWritable;
+            int useCount;
+            // the file is closed by its storage, it isn't returned anymore
+            bool isObsolete;
+        };
+
+        FilePool() = default;
+
+        std::mutex m_mutex;
+        // most recently used files first
+        std::list<Entry> m_entries;
+    };
+
+    // Releases the files acquired for a transfer
+    class AcquiredFiles
+    {
+        Q_DISABLE_COPY(AcquiredFiles)
+
+    public:
+        AcquiredFiles() = default;
+
+        ~AcquiredFiles()
+        {
+            for (const int fd : m_fds)
+                FilePool::instance().release(fd);
+        }
+
+        void add(const int fd)
+        {
+            m_fds.push_back(fd);
+        }
+
+    private:
+        std::vector<int> m_fds;
+    };
+
+    // Every disk thread has its own ring so they don't need any synchronization
+    Ring &threadRing()
+    {
+        thread_local Ring ring;
+        return ring;
+    }
+
+    struct Request
+    {
+        lt::file_index_t fileIndex;
+        int fd;
+        qint64 offset;
+        qint64 size;
+        int iovIndex;
+        int iovCount;
+        int result;
+    };
+
+    bool isRetriableError(const int error)
+    {
+        return ((error == EAGAIN) || (error == EINTR) || (error == EOPNOTSUPP) || (error == EINVAL));
+    }
+}
+
+IOUringStorage::IOUringStorage(const lt::storage_params &params, lt::file_pool &filePool)
+    : CustomStorage {params, filePool}
+{
+}
+
+IOUringStorage::~IOUringStorage()
+{
+    closeFiles();
+}
+
+int IOUringStorage::readv(const lt::span<const lt::iovec_t> bufs, const lt::piece_index_t piece, const int offset
+                          , const lt::open_mode_t flags, lt::storage_error &ec)
+{
+    int result = 0;
+    if (transfer(Operation::Read, bufs, piece, offset, result, ec))
+        return result;
+
+    return CustomStorage::readv(bufs, piece, offset, flags, ec);
+}
+
+int IOUringStorage::writev(const lt::span<const lt::iovec_t> bufs, const lt::piece_index_t piece, const int offset
+                           , const lt::open_mode_t flags, lt::storage_error &ec)
+{
+    int result = 0;
+    if (transfer(Operation::Write, bufs, piece, offset, result, ec))
+        return result;
+
+    return CustomStorage::writev(bufs, piece, offset, flags, ec);
+}
+
+lt::status_t IOUringStorage::move_storage(const std::string &savePath, const lt::move_flags_t flags, lt::storage_error &ec)
+{
+    closeFiles();
+    return CustomStorage::move_storage(savePath, flags, ec);
+}
+
+void IOUringStorage::rename_file(const lt::file_index_t index, const std::string &newFilename, lt::storage_error &ec)
+{
+    closeFiles();
+    CustomStorage::rename_file(index, newFilename, ec);
+}
+
+void IOUringStorage::release_files(lt::storage_error &ec)
+{
+    closeFiles();
+    CustomStorage::release_files(ec);
+}
+
+void IOUringStorage::delete_files(const lt::remove_flags_t options, lt::storage_error &ec)
+{
+    closeFiles();
+    CustomStorage::delete_files(options, ec);
+}
+
+bool IOUringStorage::transfer(const Operation operation, const lt::span<const lt::iovec_t> bufs, const lt::piece_index_t piece, const int offset
+                              , int &result, lt::storage_error &ec)
+{
+    Ring &ring = threadRing();
+    io_uring *nativeRing = ring.get();
+    if (!nativeRing)
+        return false;
+
+    int size = 0;
+    for (const lt::iovec_t &buf : bufs)
+        size += static_cast<int>(buf.size());
+
+    const lt::file_storage &fileStorage = files();
+    const std::vector<lt::file_slice> slices = fileStorage.map_block(piece, offset, size);
+
+    // Split the buffers between the files, the vector must not be reallocated
+    // after the requests are built since they point into it
+    std::vector<iovec> iovecs;
+    iovecs.reserve(static_cast<std::size_t>(bufs.size()) + slices.size());
+    std::vector<Request> requests;
+    requests.reserve(slices.size());
+
+    AcquiredFiles acquiredFiles;
+    int transferred = 0;
+    std::ptrdiff_t bufIndex = 0;
+    std::ptrdiff_t bufOffset = 0;
+    for (const lt::file_slice &slice : slices) {
+        const bool isPadFile = fileStorage.pad_file_at(slice.file_index);
+        // the data of unwanted files may be kept in the part file
+        if (!isPadFile && !isFileWanted(slice.file_index))
+            return false;
+
+        const int fd = (isPadFile ? -1 : openFile(slice.file_index, operation));
+        if (!isPadFile && (fd < 0))
+            return false;
+        if (!isPadFile)
+            acquiredFiles.add(fd);
+
+        const int iovIndex = static_cast<int>(iovecs.size());
+        for (qint64 remaining = slice.size; remaining > 0;) {
+            const lt::iovec_t &buf = bufs[bufIndex];
+            const qint64 length = std::min<qint64>((buf.size() - bufOffset), remaining);
+            char *data = (buf.data() + bufOffset);
+            if (!isPadFile)
+                iovecs.push_back({data, static_cast<std::size_t>(length)});
+            else if (operation == Operation::Read)
+                std::memset(data, 0, static_cast<std::size_t>(length));
+
+            remaining -= length;
+            bufOffset += length;
+            if (bufOffset == buf.size()) {
+                ++bufIndex;
+                bufOffset = 0;
+            }
+        }
+
+        if (isPadFile) {
+            transferred += static_cast<int>(slice.size);
+            continue;
+        }
+
+        requests.push_back({slice.file_index, fd, slice.offset, slice.size
+                            , iovIndex, (static_cast<int>(iovecs.size()) - iovIndex), 0});
+    }
+
+    for (std::size_t first = 0; first < requests.size(); first += QUEUE_DEPTH) {
+        const unsigned int count = static_cast<unsigned int>(std::min<std::size_t>(QUEUE_DEPTH, (requests.size() - first)));
+        for (std::size_t i = first; i < (first + count); ++i) {
+            Request &request = requests[i];
+            io_uring_sqe *sqe = io_uring_get_sqe(nativeRing);
+            if (operation == Operation::Read)
+                io_uring_prep_readv(sqe, request.fd, &iovecs[request.iovIndex], request.iovCount, request.offset);
+            else
+                io_uring_prep_writev(sqe, request.fd, &iovecs[request.iovIndex], request.iovCount, request.offset);
+            io_uring_sqe_set_data(sqe, &request);
+        }
+
+        unsigned int submitted = 0;
+        bool isSubmitFailed = false;
+        while (submitted < count) {
+            const int ret = io_uring_submit(nativeRing);
+            if (ret == -EINTR)
+                continue;
+            if (ret <= 0) {
+                isSubmitFailed = true;
+                break;
+            }
+            submitted += static_cast<unsigned int>(ret);
+        }
+
+        // The buffers must stay untouched until the kernel is done with all the submitted requests
+        for (unsigned int i = 0; i < submitted; ++i) {
+            io_uring_cqe *cqe = nullptr;
+            int ret = 0;
+            do {
+                ret = io_uring_wait_cqe(nativeRing, &cqe);
+            } while (ret == -EINTR);
+
+            if (ret < 0) {
+                // The state of the remaining requests is unknown so the buffers
+                // can't be passed to the default storage, the job fails instead
+                ring.markBroken();
+                ec.ec.assign(-ret, lt::system_category());
+                ec.file(requests[first].fileIndex);
+                ec.operation = ((operation == Operation::Read) ? lt::operation_t::file_read : lt::operation_t::file_write);
+                result = -1;
+                return true;
+            }
+
+            static_cast<Request *>(io_uring_cqe_get_data(cqe))->result = cqe->res;
+            io_uring_cqe_seen(nativeRing, cqe);
+        }
+
+        if (isSubmitFailed) {
+            ring.markBroken();
+            return false;
+        }
+    }
+
+    for (const Request &request : requests) {
+        if (request.result < 0) {
+            const int error = -request.result;
+            if (isRetriableError(error))
+                return false;
+
+            ec.ec.assign(error, lt::system_category());
+            ec.file(request.fileIndex);
+            ec.operation = ((operation == Operation::Read) ? lt::operation_t::file_read : lt::operation_t::file_write);
+            result = -1;
+            return true;
+        }
+
+        // short transfers (e.g. reading beyond the end of the file) are left to the default storage
+        if (request.result < request.size)
+            return false;
+
+        transferred += request.result;
+    }
+
+    result = transferred;
+    return true;
+}
+
+int IOUringStorage::openFile(const lt::file_index_t fileIndex, const Operation operation)
+{
+    const std::string filePath = files().file_path(fileIndex, savePath().toStdString());
+    return FilePool::instance().acquire(this, fileIndex, filePath, (operation == Operation::Write));
+}
+
+void IOUringStorage::closeFiles()
+{
+    FilePool::instance().closeFiles(this);
+}
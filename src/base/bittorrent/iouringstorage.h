@@ -0,0 +1,67 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <libtorrent/fwd.hpp>
+#include <libtorrent/storage.hpp>
+
+#include "customstorage.h"
+
+// Reads and writes the torrent data using Linux io_uring so that all the parts of
+// a disk job (that may span several files) are submitted to the kernel at once.
+// The requests it can't handle (files that don't exist yet, part files, short
+// transfers or io_uring being unavailable) are passed to the default storage.
+class IOUringStorage final : public CustomStorage
+{
+public:
+    explicit IOUringStorage(const lt::storage_params &params, lt::file_pool &filePool);
+    ~IOUringStorage() override;
+
+    int readv(lt::span<const lt::iovec_t> bufs, lt::piece_index_t piece, int offset, lt::open_mode_t flags, lt::storage_error &ec) override;
+    int writev(lt::span<const lt::iovec_t> bufs, lt::piece_index_t piece, int offset, lt::open_mode_t flags, lt::storage_error &ec) override;
+
+    lt::status_t move_storage(const std::string &savePath, lt::move_flags_t flags, lt::storage_error &ec) override;
+    void rename_file(lt::file_index_t index, const std::string &newFilename, lt::storage_error &ec) override;
+    void release_files(lt::storage_error &ec) override;
+    void delete_files(lt::remove_flags_t options, lt::storage_error &ec) override;
+
+private:
+    enum class Operation
+    {
+        Read,
+        Write
+    };
+
+    // Returns false if the request should be handled by the default storage
+    bool transfer(Operation operation, lt::span<const lt::iovec_t> bufs, lt::piece_index_t piece, int offset
+                  , int &result, lt::storage_error &ec);
+    // Returns the file from the pool shared by all the storages, it is released by the caller
+    int openFile(lt::file_index_t fileIndex, Operation operation);
+    void closeFiles();
+};
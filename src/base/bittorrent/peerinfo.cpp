@@ -28,19 +28,17 @@
 
 #include "peerinfo.h"
 
-#include <QBitArray>
-
-#include "base/bittorrent/torrenthandle.h"
+#include "base/bitfield.h"
 #include "base/net/geoipmanager.h"
 #include "base/unicodestrings.h"
 #include "peeraddress.h"
 
 using namespace BitTorrent;
 
-PeerInfo::PeerInfo(const TorrentHandle *torrent, const lt::peer_info &nativeInfo)
+PeerInfo::PeerInfo(const lt::peer_info &nativeInfo, const Bitfield &allPieces)
     : m_nativeInfo(nativeInfo)
 {
-    calcRelevance(torrent);
+    calcRelevance(allPieces);
     determineFlags();
 }
 
@@ -61,11 +59,19 @@ bool PeerInfo::fromLSD() const
 
 QString PeerInfo::country() const
 {
-    if (m_country.isEmpty())
+    if (!m_isCountryResolved) {
         m_country = Net::GeoIPManager::instance()->lookup(address().ip);
+        m_isCountryResolved = true;
+    }
     return m_country;
 }
 
+void PeerInfo::setCountry(const QString &country)
+{
+    m_country = country;
+    m_isCountryResolved = true;
+}
+
 bool PeerInfo::isInteresting() const
 {
     return static_cast<bool>(m_nativeInfo.flags & lt::peer_info::interesting);
@@ -205,14 +211,9 @@ qlonglong PeerInfo::totalDownload() const
     return m_nativeInfo.total_download;
 }
 
-QBitArray PeerInfo::pieces() const
+Bitfield PeerInfo::pieces() const
 {
-    QBitArray result(m_nativeInfo.pieces.size());
-    for (int i = 0; i < result.size(); ++i) {
-        if (m_nativeInfo.pieces[lt::piece_index_t {i}])
-            result.setBit(i, true);
-    }
-    return result;
+    return Bitfield::fromRawData(m_nativeInfo.pieces.data(), m_nativeInfo.pieces.size());
 }
 
 QString PeerInfo::connectionType() const
@@ -233,21 +234,11 @@ QString PeerInfo::connectionType() const
     return connection;
 }
 
-void PeerInfo::calcRelevance(const TorrentHandle *torrent)
+void PeerInfo::calcRelevance(const Bitfield &allPieces)
 {
-    const QBitArray allPieces = torrent->pieces();
-    const QBitArray peerPieces = pieces();
-
-    int localMissing = 0;
-    int remoteHaves = 0;
-
-    for (int i = 0; i < allPieces.size(); ++i) {
-        if (!allPieces[i]) {
-            ++localMissing;
-            if (peerPieces[i])
-                ++remoteHaves;
-        }
-    }
+    const int localMissing = allPieces.size() - allPieces.count();
+    // pieces the peer has and we are missing
+    const int remoteHaves = (localMissing > 0) ? pieces().countAndNot(allPieces) : 0;
 
     if (localMissing == 0)
         m_relevance = 0.0;
@@ -33,11 +33,10 @@
 
 #include <QCoreApplication>
 
-class QBitArray;
+class Bitfield;
 
 namespace BitTorrent
 {
-    class TorrentHandle;
     struct PeerAddress;
 
     class PeerInfo
@@ -46,7 +45,8 @@ namespace BitTorrent
 
     public:
         PeerInfo() = default;
-        PeerInfo(const TorrentHandle *torrent, const lt::peer_info &nativeInfo);
+        // `allPieces` are the pieces the torrent has, shared by all its peers
+        PeerInfo(const lt::peer_info &nativeInfo, const Bitfield &allPieces);
 
         bool fromDHT() const;
         bool fromPeX() const;
@@ -84,7 +84,7 @@ namespace BitTorrent
         int payloadDownSpeed() const;
         qlonglong totalUpload() const;
         qlonglong totalDownload() const;
-        QBitArray pieces() const;
+        Bitfield pieces() const;
         QString connectionType() const;
         qreal relevance() const;
         QString flags() const;
@@ -92,8 +92,11 @@ namespace BitTorrent
         QString country() const;
         int downloadingPieceIndex() const;
 
+        // Use to supply the country resolved by a batch lookup
+        void setCountry(const QString &country);
+
     private:
-        void calcRelevance(const TorrentHandle *torrent);
+        void calcRelevance(const Bitfield &allPieces);
         void determineFlags();
 
         lt::peer_info m_nativeInfo = {};
@@ -102,6 +105,7 @@ namespace BitTorrent
         QString m_flagsDescription;
 
         mutable QString m_country;
+        mutable bool m_isCountryResolved = false;
     };
 }
 
@@ -0,0 +1,407 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#include "resumedatajournal.h"
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <zlib.h>
+
+#include <QByteArray>
+#include <QSaveFile>
+#include <QStringList>
+#include <QVector>
+#include <QtEndian>
+
+#include "base/global.h"
+#include "base/logger.h"
+
+namespace
+{
+    const char SIGNATURE[] = "qBtRDJ01";
+    const int SIGNATURE_SIZE = sizeof(SIGNATURE) - 1;
+
+    // Each record starts with the header which consists of key size,
+    // data size and CRC-32 checksum of the record (32-bit little-endian numbers)
+    const int RECORD_HEADER_SIZE = 12;
+    // Data size value that denotes the removal of the entry
+    const quint32 REMOVAL_MARK = 0xFFFFFFFF;
+    // Compaction is performed when superseded records take more space
+    // than the actual ones but not before they reach this size
+    const qint64 COMPACTION_THRESHOLD = 4 * 1024 * 1024;
+
+    quint32 recordChecksum(const char *header, const QByteArray &key, const QByteArray &data)
+    {
+        uLong crc = ::crc32(0L, Z_NULL, 0);
+        crc = ::crc32(crc, reinterpret_cast<const Bytef *>(header), 8);
+        crc = ::crc32(crc, reinterpret_cast<const Bytef *>(key.constData()), static_cast<uInt>(key.size()));
+        crc = ::crc32(crc, reinterpret_cast<const Bytef *>(data.constData()), static_cast<uInt>(data.size()));
+        return static_cast<quint32>(crc);
+    }
+
+    int appendRecord(QByteArray &buffer, const QByteArray &key, const QByteArray &data, const bool isRemoval)
+    {
+        char header[RECORD_HEADER_SIZE];
+        qToLittleEndian<quint32>(static_cast<quint32>(key.size()), header);
+        qToLittleEndian<quint32>((isRemoval ? REMOVAL_MARK : static_cast<quint32>(data.size())), (header + 4));
+        qToLittleEndian<quint32>(recordChecksum(header, key, data), (header + 8));
+
+        buffer.append(header, RECORD_HEADER_SIZE);
+        buffer.append(key);
+        buffer.append(data);
+
+        return (RECORD_HEADER_SIZE + key.size() + data.size());
+    }
+
+    bool syncToDisk(QFile &file)
+    {
+        if (!file.flush())
+            return false;
+
+#if defined(Q_OS_WIN)
+        const auto handle = reinterpret_cast<HANDLE>(::_get_osfhandle(file.handle()));
+        return ::FlushFileBuffers(handle);
+#else
+        return (::fsync(file.handle()) == 0);
+#endif
+    }
+}
+
+using namespace BitTorrent;
+
+ResumeDataJournal::ResumeDataJournal(const QString &path)
+    : m_path {path}
+    , m_file {path}
+{
+}
+
+ResumeDataJournal::~ResumeDataJournal()
+{
+    flush();
+}
+
+bool ResumeDataJournal::open()
+{
+    const QWriteLocker locker {&m_lock};
+
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        LogMsg(tr("Couldn't open resume data journal '%1'. Error: %2")
+            .arg(m_path, m_file.errorString()), Log::CRITICAL);
+        return false;
+    }
+
+    if (!load()) {
+        m_file.close();
+        return false;
+    }
+
+    if ((m_garbageSize > m_usedSize) && (m_garbageSize > COMPACTION_THRESHOLD))
+        compact();
+
+    return true;
+}
+
+QString ResumeDataJournal::path() const
+{
+    return m_path;
+}
+
+QStringList ResumeDataJournal::keys() const
+{
+    const QReadLocker locker {&m_lock};
+
+    QStringList result;
+    result.reserve(m_index.size() + m_pendingChanges.size());
+    for (auto iter = m_index.cbegin(); iter != m_index.cend(); ++iter) {
+        if (!m_pendingChanges.contains(iter.key()))
+            result.append(iter.key());
+    }
+    for (auto iter = m_pendingChanges.cbegin(); iter != m_pendingChanges.cend(); ++iter) {
+        if (!iter->isRemoval)
+            result.append(iter.key());
+    }
+
+    return result;
+}
+
+bool ResumeDataJournal::contains(const QString &key) const
+{
+    const QReadLocker locker {&m_lock};
+
+    const auto pendingIter = m_pendingChanges.constFind(key);
+    if (pendingIter != m_pendingChanges.cend())
+        return !pendingIter->isRemoval;
+
+    return m_index.contains(key);
+}
+
+QByteArray ResumeDataJournal::read(const QString &key) const
+{
+    const QReadLocker locker {&m_lock};
+
+    const auto pendingIter = m_pendingChanges.constFind(key);
+    if (pendingIter != m_pendingChanges.cend())
+        return (pendingIter->isRemoval ? QByteArray {} : pendingIter->data);
+
+    const auto iter = m_index.constFind(key);
+    if (iter == m_index.cend())
+        return {};
+
+    // Separate file object is used so that concurrent reads don't interfere
+    QFile file {m_path};
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(iter->dataOffset)) {
+        LogMsg(tr("Couldn't read '%1' from resume data journal '%2'. Error: %3")
+            .arg(key, m_path, file.errorString()), Log::WARNING);
+        return {};
+    }
+
+    const QByteArray data = file.read(iter->dataSize);
+    if (data.size() != iter->dataSize) {
+        LogMsg(tr("Couldn't read '%1' from resume data journal '%2'. Error: %3")
+            .arg(key, m_path, file.errorString()), Log::WARNING);
+        return {};
+    }
+
+    return data;
+}
+
+void ResumeDataJournal::write(const QString &key, const QByteArray &data)
+{
+    const QWriteLocker locker {&m_lock};
+    m_pendingChanges[key] = {false, data};
+}
+
+void ResumeDataJournal::remove(const QString &key)
+{
+    const QWriteLocker locker {&m_lock};
+    m_pendingChanges[key] = {true, {}};
+}
+
+bool ResumeDataJournal::flush()
+{
+    const QWriteLocker locker {&m_lock};
+
+    if (m_pendingChanges.isEmpty() || !m_file.isOpen())
+        return m_pendingChanges.isEmpty();
+
+    struct WrittenRecord
+    {
+        QString key;
+        bool isRemoval;
+        Entry entry;
+    };
+
+    const qint64 startOffset = m_file.size();
+
+    QByteArray buffer;
+    QVector<WrittenRecord> records;
+    records.reserve(m_pendingChanges.size());
+    qint64 offset = startOffset;
+    for (auto iter = m_pendingChanges.cbegin(); iter != m_pendingChanges.cend(); ++iter) {
+        // Nothing to do with removal of nonexistent entry
+        if (iter->isRemoval && !m_index.contains(iter.key()))
+            continue;
+
+        const QByteArray key = iter.key().toUtf8();
+        const int recordSize = appendRecord(buffer, key, iter->data, iter->isRemoval);
+        records.append({iter.key(), iter->isRemoval
+            , {(offset + RECORD_HEADER_SIZE + key.size()), iter->data.size(), recordSize}});
+        offset += recordSize;
+    }
+
+    if (!m_file.seek(startOffset) || (m_file.write(buffer) != buffer.size()) || !syncToDisk(m_file)) {
+        LogMsg(tr("Couldn't write resume data journal '%1'. Error: %2")
+            .arg(m_path, m_file.errorString()), Log::CRITICAL);
+        // Drop partially written records, pending changes are kept for the next attempt
+        m_file.resize(startOffset);
+        return false;
+    }
+
+    for (const WrittenRecord &record : asConst(records)) {
+        const auto iter = m_index.find(record.key);
+        if (iter != m_index.end()) {
+            m_usedSize -= iter->recordSize;
+            m_garbageSize += iter->recordSize;
+            m_index.erase(iter);
+        }
+
+        if (record.isRemoval) {
+            m_garbageSize += record.entry.recordSize;
+        }
+        else {
+            m_index.insert(record.key, record.entry);
+            m_usedSize += record.entry.recordSize;
+        }
+    }
+    m_pendingChanges.clear();
+
+    if ((m_garbageSize > m_usedSize) && (m_garbageSize > COMPACTION_THRESHOLD))
+        compact();
+
+    return true;
+}
+
+bool ResumeDataJournal::load()
+{
+    m_index.clear();
+    m_usedSize = 0;
+    m_garbageSize = 0;
+
+    const qint64 fileSize = m_file.size();
+    if (fileSize == 0) {
+        if ((m_file.write(SIGNATURE, SIGNATURE_SIZE) != SIGNATURE_SIZE) || !syncToDisk(m_file)) {
+            LogMsg(tr("Couldn't write resume data journal '%1'. Error: %2")
+                .arg(m_path, m_file.errorString()), Log::CRITICAL);
+            return false;
+        }
+
+        return true;
+    }
+
+    if (m_file.read(SIGNATURE_SIZE) != QByteArray::fromRawData(SIGNATURE, SIGNATURE_SIZE)) {
+        LogMsg(tr("Resume data journal '%1' has unsupported format.").arg(m_path), Log::CRITICAL);
+        return false;
+    }
+
+    qint64 offset = SIGNATURE_SIZE;
+    while (offset < fileSize) {
+        const QByteArray header = m_file.read(RECORD_HEADER_SIZE);
+        if (header.size() != RECORD_HEADER_SIZE)
+            break;
+
+        const quint32 keySize = qFromLittleEndian<quint32>(header.constData());
+        const quint32 rawDataSize = qFromLittleEndian<quint32>(header.constData() + 4);
+        const bool isRemoval = (rawDataSize == REMOVAL_MARK);
+        const quint32 dataSize = (isRemoval ? 0 : rawDataSize);
+        const qint64 recordSize = RECORD_HEADER_SIZE + static_cast<qint64>(keySize) + dataSize;
+        if ((offset + recordSize) > fileSize)
+            break;
+
+        const QByteArray key = m_file.read(keySize);
+        const QByteArray data = m_file.read(dataSize);
+        if ((static_cast<quint32>(key.size()) != keySize) || (static_cast<quint32>(data.size()) != dataSize))
+            break;
+        if (qFromLittleEndian<quint32>(header.constData() + 8) != recordChecksum(header.constData(), key, data))
+            break;
+
+        const QString name = QString::fromUtf8(key);
+        const auto iter = m_index.find(name);
+        if (iter != m_index.end()) {
+            m_usedSize -= iter->recordSize;
+            m_garbageSize += iter->recordSize;
+            m_index.erase(iter);
+        }
+
+        if (isRemoval) {
+            m_garbageSize += recordSize;
+        }
+        else {
+            m_index.insert(name, {(offset + RECORD_HEADER_SIZE + keySize), static_cast<int>(dataSize), static_cast<int>(recordSize)});
+            m_usedSize += recordSize;
+        }
+
+        offset += recordSize;
+    }
+
+    if (offset < fileSize) {
+        // The tail of the journal is damaged, e.g. the application was terminated while writing it
+        LogMsg(tr("Resume data journal '%1' is damaged. Discarding last %2 bytes.")
+            .arg(m_path, QString::number(fileSize - offset)), Log::WARNING);
+        if (!m_file.resize(offset)) {
+            LogMsg(tr("Couldn't write resume data journal '%1'. Error: %2")
+                .arg(m_path, m_file.errorString()), Log::CRITICAL);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ResumeDataJournal::compact()
+{
+    // Caller must hold the write lock
+
+    QSaveFile file {m_path};
+    const auto fail = [this, &file](const QString &errorString) -> bool
+    {
+        file.cancelWriting();
+        LogMsg(tr("Couldn't compact resume data journal '%1'. Error: %2")
+            .arg(m_path, errorString), Log::WARNING);
+        return false;
+    };
+
+    if (!file.open(QIODevice::WriteOnly) || (file.write(SIGNATURE, SIGNATURE_SIZE) != SIGNATURE_SIZE))
+        return fail(file.errorString());
+
+    QHash<QString, Entry> index;
+    index.reserve(m_index.size());
+    qint64 offset = SIGNATURE_SIZE;
+    for (auto iter = m_index.cbegin(); iter != m_index.cend(); ++iter) {
+        if (!m_file.seek(iter->dataOffset))
+            return fail(m_file.errorString());
+
+        const QByteArray data = m_file.read(iter->dataSize);
+        if (data.size() != iter->dataSize)
+            return fail(m_file.errorString());
+
+        QByteArray record;
+        const QByteArray key = iter.key().toUtf8();
+        const int recordSize = appendRecord(record, key, data, false);
+        if (file.write(record) != record.size())
+            return fail(file.errorString());
+
+        index.insert(iter.key(), {(offset + RECORD_HEADER_SIZE + key.size()), data.size(), recordSize});
+        offset += recordSize;
+    }
+
+    // The journal must be closed before it can be replaced on Windows
+    m_file.close();
+    const bool isCommitted = file.commit();
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        LogMsg(tr("Couldn't open resume data journal '%1'. Error: %2")
+            .arg(m_path, m_file.errorString()), Log::CRITICAL);
+        return false;
+    }
+
+    if (!isCommitted) {
+        LogMsg(tr("Couldn't compact resume data journal '%1'. Error: %2")
+            .arg(m_path, file.errorString()), Log::WARNING);
+        return false;
+    }
+
+    m_index = index;
+    m_usedSize = offset - SIGNATURE_SIZE;
+    m_garbageSize = 0;
+    qDebug("Resume data journal compacted. Size: %lld", offset);
+
+    return true;
+}
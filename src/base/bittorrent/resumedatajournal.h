@@ -0,0 +1,94 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#pragma once
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+
+class QByteArray;
+class QStringList;
+
+namespace BitTorrent
+{
+    // Single file append-only storage of the resume data.
+    // Entries are identified by the file names used by the legacy
+    // resume folder layout (e.g. "<hash>.fastresume", "queue").
+    // Modifications are accumulated in memory and written to the file
+    // by flush() at once, so many entries cost a single write and fsync.
+    // Superseded records are dropped by compaction which runs
+    // automatically once they take more space than the actual ones.
+    // The object can be used from several threads simultaneously.
+    class ResumeDataJournal
+    {
+        Q_DISABLE_COPY(ResumeDataJournal)
+        Q_DECLARE_TR_FUNCTIONS(BitTorrent::ResumeDataJournal)
+
+    public:
+        explicit ResumeDataJournal(const QString &path);
+        ~ResumeDataJournal();
+
+        bool open();
+        QString path() const;
+
+        QStringList keys() const;
+        bool contains(const QString &key) const;
+        QByteArray read(const QString &key) const;
+
+        void write(const QString &key, const QByteArray &data);
+        void remove(const QString &key);
+        bool flush();
+
+    private:
+        struct Entry
+        {
+            qint64 dataOffset;
+            int dataSize;
+            int recordSize;
+        };
+
+        struct PendingChange
+        {
+            bool isRemoval;
+            QByteArray data;
+        };
+
+        bool load();
+        bool compact();
+
+        const QString m_path;
+        mutable QReadWriteLock m_lock;
+        QFile m_file;
+        QHash<QString, Entry> m_index;
+        QHash<QString, PendingChange> m_pendingChanges;
+        qint64 m_usedSize = 0;
+        qint64 m_garbageSize = 0;
+    };
+}
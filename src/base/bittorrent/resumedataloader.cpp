@@ -0,0 +1,274 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "resumedataloader.h"
+
+#include <algorithm>
+
+#include <libtorrent/bdecode.hpp>
+#include <libtorrent/magnet_uri.hpp>
+#include <libtorrent/read_resume_data.hpp>
+
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/profile.h"
+#include "base/utils/fs.h"
+#include "resumedatajournal.h"
+#include "session.h"
+
+namespace
+{
+    // Number of torrents that are decoded by a single task
+    // and handed over to the session at once
+    const int BATCH_SIZE = 64;
+
+    template <typename LTStr>
+    QString fromLTString(const LTStr &str)
+    {
+        return QString::fromUtf8(str.data(), static_cast<int>(str.size()));
+    }
+
+    bool readFile(const QString &path, QByteArray &buf)
+    {
+        QFile file {path};
+        if (!file.open(QIODevice::ReadOnly)) {
+            LogMsg(BitTorrent::ResumeDataLoader::tr("Cannot read file %1: %2").arg(path, file.errorString()), Log::WARNING);
+            return false;
+        }
+
+        buf = file.readAll();
+        return true;
+    }
+
+    bool decodeResumeData(const QByteArray &data, const BitTorrent::TorrentInfo &metadata, BitTorrent::LoadedResumeData &resumeData)
+    {
+        using namespace BitTorrent;
+
+        LoadTorrentParams &torrentParams = resumeData.params;
+
+        lt::error_code ec;
+        const lt::bdecode_node root = lt::bdecode(data, ec);
+        if (ec || (root.type() != lt::bdecode_node::dict_t)) return false;
+
+        torrentParams.restored = true;
+        torrentParams.category = fromLTString(root.dict_find_string_value("qBt-category"));
+        torrentParams.name = fromLTString(root.dict_find_string_value("qBt-name"));
+        torrentParams.savePath = Profile::instance()->fromPortablePath(
+            Utils::Fs::toUniformPath(fromLTString(root.dict_find_string_value("qBt-savePath"))));
+        torrentParams.sequential = root.dict_find_int_value("qBt-sequential");
+        torrentParams.hasSeedStatus = root.dict_find_int_value("qBt-seedStatus");
+        torrentParams.firstLastPiecePriority = root.dict_find_int_value("qBt-firstLastPiecePriority");
+        torrentParams.hasRootFolder = root.dict_find_int_value("qBt-hasRootFolder");
+        torrentParams.seedingTimeLimit = root.dict_find_int_value("qBt-seedingTimeLimit", TorrentHandle::USE_GLOBAL_SEEDING_TIME);
+
+        const lt::string_view ratioLimitString = root.dict_find_string_value("qBt-ratioLimit");
+        if (ratioLimitString.empty())
+            torrentParams.ratioLimit = root.dict_find_int_value("qBt-ratioLimit", TorrentHandle::USE_GLOBAL_RATIO * 1000) / 1000.0;
+        else
+            torrentParams.ratioLimit = fromLTString(ratioLimitString).toDouble();
+
+        const lt::bdecode_node tagsNode = root.dict_find("qBt-tags");
+        if (tagsNode.type() == lt::bdecode_node::list_t) {
+            for (int i = 0; i < tagsNode.list_size(); ++i) {
+                const QString tag = fromLTString(tagsNode.list_string_value_at(i));
+                if (Session::isValidTag(tag))
+                    torrentParams.tags << tag;
+            }
+        }
+
+        lt::add_torrent_params &p = torrentParams.ltAddTorrentParams;
+
+        p = lt::read_resume_data(root, ec);
+        p.save_path = Profile::instance()->fromPortablePath(fromLTString(p.save_path)).toStdString();
+        if (metadata.isValid())
+            p.ti = metadata.nativeInfo();
+
+        const bool hasMetadata = (p.ti && p.ti->is_valid());
+        if (!hasMetadata && !root.dict_find("info-hash")) {
+            // TODO: The following code is deprecated. Remove after several releases in 4.3.x.
+            // === BEGIN DEPRECATED CODE === //
+            // Try to load from legacy data used in older versions for torrents w/o metadata
+            const lt::bdecode_node magnetURINode = root.dict_find("qBt-magnetUri");
+            if (magnetURINode.type() != lt::bdecode_node::string_t)
+                return false;
+
+            lt::parse_magnet_uri(magnetURINode.string_value(), p, ec);
+            resumeData.isLegacyMagnet = true;
+
+            const lt::bdecode_node addedTimeNode = root.dict_find("qBt-addedTime");
+            if (addedTimeNode.type() == lt::bdecode_node::int_t)
+                p.added_time = addedTimeNode.int_value();
+            // === END DEPRECATED CODE === //
+        }
+
+        return true;
+    }
+
+    BitTorrent::LoadedResumeData loadResumeData(const QDir &resumeDataDir, const BitTorrent::ResumeDataJournal *journal
+        , const BitTorrent::InfoHash &hash)
+    {
+        BitTorrent::LoadedResumeData resumeData;
+        resumeData.hash = hash;
+
+        const QString fastresumeName = QString::fromLatin1("%1.fastresume").arg(hash);
+        QByteArray data;
+        if (journal)
+            data = journal->read(fastresumeName);
+        else if (!readFile(resumeDataDir.absoluteFilePath(fastresumeName), data))
+            return resumeData;
+
+        const QString torrentFilePath = resumeDataDir.absoluteFilePath(QString::fromLatin1("%1.torrent").arg(hash));
+        const BitTorrent::TorrentInfo metadata = BitTorrent::TorrentInfo::loadFromFile(torrentFilePath);
+
+        resumeData.isValid = decodeResumeData(data, metadata, resumeData);
+        return resumeData;
+    }
+}
+
+using namespace BitTorrent;
+
+class ResumeDataLoader::LoadTask final : public QRunnable
+{
+public:
+    LoadTask(ResumeDataLoader *loader, const int batchIndex, const QVector<InfoHash> &hashes)
+        : m_loader {loader}
+        , m_batchIndex {batchIndex}
+        , m_hashes {hashes}
+    {
+    }
+
+    void run() override
+    {
+        const QDir resumeDataDir {m_loader->m_resumeFolderPath};
+
+        QVector<LoadedResumeData> batch;
+        batch.reserve(m_hashes.size());
+        for (const InfoHash &hash : asConst(m_hashes)) {
+            if (m_loader->m_aborted) return;
+
+            batch.append(loadResumeData(resumeDataDir, m_loader->m_journal, hash));
+        }
+
+        m_loader->storeResults(m_batchIndex, batch);
+    }
+
+private:
+    ResumeDataLoader *const m_loader;
+    const int m_batchIndex;
+    const QVector<InfoHash> m_hashes;
+};
+
+ResumeDataLoader::ResumeDataLoader(const QString &resumeFolderPath, const ResumeDataJournal *journal, QObject *parent)
+    : QObject {parent}
+    , m_resumeFolderPath {resumeFolderPath}
+    , m_journal {journal}
+{
+    m_threadPool.setMaxThreadCount(std::max(QThread::idealThreadCount(), 2));
+}
+
+ResumeDataLoader::~ResumeDataLoader()
+{
+    m_aborted = true;
+    m_threadPool.clear();
+    m_threadPool.waitForDone();
+}
+
+void ResumeDataLoader::load(const QVector<InfoHash> &hashes)
+{
+    Q_ASSERT(m_totalCount == 0);
+
+    m_elapsedTimer.start();
+    m_totalCount = hashes.size();
+
+    for (int i = 0; i < hashes.size(); i += BATCH_SIZE)
+        m_threadPool.start(new LoadTask {this, m_batchCount++, hashes.mid(i, BATCH_SIZE)});
+
+    if (m_batchCount == 0) {
+        // Nothing to load, but we still need to notify about it asynchronously
+        QMetaObject::invokeMethod(this, "deliverResults", Qt::QueuedConnection);
+    }
+}
+
+int ResumeDataLoader::totalCount() const
+{
+    return m_totalCount;
+}
+
+int ResumeDataLoader::loadedCount() const
+{
+    return m_loadedCount;
+}
+
+qint64 ResumeDataLoader::elapsedTime() const
+{
+    return m_elapsedTimer.elapsed();
+}
+
+void ResumeDataLoader::storeResults(const int batchIndex, const QVector<LoadedResumeData> &batch)
+{
+    // It is called from worker thread
+    {
+        const QMutexLocker locker {&m_resultsMutex};
+        m_results.insert(batchIndex, batch);
+    }
+
+    QMetaObject::invokeMethod(this, "deliverResults", Qt::QueuedConnection);
+}
+
+void ResumeDataLoader::deliverResults()
+{
+    while (m_nextBatchIndex < m_batchCount) {
+        QVector<LoadedResumeData> batch;
+        {
+            const QMutexLocker locker {&m_resultsMutex};
+            // Batches are delivered strictly in order so we
+            // have to wait for the next one if it isn't ready yet
+            const auto iter = m_results.find(m_nextBatchIndex);
+            if (iter == m_results.end())
+                return;
+
+            batch = iter.value();
+            m_results.erase(iter);
+        }
+
+        ++m_nextBatchIndex;
+        m_loadedCount += batch.size();
+        emit batchLoaded(batch);
+    }
+
+    if (!m_isFinished && (m_loadedCount == m_totalCount)) {
+        m_isFinished = true;
+        emit finished();
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+
+#include "infohash.h"
+#include "torrenthandleimpl.h"
+
+namespace BitTorrent
+{
+    class ResumeDataJournal;
+
+    struct LoadedResumeData
+    {
+        InfoHash hash;
+        LoadTorrentParams params;
+        bool isValid = false;
+        // Torrent w/o metadata stored by older versions, its save path
+        // should be determined by the session when it is restored.
+        // TODO: Remove after several releases in 4.3.x.
+        bool isLegacyMagnet = false;
+    };
+
+    // Reads and decodes the stored resume data of the given torrents on a pool
+    // of worker threads. Results are delivered in the order of the initial list
+    // (i.e. it keeps the torrents queue order) in small batches so the session
+    // can feed them to libtorrent while the rest of the data is being decoded.
+    class ResumeDataLoader final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(ResumeDataLoader)
+
+    public:
+        // If journal is provided the resume data is read from it instead of the separate files
+        ResumeDataLoader(const QString &resumeFolderPath, const ResumeDataJournal *journal, QObject *parent = nullptr);
+        ~ResumeDataLoader() override;
+
+        void load(const QVector<InfoHash> &hashes);
+
+        int totalCount() const;
+        int loadedCount() const;
+        qint64 elapsedTime() const;
+
+    signals:
+        void batchLoaded(const QVector<BitTorrent::LoadedResumeData> &batch);
+        void finished();
+
+    private:
+        class LoadTask;
+
+        Q_INVOKABLE void deliverResults();
+        void storeResults(int batchIndex, const QVector<LoadedResumeData> &batch);
+
+        const QString m_resumeFolderPath;
+        const ResumeDataJournal *const m_journal;
+        QThreadPool m_threadPool;
+        std::atomic_bool m_aborted {false};
+        QElapsedTimer m_elapsedTimer;
+
+        QMutex m_resultsMutex;
+        QMap<int, QVector<LoadedResumeData>> m_results;
+
+        int m_batchCount = 0;
+        int m_nextBatchIndex = 0;
+        int m_totalCount = 0;
+        int m_loadedCount = 0;
+        bool m_isFinished = false;
+    };
+}
@@ -28,23 +28,50 @@
 
 #include "resumedatasavingmanager.h"
 
+#include <iterator>
+
 #include <libtorrent/bencode.hpp>
 #include <libtorrent/entry.hpp>
 
 #include <QByteArray>
 #include <QSaveFile>
+#include <QTimer>
 
 #include "base/logger.h"
 #include "base/utils/fs.h"
 #include "base/utils/io.h"
+#include "resumedatajournal.h"
+
+namespace
+{
+    // Changes coming during this interval are written to the journal at once
+    const int JOURNAL_FLUSH_DELAY = 500; // msec
+}
 
-ResumeDataSavingManager::ResumeDataSavingManager(const QString &resumeFolderPath)
+ResumeDataSavingManager::ResumeDataSavingManager(const QString &resumeFolderPath, BitTorrent::ResumeDataJournal *journal)
     : m_resumeDataDir(resumeFolderPath)
+    , m_journal {journal}
+{
+    if (m_journal) {
+        m_journalFlushTimer = new QTimer {this};
+        m_journalFlushTimer->setSingleShot(true);
+        m_journalFlushTimer->setInterval(JOURNAL_FLUSH_DELAY);
+        connect(m_journalFlushTimer, &QTimer::timeout, this, &ResumeDataSavingManager::flushJournal);
+    }
+}
+
+ResumeDataSavingManager::~ResumeDataSavingManager()
 {
+    flushJournal();
 }
 
 void ResumeDataSavingManager::save(const QString &filename, const QByteArray &data) const
 {
+    if (m_journal) {
+        saveToJournal(filename, data);
+        return;
+    }
+
     const QString filepath = m_resumeDataDir.absoluteFilePath(filename);
 
     QSaveFile file {filepath};
@@ -56,6 +83,13 @@ void ResumeDataSavingManager::save(const QString &filename, const QByteArray &da
 
 void ResumeDataSavingManager::save(const QString &filename, const std::shared_ptr<lt::entry> &data) const
 {
+    if (m_journal) {
+        QByteArray buffer;
+        lt::bencode(std::back_inserter(buffer), *data);
+        saveToJournal(filename, buffer);
+        return;
+    }
+
     const QString filepath = m_resumeDataDir.absoluteFilePath(filename);
 
     QSaveFile file {filepath};
@@ -74,7 +108,27 @@ void ResumeDataSavingManager::save(const QString &filename, const std::shared_pt
 
 void ResumeDataSavingManager::remove(const QString &filename) const
 {
+    if (m_journal) {
+        m_journal->remove(filename);
+        if (!m_journalFlushTimer->isActive())
+            m_journalFlushTimer->start();
+        return;
+    }
+
     const QString filepath = m_resumeDataDir.absoluteFilePath(filename);
 
     Utils::Fs::forceRemove(filepath);
 }
+
+void ResumeDataSavingManager::saveToJournal(const QString &filename, const QByteArray &data) const
+{
+    m_journal->write(filename, data);
+    if (!m_journalFlushTimer->isActive())
+        m_journalFlushTimer->start();
+}
+
+void ResumeDataSavingManager::flushJournal() const
+{
+    if (m_journal)
+        m_journal->flush();
+}
@@ -36,6 +36,12 @@
 #include <QObject>
 
 class QByteArray;
+class QTimer;
+
+namespace BitTorrent
+{
+    class ResumeDataJournal;
+}
 
 class ResumeDataSavingManager : public QObject
 {
@@ -43,13 +49,22 @@ class ResumeDataSavingManager : public QObject
     Q_DISABLE_COPY(ResumeDataSavingManager)
 
 public:
-    explicit ResumeDataSavingManager(const QString &resumeFolderPath);
+    // If journal is provided the data is stored in it instead of the separate files
+    explicit ResumeDataSavingManager(const QString &resumeFolderPath, BitTorrent::ResumeDataJournal *journal = nullptr);
+    ~ResumeDataSavingManager() override;
 
 public slots:
     void save(const QString &filename, const QByteArray &data) const;
     void save(const QString &filename, const std::shared_ptr<lt::entry> &data) const;
     void remove(const QString &filename) const;
 
+private slots:
+    void flushJournal() const;
+
 private:
+    void saveToJournal(const QString &filename, const QByteArray &data) const;
+
     const QDir m_resumeDataDir;
+    BitTorrent::ResumeDataJournal *const m_journal;
+    QTimer *m_journalFlushTimer = nullptr;
 };
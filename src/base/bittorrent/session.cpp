@@ -30,6 +30,7 @@
 #include "session.h"
 
 #include <algorithm>
+#include <numeric>
 #include <queue>
 #include <string>
 #include <utility>
@@ -49,23 +50,27 @@
 #include <libtorrent/extensions/ut_pex.hpp>
 #include <libtorrent/ip_filter.hpp>
 #include <libtorrent/magnet_uri.hpp>
-#include <libtorrent/read_resume_data.hpp>
 #include <libtorrent/session.hpp>
 #include <libtorrent/session_stats.hpp>
 #include <libtorrent/session_status.hpp>
 #include <libtorrent/torrent_info.hpp>
 
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QHostAddress>
 #include <QNetworkAddressEntry>
 #include <QNetworkConfigurationManager>
 #include <QNetworkInterface>
 #include <QRegularExpression>
+#include <QSaveFile>
+#include <QStorageInfo>
 #include <QString>
 #include <QThread>
 #include <QTimer>
+#include <QUrl>
 #include <QUuid>
 
 #include "base/algorithm.h"
@@ -92,24 +97,66 @@
 #include "magneturi.h"
 #include "nativesessionextension.h"
 #include "portforwarderimpl.h"
+#include "resumedatajournal.h"
+#include "resumedataloader.h"
 #include "resumedatasavingmanager.h"
 #include "statistics.h"
+#include "torrentdetailscache.h"
 #include "torrenthandleimpl.h"
 #include "tracker.h"
 #include "trackerentry.h"
+#include "transferhistory.h"
 
 static const char PEER_ID[] = "qB";
 static const char RESUME_FOLDER[] = "BT_backup";
+static const char TRANSFER_HISTORY_FOLDER[] = "transfer_history";
+static const char RESUME_JOURNAL_FILE[] = "resumedata.journal";
+static const char RESUME_JOURNAL_EXPORTED_FILE[] = "resumedata.journal.exported";
 static const char USER_AGENT[] = "qBittorrent/" QBT_VERSION_2;
 
 using namespace BitTorrent;
 
 namespace
 {
-    template <typename LTStr>
-    QString fromLTString(const LTStr &str)
+    // Handling of the large batch of alerts is continued in the next
+    // event loop iteration after this time to keep the UI responsive
+    const qint64 ALERT_HANDLING_TIME_SLICE = 50 * 1000 * 1000; // nsecs
+
+    // Returns the device the path belongs to (or would belong to when it is created)
+    QByteArray storageDevice(QString path, QHash<QString, QByteArray> &cache)
+    {
+        const auto iter = cache.constFind(path);
+        if (iter != cache.cend())
+            return iter.value();
+
+        const QString originalPath = path;
+        while (!QFileInfo::exists(path)) {
+            const QString parentPath = Utils::Fs::branchPath(path);
+            if (parentPath.isEmpty() || (parentPath == path))
+                break;
+            path = parentPath;
+        }
+
+        const QStorageInfo storageInfo {path};
+        const QByteArray device = (storageInfo.isValid() ? storageInfo.device() : QByteArray());
+        cache.insert(originalPath, device);
+        return device;
+    }
+
+    void addToIndex(QHash<QString, QSet<InfoHash>> &index, const QString &key, const InfoHash &hash)
     {
-        return QString::fromUtf8(str.data(), static_cast<int>(str.size()));
+        index[key].insert(hash);
+    }
+
+    void removeFromIndex(QHash<QString, QSet<InfoHash>> &index, const QString &key, const InfoHash &hash)
+    {
+        const auto iter = index.find(key);
+        if (iter == index.end())
+            return;
+
+        iter->remove(hash);
+        if (iter->isEmpty())
+            index.erase(iter);
     }
 
     void torrentQueuePositionUp(const lt::torrent_handle &handle)
@@ -283,6 +330,7 @@ Session::Session(QObject *parent)
     , m_announceToAllTrackers(BITTORRENT_SESSION_KEY("AnnounceToAllTrackers"), false)
     , m_announceToAllTiers(BITTORRENT_SESSION_KEY("AnnounceToAllTiers"), true)
     , m_asyncIOThreads(BITTORRENT_SESSION_KEY("AsyncIOThreadsCount"), 4)
+    , m_moveStorageConcurrency(BITTORRENT_SESSION_KEY("MoveStorageConcurrency"), 1)
     , m_filePoolSize(BITTORRENT_SESSION_KEY("FilePoolSize"), 40)
     , m_checkingMemUsage(BITTORRENT_SESSION_KEY("CheckingMemUsageSize"), 32)
 #if (LIBTORRENT_VERSION_NUM >= 10206)
@@ -352,6 +400,8 @@ Session::Session(QObject *parent)
     , m_isAltGlobalSpeedLimitEnabled(BITTORRENT_SESSION_KEY("UseAlternativeGlobalSpeedLimit"), false)
     , m_isBandwidthSchedulerEnabled(BITTORRENT_SESSION_KEY("BandwidthSchedulerEnabled"), false)
     , m_saveResumeDataInterval(BITTORRENT_SESSION_KEY("SaveResumeDataInterval"), 60)
+    , m_resumeDataStorageType(BITTORRENT_SESSION_KEY("ResumeDataStorageType"), ResumeDataStorageType::Legacy
+        , clampValue(ResumeDataStorageType::Legacy, ResumeDataStorageType::Journal))
     , m_port(BITTORRENT_SESSION_KEY("Port"), -1)
     , m_useRandomPort(BITTORRENT_SESSION_KEY("UseRandomPort"), false)
     , m_networkInterface(BITTORRENT_SESSION_KEY("Interface"))
@@ -391,6 +441,8 @@ Session::Session(QObject *parent)
     , m_seedingLimitTimer {new QTimer {this}}
     , m_resumeDataTimer {new QTimer {this}}
     , m_statistics {new Statistics {this}}
+    , m_torrentDetailsCache {new TorrentDetailsCache {this}}
+    , m_transferHistory {new TransferHistory {Utils::Fs::expandPathAbs(specialFolderLocation(SpecialFolder::Data) + TRANSFER_HISTORY_FOLDER)}}
     , m_ioThread {new QThread {this}}
     , m_recentErroredTorrentsTimer {new QTimer {this}}
     , m_networkManager {new QNetworkConfigurationManager {this}}
@@ -405,8 +457,13 @@ Session::Session(QObject *parent)
     connect(m_recentErroredTorrentsTimer, &QTimer::timeout
         , this, [this]() { m_recentErroredTorrents.clear(); });
 
-    m_seedingLimitTimer->setInterval(10000);
+    m_seedingLimitTimer->setSingleShot(true);
     connect(m_seedingLimitTimer, &QTimer::timeout, this, &Session::processShareLimits);
+    m_shareLimitClock.start();
+    m_metricsClock.start();
+    m_alertStatistics.types.resize(lt::num_alert_types);
+    for (int alertType = 0; alertType < m_alertStatistics.types.size(); ++alertType)
+        m_alertStatistics.types[alertType].name = QString::fromLatin1(lt::alert_name(alertType));
 
     initializeNativeSession();
     configureComponents();
@@ -424,7 +481,6 @@ Session::Session(QObject *parent)
     m_tags = List::toSet(m_storedTags.value());
 
     enqueueRefresh();
-    updateSeedingLimitTimer();
     populateAdditionalTrackers();
 
     enableTracker(isTrackerEnabled());
@@ -439,7 +495,9 @@ Session::Session(QObject *parent)
     connect(m_networkManager, &QNetworkConfigurationManager::configurationRemoved, this, &Session::networkConfigurationChange);
     connect(m_networkManager, &QNetworkConfigurationManager::configurationChanged, this, &Session::networkConfigurationChange);
 
-    m_resumeDataSavingManager = new ResumeDataSavingManager {m_resumeFolderPath};
+    initResumeDataStorage();
+
+    m_resumeDataSavingManager = new ResumeDataSavingManager {m_resumeFolderPath, m_resumeDataJournal};
     m_resumeDataSavingManager->moveToThread(m_ioThread);
     connect(m_ioThread, &QThread::finished, m_resumeDataSavingManager, &QObject::deleteLater);
     m_ioThread->start();
@@ -671,25 +729,24 @@ bool Session::editCategory(const QString &name, const QString &savePath)
 
     m_categories[name] = savePath;
     m_storedCategories = map_cast(m_categories);
-    if (isDisableAutoTMMWhenCategorySavePathChanged()) {
-        for (TorrentHandleImpl *const torrent : asConst(m_torrents))
-            if (torrent->category() == name)
-                torrent->setAutoTMMEnabled(false);
-    }
-    else {
-        for (TorrentHandleImpl *const torrent : asConst(m_torrents))
-            if (torrent->category() == name)
-                torrent->handleCategorySavePathChanged();
+    for (const InfoHash &hash : asConst(m_torrentsByCategory.value(name))) {
+        TorrentHandleImpl *const torrent = m_torrents.value(hash);
+        if (isDisableAutoTMMWhenCategorySavePathChanged())
+            torrent->setAutoTMMEnabled(false);
+        else
+            torrent->handleCategorySavePathChanged();
     }
 
+    emit categorySavePathChanged(name);
     return true;
 }
 
 bool Session::removeCategory(const QString &name)
 {
-    for (TorrentHandleImpl *const torrent : asConst(m_torrents))
-        if (torrent->belongsToCategory(name))
-            torrent->setCategory("");
+    if (name.isEmpty()) return false;
+
+    for (const InfoHash &hash : asConst(torrentsByCategory(name)))
+        m_torrents.value(hash)->setCategory("");
 
     // remove stored category and its subcategories if exist
     bool result = false;
@@ -700,6 +757,7 @@ bool Session::removeCategory(const QString &name)
         {
             if (category.startsWith(test)) {
                 result = true;
+                m_transferHistory->removeCategory(category);
                 emit categoryRemoved(category);
                 return true;
             }
@@ -712,6 +770,7 @@ bool Session::removeCategory(const QString &name)
     if (result) {
         // update stored categories
         m_storedCategories = map_cast(m_categories);
+        m_transferHistory->removeCategory(name);
         emit categoryRemoved(name);
     }
 
@@ -774,8 +833,8 @@ bool Session::addTag(const QString &tag)
 bool Session::removeTag(const QString &tag)
 {
     if (m_tags.remove(tag)) {
-        for (TorrentHandleImpl *const torrent : asConst(m_torrents))
-            torrent->removeTag(tag);
+        for (const InfoHash &hash : asConst(m_torrentsByTag.value(tag)))
+            m_torrents.value(hash)->removeTag(tag);
         m_storedTags = m_tags.values();
         emit tagRemoved(tag);
         return true;
@@ -783,6 +842,18 @@ bool Session::removeTag(const QString &tag)
     return false;
 }
 
+QString Session::trackerHost(const QString &trackerUrl)
+{
+    // subdomains are disregarded
+    const QString host = QUrl(trackerUrl).host();
+
+    // host is in IP format
+    if (!QHostAddress(host).isNull())
+        return host;
+
+    return host.section('.', -2, -1);
+}
+
 bool Session::isAutoTMMDisabledByDefault() const
 {
     return m_isAutoTMMDisabledByDefault;
@@ -862,7 +933,7 @@ void Session::setGlobalMaxRatio(qreal ratio)
 
     if (ratio != globalMaxRatio()) {
         m_globalMaxRatio = ratio;
-        updateSeedingLimitTimer();
+        rescheduleShareLimitChecks();
     }
 }
 
@@ -878,13 +949,20 @@ void Session::setGlobalMaxSeedingMinutes(int minutes)
 
     if (minutes != globalMaxSeedingMinutes()) {
         m_globalMaxSeedingMinutes = minutes;
-        updateSeedingLimitTimer();
+        rescheduleShareLimitChecks();
     }
 }
 
 // Main destructor
 Session::~Session()
 {
+    // Stop restoring of the torrents if it is still in progress
+    delete m_resumeDataLoader;
+    m_resumeDataLoader = nullptr;
+    // Wait for the pending queries of the torrent details
+    delete m_torrentDetailsCache;
+    m_torrentDetailsCache = nullptr;
+
     // Do some BT related saving
     saveResumeData();
 
@@ -902,6 +980,9 @@ Session::~Session()
     m_ioThread->quit();
     m_ioThread->wait();
 
+    delete m_resumeDataJournal;
+    delete m_transferHistory;
+
     m_resumeFolderLock->close();
     m_resumeFolderLock->remove();
 }
@@ -1521,74 +1602,168 @@ void Session::processShareLimits()
 {
     qDebug("Processing share limits...");
 
-    // We shouldn't iterate over `m_torrents` in the loop below
-    // since `deleteTorrent()` modifies it indirectly
-    const QHash<InfoHash, TorrentHandleImpl *> torrents {m_torrents};
-    for (TorrentHandleImpl *const torrent : torrents) {
-        if (torrent->isSeed() && !torrent->isForced()) {
-            if (torrent->ratioLimit() != TorrentHandle::NO_RATIO_LIMIT) {
-                const qreal ratio = torrent->realRatio();
-                qreal ratioLimit = torrent->ratioLimit();
-                if (ratioLimit == TorrentHandle::USE_GLOBAL_RATIO)
-                    // If Global Max Ratio is really set...
-                    ratioLimit = globalMaxRatio();
-
-                if (ratioLimit >= 0) {
-                    qDebug("Ratio: %f (limit: %f)", ratio, ratioLimit);
-
-                    if ((ratio <= TorrentHandle::MAX_RATIO) && (ratio >= ratioLimit)) {
-                        if (m_maxRatioAction == Remove) {
-                            LogMsg(tr("'%1' reached the maximum ratio you set. Removed.").arg(torrent->name()));
-                            deleteTorrent(torrent->hash());
-                        }
-                        else if (m_maxRatioAction == DeleteFiles) {
-                            LogMsg(tr("'%1' reached the maximum ratio you set. Removed torrent and its files.").arg(torrent->name()));
-                            deleteTorrent(torrent->hash(), TorrentAndFiles);
-                        }
-                        else if ((m_maxRatioAction == Pause) && !torrent->isPaused()) {
-                            torrent->pause();
-                            LogMsg(tr("'%1' reached the maximum ratio you set. Paused.").arg(torrent->name()));
-                        }
-                        else if ((m_maxRatioAction == EnableSuperSeeding) && !torrent->isPaused() && !torrent->superSeeding()) {
-                            torrent->setSuperSeeding(true);
-                            LogMsg(tr("'%1' reached the maximum ratio you set. Enabled super seeding for it.").arg(torrent->name()));
-                        }
-                        continue;
-                    }
+    const qint64 now = m_shareLimitClock.elapsed() / 1000;
+
+    // Take the due torrents first since `deleteTorrent()` modifies the queue indirectly
+    QVector<InfoHash> dueTorrents;
+    while (!m_shareLimitQueue.isEmpty() && (m_shareLimitQueue.firstKey() <= now)) {
+        const InfoHash hash = m_shareLimitQueue.first();
+        m_shareLimitQueue.erase(m_shareLimitQueue.begin());
+        m_shareLimitDueTimes.remove(hash);
+        dueTorrents.append(hash);
+    }
+
+    for (const InfoHash &hash : asConst(dueTorrents)) {
+        TorrentHandleImpl *const torrent = m_torrents.value(hash);
+        if (!torrent) continue;
+
+        // The torrent that has reached its limits is checked again
+        // only after its state is changed (e.g. it is resumed by user)
+        if (!processTorrentShareLimits(torrent))
+            scheduleShareLimitCheck(torrent);
+    }
+
+    updateSeedingLimitTimer();
+}
+
+bool Session::processTorrentShareLimits(TorrentHandleImpl *const torrent)
+{
+    if (!torrent->isSeed() || torrent->isForced())
+        return false;
+
+    if (torrent->ratioLimit() != TorrentHandle::NO_RATIO_LIMIT) {
+        const qreal ratio = torrent->realRatio();
+        qreal ratioLimit = torrent->ratioLimit();
+        if (ratioLimit == TorrentHandle::USE_GLOBAL_RATIO)
+            // If Global Max Ratio is really set...
+            ratioLimit = globalMaxRatio();
+
+        if (ratioLimit >= 0) {
+            qDebug("Ratio: %f (limit: %f)", ratio, ratioLimit);
+
+            if ((ratio <= TorrentHandle::MAX_RATIO) && (ratio >= ratioLimit)) {
+                if (m_maxRatioAction == Remove) {
+                    LogMsg(tr("'%1' reached the maximum ratio you set. Removed.").arg(torrent->name()));
+                    deleteTorrent(torrent->hash());
+                }
+                else if (m_maxRatioAction == DeleteFiles) {
+                    LogMsg(tr("'%1' reached the maximum ratio you set. Removed torrent and its files.").arg(torrent->name()));
+                    deleteTorrent(torrent->hash(), TorrentAndFiles);
+                }
+                else if ((m_maxRatioAction == Pause) && !torrent->isPaused()) {
+                    torrent->pause();
+                    LogMsg(tr("'%1' reached the maximum ratio you set. Paused.").arg(torrent->name()));
                 }
+                else if ((m_maxRatioAction == EnableSuperSeeding) && !torrent->isPaused() && !torrent->superSeeding()) {
+                    torrent->setSuperSeeding(true);
+                    LogMsg(tr("'%1' reached the maximum ratio you set. Enabled super seeding for it.").arg(torrent->name()));
+                }
+                return true;
             }
+        }
+    }
 
-            if (torrent->seedingTimeLimit() != TorrentHandle::NO_SEEDING_TIME_LIMIT) {
-                const qlonglong seedingTimeInMinutes = torrent->seedingTime() / 60;
-                int seedingTimeLimit = torrent->seedingTimeLimit();
-                if (seedingTimeLimit == TorrentHandle::USE_GLOBAL_SEEDING_TIME) {
-                     // If Global Seeding Time Limit is really set...
-                    seedingTimeLimit = globalMaxSeedingMinutes();
-                }
+    if (torrent->seedingTimeLimit() != TorrentHandle::NO_SEEDING_TIME_LIMIT) {
+        const qlonglong seedingTimeInMinutes = torrent->seedingTime() / 60;
+        int seedingTimeLimit = torrent->seedingTimeLimit();
+        if (seedingTimeLimit == TorrentHandle::USE_GLOBAL_SEEDING_TIME) {
+             // If Global Seeding Time Limit is really set...
+            seedingTimeLimit = globalMaxSeedingMinutes();
+        }
 
-                if (seedingTimeLimit >= 0) {
-                    if ((seedingTimeInMinutes <= TorrentHandle::MAX_SEEDING_TIME) && (seedingTimeInMinutes >= seedingTimeLimit)) {
-                        if (m_maxRatioAction == Remove) {
-                            LogMsg(tr("'%1' reached the maximum seeding time you set. Removed.").arg(torrent->name()));
-                            deleteTorrent(torrent->hash());
-                        }
-                        else if (m_maxRatioAction == DeleteFiles) {
-                            LogMsg(tr("'%1' reached the maximum seeding time you set. Removed torrent and its files.").arg(torrent->name()));
-                            deleteTorrent(torrent->hash(), TorrentAndFiles);
-                        }
-                        else if ((m_maxRatioAction == Pause) && !torrent->isPaused()) {
-                            torrent->pause();
-                            LogMsg(tr("'%1' reached the maximum seeding time you set. Paused.").arg(torrent->name()));
-                        }
-                        else if ((m_maxRatioAction == EnableSuperSeeding) && !torrent->isPaused() && !torrent->superSeeding()) {
-                            torrent->setSuperSeeding(true);
-                            LogMsg(tr("'%1' reached the maximum seeding time you set. Enabled super seeding for it.").arg(torrent->name()));
-                        }
-                    }
+        if (seedingTimeLimit >= 0) {
+            if ((seedingTimeInMinutes <= TorrentHandle::MAX_SEEDING_TIME) && (seedingTimeInMinutes >= seedingTimeLimit)) {
+                if (m_maxRatioAction == Remove) {
+                    LogMsg(tr("'%1' reached the maximum seeding time you set. Removed.").arg(torrent->name()));
+                    deleteTorrent(torrent->hash());
                 }
+                else if (m_maxRatioAction == DeleteFiles) {
+                    LogMsg(tr("'%1' reached the maximum seeding time you set. Removed torrent and its files.").arg(torrent->name()));
+                    deleteTorrent(torrent->hash(), TorrentAndFiles);
+                }
+                else if ((m_maxRatioAction == Pause) && !torrent->isPaused()) {
+                    torrent->pause();
+                    LogMsg(tr("'%1' reached the maximum seeding time you set. Paused.").arg(torrent->name()));
+                }
+                else if ((m_maxRatioAction == EnableSuperSeeding) && !torrent->isPaused() && !torrent->superSeeding()) {
+                    torrent->setSuperSeeding(true);
+                    LogMsg(tr("'%1' reached the maximum seeding time you set. Enabled super seeding for it.").arg(torrent->name()));
+                }
+                return true;
             }
         }
     }
+
+    return false;
+}
+
+void Session::scheduleShareLimitCheck(TorrentHandleImpl *const torrent)
+{
+    unscheduleShareLimitCheck(torrent->hash());
+
+    if (!torrent->isSeed() || torrent->isForced())
+        return;
+
+    // Nothing to do if the action has been already applied
+    if (((m_maxRatioAction == Pause) || (m_maxRatioAction == EnableSuperSeeding)) && torrent->isPaused())
+        return;
+    if ((m_maxRatioAction == EnableSuperSeeding) && torrent->superSeeding())
+        return;
+
+    const qreal ratioLimit = (torrent->ratioLimit() == TorrentHandle::USE_GLOBAL_RATIO)
+        ? globalMaxRatio() : torrent->ratioLimit();
+    const int seedingTimeLimit = (torrent->seedingTimeLimit() == TorrentHandle::USE_GLOBAL_SEEDING_TIME)
+        ? globalMaxSeedingMinutes() : torrent->seedingTimeLimit();
+
+    const qint64 now = m_shareLimitClock.elapsed() / 1000;
+    qint64 dueTime = -1;
+
+    // Ratio is changed only by uploading which is reported by the state updates,
+    // so it is enough to check it when the torrent state is updated
+    if (ratioLimit >= 0) {
+        const qreal ratio = torrent->realRatio();
+        if ((ratio <= TorrentHandle::MAX_RATIO) && (ratio >= ratioLimit))
+            dueTime = now;
+    }
+
+    // Seeding time grows steadily while the torrent is active so the moment
+    // it reaches the limit can be computed in advance
+    if ((dueTime < 0) && (seedingTimeLimit >= 0)) {
+        const qint64 remaining = (seedingTimeLimit * 60LL) - torrent->seedingTime();
+        if (remaining <= 0)
+            dueTime = now;
+        else if (!torrent->isPaused())
+            dueTime = now + remaining;
+    }
+
+    if (dueTime < 0)
+        return;
+
+    m_shareLimitQueue.insert(dueTime, torrent->hash());
+    m_shareLimitDueTimes.insert(torrent->hash(), dueTime);
+
+    if (dueTime == m_shareLimitQueue.firstKey())
+        updateSeedingLimitTimer();
+}
+
+void Session::unscheduleShareLimitCheck(const InfoHash &hash)
+{
+    const auto iter = m_shareLimitDueTimes.find(hash);
+    if (iter == m_shareLimitDueTimes.end())
+        return;
+
+    m_shareLimitQueue.remove(iter.value(), hash);
+    m_shareLimitDueTimes.erase(iter);
+}
+
+void Session::rescheduleShareLimitChecks()
+{
+    m_shareLimitQueue.clear();
+    m_shareLimitDueTimes.clear();
+    for (TorrentHandleImpl *const torrent : asConst(m_torrents))
+        scheduleShareLimitCheck(torrent);
+
+    updateSeedingLimitTimer();
 }
 
 // Add to BitTorrent session the downloaded torrent file
@@ -1608,6 +1783,16 @@ void Session::handleDownloadFinished(const Net::DownloadResult &result)
     }
 }
 
+TorrentDetailsCache *Session::torrentDetailsCache() const
+{
+    return m_torrentDetailsCache;
+}
+
+const TransferHistory *Session::transferHistory() const
+{
+    return m_transferHistory;
+}
+
 // Return the torrent handle, given its hash
 TorrentHandle *Session::findTorrent(const InfoHash &hash) const
 {
@@ -1663,7 +1848,11 @@ bool Session::deleteTorrent(const InfoHash &hash, const DeleteOption deleteOptio
     TorrentHandleImpl *const torrent = m_torrents.take(hash);
     if (!torrent) return false;
 
+    unscheduleShareLimitCheck(hash);
+    m_resumeDataRequestStartTimes.remove(hash);
+
     qDebug("Deleting torrent with hash: %s", qUtf8Printable(torrent->hash()));
+    unindexTorrent(torrent);
     emit torrentAboutToBeRemoved(torrent);
 
     // Remove it from session
@@ -1695,17 +1884,15 @@ bool Session::deleteTorrent(const InfoHash &hash, const DeleteOption deleteOptio
 
         m_removingTorrents[torrent->hash()] = {torrent->name(), rootPath, deleteOption};
 
-        if (m_moveStorageQueue.size() > 1) {
-            // Delete "move storage job" for the deleted torrent
-            // (note: we shouldn't delete active job)
-            const auto iter = std::find_if(m_moveStorageQueue.begin() + 1, m_moveStorageQueue.end()
-                                     , [torrent](const MoveStorageJob &job)
-            {
-                return job.torrentHandle == torrent->nativeHandle();
-            });
-            if (iter != m_moveStorageQueue.end())
-                m_moveStorageQueue.erase(iter);
-        }
+        // Delete "move storage job" for the deleted torrent
+        // (note: we shouldn't delete active job)
+        const auto iter = std::find_if(m_moveStorageQueue.begin(), m_moveStorageQueue.end()
+                                 , [torrent](const MoveStorageJob &job)
+        {
+            return (!job.isActive && (job.torrentHandle == torrent->nativeHandle()));
+        });
+        if (iter != m_moveStorageQueue.end())
+            m_moveStorageQueue.erase(iter);
 
         m_nativeSession->remove_torrent(torrent->nativeHandle(), lt::session::delete_files);
     }
@@ -1718,6 +1905,18 @@ bool Session::deleteTorrent(const InfoHash &hash, const DeleteOption deleteOptio
     for (const QString &file : files)
         Utils::Fs::forceRemove(resumeDataDir.absoluteFilePath(file));
 
+    if (m_resumeDataJournal) {
+        // Remove it using saving manager so it can't be
+        // overwritten by the pending resume data saving
+        const QString filename = QString::fromLatin1("%1.fastresume").arg(torrent->hash());
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+        QMetaObject::invokeMethod(m_resumeDataSavingManager
+            , [this, filename]() { m_resumeDataSavingManager->remove(filename); });
+#else
+        QMetaObject::invokeMethod(m_resumeDataSavingManager, "remove", Q_ARG(QString, filename));
+#endif
+    }
+
     delete torrent;
     return true;
 }
@@ -1841,10 +2040,72 @@ void Session::bottomTorrentsQueuePos(const QVector<InfoHash> &hashes)
     saveTorrentsQueue();
 }
 
+void Session::applyToTorrents(const QVector<TorrentHandle *> &torrents, const std::function<void (TorrentHandle *torrent)> &func)
+{
+    beginBulkUpdate();
+    for (TorrentHandle *const torrent : torrents)
+        func(torrent);
+    endBulkUpdate();
+}
+
+void Session::beginBulkUpdate()
+{
+    ++m_bulkUpdateDepth;
+}
+
+void Session::endBulkUpdate()
+{
+    Q_ASSERT(m_bulkUpdateDepth > 0);
+    if (--m_bulkUpdateDepth > 0)
+        return;
+
+    // the torrents could be deleted in the meantime
+    for (const InfoHash &hash : asConst(m_bulkResumeDataTorrents)) {
+        TorrentHandleImpl *const torrent = m_torrents.value(hash);
+        if (torrent)
+            torrent->saveResumeData();
+    }
+    m_bulkResumeDataTorrents.clear();
+
+    QVector<TorrentHandle *> updatedTorrents;
+    updatedTorrents.reserve(m_bulkUpdatedTorrents.size());
+    for (const InfoHash &hash : asConst(m_bulkUpdatedTorrents)) {
+        TorrentHandleImpl *const torrent = m_torrents.value(hash);
+        if (torrent)
+            updatedTorrents << torrent;
+    }
+    m_bulkUpdatedTorrents.clear();
+
+    if (!updatedTorrents.isEmpty())
+        emit torrentsUpdated(updatedTorrents);
+}
+
+bool Session::isTorrentChangeNotifiable(const TorrentHandleImpl *torrent)
+{
+    if (m_bulkUpdateDepth == 0)
+        return true;
+
+    m_bulkUpdatedTorrents.insert(torrent->hash());
+    return false;
+}
+
+bool Session::deferTorrentResumeDataSaving(const TorrentHandleImpl *torrent)
+{
+    if (m_bulkUpdateDepth == 0)
+        return false;
+
+    m_bulkResumeDataTorrents.insert(torrent->hash());
+    return true;
+}
+
 void Session::handleTorrentSaveResumeDataRequested(const TorrentHandleImpl *torrent)
 {
     qDebug("Saving resume data is requested for torrent '%s'...", qUtf8Printable(torrent->name()));
     ++m_numResumeData;
+
+    // the oldest outstanding request is measured
+    if (!m_resumeDataRequestStartTimes.contains(torrent->hash()))
+        m_resumeDataRequestStartTimes.insert(torrent->hash(), m_metricsClock.nsecsElapsed());
 }
 
 QVector<TorrentHandle *> Session::torrents() const
@@ -1857,6 +2118,119 @@ QVector<TorrentHandle *> Session::torrents() const
     return result;
 }
 
+QSet<InfoHash> Session::torrentsByTrackerHost(const QString &host) const
+{
+    return m_torrentsByTrackerHost.value(host);
+}
+
+int Session::torrentsCountByTrackerHost(const QString &host) const
+{
+    return m_torrentsByTrackerHost.value(host).size();
+}
+
+QStringList Session::torrentTrackerURLs(const InfoHash &hash) const
+{
+    return m_trackerURLsByTorrent.value(hash);
+}
+
+QSet<InfoHash> Session::torrentsByCategory(const QString &category) const
+{
+    QSet<InfoHash> result = m_torrentsByCategory.value(category);
+    if (category.isEmpty() || !isSubcategoriesEnabled())
+        return result;
+
+    const QString prefix = category + '/';
+    for (auto i = m_torrentsByCategory.cbegin(); i != m_torrentsByCategory.cend(); ++i) {
+        if (i.key().startsWith(prefix))
+            result.unite(i.value());
+    }
+    return result;
+}
+
+int Session::torrentsCountByCategory(const QString &category, const bool exactMatch) const
+{
+    int count = m_torrentsByCategory.value(category).size();
+    if (exactMatch || category.isEmpty() || !isSubcategoriesEnabled())
+        return count;
+
+    // the torrent belongs to the single category so the sets don't intersect
+    const QString prefix = category + '/';
+    for (auto i = m_torrentsByCategory.cbegin(); i != m_torrentsByCategory.cend(); ++i) {
+        if (i.key().startsWith(prefix))
+            count += i.value().size();
+    }
+    return count;
+}
+
+QSet<InfoHash> Session::torrentsByTag(const QString &tag) const
+{
+    return m_torrentsByTag.value(tag);
+}
+
+int Session::torrentsCountByTag(const QString &tag) const
+{
+    return m_torrentsByTag.value(tag).size();
+}
+
+void Session::indexTorrent(const TorrentHandleImpl *torrent)
+{
+    const InfoHash hash = torrent->hash();
+
+    addToIndex(m_torrentsByCategory, torrent->category(), hash);
+
+    const QSet<QString> tags = torrent->tags();
+    if (tags.isEmpty())
+        addToIndex(m_torrentsByTag, {}, hash);
+    for (const QString &tag : tags)
+        addToIndex(m_torrentsByTag, tag, hash);
+
+    updateTrackerHostsIndex(torrent);
+}
+
+void Session::unindexTorrent(const TorrentHandleImpl *torrent)
+{
+    const InfoHash hash = torrent->hash();
+
+    removeFromIndex(m_torrentsByCategory, torrent->category(), hash);
+
+    const QSet<QString> tags = torrent->tags();
+    if (tags.isEmpty())
+        removeFromIndex(m_torrentsByTag, {}, hash);
+    for (const QString &tag : tags)
+        removeFromIndex(m_torrentsByTag, tag, hash);
+
+    for (const QString &host : asConst(m_trackerHostsByTorrent.take(hash)))
+        removeFromIndex(m_torrentsByTrackerHost, host, hash);
+    m_trackerURLsByTorrent.remove(hash);
+}
+
+void Session::updateTrackerHostsIndex(const TorrentHandleImpl *torrent)
+{
+    const InfoHash hash = torrent->hash();
+
+    // several trackers of the torrent can share the host
+    QSet<QString> hosts;
+    QStringList urls;
+    for (const TrackerEntry &tracker : asConst(torrent->trackers())) {
+        hosts.insert(trackerHost(tracker.url()));
+        urls.append(tracker.url());
+    }
+    if (hosts.isEmpty())
+        hosts.insert({});
+    m_trackerURLsByTorrent[hash] = urls;
+
+    QSet<QString> &indexedHosts = m_trackerHostsByTorrent[hash];
+    for (const QString &host : asConst(indexedHosts)) {
+        if (!hosts.contains(host))
+            removeFromIndex(m_torrentsByTrackerHost, host, hash);
+    }
+    for (const QString &host : asConst(hosts)) {
+        if (!indexedHosts.contains(host))
+            addToIndex(m_torrentsByTrackerHost, host, hash);
+    }
+    indexedHosts = hosts;
+}
+
 bool Session::addTorrent(const QString &source, const AddTorrentParams &params)
 {
     // `source`: .torrent file path/url or magnet uri
@@ -1985,7 +2359,8 @@ bool Session::addTorrent_impl(const AddTorrentParams &addTorrentParams, const Ma
 
     // We should not add the torrent if it is already
     // processed or is pending to add to session
-    if (m_loadingTorrents.contains(hash) || m_loadedMetadata.contains(hash))
+    if (m_loadingTorrents.contains(hash) || m_loadedMetadata.contains(hash)
+        || m_restoringTorrents.contains(hash))
         return false;
 
     TorrentHandleImpl *const torrent = m_torrents.value(hash);
@@ -2128,6 +2503,7 @@ bool Session::loadMetadata(const MagnetUri &magnetUri)
     if (m_torrents.contains(hash)) return false;
     if (m_loadingTorrents.contains(hash)) return false;
     if (m_loadedMetadata.contains(hash)) return false;
+    if (m_restoringTorrents.contains(hash)) return false;
 
     qDebug("Adding torrent to preload metadata...");
     qDebug(" -> Hash: %s", qUtf8Printable(hash));
@@ -2217,14 +2593,13 @@ void Session::saveResumeData()
         saveTorrentsQueue();
     generateResumeData(true);
 
-    while (m_numResumeData > 0) {
-        const std::vector<lt::alert *> alerts = getPendingAlerts(lt::seconds(30));
-        if (alerts.empty()) {
-            LogMsg(tr("Error: Aborted saving resume data for %1 outstanding torrents.").arg(QString::number(m_numResumeData))
-                , Log::CRITICAL);
-            break;
-        }
+    // The rest of partially handled alert batch becomes invalid
+    // after the next pop so it is processed first
+    std::vector<lt::alert *> alerts {(m_alertBatch.cbegin() + m_alertBatchPosition), m_alertBatch.cend()};
+    m_alertBatch.clear();
+    m_alertBatchPosition = 0;
 
+    while (true) {
         for (const lt::alert *a : alerts) {
             switch (a->type()) {
             case lt::save_resume_data_failed_alert::alert_type:
@@ -2233,11 +2608,25 @@ void Session::saveResumeData()
                 break;
             }
         }
+
+        if (m_numResumeData <= 0)
+            break;
+
+        alerts = getPendingAlerts(lt::seconds(30));
+        if (alerts.empty()) {
+            LogMsg(tr("Error: Aborted saving resume data for %1 outstanding torrents.").arg(QString::number(m_numResumeData))
+                , Log::CRITICAL);
+            break;
+        }
     }
 }
 
 void Session::saveTorrentsQueue()
 {
+    // Queue of partially restored session doesn't contain all the torrents
+    // so we keep the stored one until the restoring is finished
+    if (m_isRestoringTorrents) return;
+
     // store hash in textual representation
     QMap<int, QString> queue; // Use QMap since it should be ordered by key
     for (const TorrentHandleImpl *torrent : asConst(m_torrents)) {
@@ -2600,6 +2989,17 @@ void Session::setSaveResumeDataInterval(const uint value)
     }
 }
 
+ResumeDataStorageType Session::resumeDataStorageType() const
+{
+    return m_resumeDataStorageType;
+}
+
+void Session::setResumeDataStorageType(const ResumeDataStorageType type)
+{
+    // It is applied on the next startup
+    m_resumeDataStorageType = type;
+}
+
 int Session::port() const
 {
     return m_port;
@@ -2948,6 +3348,20 @@ void Session::setAsyncIOThreads(const int num)
     configureDeferred();
 }
 
+int Session::moveStorageConcurrency() const
+{
+    return qBound(1, m_moveStorageConcurrency.value(), 64);
+}
+
+void Session::setMoveStorageConcurrency(const int num)
+{
+    if (num == m_moveStorageConcurrency)
+        return;
+
+    m_moveStorageConcurrency = num;
+    startMoveTorrentStorageJobs();
+}
+
 int Session::filePoolSize() const
 {
     return m_filePoolSize;
@@ -3463,7 +3877,10 @@ MaxRatioAction Session::maxRatioAction() const
 
 void Session::setMaxRatioAction(const MaxRatioAction act)
 {
+    if (act == maxRatioAction()) return;
+
     m_maxRatioAction = static_cast<int>(act);
+    rescheduleShareLimitChecks();
 }
 
 // If this functions returns true, we cannot add torrent to session,
@@ -3472,30 +3889,34 @@ bool Session::isKnownTorrent(const InfoHash &hash) const
 {
     return (m_torrents.contains(hash)
             || m_loadingTorrents.contains(hash)
-            || m_loadedMetadata.contains(hash));
+            || m_loadedMetadata.contains(hash)
+            || m_restoringTorrents.contains(hash));
 }
 
 void Session::updateSeedingLimitTimer()
 {
-    if ((globalMaxRatio() == TorrentHandle::NO_RATIO_LIMIT) && !hasPerTorrentRatioLimit()
-        && (globalMaxSeedingMinutes() == TorrentHandle::NO_SEEDING_TIME_LIMIT) && !hasPerTorrentSeedingTimeLimit()) {
-        if (m_seedingLimitTimer->isActive())
-            m_seedingLimitTimer->stop();
-    }
-    else if (!m_seedingLimitTimer->isActive()) {
-        m_seedingLimitTimer->start();
+    if (m_shareLimitQueue.isEmpty()) {
+        m_seedingLimitTimer->stop();
+        return;
     }
+
+    // Wake up at least once an hour, the timer interval can't hold the long delays
+    const qint64 delay = m_shareLimitQueue.firstKey() - (m_shareLimitClock.elapsed() / 1000);
+    m_seedingLimitTimer->start(static_cast<int>(qBound<qint64>(0, delay, 3600) * 1000));
 }
 
 void Session::handleTorrentShareLimitChanged(TorrentHandleImpl *const torrent)
 {
     torrent->saveResumeData();
-    updateSeedingLimitTimer();
+    scheduleShareLimitCheck(torrent);
+    if (isTorrentChangeNotifiable(torrent))
+        emit torrentShareLimitChanged(torrent);
 }
 
 void Session::handleTorrentNameChanged(TorrentHandleImpl *const torrent)
 {
     torrent->saveResumeData();
+    emit torrentNameChanged(torrent);
 }
 
 void Session::handleTorrentSavePathChanged(TorrentHandleImpl *const torrent)
@@ -3506,18 +3927,35 @@ void Session::handleTorrentSavePathChanged(TorrentHandleImpl *const torrent)
 
 void Session::handleTorrentCategoryChanged(TorrentHandleImpl *const torrent, const QString &oldCategory)
 {
+    if (m_torrents.contains(torrent->hash())) {
+        removeFromIndex(m_torrentsByCategory, oldCategory, torrent->hash());
+        addToIndex(m_torrentsByCategory, torrent->category(), torrent->hash());
+    }
+
     torrent->saveResumeData();
     emit torrentCategoryChanged(torrent, oldCategory);
 }
 
 void Session::handleTorrentTagAdded(TorrentHandleImpl *const torrent, const QString &tag)
 {
+    if (m_torrents.contains(torrent->hash())) {
+        if (torrent->tags().size() == 1)
+            removeFromIndex(m_torrentsByTag, {}, torrent->hash());
+        addToIndex(m_torrentsByTag, tag, torrent->hash());
+    }
+
     torrent->saveResumeData();
     emit torrentTagAdded(torrent, tag);
 }
 
 void Session::handleTorrentTagRemoved(TorrentHandleImpl *const torrent, const QString &tag)
 {
+    if (m_torrents.contains(torrent->hash())) {
+        removeFromIndex(m_torrentsByTag, tag, torrent->hash());
+        if (torrent->tags().isEmpty())
+            addToIndex(m_torrentsByTag, {}, torrent->hash());
+    }
+
     torrent->saveResumeData();
     emit torrentTagRemoved(torrent, tag);
 }
@@ -3525,29 +3963,50 @@ void Session::handleTorrentTagRemoved(TorrentHandleImpl *const torrent, const QS
 void Session::handleTorrentSavingModeChanged(TorrentHandleImpl *const torrent)
 {
     torrent->saveResumeData();
-    emit torrentSavingModeChanged(torrent);
+    if (isTorrentChangeNotifiable(torrent))
+        emit torrentSavingModeChanged(torrent);
 }
 
 void Session::handleTorrentTrackersAdded(TorrentHandleImpl *const torrent, const QVector<TrackerEntry> &newTrackers)
 {
+    if (m_torrents.contains(torrent->hash())) {
+        // the trackers are only added so the rest of the index stays valid
+        const InfoHash hash = torrent->hash();
+        QSet<QString> &indexedHosts = m_trackerHostsByTorrent[hash];
+        if (indexedHosts.remove({}))
+            removeFromIndex(m_torrentsByTrackerHost, {}, hash);
+        QStringList &indexedURLs = m_trackerURLsByTorrent[hash];
+        for (const TrackerEntry &newTracker : newTrackers) {
+            indexedURLs.append(newTracker.url());
+            const QString host = trackerHost(newTracker.url());
+            if (!indexedHosts.contains(host)) {
+                indexedHosts.insert(host);
+                addToIndex(m_torrentsByTrackerHost, host, hash);
+            }
+        }
+    }
+
     torrent->saveResumeData();
 
     for (const TrackerEntry &newTracker : newTrackers)
         LogMsg(tr("Tracker '%1' was added to torrent '%2'").arg(newTracker.url(), torrent->name()));
     emit trackersAdded(torrent, newTrackers);
-    if (torrent->trackers().size() == newTrackers.size())
+    if (torrent->trackersCount() == newTrackers.size())
         emit trackerlessStateChanged(torrent, false);
     emit trackersChanged(torrent);
 }
 
 void Session::handleTorrentTrackersRemoved(TorrentHandleImpl *const torrent, const QVector<TrackerEntry> &deletedTrackers)
 {
+    if (m_torrents.contains(torrent->hash()))
+        updateTrackerHostsIndex(torrent);
+
     torrent->saveResumeData();
 
     for (const TrackerEntry &deletedTracker : deletedTrackers)
         LogMsg(tr("Tracker '%1' was deleted from torrent '%2'").arg(deletedTracker.url(), torrent->name()));
     emit trackersRemoved(torrent, deletedTrackers);
-    if (torrent->trackers().size() == 0)
+    if (torrent->trackersCount() == 0)
         emit trackerlessStateChanged(torrent, true);
     emit trackersChanged(torrent);
 }
@@ -3574,6 +4033,9 @@ void Session::handleTorrentUrlSeedsRemoved(TorrentHandleImpl *const torrent, con
 
 void Session::handleTorrentMetadataReceived(TorrentHandleImpl *const torrent)
 {
+    // the metadata can bring more trackers
+    updateTrackerHostsIndex(torrent);
+
     torrent->saveResumeData();
 
     // Save metadata
@@ -3597,13 +4059,15 @@ void Session::handleTorrentPaused(TorrentHandleImpl *const torrent)
 {
     if (!torrent->hasError() && !torrent->hasMissingFiles())
         torrent->saveResumeData();
-    emit torrentPaused(torrent);
+    if (isTorrentChangeNotifiable(torrent))
+        emit torrentPaused(torrent);
 }
 
 void Session::handleTorrentResumed(TorrentHandleImpl *const torrent)
 {
     torrent->saveResumeData();
-    emit torrentResumed(torrent);
+    if (isTorrentChangeNotifiable(torrent))
+        emit torrentResumed(torrent);
 }
 
 void Session::handleTorrentChecked(TorrentHandleImpl *const torrent)
@@ -3650,6 +4114,12 @@ void Session::handleTorrentResumeDataReady(TorrentHandleImpl *const torrent, con
 {
     --m_numResumeData;
 
+    const auto startTimeIter = m_resumeDataRequestStartTimes.find(torrent->hash());
+    if (startTimeIter != m_resumeDataRequestStartTimes.end()) {
+        m_resumeDataRequestTime.addSample(m_metricsClock.nsecsElapsed() - startTimeIter.value());
+        m_resumeDataRequestStartTimes.erase(startTimeIter);
+    }
+
     // Separated thread is used for the blocking IO which results in slow processing of many torrents.
     // Copying lt::entry objects around isn't cheap.
 
@@ -3680,24 +4150,22 @@ bool Session::addMoveTorrentStorageJob(TorrentHandleImpl *torrent, const QString
     const lt::torrent_handle torrentHandle = torrent->nativeHandle();
     const QString currentLocation = torrent->actualStorageLocation();
 
-    if (m_moveStorageQueue.size() > 1) {
-        const auto iter = std::find_if(m_moveStorageQueue.begin() + 1, m_moveStorageQueue.end()
-                                 , [&torrentHandle](const MoveStorageJob &job)
-        {
-            return job.torrentHandle == torrentHandle;
-        });
-
-        if (iter != m_moveStorageQueue.end()) {
-            // remove existing inactive job
-            m_moveStorageQueue.erase(iter);
-            LogMsg(tr("Cancelled moving \"%1\" from \"%2\" to \"%3\".").arg(torrent->name(), currentLocation, iter->path));
-        }
+    const auto iter = std::find_if(m_moveStorageQueue.begin(), m_moveStorageQueue.end()
+                             , [&torrentHandle](const MoveStorageJob &job)
+    {
+        return (!job.isActive && (job.torrentHandle == torrentHandle));
+    });
+    if (iter != m_moveStorageQueue.end()) {
+        // remove existing inactive job
+        LogMsg(tr("Cancelled moving \"%1\" from \"%2\" to \"%3\".").arg(torrent->name(), currentLocation, iter->path));
+        m_moveStorageQueue.erase(iter);
     }
 
-    if (!m_moveStorageQueue.isEmpty() && (m_moveStorageQueue.first().torrentHandle == torrentHandle)) {
+    const auto activeJobIter = findActiveMoveStorageJob(torrentHandle);
+    if (activeJobIter != m_moveStorageQueue.end()) {
         // if there is active job for this torrent prevent creating meaningless
         // job that will move torrent to the same location as current one
-        if (QDir {m_moveStorageQueue.first().path} == QDir {newPath}) {
+        if (QDir {activeJobIter->path} == QDir {newPath}) {
             LogMsg(tr("Couldn't enqueue move of \"%1\" to \"%2\". Torrent is currently moving to the same destination location.")
                    .arg(torrent->name(), newPath));
             return false;
@@ -3711,16 +4179,132 @@ bool Session::addMoveTorrentStorageJob(TorrentHandleImpl *torrent, const QString
         }
     }
 
-    const MoveStorageJob moveStorageJob {torrentHandle, newPath, mode};
+    MoveStorageJob moveStorageJob {torrentHandle, newPath, mode};
+    const int filesCount = torrent->filesCount();
+    moveStorageJob.filePaths.reserve(filesCount);
+    moveStorageJob.fileSizes.reserve(filesCount);
+    for (int i = 0; i < filesCount; ++i) {
+        const qint64 fileSize = torrent->fileSize(i);
+        moveStorageJob.filePaths << torrent->filePath(i);
+        moveStorageJob.fileSizes << fileSize;
+        moveStorageJob.totalSize += fileSize;
+    }
     m_moveStorageQueue << moveStorageJob;
     LogMsg(tr("Enqueued to move \"%1\" from \"%2\" to \"%3\".").arg(torrent->name(), currentLocation, newPath));
 
-    if (m_moveStorageQueue.size() == 1)
-        moveTorrentStorage(moveStorageJob);
+    startMoveTorrentStorageJobs();
 
     return true;
 }
 
+// Starts the queued jobs allowed by the concurrency limits. The jobs of the same torrent
+// are processed one by one in order they were added. The moves within the same filesystem
+// are just renames so they are started immediately instead of waiting behind the copies.
+void Session::startMoveTorrentStorageJobs()
+{
+    const int concurrency = moveStorageConcurrency();
+
+    QHash<QByteArray, int> activeJobCounts;
+    for (const MoveStorageJob &job : asConst(m_moveStorageQueue)) {
+        if (job.isActive && !job.deviceKey.isEmpty())
+            ++activeJobCounts[job.deviceKey];
+    }
+
+    QHash<QString, QByteArray> deviceCache;
+    QSet<InfoHash> busyTorrents;
+    for (MoveStorageJob &job : m_moveStorageQueue) {
+        const InfoHash infoHash = job.torrentHandle.info_hash();
+        if (busyTorrents.contains(infoHash))
+            continue;
+
+        busyTorrents.insert(infoHash);
+        if (job.isActive)
+            continue;
+
+        const TorrentHandleImpl *torrent = m_torrents.value(infoHash);
+        job.sourcePath = (torrent ? torrent->actualStorageLocation()
+            : QString::fromStdString(job.torrentHandle.status(lt::torrent_handle::query_save_path).save_path));
+        if (!job.isDeviceKeyKnown) {
+            const QByteArray sourceDevice = storageDevice(job.sourcePath, deviceCache);
+            const QByteArray destinationDevice = storageDevice(job.path, deviceCache);
+            if (sourceDevice.isEmpty() || (sourceDevice != destinationDevice))
+                job.deviceKey = sourceDevice + '\n' + destinationDevice;
+            job.isDeviceKeyKnown = true;
+        }
+
+        if (!job.deviceKey.isEmpty()) {
+            int &activeJobCount = activeJobCounts[job.deviceKey];
+            if (activeJobCount >= concurrency)
+                continue;
+            ++activeJobCount;
+        }
+
+        job.isActive = true;
+        job.timer.start();
+        moveTorrentStorage(job);
+    }
+}
+
+QList<Session::MoveStorageJob>::iterator Session::findActiveMoveStorageJob(const lt::torrent_handle &torrentHandle)
+{
+    return std::find_if(m_moveStorageQueue.begin(), m_moveStorageQueue.end()
+                        , [&torrentHandle](const MoveStorageJob &job)
+    {
+        return (job.isActive && (job.torrentHandle == torrentHandle));
+    });
+}
+
+QVector<MoveStorageJobInfo> Session::moveStorageJobs() const
+{
+    QVector<MoveStorageJobInfo> jobs;
+    jobs.reserve(m_moveStorageQueue.size());
+
+    for (const MoveStorageJob &job : asConst(m_moveStorageQueue)) {
+        const InfoHash infoHash = job.torrentHandle.info_hash();
+        const TorrentHandleImpl *torrent = m_torrents.value(infoHash);
+
+        MoveStorageJobInfo jobInfo;
+        jobInfo.hash = infoHash;
+        jobInfo.name = (torrent ? torrent->name() : QString {infoHash});
+        jobInfo.sourcePath = (job.isActive ? job.sourcePath
+            : (torrent ? torrent->actualStorageLocation() : QString {}));
+        jobInfo.destinationPath = job.path;
+        jobInfo.isActive = job.isActive;
+        jobInfo.isSameDevice = (job.isDeviceKeyKnown && job.deviceKey.isEmpty());
+        jobInfo.totalSize = job.totalSize;
+
+        if (job.isActive) {
+            jobInfo.elapsedTime = job.timer.elapsed();
+            // libtorrent doesn't report the progress of moving so it is estimated by the data
+            // found at the destination. Files are copied one by one in order, so the last
+            // file present there is found by binary search instead of checking every file.
+            if (!jobInfo.isSameDevice) {
+                int low = 0;
+                int high = job.filePaths.size();
+                qint64 lastFileSize = 0;
+                while (low < high) {
+                    const int middle = low + ((high - low) / 2);
+                    const QFileInfo destinationFile {job.path + QLatin1Char('/') + job.filePaths[middle]};
+                    if (destinationFile.exists()) {
+                        lastFileSize = std::min(job.fileSizes[middle], destinationFile.size());
+                        low = middle + 1;
+                    }
+                    else {
+                        high = middle;
+                    }
+                }
+
+                if (low > 0)
+                    jobInfo.movedSize = std::accumulate(job.fileSizes.cbegin(), (job.fileSizes.cbegin() + (low - 1)), lastFileSize);
+            }
+        }
+
+        jobs.append(jobInfo);
+    }
+
+    return jobs;
+}
+
 void Session::moveTorrentStorage(const MoveStorageJob &job) const
 {
     const InfoHash infoHash = job.torrentHandle.info_hash();
@@ -3733,9 +4317,15 @@ void Session::moveTorrentStorage(const MoveStorageJob &job) const
                             ? lt::move_flags_t::always_replace_files : lt::move_flags_t::dont_replace));
 }
 
-void Session::handleMoveTorrentStorageJobFinished()
+void Session::handleMoveTorrentStorageJobFinished(const lt::torrent_handle &torrentHandle)
 {
-    const MoveStorageJob finishedJob = m_moveStorageQueue.takeFirst();
+    const auto finishedJobIter = findActiveMoveStorageJob(torrentHandle);
+    Q_ASSERT(finishedJobIter != m_moveStorageQueue.end());
+    if (finishedJobIter == m_moveStorageQueue.end())
+        return;
+
+    const MoveStorageJob finishedJob = *finishedJobIter;
+    m_moveStorageQueue.erase(finishedJobIter);
 
     const auto iter = std::find_if(m_moveStorageQueue.cbegin(), m_moveStorageQueue.cend()
                                    , [&finishedJob](const MoveStorageJob &job)
@@ -3759,8 +4349,7 @@ void Session::handleMoveTorrentStorageJobFinished()
         }
     }
 
-    if (!m_moveStorageQueue.isEmpty())
-        moveTorrentStorage(m_moveStorageQueue.first());
+    startMoveTorrentStorageJobs();
 }
 
 void Session::handleTorrentTrackerWarning(TorrentHandleImpl *const torrent, const QString &trackerUrl)
@@ -3768,22 +4357,6 @@ void Session::handleTorrentTrackerWarning(TorrentHandleImpl *const torrent, cons
     emit trackerWarning(torrent, trackerUrl);
 }
 
-bool Session::hasPerTorrentRatioLimit() const
-{
-    return std::any_of(m_torrents.cbegin(), m_torrents.cend(), [](const TorrentHandleImpl *torrent)
-    {
-        return (torrent->ratioLimit() >= 0);
-    });
-}
-
-bool Session::hasPerTorrentSeedingTimeLimit() const
-{
-    return std::any_of(m_torrents.cbegin(), m_torrents.cend(), [](const TorrentHandleImpl *torrent)
-    {
-        return (torrent->seedingTimeLimit() >= 0);
-    });
-}
-
 void Session::initResumeFolder()
 {
     m_resumeFolderPath = Utils::Fs::expandPathAbs(specialFolderLocation(SpecialFolder::Data) + RESUME_FOLDER);
@@ -3801,6 +4374,116 @@ void Session::initResumeFolder()
     }
 }
 
+void Session::initResumeDataStorage()
+{
+    const QString journalPath = QDir(m_resumeFolderPath).absoluteFilePath(RESUME_JOURNAL_FILE);
+
+    if (resumeDataStorageType() == ResumeDataStorageType::Legacy) {
+        // Resume data could be stored in the journal by the previous session
+        if (QFile::exists(journalPath))
+            exportResumeDataJournal();
+        return;
+    }
+
+    // Separate files could be written by the sessions which didn't use the journal
+    // after it was last modified, so they are imported if they are newer
+    const QFileInfo journalInfo {journalPath};
+    const QDateTime journalModified = (journalInfo.exists() ? journalInfo.lastModified() : QDateTime {});
+    m_resumeDataJournal = new ResumeDataJournal {journalPath};
+    if (!m_resumeDataJournal->open()) {
+        LogMsg(tr("Couldn't use resume data journal. Falling back to separate resume data files."), Log::CRITICAL);
+        delete m_resumeDataJournal;
+        m_resumeDataJournal = nullptr;
+        return;
+    }
+
+    importLegacyResumeData(journalModified);
+}
+
+// Moves the separate resume data files to the journal. The files which aren't newer
+// than the journal (if it isn't new) are left over by the previous import, their
+// data is in the journal already, unless it is missing there.
+void Session::importLegacyResumeData(const QDateTime &journalModified)
+{
+    const QDir resumeDataDir {m_resumeFolderPath};
+    QStringList filenames = resumeDataDir.entryList(
+                QStringList(QLatin1String("*.fastresume")), QDir::Files, QDir::Unsorted);
+    if (resumeDataDir.exists(QLatin1String {"queue"}))
+        filenames.append(QLatin1String {"queue"});
+    if (filenames.isEmpty()) return;
+
+    LogMsg(tr("Moving %1 resume data entries to journal '%2'...")
+        .arg(QString::number(filenames.size()), Utils::Fs::toNativePath(m_resumeDataJournal->path())));
+
+    for (const QString &filename : asConst(filenames)) {
+        QFile file {resumeDataDir.absoluteFilePath(filename)};
+        if (journalModified.isValid() && m_resumeDataJournal->contains(filename)
+            && (QFileInfo {file}.lastModified() <= journalModified)) {
+            continue;
+        }
+
+        if (!file.open(QIODevice::ReadOnly)) {
+            LogMsg(tr("Cannot read file %1: %2").arg(file.fileName(), file.errorString()), Log::WARNING);
+            continue;
+        }
+
+        m_resumeDataJournal->write(filename, file.readAll());
+    }
+
+    // Separate files are removed only when their data is safely stored in the journal
+    if (!m_resumeDataJournal->flush()) return;
+
+    for (const QString &filename : asConst(filenames))
+        Utils::Fs::forceRemove(resumeDataDir.absoluteFilePath(filename));
+}
+
+void Session::exportResumeDataJournal()
+{
+    const QDir resumeDataDir {m_resumeFolderPath};
+    const QString journalPath = resumeDataDir.absoluteFilePath(RESUME_JOURNAL_FILE);
+
+    bool isExported = true;
+    {
+        // Journal file is closed when leaving the scope so it can be renamed
+        ResumeDataJournal journal {journalPath};
+        if (!journal.open()) return;
+
+        const QStringList filenames = journal.keys();
+        LogMsg(tr("Moving %1 resume data entries from journal '%2'...")
+            .arg(QString::number(filenames.size()), Utils::Fs::toNativePath(journalPath)));
+
+        for (const QString &filename : filenames) {
+            const QByteArray data = journal.read(filename);
+            const QString filepath = resumeDataDir.absoluteFilePath(filename);
+
+            QSaveFile file {filepath};
+            if (!file.open(QIODevice::WriteOnly) || (file.write(data) != data.size()) || !file.commit()) {
+                LogMsg(tr("Couldn't save data to '%1'. Error: %2")
+                    .arg(filepath, file.errorString()), Log::CRITICAL);
+                isExported = false;
+            }
+        }
+    }
+
+    if (isExported) {
+        Utils::Fs::forceRemove(journalPath);
+        return;
+    }
+
+    // Keep the journal if something went wrong so the data isn't lost, but move it out of
+    // the way so it isn't exported again over the newer files saved by the following sessions
+    const QString exportedPath = resumeDataDir.absoluteFilePath(RESUME_JOURNAL_EXPORTED_FILE);
+    Utils::Fs::forceRemove(exportedPath);
+    if (!QFile::rename(journalPath, exportedPath)) {
+        LogMsg(tr("Couldn't rename '%1' to '%2'. Removing it to avoid overwriting newer resume data.")
+            .arg(Utils::Fs::toNativePath(journalPath), Utils::Fs::toNativePath(exportedPath)), Log::CRITICAL);
+        Utils::Fs::forceRemove(journalPath);
+        return;
+    }
+    LogMsg(tr("Some resume data entries couldn't be moved from journal. It is kept as '%1'.")
+        .arg(Utils::Fs::toNativePath(exportedPath)), Log::WARNING);
+}
+
 void Session::configureDeferred()
 {
     if (m_deferredConfigureScheduled)
@@ -3881,106 +4564,58 @@ const CacheStatus &Session::cacheStatus() const
     return m_cacheStatus;
 }
 
-bool Session::loadTorrentResumeData(const QByteArray &data, const TorrentInfo &metadata, LoadTorrentParams &torrentParams)
+const QVector<SessionStatsMetric> &Session::sessionStatsMetrics()
 {
-    torrentParams = {};
-
-    lt::error_code ec;
-    const lt::bdecode_node root = lt::bdecode(data, ec);
-    if (ec || (root.type() != lt::bdecode_node::dict_t)) return false;
-
-    torrentParams.restored = true;
-    torrentParams.category = fromLTString(root.dict_find_string_value("qBt-category"));
-    torrentParams.name = fromLTString(root.dict_find_string_value("qBt-name"));
-    torrentParams.savePath = Profile::instance()->fromPortablePath(
-        Utils::Fs::toUniformPath(fromLTString(root.dict_find_string_value("qBt-savePath"))));
-    torrentParams.sequential = root.dict_find_int_value("qBt-sequential");
-    torrentParams.hasSeedStatus = root.dict_find_int_value("qBt-seedStatus");
-    torrentParams.firstLastPiecePriority = root.dict_find_int_value("qBt-firstLastPiecePriority");
-    torrentParams.hasRootFolder = root.dict_find_int_value("qBt-hasRootFolder");
-    torrentParams.seedingTimeLimit = root.dict_find_int_value("qBt-seedingTimeLimit", TorrentHandle::USE_GLOBAL_SEEDING_TIME);
-
-    const lt::string_view ratioLimitString = root.dict_find_string_value("qBt-ratioLimit");
-    if (ratioLimitString.empty())
-        torrentParams.ratioLimit = root.dict_find_int_value("qBt-ratioLimit", TorrentHandle::USE_GLOBAL_RATIO * 1000) / 1000.0;
-    else
-        torrentParams.ratioLimit = fromLTString(ratioLimitString).toDouble();
-
-    const lt::bdecode_node tagsNode = root.dict_find("qBt-tags");
-    if (tagsNode.type() == lt::bdecode_node::list_t) {
-        for (int i = 0; i < tagsNode.list_size(); ++i) {
-            const QString tag = fromLTString(tagsNode.list_string_value_at(i));
-            if (Session::isValidTag(tag))
-                torrentParams.tags << tag;
+    static const QVector<SessionStatsMetric> metrics = []()
+    {
+        const std::vector<lt::stats_metric> nativeMetrics = lt::session_stats_metrics();
+
+        int valueCount = 0;
+        for (const lt::stats_metric &nativeMetric : nativeMetrics)
+            valueCount = std::max(valueCount, (nativeMetric.value_index + 1));
+
+        QVector<SessionStatsMetric> result(valueCount);
+        for (const lt::stats_metric &nativeMetric : nativeMetrics) {
+            SessionStatsMetric &metric = result[nativeMetric.value_index];
+            metric.name = QString::fromLatin1(nativeMetric.name);
+            metric.type = ((nativeMetric.type == lt::metric_type_t::gauge)
+                ? SessionStatsMetric::Type::Gauge : SessionStatsMetric::Type::Counter);
         }
-    }
-
-    // NOTE: Do we really need the following block in case of existing (restored) torrent?
-    torrentParams.savePath = normalizePath(torrentParams.savePath);
-    if (!torrentParams.category.isEmpty()) {
-        if (!m_categories.contains(torrentParams.category) && !addCategory(torrentParams.category))
-            torrentParams.category = "";
-    }
-
-    lt::add_torrent_params &p = torrentParams.ltAddTorrentParams;
-
-    p = lt::read_resume_data(root, ec);
-    p.save_path = Profile::instance()->fromPortablePath(fromLTString(p.save_path)).toStdString();
-    if (metadata.isValid())
-        p.ti = metadata.nativeInfo();
+        return result;
+    }();
 
-    const bool hasMetadata = (p.ti && p.ti->is_valid());
-    if (!hasMetadata && !root.dict_find("info-hash")) {
-        // TODO: The following code is deprecated. Remove after several releases in 4.3.x.
-        // === BEGIN DEPRECATED CODE === //
-        // Try to load from legacy data used in older versions for torrents w/o metadata
-        const lt::bdecode_node magnetURINode = root.dict_find("qBt-magnetUri");
-        if (magnetURINode.type() == lt::bdecode_node::string_t) {
-            lt::parse_magnet_uri(magnetURINode.string_value(), p, ec);
+    return metrics;
+}
 
-            if (isTempPathEnabled()) {
-                p.save_path = Utils::Fs::toNativePath(tempPath()).toStdString();
-            }
-            else {
-                // If empty then Automatic mode, otherwise Manual mode
-                const QString savePath = torrentParams.savePath.isEmpty() ? categorySavePath(torrentParams.category) : torrentParams.savePath;
-                p.save_path = Utils::Fs::toNativePath(savePath).toStdString();
-            }
+const QVector<qint64> &Session::sessionStatsValues() const
+{
+    return m_sessionStatsValues;
+}
 
-            // Preallocation mode
-            p.storage_mode = (isPreallocationEnabled() ? lt::storage_mode_allocate : lt::storage_mode_sparse);
+const AlertStatistics &Session::alertStatistics() const
+{
+    return m_alertStatistics;
+}
 
-            const lt::bdecode_node addedTimeNode = root.dict_find("qBt-addedTime");
-            if (addedTimeNode.type() == lt::bdecode_node::int_t)
-                p.added_time = addedTimeNode.int_value();
-        }
-        // === END DEPRECATED CODE === //
-        else {
-            return false;
-        }
-    }
+const Utils::LatencyHistogram &Session::resumeDataRequestTime() const
+{
+    return m_resumeDataRequestTime;
+}
 
-    return true;
+const Tracker *Session::tracker() const
+{
+    return m_tracker;
 }
 
 // Will resume torrents in backup directory
 void Session::startUpTorrents()
 {
-    const QDir resumeDataDir {m_resumeFolderPath};
-    QStringList fastresumes = resumeDataDir.entryList(
-                QStringList(QLatin1String("*.fastresume")), QDir::Files, QDir::Unsorted);
-
-    const auto readFile = [](const QString &path, QByteArray &buf) -> bool
-    {
-        QFile file(path);
-        if (!file.open(QIODevice::ReadOnly)) {
-            LogMsg(tr("Cannot read file %1: %2").arg(path, file.errorString()), Log::WARNING);
-            return false;
-        }
+    Q_ASSERT(!m_resumeDataLoader);
 
-        buf = file.readAll();
-        return true;
-    };
+    const QDir resumeDataDir {m_resumeFolderPath};
+    QStringList fastresumes = m_resumeDataJournal
+        ? m_resumeDataJournal->keys()
+        : resumeDataDir.entryList(QStringList(QLatin1String("*.fastresume")), QDir::Files, QDir::Unsorted);
 
     qDebug("Starting up torrents...");
     qDebug("Queue size: %d", fastresumes.size());
@@ -3988,49 +4623,128 @@ void Session::startUpTorrents()
     const QRegularExpression rx(QLatin1String("^([A-Fa-f0-9]{40})\\.fastresume$"));
 
     if (isQueueingSystemEnabled()) {
-        QFile queueFile {resumeDataDir.absoluteFilePath(QLatin1String {"queue"})};
-        QStringList queue;
-        if (queueFile.open(QFile::ReadOnly)) {
-            QByteArray line;
-            while (!(line = queueFile.readLine()).isEmpty())
-                queue.append(QString::fromLatin1(line.trimmed()) + QLatin1String {".fastresume"});
+        QByteArray queueData;
+        if (m_resumeDataJournal) {
+            queueData = m_resumeDataJournal->read(QLatin1String {"queue"});
         }
         else {
-            LogMsg(tr("Couldn't load torrents queue from '%1'. Error: %2")
-                .arg(queueFile.fileName(), queueFile.errorString()), Log::WARNING);
+            QFile queueFile {resumeDataDir.absoluteFilePath(QLatin1String {"queue"})};
+            if (queueFile.open(QFile::ReadOnly)) {
+                queueData = queueFile.readAll();
+            }
+            else {
+                LogMsg(tr("Couldn't load torrents queue from '%1'. Error: %2")
+                    .arg(queueFile.fileName(), queueFile.errorString()), Log::WARNING);
+            }
+        }
+
+        QStringList queue;
+        for (const QByteArray &line : asConst(queueData.split('\n'))) {
+            const QByteArray hash = line.trimmed();
+            if (!hash.isEmpty())
+                queue.append(QString::fromLatin1(hash) + QLatin1String {".fastresume"});
         }
 
         if (!queue.empty())
             fastresumes = queue + List::toSet(fastresumes).subtract(List::toSet(queue)).values();
     }
 
-    int resumedTorrentsCount = 0;
+    QVector<InfoHash> hashes;
+    hashes.reserve(fastresumes.size());
     for (const QString &fastresumeName : asConst(fastresumes)) {
         const QRegularExpressionMatch rxMatch = rx.match(fastresumeName);
         if (!rxMatch.hasMatch()) continue;
 
-        const QString hash = rxMatch.captured(1);
-        const QString fastresumePath = resumeDataDir.absoluteFilePath(fastresumeName);
-        QByteArray data;
-        LoadTorrentParams torrentParams;
-        const QString torrentFilePath = resumeDataDir.filePath(QString::fromLatin1("%1.torrent").arg(hash));
-        TorrentInfo metadata = TorrentInfo::loadFromFile(torrentFilePath);
-        if (readFile(fastresumePath, data) && loadTorrentResumeData(data, metadata, torrentParams)) {
-            qDebug() << "Starting up torrent" << hash << "...";
-            if (!loadTorrent(torrentParams))
-                LogMsg(tr("Unable to resume torrent '%1'.", "e.g: Unable to resume torrent 'hash'.")
-                           .arg(hash), Log::CRITICAL);
-
-            // process add torrent messages before message queue overflow
-            if ((resumedTorrentsCount % 100) == 0) readAlerts();
-
-            ++resumedTorrentsCount;
+        const InfoHash hash {rxMatch.captured(1)};
+        if (!m_restoringTorrents.contains(hash)) {
+            m_restoringTorrents.insert(hash);
+            hashes.append(hash);
         }
-        else {
+    }
+
+    LogMsg(tr("Restoring %1 torrents...").arg(hashes.size()), Log::INFO);
+
+    // Resume data is read and decoded by the worker threads and we
+    // receive it in batches (in the queue order) as soon as it is ready
+    m_isRestoringTorrents = true;
+    m_resumeDataLoader = new ResumeDataLoader {m_resumeFolderPath, m_resumeDataJournal, this};
+    connect(m_resumeDataLoader, &ResumeDataLoader::batchLoaded, this, &Session::handleResumeDataBatchLoaded);
+    connect(m_resumeDataLoader, &ResumeDataLoader::finished, this, &Session::handleResumeDataLoadingFinished);
+    m_resumeDataLoader->load(hashes);
+}
+
+bool Session::isRestoringTorrents() const
+{
+    return m_isRestoringTorrents;
+}
+
+void Session::handleResumeDataBatchLoaded(const QVector<LoadedResumeData> &batch)
+{
+    for (const LoadedResumeData &resumeData : batch) {
+        m_restoringTorrents.remove(resumeData.hash);
+
+        if (!resumeData.isValid) {
             LogMsg(tr("Unable to resume torrent '%1'.", "e.g: Unable to resume torrent 'hash'.")
-                       .arg(hash), Log::CRITICAL);
+                       .arg(resumeData.hash), Log::CRITICAL);
+            continue;
+        }
+
+        LoadTorrentParams torrentParams = resumeData.params;
+
+        // NOTE: Do we really need the following block in case of existing (restored) torrent?
+        torrentParams.savePath = normalizePath(torrentParams.savePath);
+        if (!torrentParams.category.isEmpty()) {
+            if (!m_categories.contains(torrentParams.category) && !addCategory(torrentParams.category))
+                torrentParams.category = "";
+        }
+
+        if (resumeData.isLegacyMagnet) {
+            // TODO: The following code is deprecated. Remove after several releases in 4.3.x.
+            // === BEGIN DEPRECATED CODE === //
+            lt::add_torrent_params &p = torrentParams.ltAddTorrentParams;
+            if (isTempPathEnabled()) {
+                p.save_path = Utils::Fs::toNativePath(tempPath()).toStdString();
+            }
+            else {
+                // If empty then Automatic mode, otherwise Manual mode
+                const QString savePath = torrentParams.savePath.isEmpty() ? categorySavePath(torrentParams.category) : torrentParams.savePath;
+                p.save_path = Utils::Fs::toNativePath(savePath).toStdString();
+            }
+
+            // Preallocation mode
+            p.storage_mode = (isPreallocationEnabled() ? lt::storage_mode_allocate : lt::storage_mode_sparse);
+            // === END DEPRECATED CODE === //
         }
+
+        qDebug("Starting up torrent %s ...", qUtf8Printable(resumeData.hash));
+        if (!loadTorrent(torrentParams))
+            LogMsg(tr("Unable to resume torrent '%1'.", "e.g: Unable to resume torrent 'hash'.")
+                       .arg(resumeData.hash), Log::CRITICAL);
     }
+
+    const int restoredCount = m_resumeDataLoader->loadedCount();
+    const int totalCount = m_resumeDataLoader->totalCount();
+    qDebug("Restored %d of %d torrents", restoredCount, totalCount);
+    emit startupProgressUpdated(restoredCount, totalCount);
+}
+
+void Session::handleResumeDataLoadingFinished()
+{
+    const int restoredCount = m_resumeDataLoader->loadedCount();
+    const int totalCount = m_resumeDataLoader->totalCount();
+    LogMsg(tr("Restored %1 torrents in %2 ms.").arg(QString::number(restoredCount)
+        , QString::number(m_resumeDataLoader->elapsedTime())), Log::INFO);
+
+    m_resumeDataLoader->deleteLater();
+    m_resumeDataLoader = nullptr;
+    m_isRestoringTorrents = false;
+    m_restoringTorrents.clear();
+    // isRestoringTorrents() is false now so the progress indicators can be hidden
+    emit startupProgressUpdated(restoredCount, totalCount);
+
+    // Store the queue of completely restored session
+    if (isQueueingSystemEnabled())
+        saveTorrentsQueue();
 }
 
 quint64 Session::getAlltimeDL() const
@@ -4100,9 +4814,61 @@ void Session::setKeepTorrentTopLevelFolder(const bool value)
 // Read alerts sent by the BitTorrent session
 void Session::readAlerts()
 {
-    const std::vector<lt::alert *> alerts = getPendingAlerts();
-    for (const lt::alert *a : alerts)
+    const bool isBatchContinued = (m_alertBatchPosition < m_alertBatch.size());
+    if (!isBatchContinued) {
+        m_alertBatch = getPendingAlerts();
+        m_alertBatchPosition = 0;
+        if (m_alertBatch.empty())
+            return;
+
+        m_alertStatistics.lastBatchSize = static_cast<int>(m_alertBatch.size());
+        m_alertStatistics.maxBatchSize = std::max(m_alertStatistics.maxBatchSize, m_alertStatistics.lastBatchSize);
+    }
+
+    // the torrents changed by the alerts are reported at once at the end of the slice
+    beginBulkUpdate();
+
+    const qint64 sliceStartTime = m_metricsClock.nsecsElapsed();
+    qint64 alertStartTime = sliceStartTime;
+    while (m_alertBatchPosition < m_alertBatch.size()) {
+        const lt::alert *a = m_alertBatch[m_alertBatchPosition++];
+        const int alertType = a->type();
         handleAlert(a);
+
+        const qint64 now = m_metricsClock.nsecsElapsed();
+        if ((alertType >= 0) && (alertType < m_alertStatistics.types.size())) {
+            AlertTypeStatistics &typeStatistics = m_alertStatistics.types[alertType];
+            ++typeStatistics.handledCount;
+            typeStatistics.handlingTime.addSample(now - alertStartTime);
+        }
+        alertStartTime = now;
+
+        if ((now - sliceStartTime) >= ALERT_HANDLING_TIME_SLICE)
+            break;
+    }
+    m_alertStatistics.sliceHandlingTime.addSample(alertStartTime - sliceStartTime);
+
+    endBulkUpdate();
+    m_alertStatistics.pendingCount = static_cast<int>(m_alertBatch.size() - m_alertBatchPosition);
+
+    if (m_alertStatistics.pendingCount > 0) {
+        if (!isBatchContinued)
+            ++m_alertStatistics.slicedBatchCount;
+    }
+    else {
+        m_alertBatch.clear();
+        m_alertBatchPosition = 0;
+        // Alert notification isn't sent while the queue isn't empty,
+        // so the alerts posted while the batch was being handled have to be read
+        if (!isBatchContinued)
+            return;
+    }
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+    QMetaObject::invokeMethod(this, &Session::readAlerts, Qt::QueuedConnection);
+#else
+    QMetaObject::invokeMethod(this, "readAlerts", Qt::QueuedConnection);
+#endif
 }
 
 void Session::handleAlert(const lt::alert *a)
@@ -4218,6 +4984,7 @@ void Session::createTorrentHandle(const lt::torrent_handle &nativeHandle)
 
     TorrentHandleImpl *const torrent = new TorrentHandleImpl {this, nativeHandle, params};
     m_torrents.insert(torrent->hash(), torrent);
+    indexTorrent(torrent);
 
     const bool hasMetadata = torrent->hasMetadata();
 
@@ -4253,9 +5020,7 @@ void Session::createTorrentHandle(const lt::torrent_handle &nativeHandle)
         torrent->saveResumeData();
     }
 
-    if (((torrent->ratioLimit() >= 0) || (torrent->seedingTimeLimit() >= 0))
-        && !m_seedingLimitTimer->isActive())
-        m_seedingLimitTimer->start();
+    scheduleShareLimitCheck(torrent);
 
     // Send torrent addition signal
     emit torrentLoaded(torrent);
@@ -4534,6 +5299,8 @@ void Session::handleSessionStatsAlert(const lt::session_stats_alert *p)
     m_statsLastTimestamp = p->timestamp();
 
     const auto stats = p->counters();
+    m_sessionStatsValues.resize(static_cast<int>(stats.size()));
+    std::copy(stats.begin(), stats.end(), m_sessionStatsValues.begin());
 
     m_status.hasIncomingConnections = static_cast<bool>(stats[m_metricIndices.net.hasIncomingConnections]);
 
@@ -4593,6 +5360,8 @@ void Session::handleSessionStatsAlert(const lt::session_stats_alert *p)
     m_cacheStatus.averageJobTime = (totalJobs > 0)
                                    ? (stats[m_metricIndices.disk.diskJobTime] / totalJobs) : 0;
 
+    recordTransferHistory();
+
     emit statsUpdated();
 
     if (m_refreshEnqueued)
@@ -4601,18 +5370,48 @@ void Session::handleSessionStatsAlert(const lt::session_stats_alert *p)
         enqueueRefresh();
 }
 
-void Session::handleAlertsDroppedAlert(const lt::alerts_dropped_alert *p) const
+void Session::recordTransferHistory()
+{
+    // the rates of the subcategories aren't included into the parent ones
+    QHash<QString, TransferHistory::CategoryRates> categoryRates;
+    categoryRates.reserve(m_categories.size() + 1);
+    const auto sumRates = [this](const QSet<InfoHash> &hashes)
+    {
+        TransferHistory::CategoryRates rates;
+        for (const InfoHash &hash : hashes) {
+            const TorrentHandleImpl *torrent = m_torrents.value(hash);
+            rates.downloadRate += torrent->downloadPayloadRate();
+            rates.uploadRate += torrent->uploadPayloadRate();
+        }
+        return rates;
+    };
+
+    categoryRates[""] = sumRates(m_torrentsByCategory.value(""));
+    for (auto i = m_categories.cbegin(); i != m_categories.cend(); ++i)
+        categoryRates[i.key()] = sumRates(m_torrentsByCategory.value(i.key()));
+
+    m_transferHistory->record(QDateTime::currentSecsSinceEpoch(), m_status, m_cacheStatus, categoryRates);
+}
+
+void Session::handleAlertsDroppedAlert(const lt::alerts_dropped_alert *p)
 {
+    for (int alertType = 0; alertType < m_alertStatistics.types.size(); ++alertType) {
+        if (p->dropped_alerts.test(alertType))
+            ++m_alertStatistics.types[alertType].droppedCount;
+    }
+
     LogMsg(tr("Error: Internal alert queue full and alerts were dropped, you might see degraded performance. Dropped alert types: %1. Message: %2")
         .arg(QString::fromStdString(p->dropped_alerts.to_string()), QString::fromStdString(p->message())), Log::CRITICAL);
 }
 
 void Session::handleStorageMovedAlert(const lt::storage_moved_alert *p)
 {
-    Q_ASSERT(!m_moveStorageQueue.isEmpty());
+    const auto currentJobIter = findActiveMoveStorageJob(p->handle);
+    Q_ASSERT(currentJobIter != m_moveStorageQueue.end());
+    if (currentJobIter == m_moveStorageQueue.end())
+        return;
 
-    const MoveStorageJob &currentJob = m_moveStorageQueue.first();
-    Q_ASSERT(currentJob.torrentHandle == p->handle);
+    const MoveStorageJob &currentJob = *currentJobIter;
 
     const QString newPath {p->storage_path()};
     Q_ASSERT(newPath == currentJob.path);
@@ -4625,15 +5424,17 @@ void Session::handleStorageMovedAlert(const lt::storage_moved_alert *p)
     if (torrent)
         emit torrentStorageMoveFinished(torrent, newPath);
 
-    handleMoveTorrentStorageJobFinished();
+    handleMoveTorrentStorageJobFinished(p->handle);
 }
 
 void Session::handleStorageMovedFailedAlert(const lt::storage_moved_failed_alert *p)
 {
-    Q_ASSERT(!m_moveStorageQueue.isEmpty());
+    const auto currentJobIter = findActiveMoveStorageJob(p->handle);
+    Q_ASSERT(currentJobIter != m_moveStorageQueue.end());
+    if (currentJobIter == m_moveStorageQueue.end())
+        return;
 
-    const MoveStorageJob &currentJob = m_moveStorageQueue.first();
-    Q_ASSERT(currentJob.torrentHandle == p->handle);
+    const MoveStorageJob &currentJob = *currentJobIter;
 
     const InfoHash infoHash = currentJob.torrentHandle.info_hash();
     TorrentHandleImpl *torrent = m_torrents.value(infoHash);
@@ -4646,7 +5447,7 @@ void Session::handleStorageMovedFailedAlert(const lt::storage_moved_failed_alert
     if (torrent)
         emit torrentStorageMoveFailed(torrent, currentJob.path, errorMessage);
 
-    handleMoveTorrentStorageJobFinished();
+    handleMoveTorrentStorageJobFinished(p->handle);
 }
 
 void Session::handleStateUpdateAlert(const lt::state_update_alert *p)
@@ -4662,6 +5463,7 @@ void Session::handleStateUpdateAlert(const lt::state_update_alert *p)
 
         torrent->handleStateUpdate(status);
         updatedTorrents.push_back(torrent);
+        scheduleShareLimitCheck(torrent);
     }
 
     if (!updatedTorrents.isEmpty())
@@ -30,6 +30,7 @@
 #ifndef BITTORRENT_SESSION_H
 #define BITTORRENT_SESSION_H
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -38,13 +39,17 @@
 #include <libtorrent/torrent_handle.hpp>
 #include <libtorrent/version.hpp>
 
+#include <QElapsedTimer>
 #include <QHash>
+#include <QMap>
 #include <QPointer>
 #include <QSet>
+#include <QStringList>
 #include <QVector>
 
 #include "base/settingvalue.h"
 #include "base/types.h"
+#include "base/utils/latencyhistogram.h"
 #include "addtorrentparams.h"
 #include "cachestatus.h"
 #include "sessionstatus.h"
@@ -54,11 +59,11 @@
 #define HAS_HTTPS_TRACKER_VALIDATION
 #endif
 
+class QDateTime;
 class QFile;
 class QNetworkConfiguration;
 class QNetworkConfigurationManager;
 class QString;
-class QStringList;
 class QThread;
 class QTimer;
 class QUrl;
@@ -99,10 +104,15 @@ namespace BitTorrent
 {
     class InfoHash;
     class MagnetUri;
+    class ResumeDataJournal;
+    class ResumeDataLoader;
+    class TorrentDetailsCache;
     class TorrentHandle;
     class TorrentHandleImpl;
     class Tracker;
     class TrackerEntry;
+    class TransferHistory;
+    struct LoadedResumeData;
     struct LoadTorrentParams;
 
     enum class MoveStorageMode;
@@ -136,6 +146,13 @@ namespace BitTorrent
         };
         Q_ENUM_NS(MixedModeAlgorithm)
 
+        enum class ResumeDataStorageType : int
+        {
+            Legacy = 0,
+            Journal = 1
+        };
+        Q_ENUM_NS(ResumeDataStorageType)
+
         enum class SeedChokingAlgorithm : int
         {
             RoundRobin = 0,
@@ -202,6 +219,56 @@ namespace BitTorrent
         } disk;
     };
 
+    struct SessionStatsMetric
+    {
+        enum class Type
+        {
+            Counter,
+            Gauge
+        };
+
+        QString name;
+        Type type = Type::Counter;
+    };
+
+    struct MoveStorageJobInfo
+    {
+        QString hash;
+        QString name;
+        QString sourcePath;
+        QString destinationPath;
+        bool isActive = false;
+        // data is moved within the same filesystem so it is just renamed
+        bool isSameDevice = false;
+        qint64 totalSize = 0;
+        // moved size is known for the active jobs only
+        qint64 movedSize = 0;
+        qint64 elapsedTime = 0; // msecs since the job was started
+    };
+
+    struct AlertTypeStatistics
+    {
+        QString name;
+        qint64 handledCount = 0;
+        qint64 droppedCount = 0;
+        Utils::LatencyHistogram handlingTime;
+    };
+
+    struct AlertStatistics
+    {
+        // indexed by libtorrent alert type
+        QVector<AlertTypeStatistics> types;
+        // time spent handling alerts in one event loop iteration
+        Utils::LatencyHistogram sliceHandlingTime;
+        // number of alerts popped at once, i.e. the alert queue depth
+        int lastBatchSize = 0;
+        int maxBatchSize = 0;
+        // batches which took more than one time slice to handle
+        qint64 slicedBatchCount = 0;
+        // alerts of the current batch which aren't handled yet
+        int pendingCount = 0;
+    };
+
     class Session : public QObject
     {
         Q_OBJECT
@@ -238,6 +305,9 @@ namespace BitTorrent
         bool addTag(const QString &tag);
         bool removeTag(const QString &tag);
 
+        // domain and top level domain of the tracker URL (or IP address)
+        static QString trackerHost(const QString &trackerUrl);
+
         // Torrent Management Mode subsystem (TMM)
         //
         // Each torrent can be either in Manual mode or in Automatic mode
@@ -304,6 +374,8 @@ namespace BitTorrent
 
         uint saveResumeDataInterval() const;
         void setSaveResumeDataInterval(uint value);
+        ResumeDataStorageType resumeDataStorageType() const;
+        void setResumeDataStorageType(ResumeDataStorageType type);
         int port() const;
         void setPort(int port);
         bool useRandomPort() const;
@@ -336,6 +408,8 @@ namespace BitTorrent
         void setAnnounceToAllTiers(bool val);
         int asyncIOThreads() const;
         void setAsyncIOThreads(int num);
+        int moveStorageConcurrency() const;
+        void setMoveStorageConcurrency(int num);
         int filePoolSize() const;
         void setFilePoolSize(int size);
         int checkingMemUsage() const;
@@ -420,13 +494,38 @@ namespace BitTorrent
 #endif
 
         void startUpTorrents();
+        bool isRestoringTorrents() const;
         TorrentHandle *findTorrent(const InfoHash &hash) const;
+        // Use it instead of the blocking TorrentHandle queries for the frequently refreshed views
+        TorrentDetailsCache *torrentDetailsCache() const;
+        const TransferHistory *transferHistory() const;
         QVector<TorrentHandle *> torrents() const;
+        // Indexes of the torrents maintained as they change. The empty tracker host,
+        // category or tag selects trackerless, uncategorized or untagged torrents.
+        QSet<InfoHash> torrentsByTrackerHost(const QString &host) const;
+        int torrentsCountByTrackerHost(const QString &host) const;
+        // URLs of the torrent trackers, unlike TorrentHandle::trackers() it doesn't wait for libtorrent
+        QStringList torrentTrackerURLs(const InfoHash &hash) const;
+        // the subcategories are included like in TorrentHandle::belongsToCategory() unless exact match is requested
+        QSet<InfoHash> torrentsByCategory(const QString &category) const;
+        int torrentsCountByCategory(const QString &category, bool exactMatch = false) const;
+        QSet<InfoHash> torrentsByTag(const QString &tag) const;
+        int torrentsCountByTag(const QString &tag) const;
         bool hasActiveTorrents() const;
         bool hasUnfinishedTorrents() const;
         bool hasRunningSeed() const;
         const SessionStatus &status() const;
         const CacheStatus &cacheStatus() const;
+        // All the metrics provided by libtorrent, the values reported by the last
+        // session stats update are stored in the same order
+        static const QVector<SessionStatsMetric> &sessionStatsMetrics();
+        const QVector<qint64> &sessionStatsValues() const;
+        const AlertStatistics &alertStatistics() const;
+        // Queued and active jobs in order they will be processed
+        QVector<MoveStorageJobInfo> moveStorageJobs() const;
+        const Utils::LatencyHistogram &resumeDataRequestTime() const;
+        // The embedded tracker, nullptr when it is disabled
+        const Tracker *tracker() const;
         quint64 getAlltimeDL() const;
         quint64 getAlltimeUL() const;
         bool isListening() const;
@@ -449,8 +548,14 @@ namespace BitTorrent
         void decreaseTorrentsQueuePos(const QVector<InfoHash> &hashes);
         void topTorrentsQueuePos(const QVector<InfoHash> &hashes);
         void bottomTorrentsQueuePos(const QVector<InfoHash> &hashes);
+        // Applies the change to the torrents in one pass. The resume data of each changed
+        // torrent is saved once afterwards and the per torrent paused/resumed, saving mode
+        // and share limit notifications are replaced with the single torrentsUpdated() signal.
+        void applyToTorrents(const QVector<TorrentHandle *> &torrents, const std::function<void (TorrentHandle *torrent)> &func);
 
         // TorrentHandle interface
+        // Returns true if the resume data is saved later since the torrents are being changed in bulk
+        bool deferTorrentResumeDataSaving(const TorrentHandleImpl *torrent);
         void handleTorrentSaveResumeDataRequested(const TorrentHandleImpl *torrent);
         void handleTorrentShareLimitChanged(TorrentHandleImpl *const torrent);
         void handleTorrentNameChanged(TorrentHandleImpl *const torrent);
@@ -480,6 +585,7 @@ namespace BitTorrent
         void allTorrentsFinished();
         void categoryAdded(const QString &categoryName);
         void categoryRemoved(const QString &categoryName);
+        void categorySavePathChanged(const QString &categoryName);
         void downloadFromUrlFailed(const QString &url, const QString &reason);
         void downloadFromUrlFinished(const QString &url);
         void fullDiskError(BitTorrent::TorrentHandle *const torrent, const QString &msg);
@@ -488,6 +594,7 @@ namespace BitTorrent
         void metadataLoaded(const BitTorrent::TorrentInfo &info);
         void recursiveTorrentDownloadPossible(BitTorrent::TorrentHandle *const torrent);
         void speedLimitModeChanged(bool alternative);
+        void startupProgressUpdated(int restoredCount, int totalCount);
         void statsUpdated();
         void subcategoriesSupportChanged();
         void tagAdded(const QString &tag);
@@ -499,10 +606,12 @@ namespace BitTorrent
         void torrentFinishedChecking(BitTorrent::TorrentHandle *const torrent);
         void torrentLoaded(BitTorrent::TorrentHandle *const torrent);
         void torrentMetadataLoaded(BitTorrent::TorrentHandle *const torrent);
+        void torrentNameChanged(BitTorrent::TorrentHandle *const torrent);
         void torrentPaused(BitTorrent::TorrentHandle *const torrent);
         void torrentResumed(BitTorrent::TorrentHandle *const torrent);
         void torrentSavePathChanged(BitTorrent::TorrentHandle *const torrent);
         void torrentSavingModeChanged(BitTorrent::TorrentHandle *const torrent);
+        void torrentShareLimitChanged(BitTorrent::TorrentHandle *const torrent);
         void torrentStorageMoveFailed(BitTorrent::TorrentHandle *const torrent, const QString &targetPath, const QString &error);
         void torrentStorageMoveFinished(BitTorrent::TorrentHandle *const torrent, const QString &newPath);
         void torrentsUpdated(const QVector<BitTorrent::TorrentHandle *> &torrents);
@@ -536,6 +645,18 @@ namespace BitTorrent
             lt::torrent_handle torrentHandle;
             QString path;
             MoveStorageMode mode;
+
+            bool isActive = false;
+            // Jobs moving data between the same pair of devices share the concurrency limit,
+            // it is empty for the moves within the same filesystem which aren't limited
+            QByteArray deviceKey;
+            bool isDeviceKeyKnown = false;
+            QString sourcePath;
+            QElapsedTimer timer;
+            // Files of the torrent when the job was queued, used to estimate the progress
+            QStringList filePaths;
+            QVector<qint64> fileSizes;
+            qint64 totalSize = 0;
         };
 
         struct RemovingTorrentData
@@ -548,10 +669,10 @@ namespace BitTorrent
         explicit Session(QObject *parent = nullptr);
         ~Session();
 
-        bool hasPerTorrentRatioLimit() const;
-        bool hasPerTorrentSeedingTimeLimit() const;
-
         void initResumeFolder();
+        void initResumeDataStorage();
+        void importLegacyResumeData(const QDateTime &journalModified);
+        void exportResumeDataJournal();
 
         // Session configuration
         Q_INVOKABLE void configure();
@@ -577,12 +698,19 @@ namespace BitTorrent
         void applyOSMemoryPriority() const;
 #endif
 
-        bool loadTorrentResumeData(const QByteArray &data, const TorrentInfo &metadata, LoadTorrentParams &torrentParams);
+        void handleResumeDataBatchLoaded(const QVector<LoadedResumeData> &batch);
+        void handleResumeDataLoadingFinished();
         bool loadTorrent(LoadTorrentParams params);
         LoadTorrentParams initLoadTorrentParams(const AddTorrentParams &addTorrentParams);
         bool addTorrent_impl(const AddTorrentParams &addTorrentParams, const MagnetUri &magnetUri, TorrentInfo torrentInfo = TorrentInfo());
         bool findIncompleteFiles(TorrentInfo &torrentInfo, QString &savePath) const;
 
+        // Share limits are checked only for the torrents that can reach them,
+        // at the time they are expected to do it
+        void scheduleShareLimitCheck(TorrentHandleImpl *torrent);
+        void unscheduleShareLimitCheck(const InfoHash &hash);
+        void rescheduleShareLimitChecks();
+        bool processTorrentShareLimits(TorrentHandleImpl *torrent);
         void updateSeedingLimitTimer();
         void exportTorrentFile(const TorrentHandle *torrent, TorrentExportFolder folder = TorrentExportFolder::Regular);
 
@@ -607,7 +735,7 @@ namespace BitTorrent
         void handleListenFailedAlert(const lt::listen_failed_alert *p);
         void handleExternalIPAlert(const lt::external_ip_alert *p);
         void handleSessionStatsAlert(const lt::session_stats_alert *p);
-        void handleAlertsDroppedAlert(const lt::alerts_dropped_alert *p) const;
+        void handleAlertsDroppedAlert(const lt::alerts_dropped_alert *p);
         void handleStorageMovedAlert(const lt::storage_moved_alert *p);
         void handleStorageMovedFailedAlert(const lt::storage_moved_failed_alert *p);
 #if (LIBTORRENT_VERSION_NUM >= 10204)
@@ -619,11 +747,14 @@ namespace BitTorrent
         void saveResumeData();
         void saveTorrentsQueue();
         void removeTorrentsQueue();
+        void recordTransferHistory();
 
         std::vector<lt::alert *> getPendingAlerts(lt::time_duration time = lt::time_duration::zero()) const;
 
+        void startMoveTorrentStorageJobs();
         void moveTorrentStorage(const MoveStorageJob &job) const;
-        void handleMoveTorrentStorageJobFinished();
+        void handleMoveTorrentStorageJobFinished(const lt::torrent_handle &torrentHandle);
+        QList<MoveStorageJob>::iterator findActiveMoveStorageJob(const lt::torrent_handle &torrentHandle);
 
         // BitTorrent
         lt::session *m_nativeSession = nullptr;
@@ -641,6 +772,7 @@ namespace BitTorrent
         CachedSettingValue<bool> m_announceToAllTrackers;
         CachedSettingValue<bool> m_announceToAllTiers;
         CachedSettingValue<int> m_asyncIOThreads;
+        CachedSettingValue<int> m_moveStorageConcurrency;
         CachedSettingValue<int> m_filePoolSize;
         CachedSettingValue<int> m_checkingMemUsage;
         CachedSettingValue<int> m_diskCacheSize;
@@ -696,6 +828,7 @@ namespace BitTorrent
         CachedSettingValue<bool> m_isAltGlobalSpeedLimitEnabled;
         CachedSettingValue<bool> m_isBandwidthSchedulerEnabled;
         CachedSettingValue<uint> m_saveResumeDataInterval;
+        CachedSettingValue<ResumeDataStorageType> m_resumeDataStorageType;
         CachedSettingValue<int> m_port;
         CachedSettingValue<bool> m_useRandomPort;
         CachedSettingValue<QString> m_networkInterface;
@@ -735,8 +868,13 @@ namespace BitTorrent
 
         bool m_refreshEnqueued = false;
         QTimer *m_seedingLimitTimer = nullptr;
+        QElapsedTimer m_shareLimitClock;
+        QMultiMap<qint64, InfoHash> m_shareLimitQueue;  // due time (secs of m_shareLimitClock) -> torrent
+        QHash<InfoHash, qint64> m_shareLimitDueTimes;
         QTimer *m_resumeDataTimer = nullptr;
         Statistics *m_statistics = nullptr;
+        TorrentDetailsCache *m_torrentDetailsCache = nullptr;
+        TransferHistory *m_transferHistory = nullptr;
         // IP filtering
         QPointer<FilterParserThread> m_filterParser;
         QPointer<BandwidthScheduler> m_bwScheduler;
@@ -745,6 +883,13 @@ namespace BitTorrent
         // fastresume data writing thread
         QThread *m_ioThread = nullptr;
         ResumeDataSavingManager *m_resumeDataSavingManager = nullptr;
+        // single file resume data storage (nullptr if separate files are used)
+        ResumeDataJournal *m_resumeDataJournal = nullptr;
+        // startup restoring of the torrents
+        ResumeDataLoader *m_resumeDataLoader = nullptr;
+        // It stays set if the restoring is aborted on shutdown
+        bool m_isRestoringTorrents = false;
+        QSet<InfoHash> m_restoringTorrents;
 
         struct LoadedMetadataHandle
         {
@@ -760,6 +905,25 @@ namespace BitTorrent
         QStringMap m_categories;
         QSet<QString> m_tags;
 
+        void beginBulkUpdate();
+        void endBulkUpdate();
+        // Returns false if the change is reported by torrentsUpdated() when the bulk update ends
+        bool isTorrentChangeNotifiable(const TorrentHandleImpl *torrent);
+
+        int m_bulkUpdateDepth = 0;
+        QSet<InfoHash> m_bulkResumeDataTorrents;
+        QSet<InfoHash> m_bulkUpdatedTorrents;
+
+        void indexTorrent(const TorrentHandleImpl *torrent);
+        void unindexTorrent(const TorrentHandleImpl *torrent);
+        void updateTrackerHostsIndex(const TorrentHandleImpl *torrent);
+
+        QHash<QString, QSet<InfoHash>> m_torrentsByTrackerHost;
+        QHash<QString, QSet<InfoHash>> m_torrentsByCategory;
+        QHash<QString, QSet<InfoHash>> m_torrentsByTag;
+        QHash<InfoHash, QSet<QString>> m_trackerHostsByTorrent;
+        QHash<InfoHash, QStringList> m_trackerURLsByTorrent;
+
         // I/O errored torrents
         QSet<InfoHash> m_recentErroredTorrents;
         QTimer *m_recentErroredTorrentsTimer = nullptr;
@@ -769,6 +933,16 @@ namespace BitTorrent
 
         SessionStatus m_status;
         CacheStatus m_cacheStatus;
+        QVector<qint64> m_sessionStatsValues;
+
+        QElapsedTimer m_metricsClock;
+        AlertStatistics m_alertStatistics;
+        // popped alerts are valid until the next pop so the batch
+        // is kept until all of them are handled
+        std::vector<lt::alert *> m_alertBatch;
+        std::size_t m_alertBatchPosition = 0;
+        Utils::LatencyHistogram m_resumeDataRequestTime;
+        QHash<InfoHash, qint64> m_resumeDataRequestStartTimes;  // nsecs of m_metricsClock
 
         QNetworkConfigurationManager *m_networkManager = nullptr;
 
@@ -0,0 +1,153 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "torrentcreationmanager.h"
+
+#include <algorithm>
+
+#include <QUuid>
+
+namespace
+{
+    const int MAX_TASK_COUNT = 1000;
+}
+
+using namespace BitTorrent;
+
+TorrentCreationManager::TorrentCreationManager(QObject *parent)
+    : QObject {parent}
+    , m_creatorThread {new TorrentCreatorThread {this}}
+{
+    connect(m_creatorThread, &TorrentCreatorThread::updateProgress, this, [this](const int progress)
+    {
+        const int index = indexOf(m_currentTaskID);
+        if (index >= 0)
+            m_tasks[index].progress = progress;
+    });
+    connect(m_creatorThread, &TorrentCreatorThread::creationSuccess, this, [this]()
+    {
+        const int index = indexOf(m_currentTaskID);
+        if (index >= 0)
+            m_tasks[index].status = TorrentCreationStatus::Finished;
+    });
+    connect(m_creatorThread, &TorrentCreatorThread::creationFailure, this, [this](const QString &msg)
+    {
+        const int index = indexOf(m_currentTaskID);
+        if (index >= 0) {
+            m_tasks[index].status = TorrentCreationStatus::Failed;
+            m_tasks[index].errorMessage = msg;
+        }
+    });
+    // thread can be restarted only after it is finished
+    connect(m_creatorThread, &QThread::finished, this, &TorrentCreationManager::handleCreationFinished);
+}
+
+QString TorrentCreationManager::addTask(const TorrentCreatorParams &params)
+{
+    if (m_tasks.size() >= MAX_TASK_COUNT)
+        return {};
+
+    TorrentCreationTask task;
+    task.id = QUuid::createUuid().toString();
+    task.id = task.id.mid(1, (task.id.size() - 2));  // remove braces
+    task.params = params;
+    task.timeAdded = QDateTime::currentDateTime();
+    m_tasks.append(task);
+
+    if (m_currentTaskID.isEmpty())
+        startNextTask();
+
+    return task.id;
+}
+
+bool TorrentCreationManager::deleteTask(const QString &id)
+{
+    const int index = indexOf(id);
+    if (index < 0)
+        return false;
+
+    // the next task is started when the canceled one is finished
+    if (id == m_currentTaskID)
+        m_creatorThread->requestInterruption();
+
+    m_tasks.remove(index);
+    return true;
+}
+
+QVector<TorrentCreationTask> TorrentCreationManager::tasks() const
+{
+    return m_tasks;
+}
+
+const TorrentCreationTask *TorrentCreationManager::task(const QString &id) const
+{
+    const int index = indexOf(id);
+    return ((index >= 0) ? &m_tasks[index] : nullptr);
+}
+
+int TorrentCreationManager::indexOf(const QString &id) const
+{
+    for (int i = 0; i < m_tasks.size(); ++i) {
+        if (m_tasks[i].id == id)
+            return i;
+    }
+    return -1;
+}
+
+void TorrentCreationManager::startNextTask()
+{
+    const auto iter = std::find_if(m_tasks.begin(), m_tasks.end(), [](const TorrentCreationTask &task)
+    {
+        return (task.status == TorrentCreationStatus::Queued);
+    });
+    if (iter == m_tasks.end()) {
+        m_currentTaskID.clear();
+        return;
+    }
+
+    iter->status = TorrentCreationStatus::Running;
+    iter->timeStarted = QDateTime::currentDateTime();
+    m_currentTaskID = iter->id;
+    m_creatorThread->create(iter->params);
+}
+
+void TorrentCreationManager::handleCreationFinished()
+{
+    const int index = indexOf(m_currentTaskID);
+    if (index >= 0) {
+        TorrentCreationTask &task = m_tasks[index];
+        // creation is finished without result only if it is interrupted
+        if (task.status == TorrentCreationStatus::Running) {
+            task.status = TorrentCreationStatus::Failed;
+            task.errorMessage = tr("Torrent creation was interrupted");
+        }
+        task.timeFinished = QDateTime::currentDateTime();
+    }
+
+    startNextTask();
+}
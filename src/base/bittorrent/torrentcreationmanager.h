@@ -0,0 +1,88 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "torrentcreatorthread.h"
+
+namespace BitTorrent
+{
+    enum class TorrentCreationStatus
+    {
+        Queued,
+        Running,
+        Finished,
+        Failed
+    };
+
+    struct TorrentCreationTask
+    {
+        QString id;
+        TorrentCreatorParams params;
+        TorrentCreationStatus status = TorrentCreationStatus::Queued;
+        int progress = 0;
+        QString errorMessage;
+        QDateTime timeAdded;
+        QDateTime timeStarted;
+        QDateTime timeFinished;
+    };
+
+    // Creates the torrents one after another (every creation uses
+    // all the CPU cores itself) so a lot of them can be queued at once.
+    // The tasks are kept until they are deleted to allow checking their results.
+    class TorrentCreationManager final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(TorrentCreationManager)
+
+    public:
+        explicit TorrentCreationManager(QObject *parent = nullptr);
+
+        // Returns ID of the added task or an empty string if there are too many tasks
+        QString addTask(const TorrentCreatorParams &params);
+        // Running task is canceled
+        bool deleteTask(const QString &id);
+        // Returns the tasks in order they were added
+        QVector<TorrentCreationTask> tasks() const;
+        const TorrentCreationTask *task(const QString &id) const;
+
+    private:
+        int indexOf(const QString &id) const;
+        void startNextTask();
+        void handleCreationFinished();
+
+        TorrentCreatorThread *m_creatorThread = nullptr;
+        QVector<TorrentCreationTask> m_tasks;
+        QString m_currentTaskID;
+    };
+}
@@ -28,36 +28,155 @@
 
 #include "torrentcreatorthread.h"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <vector>
 
 #include <libtorrent/bencode.hpp>
 #include <libtorrent/create_torrent.hpp>
 #include <libtorrent/file_storage.hpp>
 #include <libtorrent/torrent_info.hpp>
 
+#include <QCryptographicHash>
 #include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
 #include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
 
 #include "base/exceptions.h"
 #include "base/global.h"
 #include "base/utils/fs.h"
 #include "base/utils/io.h"
 #include "base/utils/string.h"
-#include "ltunderlyingtype.h"
+
+using namespace BitTorrent;
 
 namespace
 {
+    // Progress is reported not more often than this
+    const int PROGRESS_UPDATE_INTERVAL = 100; // ms
+    // Workers take the pieces in the chunks of about this size
+    // so every worker reads the files sequentially
+    const int HASHING_CHUNK_SIZE = 64 * 1024 * 1024; // bytes
+
     // do not include files and folders whose
     // name starts with a .
     bool fileFilter(const std::string &f)
     {
         return !Utils::Fs::fileName(QString::fromStdString(f)).startsWith('.');
     }
-}
 
-using namespace BitTorrent;
+    struct PieceHashingJob
+    {
+        PieceHashingJob(const lt::file_storage &files, const std::string &basePath)
+            : files {files}
+            , basePath {basePath}
+            , chunkPieceCount {std::max(1, (HASHING_CHUNK_SIZE / files.piece_length()))}
+            , hashes(static_cast<std::size_t>(files.num_pieces()))
+        {
+        }
+
+        const lt::file_storage &files;
+        const std::string basePath;
+        const int chunkPieceCount;
+        std::vector<lt::sha1_hash> hashes;
+
+        std::atomic<int> nextChunk {0};
+        std::atomic<int> hashedPieceCount {0};
+        std::atomic<bool> isCanceled {false};
+
+        QMutex errorMutex;
+        QString errorMessage;
+    };
+
+    class PieceHashingTask final : public QRunnable
+    {
+    public:
+        explicit PieceHashingTask(PieceHashingJob &job)
+            : m_job {job}
+        {
+        }
+
+        void run() override
+        {
+            const int pieceCount = m_job.files.num_pieces();
+            QByteArray buffer {m_job.files.piece_length(), Qt::Uninitialized};
+            QCryptographicHash hash {QCryptographicHash::Sha1};
+
+            while (!m_job.isCanceled) {
+                const int firstPiece = m_job.nextChunk.fetch_add(1) * m_job.chunkPieceCount;
+                if (firstPiece >= pieceCount)
+                    break;
+
+                const int lastPiece = std::min((firstPiece + m_job.chunkPieceCount), pieceCount);
+                for (int piece = firstPiece; (piece < lastPiece) && !m_job.isCanceled; ++piece) {
+                    const lt::piece_index_t pieceIndex {piece};
+                    const int pieceSize = m_job.files.piece_size(pieceIndex);
+
+                    qint64 offset = 0;
+                    for (const lt::file_slice &slice : m_job.files.map_block(pieceIndex, 0, pieceSize)) {
+                        if (!readSlice(slice, (buffer.data() + offset))) {
+                            fail();
+                            return;
+                        }
+                        offset += slice.size;
+                    }
+
+                    hash.reset();
+                    hash.addData(buffer.constData(), pieceSize);
+                    m_job.hashes[static_cast<std::size_t>(piece)] = lt::sha1_hash {hash.result().constData()};
+                    ++m_job.hashedPieceCount;
+                }
+            }
+        }
+
+    private:
+        bool readSlice(const lt::file_slice &slice, char *buffer)
+        {
+            if (slice.size <= 0)
+                return true;
+
+            if (m_job.files.pad_file_at(slice.file_index)) {
+                std::fill_n(buffer, slice.size, 0);
+                return true;
+            }
+
+            // consecutive pieces are mostly read from the same file
+            if (slice.file_index != m_fileIndex) {
+                m_file.close();
+                m_file.setFileName(QString::fromStdString(m_job.files.file_path(slice.file_index, m_job.basePath)));
+                m_fileIndex = slice.file_index;
+                // pieces are read into own buffer so Qt buffering is redundant
+                if (!m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+                    return false;
+            }
+
+            if ((m_file.pos() != slice.offset) && !m_file.seek(slice.offset))
+                return false;
+
+            return (m_file.read(buffer, slice.size) == slice.size);
+        }
+
+        void fail()
+        {
+            const QMutexLocker locker {&m_job.errorMutex};
+            if (m_job.errorMessage.isEmpty()) {
+                m_job.errorMessage = TorrentCreatorThread::tr("Failed to read file \"%1\". Reason: %2")
+                    .arg(Utils::Fs::toUniformPath(m_file.fileName()), m_file.errorString());
+            }
+            m_job.isCanceled = true;
+        }
+
+        PieceHashingJob &m_job;
+        QFile m_file;
+        lt::file_index_t m_fileIndex {-1};
+    };
+}
 
 TorrentCreatorThread::TorrentCreatorThread(QObject *parent)
     : QThread(parent)
@@ -76,9 +195,38 @@ void TorrentCreatorThread::create(const TorrentCreatorParams &params)
     start();
 }
 
-void TorrentCreatorThread::sendProgressSignal(int currentPieceIdx, int totalPieces)
+void TorrentCreatorThread::hashPieces(lt::create_torrent &newTorrent, const QString &basePath)
 {
-    emit updateProgress(static_cast<int>((currentPieceIdx * 100.) / totalPieces));
+    PieceHashingJob job {newTorrent.files(), basePath.toStdString()};
+    const int pieceCount = newTorrent.num_pieces();
+    const int chunkCount = (pieceCount + job.chunkPieceCount - 1) / job.chunkPieceCount;
+    const int threadCount = std::min(chunkCount
+        , ((m_params.hashingThreadCount > 0) ? std::min(m_params.hashingThreadCount, 1024) : QThread::idealThreadCount()));
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(std::max(1, threadCount));
+    for (int i = 0; i < threadCount; ++i)
+        threadPool.start(new PieceHashingTask {job});
+
+    int progress = 0;
+    while (!threadPool.waitForDone(PROGRESS_UPDATE_INTERVAL)) {
+        if (isInterruptionRequested())
+            job.isCanceled = true;
+
+        const int newProgress = static_cast<int>((job.hashedPieceCount * 100.) / pieceCount);
+        if (newProgress != progress) {
+            progress = newProgress;
+            emit updateProgress(progress);
+        }
+    }
+
+    if (!job.errorMessage.isEmpty())
+        throw RuntimeError {job.errorMessage};
+    if (job.isCanceled)
+        return;
+
+    for (int piece = 0; piece < pieceCount; ++piece)
+        newTorrent.set_hash(lt::piece_index_t {piece}, job.hashes[static_cast<std::size_t>(piece)]);
 }
 
 void TorrentCreatorThread::run()
@@ -152,11 +300,7 @@ void TorrentCreatorThread::run()
         if (isInterruptionRequested()) return;
 
         // calculate the hash for all pieces
-        lt::set_piece_hashes(newTorrent, Utils::Fs::toNativePath(parentPath).toStdString()
-            , [this, &newTorrent](const lt::piece_index_t n)
-        {
-            sendProgressSignal(static_cast<LTUnderlyingType<lt::piece_index_t>>(n), newTorrent.num_pieces());
-        });
+        hashPieces(newTorrent, Utils::Fs::toNativePath(parentPath));
         // Set qBittorrent as creator and add user comment to
         // torrent_info structure
         newTorrent.set_creator(creatorStr.toUtf8().constData());
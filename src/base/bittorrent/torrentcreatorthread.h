@@ -29,6 +29,8 @@
 #ifndef BITTORRENT_TORRENTCREATORTHREAD_H
 #define BITTORRENT_TORRENTCREATORTHREAD_H
 
+#include <libtorrent/fwd.hpp>
+
 #include <QStringList>
 #include <QThread>
 
@@ -46,6 +48,8 @@ namespace BitTorrent
         QString source;
         QStringList trackers;
         QStringList urlSeeds;
+        // number of the threads hashing pieces, 0 means the number of CPU cores
+        int hashingThreadCount = 0;
     };
 
     class TorrentCreatorThread final : public QThread
@@ -70,7 +74,7 @@ namespace BitTorrent
         void updateProgress(int progress);
 
     private:
-        void sendProgressSignal(int currentPieceIdx, int totalPieces);
+        void hashPieces(lt::create_torrent &newTorrent, const QString &basePath);
 
         TorrentCreatorParams m_params;
     };
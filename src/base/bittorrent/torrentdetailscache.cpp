@@ -0,0 +1,293 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "torrentdetailscache.h"
+
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+#include <libtorrent/torrent_handle.hpp>
+
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QTimer>
+
+#include "base/global.h"
+#include "session.h"
+#include "torrenthandleimpl.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    // Cached data older than this is refreshed in background
+    const int FRESHNESS_INTERVAL = 1000; // ms
+    // Details of torrents that nobody asked for during this time are dropped
+    const int EXPIRATION_INTERVAL = 60 * 1000; // ms
+    const int MAX_QUERY_THREADS = 2;
+}
+
+class TorrentDetailsCache::QueryTask final : public QRunnable
+{
+public:
+    explicit QueryTask(const std::function<void ()> &job)
+        : m_job {job}
+    {
+    }
+
+    void run() override
+    {
+        m_job();
+    }
+
+private:
+    const std::function<void ()> m_job;
+};
+
+TorrentDetailsCache::TorrentDetailsCache(Session *session)
+    : QObject {session}
+    , m_session {session}
+    , m_cleanupTimer {new QTimer {this}}
+{
+    m_threadPool.setMaxThreadCount(MAX_QUERY_THREADS);
+
+    connect(m_cleanupTimer, &QTimer::timeout, this, &TorrentDetailsCache::removeExpiredDetails);
+    m_cleanupTimer->start(EXPIRATION_INTERVAL);
+
+    connect(session, &Session::torrentAboutToBeRemoved, this, &TorrentDetailsCache::handleTorrentAboutToBeRemoved);
+    connect(session, &Session::trackersAdded, this, &TorrentDetailsCache::invalidate);
+    connect(session, &Session::trackersRemoved, this, &TorrentDetailsCache::invalidate);
+    connect(session, &Session::trackersChanged, this, &TorrentDetailsCache::invalidate);
+}
+
+TorrentDetailsCache::~TorrentDetailsCache()
+{
+    m_threadPool.clear();
+    m_threadPool.waitForDone();
+}
+
+QVector<TrackerEntry> TorrentDetailsCache::trackers(const TorrentHandle *torrent, const RequestMode mode, bool *isPending)
+{
+    return cachedValue(torrent, mode, isPending, &TorrentDetails::trackers
+        , [](const lt::torrent_handle &nativeHandle)
+        {
+            return nativeHandle.trackers();
+        }
+        , [](const TorrentHandleImpl *torrentImpl, const std::vector<lt::announce_entry> &nativeTrackers)
+        {
+            return torrentImpl->trackersFromNative(nativeTrackers);
+        });
+}
+
+QVector<PeerInfo> TorrentDetailsCache::peers(const TorrentHandle *torrent, const RequestMode mode, bool *isPending)
+{
+    return cachedValue(torrent, mode, isPending, &TorrentDetails::peers
+        , [](const lt::torrent_handle &nativeHandle)
+        {
+            std::vector<lt::peer_info> nativePeers;
+            nativeHandle.get_peer_info(nativePeers);
+            return nativePeers;
+        }
+        , [](const TorrentHandleImpl *torrentImpl, const std::vector<lt::peer_info> &nativePeers)
+        {
+            return torrentImpl->peersFromNative(nativePeers);
+        });
+}
+
+QVector<qreal> TorrentDetailsCache::filesProgress(const TorrentHandle *torrent, const RequestMode mode, bool *isPending)
+{
+    return cachedValue(torrent, mode, isPending, &TorrentDetails::filesProgress
+        , [](const lt::torrent_handle &nativeHandle)
+        {
+            std::vector<int64_t> fp;
+            nativeHandle.file_progress(fp, lt::torrent_handle::piece_granularity);
+            return fp;
+        }
+        , [](const TorrentHandleImpl *torrentImpl, const std::vector<int64_t> &fp)
+        {
+            return torrentImpl->filesProgressFromNative(fp);
+        });
+}
+
+Bitfield TorrentDetailsCache::downloadingPieces(const TorrentHandle *torrent, const RequestMode mode, bool *isPending)
+{
+    return cachedValue(torrent, mode, isPending, &TorrentDetails::downloadingPieces
+        , [](const lt::torrent_handle &nativeHandle)
+        {
+            std::vector<lt::partial_piece_info> queue;
+            nativeHandle.get_download_queue(queue);
+            return queue;
+        }
+        , [](const TorrentHandleImpl *torrentImpl, const std::vector<lt::partial_piece_info> &queue)
+        {
+            return torrentImpl->downloadingPiecesFromNative(queue);
+        });
+}
+
+QVector<int> TorrentDetailsCache::pieceAvailability(const TorrentHandle *torrent, const RequestMode mode, bool *isPending)
+{
+    return cachedValue(torrent, mode, isPending, &TorrentDetails::pieceAvailability
+        , [](const lt::torrent_handle &nativeHandle)
+        {
+            std::vector<int> avail;
+            nativeHandle.piece_availability(avail);
+            return avail;
+        }
+        , [](const TorrentHandleImpl *torrentImpl, const std::vector<int> &avail)
+        {
+            return torrentImpl->pieceAvailabilityFromNative(avail);
+        });
+}
+
+void TorrentDetailsCache::invalidate(const TorrentHandle *torrent)
+{
+    const auto iter = m_details.find(torrent->hash());
+    if (iter == m_details.end()) return;
+
+    TorrentDetails &details = iter.value();
+    // The pending queries could obtain the data before the change,
+    // their results are discarded and the data is queried again
+    ++details.generation;
+
+    const auto invalidateValue = [](auto &cached)
+    {
+        cached.timer.invalidate();
+        cached.isPending = false;
+    };
+    invalidateValue(details.trackers);
+    invalidateValue(details.peers);
+    invalidateValue(details.filesProgress);
+    invalidateValue(details.downloadingPieces);
+    invalidateValue(details.pieceAvailability);
+}
+
+template <typename T, typename Query, typename Convert>
+T TorrentDetailsCache::cachedValue(const TorrentHandle *torrent, const RequestMode mode, bool *isPending, CachedValue<T> TorrentDetails::*member, Query query, Convert convert)
+{
+    const InfoHash hash = torrent->hash();
+    const auto *torrentImpl = static_cast<const TorrentHandleImpl *>(torrent);
+
+    TorrentDetails &details = m_details[hash];
+    details.lastAccessTimer.start();
+
+    CachedValue<T> &cached = details.*member;
+    if ((mode == RequestMode::Blocking) && (!cached.hasValue || !cached.timer.isValid())) {
+        // There is nothing actual to serve so we have to wait for the data
+        try {
+            cached.value = convert(torrentImpl, query(torrentImpl->nativeHandle()));
+            cached.hasValue = true;
+            cached.timer.start();
+        }
+        catch (const std::exception &) {
+            // The torrent is being removed, serve what we have
+        }
+    }
+    else if (!cached.isPending && (!cached.timer.isValid() || cached.timer.hasExpired(FRESHNESS_INTERVAL))) {
+        cached.isPending = true;
+
+        const quint64 generation = details.generation;
+        const lt::torrent_handle nativeHandle = torrentImpl->nativeHandle();
+        m_threadPool.start(new QueryTask([this, hash, generation, member, nativeHandle, query, convert]()
+        {
+            decltype(query(nativeHandle)) nativeData;
+            bool isSucceeded = false;
+            try {
+                nativeData = query(nativeHandle);
+                isSucceeded = true;
+            }
+            catch (const std::exception &) {
+                // The torrent was removed while the query was waiting in the queue
+            }
+
+            storeResult([this, hash, generation, member, convert, nativeData, isSucceeded]()
+            {
+                const auto iter = m_details.find(hash);
+                if (iter == m_details.end()) return;
+
+                // The details were invalidated after the query had started
+                TorrentDetails &details = iter.value();
+                if (details.generation != generation) return;
+
+                CachedValue<T> &cached = details.*member;
+                cached.isPending = false;
+                // Keep serving the previous data, the query is repeated on the next request
+                if (!isSucceeded) return;
+
+                auto *torrentImpl = static_cast<TorrentHandleImpl *>(m_session->findTorrent(hash));
+                if (!torrentImpl) return;
+
+                const bool isNotifiable = (!cached.hasValue || !cached.timer.isValid());
+                cached.value = convert(torrentImpl, nativeData);
+                cached.hasValue = true;
+                cached.timer.start();
+                if (isNotifiable)
+                    emit detailsUpdated(torrentImpl);
+            });
+        }));
+    }
+
+    if (isPending)
+        *isPending = (!cached.hasValue || !cached.timer.isValid());
+    return cached.value;
+}
+
+void TorrentDetailsCache::storeResult(const std::function<void ()> &result)
+{
+    const QMutexLocker locker {&m_resultsMutex};
+    m_results.append(result);
+    if (m_results.size() == 1)
+        QMetaObject::invokeMethod(this, "processResults", Qt::QueuedConnection);
+}
+
+void TorrentDetailsCache::processResults()
+{
+    QVector<std::function<void ()>> results;
+    {
+        const QMutexLocker locker {&m_resultsMutex};
+        results.swap(m_results);
+    }
+
+    for (const std::function<void ()> &result : asConst(results))
+        result();
+}
+
+void TorrentDetailsCache::removeExpiredDetails()
+{
+    for (auto iter = m_details.begin(); iter != m_details.end();) {
+        if (iter.value().lastAccessTimer.hasExpired(EXPIRATION_INTERVAL))
+            iter = m_details.erase(iter);
+        else
+            ++iter;
+    }
+}
+
+void TorrentDetailsCache::handleTorrentAboutToBeRemoved(TorrentHandle *torrent)
+{
+    m_details.remove(torrent->hash());
+}
@@ -0,0 +1,134 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <functional>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+
+#include "base/bitfield.h"
+#include "infohash.h"
+#include "peerinfo.h"
+#include "trackerentry.h"
+
+class QTimer;
+
+namespace BitTorrent
+{
+    class Session;
+    class TorrentHandle;
+
+    // Provides the torrent details that libtorrent can only report via blocking
+    // calls (they wait for the network thread). The results are cached per torrent.
+    // When the cached data is older than the freshness interval it is requested
+    // again on a worker thread while the stale data is still served to the callers.
+    // Concurrent requests of the same data are coalesced into a single query.
+    class TorrentDetailsCache final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(TorrentDetailsCache)
+
+    public:
+        // How to handle the request of the data which isn't available yet
+        // (requested for the first time or invalidated)
+        enum class RequestMode
+        {
+            // wait for the actual data, the main thread is blocked meanwhile
+            Blocking,
+            // get the empty (or the invalidated) data and be notified by detailsUpdated()
+            // when the actual one arrives, suitable for the periodically refreshed views
+            NonBlocking
+        };
+
+        explicit TorrentDetailsCache(Session *session);
+        ~TorrentDetailsCache() override;
+
+        // If isPending is given it is set when the returned data isn't actual
+        // (it is empty or invalidated) and the actual one is still being queried
+        QVector<TrackerEntry> trackers(const TorrentHandle *torrent, RequestMode mode = RequestMode::Blocking, bool *isPending = nullptr);
+        QVector<PeerInfo> peers(const TorrentHandle *torrent, RequestMode mode = RequestMode::Blocking, bool *isPending = nullptr);
+        QVector<qreal> filesProgress(const TorrentHandle *torrent, RequestMode mode = RequestMode::Blocking, bool *isPending = nullptr);
+        Bitfield downloadingPieces(const TorrentHandle *torrent, RequestMode mode = RequestMode::Blocking, bool *isPending = nullptr);
+        QVector<int> pieceAvailability(const TorrentHandle *torrent, RequestMode mode = RequestMode::Blocking, bool *isPending = nullptr);
+
+        // Drops the cached data so the next request obtains the actual one,
+        // the results of the queries started before are discarded
+        void invalidate(const TorrentHandle *torrent);
+
+    signals:
+        // Emitted when the data which wasn't available yet arrives,
+        // the periodic refreshes of the available data aren't notified
+        void detailsUpdated(BitTorrent::TorrentHandle *torrent);
+
+    private:
+        template <typename T>
+        struct CachedValue
+        {
+            T value;
+            QElapsedTimer timer;  // invalid if the value isn't actual
+            bool hasValue = false;
+            bool isPending = false;
+        };
+
+        struct TorrentDetails
+        {
+            CachedValue<QVector<TrackerEntry>> trackers;
+            CachedValue<QVector<PeerInfo>> peers;
+            CachedValue<QVector<qreal>> filesProgress;
+            CachedValue<Bitfield> downloadingPieces;
+            CachedValue<QVector<int>> pieceAvailability;
+            QElapsedTimer lastAccessTimer;
+            // is increased by invalidation so the results of the earlier queries can be recognized
+            quint64 generation = 0;
+        };
+
+        class QueryTask;
+
+        template <typename T, typename Query, typename Convert>
+        T cachedValue(const TorrentHandle *torrent, RequestMode mode, bool *isPending, CachedValue<T> TorrentDetails::*member, Query query, Convert convert);
+
+        Q_INVOKABLE void processResults();
+        void storeResult(const std::function<void ()> &result);
+        void removeExpiredDetails();
+        void handleTorrentAboutToBeRemoved(TorrentHandle *torrent);
+
+        Session *const m_session;
+        QThreadPool m_threadPool;
+        QTimer *m_cleanupTimer = nullptr;
+        QHash<InfoHash, TorrentDetails> m_details;
+
+        QMutex m_resultsMutex;
+        QVector<std::function<void ()>> m_results;
+    };
+}
@@ -35,11 +35,12 @@
 #include <QString>
 #include <QVector>
 
-class QBitArray;
 class QDateTime;
 class QStringList;
 class QUrl;
 
+class Bitfield;
+
 namespace BitTorrent
 {
     enum class DownloadPriority;
@@ -171,6 +172,8 @@ namespace BitTorrent
         virtual bool setCategory(const QString &category) = 0;
 
         virtual QSet<QString> tags() const = 0;
+        // Sorted tags joined by ", "
+        virtual QString tagsString() const = 0;
         virtual bool hasTag(const QString &tag) const = 0;
         virtual bool addTag(const QString &tag) = 0;
         virtual bool removeTag(const QString &tag) = 0;
@@ -214,6 +217,7 @@ namespace BitTorrent
         virtual bool hasFilteredPieces() const = 0;
         virtual int queuePosition() const = 0;
         virtual QVector<TrackerEntry> trackers() const = 0;
+        virtual int trackersCount() const = 0;
         virtual QHash<QString, TrackerInfo> trackerInfos() const = 0;
         virtual QVector<QUrl> urlSeeds() const = 0;
         virtual QString error() const = 0;
@@ -241,8 +245,8 @@ namespace BitTorrent
         virtual int uploadLimit() const = 0;
         virtual bool superSeeding() const = 0;
         virtual QVector<PeerInfo> peers() const = 0;
-        virtual QBitArray pieces() const = 0;
-        virtual QBitArray downloadingPieces() const = 0;
+        virtual Bitfield pieces() const = 0;
+        virtual Bitfield downloadingPieces() const = 0;
         virtual QVector<int> pieceAvailability() const = 0;
         virtual qreal distributedCopies() const = 0;
         virtual qreal maxRatio() const = 0;
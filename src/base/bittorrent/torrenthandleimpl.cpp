@@ -46,15 +46,17 @@
 #include <libtorrent/version.hpp>
 #include <libtorrent/write_resume_data.hpp>
 
-#include <QBitArray>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QHostAddress>
 #include <QStringList>
 #include <QUrl>
 
+#include "base/bitfield.h"
 #include "base/global.h"
 #include "base/logger.h"
+#include "base/net/geoipmanager.h"
 #include "base/preferences.h"
 #include "base/profile.h"
 #include "base/utils/fs.h"
@@ -133,6 +135,7 @@ TorrentHandleImpl::TorrentHandleImpl(Session *session, const lt::torrent_handle
 
     updateStatus();
     m_hash = InfoHash(m_nativeStatus.info_hash);
+    updateTagsString();
 
     // NB: the following two if statements are present because we don't want
     // to set either sequential download or first/last piece priority to false
@@ -332,8 +335,20 @@ void TorrentHandleImpl::setAutoManaged(const bool enable)
 
 QVector<TrackerEntry> TorrentHandleImpl::trackers() const
 {
-    const std::vector<lt::announce_entry> nativeTrackers = m_nativeHandle.trackers();
+    const QVector<TrackerEntry> entries = trackersFromNative(m_nativeHandle.trackers());
+    m_trackersCount = entries.size();
+    return entries;
+}
+
+int TorrentHandleImpl::trackersCount() const
+{
+    if (m_trackersCount < 0)
+        m_trackersCount = static_cast<int>(m_nativeHandle.trackers().size());
+    return m_trackersCount;
+}
 
+QVector<TrackerEntry> TorrentHandleImpl::trackersFromNative(const std::vector<lt::announce_entry> &nativeTrackers) const
+{
     QVector<TrackerEntry> entries;
     entries.reserve(nativeTrackers.size());
 
@@ -364,8 +379,10 @@ void TorrentHandleImpl::addTrackers(const QVector<TrackerEntry> &trackers)
         }
     }
 
-    if (!newTrackers.isEmpty())
+    if (!newTrackers.isEmpty()) {
+        invalidateTrackersData();
         m_session->handleTorrentTrackersAdded(this, newTrackers);
+    }
 }
 
 void TorrentHandleImpl::replaceTrackers(const QVector<TrackerEntry> &trackers)
@@ -386,6 +403,8 @@ void TorrentHandleImpl::replaceTrackers(const QVector<TrackerEntry> &trackers)
     }
 
     m_nativeHandle.replace_trackers(nativeTrackers);
+    invalidateTrackersData();
+    m_trackersCount = static_cast<int>(nativeTrackers.size());
 
     if (newTrackers.isEmpty() && currentTrackers.isEmpty()) {
         // when existing tracker reorders
@@ -433,6 +452,9 @@ void TorrentHandleImpl::addUrlSeeds(const QVector<QUrl> &urlSeeds)
         }
     }
 
+    if (!addedUrlSeeds.isEmpty())
+        m_magnetURI.clear();
+
     if (!addedUrlSeeds.isEmpty())
         m_session->handleTorrentUrlSeedsAdded(this, addedUrlSeeds);
 }
@@ -452,6 +474,9 @@ void TorrentHandleImpl::removeUrlSeeds(const QVector<QUrl> &urlSeeds)
         }
     }
 
+    if (!removedUrlSeeds.isEmpty())
+        m_magnetURI.clear();
+
     if (!removedUrlSeeds.isEmpty())
         m_session->handleTorrentUrlSeedsRemoved(this, removedUrlSeeds);
 }
@@ -490,6 +515,10 @@ bool TorrentHandleImpl::needSaveResumeData() const
 
 void TorrentHandleImpl::saveResumeData()
 {
+    // requested once when the bulk update of the torrents is finished
+    if (m_session->deferTorrentResumeDataSaving(this))
+        return;
+
     m_nativeHandle.save_resume_data();
     m_session->handleTorrentSaveResumeDataRequested(this);
 }
@@ -549,6 +578,18 @@ QSet<QString> TorrentHandleImpl::tags() const
     return m_tags;
 }
 
+QString TorrentHandleImpl::tagsString() const
+{
+    return m_tagsString;
+}
+
+void TorrentHandleImpl::updateTagsString()
+{
+    QStringList tagsList = m_tags.values();
+    tagsList.sort();
+    m_tagsString = tagsList.join(", ");
+}
+
 bool TorrentHandleImpl::hasTag(const QString &tag) const
 {
     return m_tags.contains(tag);
@@ -564,6 +605,7 @@ bool TorrentHandleImpl::addTag(const QString &tag)
             if (!m_session->addTag(tag))
                 return false;
         m_tags.insert(tag);
+        updateTagsString();
         m_session->handleTorrentTagAdded(this, tag);
         return true;
     }
@@ -573,6 +615,7 @@ bool TorrentHandleImpl::addTag(const QString &tag)
 bool TorrentHandleImpl::removeTag(const QString &tag)
 {
     if (m_tags.remove(tag)) {
+        updateTagsString();
         m_session->handleTorrentTagRemoved(this, tag);
         return true;
     }
@@ -926,6 +969,11 @@ QVector<qreal> TorrentHandleImpl::filesProgress() const
     std::vector<int64_t> fp;
     m_nativeHandle.file_progress(fp, lt::torrent_handle::piece_granularity);
 
+    return filesProgressFromNative(fp);
+}
+
+QVector<qreal> TorrentHandleImpl::filesProgressFromNative(const std::vector<int64_t> &fp) const
+{
     const int count = static_cast<int>(fp.size());
     QVector<qreal> result;
     result.reserve(count);
@@ -1042,30 +1090,49 @@ QVector<PeerInfo> TorrentHandleImpl::peers() const
     std::vector<lt::peer_info> nativePeers;
     m_nativeHandle.get_peer_info(nativePeers);
 
+    return peersFromNative(nativePeers);
+}
+
+QVector<PeerInfo> TorrentHandleImpl::peersFromNative(const std::vector<lt::peer_info> &nativePeers) const
+{
+    const Bitfield allPieces = pieces();
+
     QVector<PeerInfo> peers;
     peers.reserve(nativePeers.size());
     for (const lt::peer_info &peer : nativePeers)
-        peers << PeerInfo(this, peer);
+        peers << PeerInfo(peer, allPieces);
+
+    // Resolve all countries at once instead of on each PeerInfo::country() call
+    QVector<QHostAddress> addresses;
+    addresses.reserve(peers.size());
+    for (const PeerInfo &peer : asConst(peers))
+        addresses << peer.address().ip;
+
+    const QVector<QString> countries = Net::GeoIPManager::instance()->lookup(addresses);
+    if (countries.size() == peers.size()) {
+        for (int i = 0; i < peers.size(); ++i)
+            peers[i].setCountry(countries[i]);
+    }
+
     return peers;
 }
 
-QBitArray TorrentHandleImpl::pieces() const
+Bitfield TorrentHandleImpl::pieces() const
 {
-    QBitArray result(m_nativeStatus.pieces.size());
-    for (int i = 0; i < result.size(); ++i) {
-        if (m_nativeStatus.pieces[lt::piece_index_t {i}])
-            result.setBit(i, true);
-    }
-    return result;
+    return Bitfield::fromRawData(m_nativeStatus.pieces.data(), m_nativeStatus.pieces.size());
 }
 
-QBitArray TorrentHandleImpl::downloadingPieces() const
+Bitfield TorrentHandleImpl::downloadingPieces() const
 {
-    QBitArray result(piecesCount());
-
     std::vector<lt::partial_piece_info> queue;
     m_nativeHandle.get_download_queue(queue);
 
+    return downloadingPiecesFromNative(queue);
+}
+
+Bitfield TorrentHandleImpl::downloadingPiecesFromNative(const std::vector<lt::partial_piece_info> &queue) const
+{
+    Bitfield result(piecesCount());
     for (const lt::partial_piece_info &info : queue)
         result.setBit(static_cast<LTUnderlyingType<lt::piece_index_t>>(info.piece_index));
 
@@ -1077,6 +1144,11 @@ QVector<int> TorrentHandleImpl::pieceAvailability() const
     std::vector<int> avail;
     m_nativeHandle.piece_availability(avail);
 
+    return pieceAvailabilityFromNative(avail);
+}
+
+QVector<int> TorrentHandleImpl::pieceAvailabilityFromNative(const std::vector<int> &avail) const
+{
     return Vector::fromStdVector(avail);
 }
 
@@ -1634,6 +1706,7 @@ void TorrentHandleImpl::handleMetadataReceivedAlert(const lt::metadata_received_
     Q_UNUSED(p);
     qDebug("Metadata received for torrent %s.", qUtf8Printable(name()));
     updateStatus();
+    invalidateTrackersData();
     if (m_session->isAppendExtensionEnabled())
         manageIncompleteFiles();
     if (!m_hasRootFolder)
@@ -1890,7 +1963,16 @@ void TorrentHandleImpl::flushCache() const
 
 QString TorrentHandleImpl::createMagnetURI() const
 {
-    return QString::fromStdString(lt::make_magnet_uri(m_nativeHandle));
+    if (m_magnetURI.isEmpty())
+        m_magnetURI = QString::fromStdString(lt::make_magnet_uri(m_nativeHandle));
+    return m_magnetURI;
+}
+
+void TorrentHandleImpl::invalidateTrackersData()
+{
+    // the magnet URI includes the trackers
+    m_magnetURI.clear();
+    m_trackersCount = -1;
 }
 
 void TorrentHandleImpl::prioritizeFiles(const QVector<DownloadPriority> &priorities)
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 
 #include <libtorrent/add_torrent_params.hpp>
 #include <libtorrent/fwd.hpp>
@@ -120,6 +121,7 @@ namespace BitTorrent
         bool setCategory(const QString &category) override;
 
         QSet<QString> tags() const override;
+        QString tagsString() const override;
         bool hasTag(const QString &tag) const override;
         bool addTag(const QString &tag) override;
         bool removeTag(const QString &tag) override;
@@ -163,6 +165,7 @@ namespace BitTorrent
         bool hasFilteredPieces() const override;
         int queuePosition() const override;
         QVector<TrackerEntry> trackers() const override;
+        int trackersCount() const override;
         QHash<QString, TrackerInfo> trackerInfos() const override;
         QVector<QUrl> urlSeeds() const override;
         QString error() const override;
@@ -190,8 +193,8 @@ namespace BitTorrent
         int uploadLimit() const override;
         bool superSeeding() const override;
         QVector<PeerInfo> peers() const override;
-        QBitArray pieces() const override;
-        QBitArray downloadingPieces() const override;
+        Bitfield pieces() const override;
+        Bitfield downloadingPieces() const override;
         QVector<int> pieceAvailability() const override;
         qreal distributedCopies() const override;
         qreal maxRatio() const override;
@@ -237,6 +240,14 @@ namespace BitTorrent
         // Session interface
         lt::torrent_handle nativeHandle() const;
 
+        // Conversion of the data queried from the native handle
+        // (it is used by TorrentDetailsCache which performs the queries asynchronously)
+        QVector<TrackerEntry> trackersFromNative(const std::vector<lt::announce_entry> &nativeTrackers) const;
+        QVector<PeerInfo> peersFromNative(const std::vector<lt::peer_info> &nativePeers) const;
+        QVector<qreal> filesProgressFromNative(const std::vector<int64_t> &fp) const;
+        Bitfield downloadingPiecesFromNative(const std::vector<lt::partial_piece_info> &queue) const;
+        QVector<int> pieceAvailabilityFromNative(const std::vector<int> &avail) const;
+
         void handleAlert(const lt::alert *a);
         void handleStateUpdate(const lt::torrent_status &nativeStatus);
         void handleTempPathChanged();
@@ -254,6 +265,8 @@ namespace BitTorrent
         void updateStatus(const lt::torrent_status &nativeStatus);
         void updateState();
         void updateTorrentInfo();
+        void updateTagsString();
+        void invalidateTrackersData();
 
         void handleFastResumeRejectedAlert(const lt::fastresume_rejected_alert *p);
         void handleFileCompletedAlert(const lt::file_completed_alert *p);
@@ -304,6 +317,12 @@ namespace BitTorrent
 
         QHash<QString, TrackerInfo> m_trackerInfos;
 
+        // Derived data that would otherwise require blocking libtorrent calls
+        // (or rebuilding) each time the torrent is serialized
+        mutable QString m_magnetURI;
+        mutable int m_trackersCount = -1;
+        QString m_tagsString;
+
         // Persistent data
         QString m_name;
         QString m_savePath;
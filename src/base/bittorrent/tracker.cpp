@@ -30,10 +30,17 @@
 
 #include "tracker.h"
 
+#include <algorithm>
+
 #include <libtorrent/bencode.hpp>
 #include <libtorrent/entry.hpp>
 
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QHostAddress>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QtEndian>
 
 #include "base/exceptions.h"
 #include "base/global.h"
@@ -42,6 +49,7 @@
 #include "base/http/types.h"
 #include "base/logger.h"
 #include "base/preferences.h"
+#include "base/utils/random.h"
 
 namespace
 {
@@ -49,11 +57,18 @@ namespace
     const int MAX_TORRENTS = 10000;
     const int MAX_PEERS_PER_TORRENT = 200;
     const int ANNOUNCE_INTERVAL = 1800;  // 30min
+    const int MAX_SCRAPE_TORRENTS = 74;  // [BEP-15] that is what fits in a single UDP packet
+
+    // peers that didn't reannounce in time are removed
+    const int PEER_TIMEOUT = ANNOUNCE_INTERVAL * 2;
+    const int EXPIRATION_TICK_INTERVAL = 60;  // 1min
+    const int EXPIRATION_WHEEL_SIZE = PEER_TIMEOUT / EXPIRATION_TICK_INTERVAL;
 
     // constants
     const int PEER_ID_SIZE = 20;
 
     const char ANNOUNCE_REQUEST_PATH[] = "/announce";
+    const char SCRAPE_REQUEST_PATH[] = "/scrape";
 
     const char ANNOUNCE_REQUEST_COMPACT[] = "compact";
     const char ANNOUNCE_REQUEST_INFO_HASH[] = "info_hash";
@@ -83,6 +98,26 @@ namespace
     const char ANNOUNCE_RESPONSE_PEERS_PEER_ID[] = "peer id";
     const char ANNOUNCE_RESPONSE_PEERS_PORT[] = "port";
 
+    const char SCRAPE_RESPONSE_DOWNLOADED[] = "downloaded";
+    const char SCRAPE_RESPONSE_FILES[] = "files";
+
+    // [BEP-15] UDP Tracker Protocol
+    const quint64 UDP_PROTOCOL_ID = 0x41727101980;
+    const int UDP_CONNECTION_ID_LIFETIME = 120;  // 2min
+    const int UDP_MAX_DATAGRAM_SIZE = 2048;
+    const int UDP_REQUEST_HEADER_SIZE = 16;
+    const int UDP_ANNOUNCE_REQUEST_SIZE = 98;
+
+    const quint32 UDP_ACTION_CONNECT = 0;
+    const quint32 UDP_ACTION_ANNOUNCE = 1;
+    const quint32 UDP_ACTION_SCRAPE = 2;
+    const quint32 UDP_ACTION_ERROR = 3;
+
+    const quint32 UDP_EVENT_NONE = 0;
+    const quint32 UDP_EVENT_COMPLETED = 1;
+    const quint32 UDP_EVENT_STARTED = 2;
+    const quint32 UDP_EVENT_STOPPED = 3;
+
     class TrackerError : public RuntimeError
     {
     public:
@@ -117,6 +152,61 @@ namespace
             return {};
         };
     }
+
+    QHostAddress normalizedAddress(const QHostAddress &address)
+    {
+        // Enforce using IPv4 if address is indeed IPv4 or if it is an IPv4-mapped IPv6 address
+        bool ok = false;
+        const quint32 decimalIPv4 = address.toIPv4Address(&ok);
+        return (ok ? QHostAddress(decimalIPv4) : address);
+    }
+
+    template <typename T>
+    void appendBigEndian(QByteArray &out, const T value)
+    {
+        char buffer[sizeof(T)];
+        qToBigEndian(value, buffer);
+        out.append(buffer, sizeof(T));
+    }
+
+    // Bencoding helpers, they let us build the replies in place
+    // instead of constructing `lt::entry` dictionaries for each request
+    void appendBencodedString(QByteArray &out, const char *data, const int size)
+    {
+        out.append(QByteArray::number(size)).append(':').append(data, size);
+    }
+
+    void appendBencodedString(QByteArray &out, const char *str)
+    {
+        appendBencodedString(out, str, static_cast<int>(qstrlen(str)));
+    }
+
+    void appendBencodedInteger(QByteArray &out, const qint64 value)
+    {
+        out.append('i').append(QByteArray::number(value)).append('e');
+    }
+
+    // Appends `count` entries of `entrySize` bytes each starting from a random one,
+    // so that different peers receive different parts of the large swarms
+    void appendPeers(QByteArray &out, const QByteArray &compactPeers, const int entrySize, const int count)
+    {
+        const int peersCount = compactPeers.size() / entrySize;
+        if (count >= peersCount) {
+            out.append(compactPeers);
+            return;
+        }
+
+        const int startPos = static_cast<int>(Utils::Random::rand(0, (peersCount - 1))) * entrySize;
+        const int size = count * entrySize;
+        const int tailSize = std::min(size, (compactPeers.size() - startPos));
+        out.append((compactPeers.constData() + startPos), tailSize);
+        out.append(compactPeers.constData(), (size - tailSize));
+    }
+
+    lt::sha1_hash toNativeHash(const QByteArray &rawHash)
+    {
+        return lt::sha1_hash {rawHash.constData()};
+    }
 }
 
 namespace BitTorrent
@@ -156,41 +246,90 @@ struct Tracker::TrackerAnnounceRequest
     int numwant = 50;
     bool compact = true;
     bool noPeerId = false;
+
+    void cachePeerAddress()
+    {
+        // cache `peers` field so we don't recompute when sending response
+        const QHostAddress claimedIPAddress {QString::fromLatin1(claimedAddress)};
+        peer.endpoint = toBigEndianByteArray(!claimedIPAddress.isNull() ? claimedIPAddress : socketAddress)
+            .append(static_cast<char>((peer.port >> 8) & 0xFF))
+            .append(static_cast<char>(peer.port & 0xFF))
+            .toStdString();
+
+        // cache `address` field so we don't recompute when sending response
+        peer.address = !claimedAddress.isEmpty()
+            ? claimedAddress.constData()
+            : socketAddress.toString().toLatin1().constData();
+    }
 };
 
 // Tracker::TorrentStats
 void Tracker::TorrentStats::setPeer(const Peer &peer)
 {
+    const QByteArray peerID = peer.uniqueID();
+
     // always replace existing peer
-    if (!removePeer(peer)) {
+    if (!removePeer(peerID)) {
         // Too many peers, remove a random one
         if (peers.size() >= MAX_PEERS_PER_TORRENT)
-            removePeer(*peers.begin());
+            removePeer(peers.begin().key());
     }
 
     // add peer
     if (peer.isSeeder)
         ++seeders;
-    peers.insert(peer);
+    peers.insert(peerID, peer);
+    isCompactPeersValid = false;
 }
 
-bool Tracker::TorrentStats::removePeer(const Peer &peer)
+bool Tracker::TorrentStats::removePeer(const QByteArray &peerID)
 {
-    const auto iter = peers.find(peer);
+    const auto iter = peers.find(peerID);
     if (iter == peers.end())
         return false;
 
     if (iter->isSeeder)
         --seeders;
-    peers.remove(*iter);
+    peers.erase(iter);
+    isCompactPeersValid = false;
     return true;
 }
 
+void Tracker::TorrentStats::updateCompactPeers() const
+{
+    if (isCompactPeersValid)
+        return;
+
+    compactPeers.clear();
+    compactPeers6.clear();
+    for (const Peer &peer : peers) {
+        if (peer.endpoint.size() == 6)  // IPv4 + port
+            compactPeers.append(peer.endpoint.data(), 6);
+        else if (peer.endpoint.size() == 18)  // IPv6 + port
+            compactPeers6.append(peer.endpoint.data(), 18);
+    }
+
+    isCompactPeersValid = true;
+}
+
 // Tracker
 Tracker::Tracker(QObject *parent)
     : QObject(parent)
     , m_server(new Http::Server(this, this))
+    , m_udpSocket(new QUdpSocket(this))
+    , m_udpBuffer(UDP_MAX_DATAGRAM_SIZE, Qt::Uninitialized)
+    , m_expirationTimer(new QTimer(this))
+    , m_expirationWheel(EXPIRATION_WHEEL_SIZE)
 {
+    for (int i = 0; i < 4; ++i)
+        appendBigEndian<quint32>(m_udpSecret, Utils::Random::rand());
+
+    connect(m_udpSocket, &QUdpSocket::readyRead, this, &Tracker::handleUdpReadyRead);
+
+    connect(m_expirationTimer, &QTimer::timeout, this, &Tracker::expirePeers);
+    m_expirationTimer->start(EXPIRATION_TICK_INTERVAL * 1000);
+
+    m_uptime.start();
 }
 
 bool Tracker::start()
@@ -206,6 +345,7 @@ bool Tracker::start()
 
         // Wrong port, closing the server
         m_server->close();
+        m_udpSocket->close();
     }
 
     // Listen on the predefined port
@@ -221,9 +361,32 @@ bool Tracker::start()
             , Log::WARNING);
     }
 
+    // [BEP-15] UDP tracker uses the same port number
+    if (!m_udpSocket->bind(ip, port)) {
+        LogMsg(tr("Embedded Tracker: Unable to bind UDP socket to IP: %1, port: %2. Reason: %3")
+                .arg(ip.toString(), QString::number(port), m_udpSocket->errorString())
+            , Log::WARNING);
+    }
+
     return listenSuccess;
 }
 
+Tracker::Counters Tracker::counters() const
+{
+    rollAnnounceCounter();
+
+    Counters result;
+    result.torrents = m_torrents.size();
+    for (const TorrentStats &torrentStats : m_torrents)
+        result.peers += torrentStats.peers.size();
+    result.announces = m_announces;
+    result.scrapes = m_scrapes;
+    result.udpRequests = m_udpRequests;
+    result.expiredPeers = m_expiredPeers;
+    result.announcesPerSecond = m_lastSecondAnnounces;
+    return result;
+}
+
 Http::Response Tracker::processRequest(const Http::Request &request, const Http::Environment &env)
 {
     clear();  // clear response
@@ -238,8 +401,11 @@ Http::Response Tracker::processRequest(const Http::Request &request, const Http:
         if (request.method != Http::HEADER_REQUEST_METHOD_GET)
             throw MethodNotAllowedHTTPError();
 
-        if (request.path.toLower().startsWith(ANNOUNCE_REQUEST_PATH))
+        const QString path = request.path.toLower();
+        if (path.startsWith(ANNOUNCE_REQUEST_PATH))
             processAnnounceRequest();
+        else if (path.startsWith(SCRAPE_REQUEST_PATH))
+            processScrapeRequest();
         else
             throw NotFoundHTTPError();
     }
@@ -269,15 +435,9 @@ void Tracker::processAnnounceRequest()
     TrackerAnnounceRequest announceReq;
 
     // ip address
-    announceReq.socketAddress = m_env.clientAddress;
+    announceReq.socketAddress = normalizedAddress(m_env.clientAddress);
     announceReq.claimedAddress = queryParams.value(ANNOUNCE_REQUEST_IP);
 
-    // Enforce using IPv4 if address is indeed IPv4 or if it is an IPv4-mapped IPv6 address
-    bool ok = false;
-    const qint32 decimalIPv4 = announceReq.socketAddress.toIPv4Address(&ok);
-    if (ok)
-        announceReq.socketAddress = QHostAddress(decimalIPv4);
-
     // 1. info_hash
     const auto infoHashIter = queryParams.find(ANNOUNCE_REQUEST_INFO_HASH);
     if (infoHashIter == queryParams.end())
@@ -329,28 +489,74 @@ void Tracker::processAnnounceRequest()
     // 7. compact
     announceReq.compact = (queryParams.value(ANNOUNCE_REQUEST_COMPACT) != "0");
 
-    // 8. cache `peers` field so we don't recompute when sending response
-    const QHostAddress claimedIPAddress {QString::fromLatin1(announceReq.claimedAddress)};
-    announceReq.peer.endpoint = toBigEndianByteArray(!claimedIPAddress.isNull() ? claimedIPAddress : announceReq.socketAddress)
-        .append(static_cast<char>((announceReq.peer.port >> 8) & 0xFF))
-        .append(static_cast<char>(announceReq.peer.port & 0xFF))
-        .toStdString();
-
-    // 9. cache `address` field so we don't recompute when sending response
-    announceReq.peer.address = !announceReq.claimedAddress.isEmpty()
-        ? announceReq.claimedAddress.constData()
-        : announceReq.socketAddress.toString().toLatin1().constData(),
+    // 8. cache `peers` and `address` fields
+    announceReq.cachePeerAddress();
 
-    // 10. event
+    // 9. event
     announceReq.event = queryParams.value(ANNOUNCE_REQUEST_EVENT);
 
+    processAnnounce(announceReq);
+    prepareAnnounceResponse(announceReq);
+}
+
+void Tracker::processScrapeRequest()
+{
+    // [BEP-48] Tracker Protocol Extension: Scrape
+    // Only a single `info_hash` parameter is supported since the query parameters are unique,
+    // all the torrents are reported if it is omitted
+    ++m_scrapes;
+
+    QVector<lt::sha1_hash> hashes;
+    const auto infoHashIter = m_request.query.find(ANNOUNCE_REQUEST_INFO_HASH);
+    if (infoHashIter != m_request.query.end()) {
+        if (infoHashIter->size() != InfoHash::length())
+            throw TrackerError("Invalid \"info_hash\" parameter");
+        hashes.append(toNativeHash(*infoHashIter));
+    }
+    else {
+        hashes.reserve(m_torrents.size());
+        for (auto iter = m_torrents.cbegin(); iter != m_torrents.cend(); ++iter)
+            hashes.append(iter.key());
+        // dictionary keys must be sorted
+        std::sort(hashes.begin(), hashes.end());
+    }
+
+    QByteArray reply;
+    reply.reserve(16 + (hashes.size() * 80));
+    reply.append('d');
+    appendBencodedString(reply, SCRAPE_RESPONSE_FILES);
+    reply.append('d');
+    for (const lt::sha1_hash &hash : asConst(hashes)) {
+        const auto iter = m_torrents.constFind(hash);
+        if (iter == m_torrents.cend())
+            continue;
+
+        appendBencodedString(reply, hash.data(), static_cast<int>(hash.size()));
+        reply.append('d');
+        appendBencodedString(reply, ANNOUNCE_RESPONSE_COMPLETE);
+        appendBencodedInteger(reply, iter->seeders);
+        appendBencodedString(reply, SCRAPE_RESPONSE_DOWNLOADED);
+        appendBencodedInteger(reply, iter->completed);
+        appendBencodedString(reply, ANNOUNCE_RESPONSE_INCOMPLETE);
+        appendBencodedInteger(reply, (iter->peers.size() - iter->seeders));
+        reply.append('e');
+    }
+    reply.append("ee");
+
+    print(reply, Http::CONTENT_TYPE_TXT);
+}
+
+void Tracker::processAnnounce(const TrackerAnnounceRequest &announceReq)
+{
+    countAnnounce();
+
     if (announceReq.event.isEmpty()
         || (announceReq.event == ANNOUNCE_REQUEST_EVENT_EMPTY)
         || (announceReq.event == ANNOUNCE_REQUEST_EVENT_COMPLETED)
         || (announceReq.event == ANNOUNCE_REQUEST_EVENT_STARTED)
         || (announceReq.event == ANNOUNCE_REQUEST_EVENT_PAUSED)) {
         // [BEP-21] Extension for partial seeds
-        // (partial support - we don't support BEP-48 so the part that concerns that is not supported)
+        // (partial support - partial seeds aren't reported separately by scrape)
         registerPeer(announceReq);
     }
     else if (announceReq.event == ANNOUNCE_REQUEST_EVENT_STOPPED) {
@@ -359,19 +565,32 @@ void Tracker::processAnnounceRequest()
     else {
         throw TrackerError("Invalid \"event\" parameter");
     }
-
-    prepareAnnounceResponse(announceReq);
 }
 
 void Tracker::registerPeer(const TrackerAnnounceRequest &announceReq)
 {
     if (!m_torrents.contains(announceReq.infoHash)) {
-        // Reached max size, remove a random torrent
-        if (m_torrents.size() >= MAX_TORRENTS)
-            m_torrents.erase(m_torrents.begin());
+        // Reached max size, remove the torrent that was inactive for the longest time
+        if (m_torrents.size() >= MAX_TORRENTS) {
+            const auto staleIter = std::min_element(m_torrents.begin(), m_torrents.end()
+                , [](const TorrentStats &left, const TorrentStats &right)
+            {
+                return (left.announceTick < right.announceTick);
+            });
+            m_torrents.erase(staleIter);
+        }
     }
 
-    m_torrents[announceReq.infoHash].setPeer(announceReq.peer);
+    TorrentStats &torrentStats = m_torrents[announceReq.infoHash];
+    torrentStats.announceTick = m_currentTick;
+    if (announceReq.event == ANNOUNCE_REQUEST_EVENT_COMPLETED)
+        ++torrentStats.completed;
+
+    Peer peer = announceReq.peer;
+    peer.announceTick = m_currentTick;
+    torrentStats.setPeer(peer);
+
+    m_expirationWheel[m_currentTick % EXPIRATION_WHEEL_SIZE].append({announceReq.infoHash, peer.uniqueID()});
 }
 
 void Tracker::unregisterPeer(const TrackerAnnounceRequest &announceReq)
@@ -380,15 +599,62 @@ void Tracker::unregisterPeer(const TrackerAnnounceRequest &announceReq)
     if (torrentStatsIter == m_torrents.end())
         return;
 
-    torrentStatsIter->removePeer(announceReq.peer);
+    torrentStatsIter->removePeer(announceReq.peer.uniqueID());
 
     if (torrentStatsIter->peers.isEmpty())
         m_torrents.erase(torrentStatsIter);
 }
 
+const Tracker::TorrentStats &Tracker::torrentStats(const InfoHash &infoHash) const
+{
+    static const TorrentStats emptyStats;
+
+    const auto iter = m_torrents.constFind(infoHash);
+    return ((iter != m_torrents.cend()) ? iter.value() : emptyStats);
+}
+
 void Tracker::prepareAnnounceResponse(const TrackerAnnounceRequest &announceReq)
 {
-    const TorrentStats &torrentStats = m_torrents[announceReq.infoHash];
+    const TorrentStats &torrentStats = this->torrentStats(announceReq.infoHash);
+    const bool isStopped = (announceReq.event == ANNOUNCE_REQUEST_EVENT_STOPPED);
+
+    // peer list
+    // [BEP-7] IPv6 Tracker Extension (partial support - only the part that concerns BEP-23)
+    // [BEP-23] Tracker Returns Compact Peer Lists
+    if (announceReq.compact) {
+        torrentStats.updateCompactPeers();
+
+        const int peersCount = isStopped ? 0 : std::min((torrentStats.compactPeers.size() / 6), announceReq.numwant);
+        const int peers6Count = isStopped ? 0 : std::min((torrentStats.compactPeers6.size() / 18), (announceReq.numwant - peersCount));
+        const QByteArray externalIP = toBigEndianByteArray(announceReq.socketAddress);
+
+        // dictionary keys must be sorted
+        QByteArray reply;
+        reply.reserve(160 + (peersCount * 6) + (peers6Count * 18));
+        reply.append('d');
+        appendBencodedString(reply, ANNOUNCE_RESPONSE_COMPLETE);
+        appendBencodedInteger(reply, torrentStats.seeders);
+        // [BEP-24] Tracker Returns External IP (partial support - might not work properly for all IPv6 cases)
+        appendBencodedString(reply, ANNOUNCE_RESPONSE_EXTERNAL_IP);
+        appendBencodedString(reply, externalIP.constData(), externalIP.size());
+        appendBencodedString(reply, ANNOUNCE_RESPONSE_INCOMPLETE);
+        appendBencodedInteger(reply, (torrentStats.peers.size() - torrentStats.seeders));
+        appendBencodedString(reply, ANNOUNCE_RESPONSE_INTERVAL);
+        appendBencodedInteger(reply, ANNOUNCE_INTERVAL);
+        // required, even it's empty
+        appendBencodedString(reply, ANNOUNCE_RESPONSE_PEERS);
+        reply.append(QByteArray::number(peersCount * 6)).append(':');
+        appendPeers(reply, torrentStats.compactPeers, 6, peersCount);
+        if (peers6Count > 0) {
+            appendBencodedString(reply, ANNOUNCE_RESPONSE_PEERS6);
+            reply.append(QByteArray::number(peers6Count * 18)).append(':');
+            appendPeers(reply, torrentStats.compactPeers6, 18, peers6Count);
+        }
+        reply.append('e');
+
+        print(reply, Http::CONTENT_TYPE_TXT);
+        return;
+    }
 
     lt::entry::dictionary_type replyDict {
         {ANNOUNCE_RESPONSE_INTERVAL, ANNOUNCE_INTERVAL},
@@ -399,56 +665,240 @@ void Tracker::prepareAnnounceResponse(const TrackerAnnounceRequest &announceReq)
         {ANNOUNCE_RESPONSE_EXTERNAL_IP, toBigEndianByteArray(announceReq.socketAddress).toStdString()}
     };
 
-    // peer list
-    // [BEP-7] IPv6 Tracker Extension (partial support - only the part that concerns BEP-23)
-    // [BEP-23] Tracker Returns Compact Peer Lists
-    if (announceReq.compact) {
-        lt::entry::string_type peers;
-        lt::entry::string_type peers6;
-
-        if (announceReq.event != ANNOUNCE_REQUEST_EVENT_STOPPED) {
-            int counter = 0;
-            for (const Peer &peer : asConst(torrentStats.peers)) {
-                if (counter++ >= announceReq.numwant)
-                    break;
-
-                if (peer.endpoint.size() == 6)  // IPv4 + port
-                    peers.append(peer.endpoint);
-                else if (peer.endpoint.size() == 18)  // IPv6 + port
-                    peers6.append(peer.endpoint);
-            }
+    lt::entry::list_type peerList;
+
+    if (!isStopped) {
+        int counter = 0;
+        for (const Peer &peer : torrentStats.peers) {
+            if (counter++ >= announceReq.numwant)
+                break;
+
+            lt::entry::dictionary_type peerDict = {
+                {ANNOUNCE_RESPONSE_PEERS_IP, peer.address},
+                {ANNOUNCE_RESPONSE_PEERS_PORT, peer.port}
+            };
+
+            if (!announceReq.noPeerId)
+                peerDict[ANNOUNCE_RESPONSE_PEERS_PEER_ID] = peer.peerId.constData();
+
+            peerList.emplace_back(peerDict);
         }
+    }
+
+    replyDict[ANNOUNCE_RESPONSE_PEERS] = peerList;
 
-        replyDict[ANNOUNCE_RESPONSE_PEERS] = peers;  // required, even it's empty
-        if (!peers6.empty())
-            replyDict[ANNOUNCE_RESPONSE_PEERS6] = peers6;
+    // bencode
+    QByteArray reply;
+    lt::bencode(std::back_inserter(reply), replyDict);
+    print(reply, Http::CONTENT_TYPE_TXT);
+}
+
+void Tracker::handleUdpReadyRead()
+{
+    while (m_udpSocket->hasPendingDatagrams()) {
+        QHostAddress address;
+        quint16 port = 0;
+        const qint64 size = m_udpSocket->readDatagram(m_udpBuffer.data(), m_udpBuffer.size(), &address, &port);
+        if (size < UDP_REQUEST_HEADER_SIZE)
+            continue;
+
+        ++m_udpRequests;
+
+        const QByteArray datagram = QByteArray::fromRawData(m_udpBuffer.constData(), static_cast<int>(size));
+        const QByteArray reply = processUdpRequest(datagram, normalizedAddress(address), port);
+        if (!reply.isEmpty())
+            m_udpSocket->writeDatagram(reply, address, port);
     }
-    else {
-        lt::entry::list_type peerList;
+}
 
-        if (announceReq.event != ANNOUNCE_REQUEST_EVENT_STOPPED) {
-            int counter = 0;
-            for (const Peer &peer : torrentStats.peers) {
-                if (counter++ >= announceReq.numwant)
-                    break;
+QByteArray Tracker::processUdpRequest(const QByteArray &datagram, const QHostAddress &address, const quint16 port)
+{
+    const char *data = datagram.constData();
+    const quint64 connectionID = qFromBigEndian<quint64>(data);
+    const quint32 action = qFromBigEndian<quint32>(data + 8);
+    const quint32 transactionID = qFromBigEndian<quint32>(data + 12);
 
-                lt::entry::dictionary_type peerDict = {
-                    {ANNOUNCE_RESPONSE_PEERS_IP, peer.address},
-                    {ANNOUNCE_RESPONSE_PEERS_PORT, peer.port}
-                };
+    // Connection IDs aren't stored, they are derived from the client address and
+    // the current time period so we accept the ones issued for the previous period as well
+    const qint64 epoch = QDateTime::currentSecsSinceEpoch() / UDP_CONNECTION_ID_LIFETIME;
 
-                if (!announceReq.noPeerId)
-                    peerDict[ANNOUNCE_RESPONSE_PEERS_PEER_ID] = peer.peerId.constData();
+    if (action == UDP_ACTION_CONNECT) {
+        if (connectionID != UDP_PROTOCOL_ID)
+            return {};
 
-                peerList.emplace_back(peerDict);
-            }
+        QByteArray reply;
+        reply.reserve(16);
+        appendBigEndian<quint32>(reply, UDP_ACTION_CONNECT);
+        appendBigEndian<quint32>(reply, transactionID);
+        appendBigEndian<quint64>(reply, udpConnectionID(address, port, epoch));
+        return reply;
+    }
+
+    try {
+        if ((connectionID != udpConnectionID(address, port, epoch))
+            && (connectionID != udpConnectionID(address, port, (epoch - 1)))) {
+            throw TrackerError("Invalid connection ID");
         }
 
-        replyDict[ANNOUNCE_RESPONSE_PEERS] = peerList;
+        switch (action) {
+        case UDP_ACTION_ANNOUNCE:
+            return processUdpAnnounceRequest(datagram, address, transactionID);
+        case UDP_ACTION_SCRAPE:
+            return processUdpScrapeRequest(datagram, transactionID);
+        default:
+            throw TrackerError("Invalid action");
+        }
     }
+    catch (const TrackerError &error) {
+        const QByteArray message = error.message().toUtf8();
+
+        QByteArray reply;
+        reply.reserve(8 + message.size());
+        appendBigEndian<quint32>(reply, UDP_ACTION_ERROR);
+        appendBigEndian<quint32>(reply, transactionID);
+        reply.append(message);
+        return reply;
+    }
+}
+
+QByteArray Tracker::processUdpAnnounceRequest(const QByteArray &datagram, const QHostAddress &address, const quint32 transactionID)
+{
+    if (datagram.size() < UDP_ANNOUNCE_REQUEST_SIZE)
+        throw TrackerError("Invalid announce request");
+
+    const char *data = datagram.constData();
+    TrackerAnnounceRequest announceReq;
+    announceReq.socketAddress = address;
+    announceReq.infoHash = toNativeHash(QByteArray::fromRawData((data + 16), InfoHash::length()));
+    announceReq.peer.peerId = QByteArray((data + 36), PEER_ID_SIZE);
+    announceReq.peer.isSeeder = (qFromBigEndian<quint64>(data + 64) == 0);
+
+    switch (qFromBigEndian<quint32>(data + 80)) {
+    case UDP_EVENT_NONE:
+        break;
+    case UDP_EVENT_COMPLETED:
+        announceReq.event = ANNOUNCE_REQUEST_EVENT_COMPLETED;
+        break;
+    case UDP_EVENT_STARTED:
+        announceReq.event = ANNOUNCE_REQUEST_EVENT_STARTED;
+        break;
+    case UDP_EVENT_STOPPED:
+        announceReq.event = ANNOUNCE_REQUEST_EVENT_STOPPED;
+        break;
+    default:
+        throw TrackerError("Invalid \"event\" parameter");
+    }
+
+    const quint32 claimedIPv4 = qFromBigEndian<quint32>(data + 84);
+    if (claimedIPv4 != 0)
+        announceReq.claimedAddress = QHostAddress(claimedIPv4).toString().toLatin1();
+
+    const qint32 numwant = qFromBigEndian<qint32>(data + 92);
+    if (numwant >= 0)
+        announceReq.numwant = numwant;
+
+    announceReq.peer.port = qFromBigEndian<quint16>(data + 96);
+    if (announceReq.peer.port == 0)
+        throw TrackerError("Invalid \"port\" parameter");
+
+    announceReq.cachePeerAddress();
+
+    processAnnounce(announceReq);
+
+    const TorrentStats &torrentStats = this->torrentStats(announceReq.infoHash);
+    torrentStats.updateCompactPeers();
+
+    // the peers of the same address family as the request one are returned
+    const bool isIPv6 = (address.protocol() == QAbstractSocket::IPv6Protocol);
+    const QByteArray &compactPeers = isIPv6 ? torrentStats.compactPeers6 : torrentStats.compactPeers;
+    const int entrySize = isIPv6 ? 18 : 6;
+    const int maxCount = (UDP_MAX_DATAGRAM_SIZE - 20) / entrySize;
+    const int peersCount = (announceReq.event == ANNOUNCE_REQUEST_EVENT_STOPPED)
+        ? 0 : std::min({(compactPeers.size() / entrySize), announceReq.numwant, maxCount});
 
-    // bencode
     QByteArray reply;
-    lt::bencode(std::back_inserter(reply), replyDict);
-    print(reply, Http::CONTENT_TYPE_TXT);
+    reply.reserve(20 + (peersCount * entrySize));
+    appendBigEndian<quint32>(reply, UDP_ACTION_ANNOUNCE);
+    appendBigEndian<quint32>(reply, transactionID);
+    appendBigEndian<quint32>(reply, ANNOUNCE_INTERVAL);
+    appendBigEndian<quint32>(reply, (torrentStats.peers.size() - torrentStats.seeders));
+    appendBigEndian<quint32>(reply, torrentStats.seeders);
+    appendPeers(reply, compactPeers, entrySize, peersCount);
+    return reply;
+}
+
+QByteArray Tracker::processUdpScrapeRequest(const QByteArray &datagram, const quint32 transactionID)
+{
+    ++m_scrapes;
+
+    const int hashesCount = std::min(((datagram.size() - UDP_REQUEST_HEADER_SIZE) / InfoHash::length()), MAX_SCRAPE_TORRENTS);
+
+    QByteArray reply;
+    reply.reserve(8 + (hashesCount * 12));
+    appendBigEndian<quint32>(reply, UDP_ACTION_SCRAPE);
+    appendBigEndian<quint32>(reply, transactionID);
+    for (int i = 0; i < hashesCount; ++i) {
+        const char *rawHash = datagram.constData() + UDP_REQUEST_HEADER_SIZE + (i * InfoHash::length());
+        const TorrentStats &torrentStats = this->torrentStats(toNativeHash(QByteArray::fromRawData(rawHash, InfoHash::length())));
+        appendBigEndian<quint32>(reply, torrentStats.seeders);
+        appendBigEndian<quint32>(reply, torrentStats.completed);
+        appendBigEndian<quint32>(reply, (torrentStats.peers.size() - torrentStats.seeders));
+    }
+    return reply;
+}
+
+quint64 Tracker::udpConnectionID(const QHostAddress &address, const quint16 port, const qint64 epoch) const
+{
+    QByteArray data = m_udpSecret + toBigEndianByteArray(address);
+    appendBigEndian<quint16>(data, port);
+    appendBigEndian<qint64>(data, epoch);
+
+    const QByteArray digest = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    return qFromBigEndian<quint64>(digest.constData());
+}
+
+void Tracker::expirePeers()
+{
+    ++m_currentTick;
+
+    // The slot contains the peers that announced `EXPIRATION_WHEEL_SIZE` ticks ago,
+    // the ones that have reannounced since then are referenced by a newer slot
+    QVector<PeerRef> &slot = m_expirationWheel[m_currentTick % EXPIRATION_WHEEL_SIZE];
+    const qint64 expiredTick = m_currentTick - EXPIRATION_WHEEL_SIZE;
+    for (const PeerRef &peerRef : asConst(slot)) {
+        const auto torrentStatsIter = m_torrents.find(peerRef.infoHash);
+        if (torrentStatsIter == m_torrents.end())
+            continue;
+
+        const auto peerIter = torrentStatsIter->peers.constFind(peerRef.peerID);
+        if ((peerIter == torrentStatsIter->peers.cend()) || (peerIter->announceTick != expiredTick))
+            continue;
+
+        torrentStatsIter->removePeer(peerRef.peerID);
+        ++m_expiredPeers;
+
+        if (torrentStatsIter->peers.isEmpty())
+            m_torrents.erase(torrentStatsIter);
+    }
+
+    slot.clear();
+    slot.squeeze();
+}
+
+void Tracker::countAnnounce()
+{
+    rollAnnounceCounter();
+    ++m_currentSecondAnnounces;
+    ++m_announces;
+}
+
+void Tracker::rollAnnounceCounter() const
+{
+    const qint64 second = m_uptime.elapsed() / 1000;
+    if (second == m_counterSecond)
+        return;
+
+    m_lastSecondAnnounces = (second == (m_counterSecond + 1)) ? m_currentSecondAnnounces : 0;
+    m_currentSecondAnnounces = 0;
+    m_counterSecond = second;
 }
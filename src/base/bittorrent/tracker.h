@@ -35,14 +35,20 @@
 
 #include <libtorrent/entry.hpp>
 
+#include <QByteArray>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QObject>
-#include <QSet>
+#include <QVector>
 
 #include "base/bittorrent/infohash.h"
 #include "base/http/irequesthandler.h"
 #include "base/http/responsebuilder.h"
 
+class QHostAddress;
+class QTimer;
+class QUdpSocket;
+
 namespace Http
 {
     class Server;
@@ -55,6 +61,7 @@ namespace BitTorrent
         QByteArray peerId;
         ushort port = 0;  // self-claimed by peer, might not be the same as socket port
         bool isSeeder = false;
+        qint64 announceTick = 0;  // tick of the expiration wheel when the peer announced last time
 
         // caching precomputed values
         lt::entry::string_type address;
@@ -70,6 +77,8 @@ namespace BitTorrent
     // *Basic* Bittorrent tracker implementation
     // [BEP-3] The BitTorrent Protocol Specification
     // also see: https://wiki.theory.org/index.php/BitTorrentSpecification#Tracker_HTTP.2FHTTPS_Protocol
+    // [BEP-15] UDP Tracker Protocol for BitTorrent
+    // [BEP-48] Tracker Protocol Extension: Scrape
     class Tracker final : public QObject, public Http::IRequestHandler, private Http::ResponseBuilder
     {
         Q_OBJECT
@@ -80,30 +89,89 @@ namespace BitTorrent
         struct TorrentStats
         {
             qint64 seeders = 0;
-            QSet<Peer> peers;
+            qint64 completed = 0;
+            qint64 announceTick = 0;
+            QHash<QByteArray, Peer> peers;  // key is Peer::uniqueID()
+
+            // [BEP-23] peer lists are kept encoded and are rebuilt only after the peers are changed
+            mutable QByteArray compactPeers;
+            mutable QByteArray compactPeers6;
+            mutable bool isCompactPeersValid = false;
 
             void setPeer(const Peer &peer);
-            bool removePeer(const Peer &peer);
+            bool removePeer(const QByteArray &peerID);
+            void updateCompactPeers() const;
+        };
+
+        struct PeerRef
+        {
+            InfoHash infoHash;
+            QByteArray peerID;
         };
 
     public:
+        struct Counters
+        {
+            int torrents = 0;
+            int peers = 0;
+            qint64 announces = 0;
+            qint64 scrapes = 0;
+            qint64 udpRequests = 0;
+            qint64 expiredPeers = 0;
+            int announcesPerSecond = 0;  // during the last completed second
+        };
+
         explicit Tracker(QObject *parent = nullptr);
 
         bool start();
 
+        Counters counters() const;
+
     private:
         Http::Response processRequest(const Http::Request &request, const Http::Environment &env) override;
         void processAnnounceRequest();
+        void processScrapeRequest();
 
+        void processAnnounce(const TrackerAnnounceRequest &announceReq);
         void registerPeer(const TrackerAnnounceRequest &announceReq);
         void unregisterPeer(const TrackerAnnounceRequest &announceReq);
         void prepareAnnounceResponse(const TrackerAnnounceRequest &announceReq);
+        const TorrentStats &torrentStats(const InfoHash &infoHash) const;
+
+        void handleUdpReadyRead();
+        QByteArray processUdpRequest(const QByteArray &datagram, const QHostAddress &address, quint16 port);
+        QByteArray processUdpAnnounceRequest(const QByteArray &datagram, const QHostAddress &address, quint32 transactionID);
+        QByteArray processUdpScrapeRequest(const QByteArray &datagram, quint32 transactionID);
+        quint64 udpConnectionID(const QHostAddress &address, quint16 port, qint64 epoch) const;
+
+        void expirePeers();
+        void countAnnounce();
+        void rollAnnounceCounter() const;
 
         Http::Server *m_server;
         Http::Request m_request;
         Http::Environment m_env;
 
+        QUdpSocket *m_udpSocket;
+        QByteArray m_udpBuffer;
+        QByteArray m_udpSecret;
+
         QHash<InfoHash, TorrentStats> m_torrents;
+
+        // Peers are expired using a timing wheel: each slot holds the peers
+        // announced during one tick, it is processed when the wheel has turned around
+        QTimer *m_expirationTimer;
+        QVector<QVector<PeerRef>> m_expirationWheel;
+        qint64 m_currentTick = 0;
+
+        QElapsedTimer m_uptime;
+        qint64 m_announces = 0;
+        qint64 m_scrapes = 0;
+        qint64 m_udpRequests = 0;
+        qint64 m_expiredPeers = 0;
+        mutable qint64 m_counterSecond = 0;
+        mutable int m_currentSecondAnnounces = 0;
+        mutable int m_lastSecondAnnounces = 0;
     };
 }
 
@@ -0,0 +1,213 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#include "transferhistory.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/utils/fs.h"
+#include "cachestatus.h"
+#include "sessionstatus.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    const char SESSION_FILE_NAME[] = "session.dat";
+    const char CATEGORY_FILE_PREFIX[] = "category-";
+    const char FILE_SUFFIX[] = ".dat";
+
+    // every category file takes about 220 KiB
+    const int MAX_CATEGORY_STORES = 64;
+
+    QString categoryFileName(const QString &category)
+    {
+        const QByteArray hash = QCryptographicHash::hash(category.toUtf8(), QCryptographicHash::Sha1).toHex();
+        return QLatin1String(CATEGORY_FILE_PREFIX) + QString::fromLatin1(hash) + QLatin1String(FILE_SUFFIX);
+    }
+}
+
+TransferHistory::TransferHistory(const QString &directory)
+    : m_directory {directory}
+{
+    const QDir dir {m_directory};
+    if (!dir.mkpath(QLatin1String("."))) {
+        LogMsg(QObject::tr("Couldn't create the transfer history directory \"%1\"").arg(Utils::Fs::toNativePath(m_directory)), Log::WARNING);
+        return;
+    }
+
+    m_sessionStore = new Utils::TimeSeriesStore {dir.absoluteFilePath(SESSION_FILE_NAME), sessionFields().size(), archives()};
+    if (!m_sessionStore->isValid())
+        LogMsg(QObject::tr("Couldn't open the transfer history file \"%1\"").arg(Utils::Fs::toNativePath(m_sessionStore->path())), Log::WARNING);
+
+    const QStringList nameFilters {QLatin1String(CATEGORY_FILE_PREFIX) + '*' + QLatin1String(FILE_SUFFIX)};
+    for (const QString &fileName : asConst(dir.entryList(nameFilters, QDir::Files))) {
+        const QString path = dir.absoluteFilePath(fileName);
+        const QString category = Utils::TimeSeriesStore::readLabel(path);
+        // skip the damaged files, they are recreated when the category is recorded again
+        if ((categoryFileName(category) != fileName) || (m_categoryStores.size() >= MAX_CATEGORY_STORES))
+            continue;
+
+        auto *store = new Utils::TimeSeriesStore {path, categoryFields().size(), archives(), category};
+        if (store->isValid())
+            m_categoryStores[category] = store;
+        else
+            delete store;
+    }
+}
+
+TransferHistory::~TransferHistory()
+{
+    delete m_sessionStore;
+    qDeleteAll(m_categoryStores);
+}
+
+QVector<Utils::TimeSeriesStore::Archive> TransferHistory::archives()
+{
+    return {
+        {5, 720},  // last hour
+        {60, 1440},  // last day
+        {900, 2976},  // last 31 days
+        {3600, 8784}  // last year
+    };
+}
+
+int TransferHistory::resolutionFor(const qint64 from, const qint64 now)
+{
+    const QVector<Utils::TimeSeriesStore::Archive> allArchives = archives();
+    for (const Utils::TimeSeriesStore::Archive &archive : allArchives) {
+        if ((now - from) < (static_cast<qint64>(archive.resolution) * archive.capacity))
+            return archive.resolution;
+    }
+    return allArchives.last().resolution;
+}
+
+QStringList TransferHistory::sessionFields()
+{
+    return {
+        QLatin1String("dl_speed"),
+        QLatin1String("up_speed"),
+        QLatin1String("dl_payload_speed"),
+        QLatin1String("up_payload_speed"),
+        QLatin1String("peers"),
+        QLatin1String("queued_io_jobs")
+    };
+}
+
+QStringList TransferHistory::categoryFields()
+{
+    return {
+        QLatin1String("dl_payload_speed"),
+        QLatin1String("up_payload_speed")
+    };
+}
+
+void TransferHistory::record(const qint64 timestamp, const SessionStatus &status, const CacheStatus &cacheStatus
+                             , const QHash<QString, CategoryRates> &categoryRates)
+{
+    if (m_sessionStore) {
+        m_sessionStore->append(timestamp, {
+            static_cast<double>(status.downloadRate),
+            static_cast<double>(status.uploadRate),
+            static_cast<double>(status.payloadDownloadRate),
+            static_cast<double>(status.payloadUploadRate),
+            static_cast<double>(status.peersCount),
+            static_cast<double>(cacheStatus.jobQueueLength)
+        });
+    }
+
+    for (auto i = categoryRates.cbegin(); i != categoryRates.cend(); ++i) {
+        Utils::TimeSeriesStore *store = categoryStore(i.key());
+        if (store) {
+            store->append(timestamp, {
+                static_cast<double>(i.value().downloadRate),
+                static_cast<double>(i.value().uploadRate)
+            });
+        }
+    }
+}
+
+void TransferHistory::removeCategory(const QString &category)
+{
+    Utils::TimeSeriesStore *store = m_categoryStores.take(category);
+    if (!store)
+        return;
+
+    const QString path = store->path();
+    delete store;
+    QFile::remove(path);
+}
+
+QStringList TransferHistory::categories() const
+{
+    return m_categoryStores.keys();
+}
+
+QVector<Utils::TimeSeriesStore::Sample> TransferHistory::sessionSamples(const int resolution, const qint64 from, const qint64 to) const
+{
+    if (!m_sessionStore)
+        return {};
+    return m_sessionStore->samples(resolution, from, to);
+}
+
+QVector<Utils::TimeSeriesStore::Sample> TransferHistory::categorySamples(const QString &category, const int resolution, const qint64 from, const qint64 to) const
+{
+    const Utils::TimeSeriesStore *store = m_categoryStores.value(category);
+    if (!store)
+        return {};
+    return store->samples(resolution, from, to);
+}
+
+Utils::TimeSeriesStore *TransferHistory::categoryStore(const QString &category)
+{
+    Utils::TimeSeriesStore *store = m_categoryStores.value(category);
+    if (store || !m_sessionStore)
+        return store;
+
+    if (m_categoryStores.size() >= MAX_CATEGORY_STORES) {
+        if (!m_isCategoryLimitReported) {
+            m_isCategoryLimitReported = true;
+            LogMsg(QObject::tr("The transfer history is kept for %1 categories at most, the rest of them aren't recorded")
+                .arg(MAX_CATEGORY_STORES), Log::INFO);
+        }
+        return nullptr;
+    }
+
+    store = new Utils::TimeSeriesStore {QDir(m_directory).absoluteFilePath(categoryFileName(category))
+        , categoryFields().size(), archives(), category};
+    if (!store->isValid()) {
+        delete store;
+        return nullptr;
+    }
+
+    m_categoryStores[category] = store;
+    return store;
+}
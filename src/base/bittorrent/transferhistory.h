@@ -0,0 +1,84 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "base/utils/timeseriesstore.h"
+
+namespace BitTorrent
+{
+    struct CacheStatus;
+    struct SessionStatus;
+
+    // Keeps the history of the session transfer rates and of the rates of each category
+    // in the round-robin files of the fixed size. Every file holds several archives
+    // of the different resolutions, from the last hour in 5 second steps up to
+    // the last year in 1 hour steps.
+    class TransferHistory final
+    {
+        Q_DISABLE_COPY(TransferHistory)
+
+    public:
+        struct CategoryRates
+        {
+            quint64 downloadRate = 0;
+            quint64 uploadRate = 0;
+        };
+
+        explicit TransferHistory(const QString &directory);
+        ~TransferHistory();
+
+        static QVector<Utils::TimeSeriesStore::Archive> archives();
+        // The finest resolution still covering the given period
+        static int resolutionFor(qint64 from, qint64 now);
+
+        static QStringList sessionFields();
+        static QStringList categoryFields();
+
+        // The empty category collects the rates of the uncategorized torrents
+        void record(qint64 timestamp, const SessionStatus &status, const CacheStatus &cacheStatus
+                    , const QHash<QString, CategoryRates> &categoryRates);
+        void removeCategory(const QString &category);
+
+        QStringList categories() const;
+        QVector<Utils::TimeSeriesStore::Sample> sessionSamples(int resolution, qint64 from, qint64 to) const;
+        QVector<Utils::TimeSeriesStore::Sample> categorySamples(const QString &category, int resolution, qint64 from, qint64 to) const;
+
+    private:
+        Utils::TimeSeriesStore *categoryStore(const QString &category);
+
+        const QString m_directory;
+        Utils::TimeSeriesStore *m_sessionStore = nullptr;
+        QHash<QString, Utils::TimeSeriesStore *> m_categoryStores;
+        bool m_isCategoryLimitReported = false;
+    };
+}
@@ -30,15 +30,24 @@
 
 #include "connection.h"
 
+#include <algorithm>
+
 #include <QTcpSocket>
 
 #include "base/logger.h"
+#include "base/utils/gzip.h"
+#include "contentstream.h"
 #include "irequesthandler.h"
-#include "requestparser.h"
 #include "responsegenerator.h"
 
 using namespace Http;
 
+namespace
+{
+    // the next content chunk is generated only when the socket has sent most of the previous ones
+    const qint64 MAX_PENDING_OUTPUT = 256 * 1024;
+}
+
 Connection::Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObject *parent)
     : QObject(parent)
     , m_socket(socket)
@@ -47,6 +56,7 @@ Connection::Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObj
     m_socket->setParent(this);
     m_idleTimer.start();
     connect(m_socket, &QTcpSocket::readyRead, this, &Connection::read);
+    connect(m_socket, &QTcpSocket::bytesWritten, this, &Connection::sendContentChunks);
 }
 
 Connection::~Connection()
@@ -57,13 +67,40 @@ Connection::~Connection()
 void Connection::read()
 {
     m_idleTimer.restart();
-    m_receivedData.append(m_socket->readAll());
 
-    while (!m_receivedData.isEmpty()) {
-        const RequestParser::ParseResult result = RequestParser::parse(m_receivedData);
+    // read directly into the buffer to avoid the intermediate copy
+    const qint64 available = m_socket->bytesAvailable();
+    if (available > 0) {
+        const int oldSize = m_receivedData.size();
+        m_receivedData.resize(oldSize + static_cast<int>(available));
+        const qint64 readSize = m_socket->read((m_receivedData.data() + oldSize), available);
+        m_receivedData.resize(oldSize + static_cast<int>(std::max<qint64>(readSize, 0)));
+    }
+
+    processReceivedData();
+}
+
+void Connection::processReceivedData()
+{
+    while (m_readOffset < m_receivedData.size()) {
+        // the requests are answered in order so the next one
+        // has to wait until the current response is sent
+        if (m_contentGenerator || m_contentStream)
+            return;
+
+        // pipelined requests are parsed in place, the buffer is only
+        // compacted when the last of them is incomplete
+        const QByteArray unprocessedData = QByteArray::fromRawData((m_receivedData.constData() + m_readOffset)
+            , (m_receivedData.size() - m_readOffset));
+        const RequestParser::ParseResult result = m_requestParser.parse(unprocessedData);
 
         switch (result.status) {
         case RequestParser::ParseStatus::Incomplete: {
+                if (m_readOffset > 0) {
+                    m_receivedData.remove(0, m_readOffset);
+                    m_readOffset = 0;
+                }
+
                 const long bufferLimit = RequestParser::MAX_CONTENT_SIZE * 1.1;  // some margin for headers
                 if (m_receivedData.size() > bufferLimit) {
                     Logger::instance()->addMessage(tr("Http request size exceeds limiation, closing socket. Limit: %1, IP: %2")
@@ -72,9 +109,15 @@ void Connection::read()
                     Response resp(413, "Payload Too Large");
                     resp.headers[HEADER_CONNECTION] = "close";
 
-                    sendResponse(resp);
+                    sendResponse(resp, {});
                     m_socket->close();
+                    return;
                 }
+
+                // allocate the buffer for the whole request at once
+                const long expectedSize = m_requestParser.expectedFrameSize();
+                if (expectedSize > m_receivedData.capacity())
+                    m_receivedData.reserve(static_cast<int>(expectedSize));
             }
             return;
 
@@ -85,7 +128,7 @@ void Connection::read()
                 Response resp(400, "Bad Request");
                 resp.headers[HEADER_CONNECTION] = "close";
 
-                sendResponse(resp);
+                sendResponse(resp, {});
                 m_socket->close();
             }
             return;
@@ -94,14 +137,17 @@ void Connection::read()
                 const Environment env {m_socket->localAddress(), m_socket->localPort(), m_socket->peerAddress(), m_socket->peerPort()};
 
                 Response resp = m_requestHandler->processRequest(result.request, env);
-
-                if (acceptsGzipEncoding(result.request.headers["accept-encoding"]))
-                    resp.headers[HEADER_CONTENT_ENCODING] = "gzip";
-
                 resp.headers[HEADER_CONNECTION] = "keep-alive";
 
-                sendResponse(resp);
-                m_receivedData = m_receivedData.mid(result.frameSize);
+                sendResponse(resp, result.request);
+
+                // the request data is no longer needed, truncate() keeps the buffer
+                // reserved for the large request above while clear() would free it
+                m_readOffset += result.frameSize;
+                if (m_readOffset >= m_receivedData.size()) {
+                    m_receivedData.truncate(0);
+                    m_readOffset = 0;
+                }
             }
             break;
 
@@ -112,13 +158,161 @@ void Connection::read()
     }
 }
 
-void Connection::sendResponse(const Response &response) const
+void Connection::sendResponse(Response response, const Request &request)
 {
-    m_socket->write(toByteArray(response));
+    const bool acceptsGzip = acceptsGzipEncoding(request.headers.value(QLatin1String("accept-encoding")));
+
+    if (response.contentGenerator && (request.version == QLatin1String("1.0"))) {
+        // HTTP/1.0 doesn't support chunked transfer coding
+        for (QByteArray piece = response.contentGenerator(); !piece.isEmpty(); piece = response.contentGenerator())
+            response.content += piece;
+        response.contentGenerator = nullptr;
+    }
+
+    response.headers[HEADER_DATE] = httpDate();
+
+    if (response.contentStream) {
+        // Pushed data must reach the client immediately so it isn't compressed
+        response.headers.remove(HEADER_CONTENT_LENGTH);
+        response.headers[HEADER_CACHE_CONTROL] = "no-cache";
+        // HTTP/1.0 doesn't support chunked transfer coding,
+        // the end of the content is marked by closing the connection
+        m_isStreamChunked = (request.version != QLatin1String("1.0"));
+        if (m_isStreamChunked)
+            response.headers[HEADER_TRANSFER_ENCODING] = "chunked";
+        else
+            response.headers[HEADER_CONNECTION] = "close";
+
+        m_socket->write(headersToByteArray(response));
+
+        m_contentStream = response.contentStream;
+        connect(m_contentStream.get(), &ContentStream::dataAvailable, this, &Connection::sendStreamData);
+        connect(m_contentStream.get(), &ContentStream::finished, this, &Connection::sendStreamData);
+        sendStreamData();
+        return;
+    }
+
+    if (!response.contentGenerator) {
+        if (acceptsGzip)
+            response.headers[HEADER_CONTENT_ENCODING] = "gzip";
+        compressContent(response);
+        response.headers[HEADER_CONTENT_LENGTH] = QString::number(response.content.length());
+
+        // header and body are sent as separate buffers so the content isn't copied once more
+        m_socket->write(headersToByteArray(response));
+        m_socket->write(response.content);
+        return;
+    }
+
+    // [rfc7230] 4.1. Chunked Transfer Coding
+    response.headers.remove(HEADER_CONTENT_LENGTH);
+    response.headers[HEADER_TRANSFER_ENCODING] = "chunked";
+    if (acceptsGzip) {
+        m_compressor.reset(new Utils::Gzip::StreamCompressor);
+        if (m_compressor->isValid())
+            response.headers[HEADER_CONTENT_ENCODING] = "gzip";
+        else
+            m_compressor.reset();
+    }
+
+    m_socket->write(headersToByteArray(response));
+
+    m_contentGenerator = response.contentGenerator;
+    sendContentChunks();
+}
+
+void Connection::sendContentChunks()
+{
+    if (m_contentStream) {
+        sendStreamData();
+        return;
+    }
+
+    while (m_contentGenerator && (m_socket->bytesToWrite() < MAX_PENDING_OUTPUT)) {
+        m_idleTimer.restart();
+
+        const QByteArray piece = m_contentGenerator();
+        if (!piece.isEmpty()) {
+            sendChunk(m_compressor ? m_compressor->compress(piece) : piece);
+            continue;
+        }
+
+        // the end of the content
+        if (m_compressor) {
+            sendChunk(m_compressor->finish());
+            m_compressor.reset();
+        }
+        m_socket->write(QByteArray("0") + CRLF + CRLF);
+        m_contentGenerator = nullptr;
+
+        // continue with the requests that have arrived in the meantime
+        if (m_readOffset < m_receivedData.size())
+            QMetaObject::invokeMethod(this, "processReceivedData", Qt::QueuedConnection);
+    }
+}
+
+void Connection::sendChunk(const QByteArray &data)
+{
+    // an empty chunk would mark the end of the content
+    if (data.isEmpty())
+        return;
+
+    m_socket->write(QByteArray::number(data.size(), 16) + CRLF);
+    m_socket->write(data);
+    m_socket->write(CRLF);
+}
+
+void Connection::sendStreamData()
+{
+    if (!m_contentStream)
+        return;
+
+    if (m_contentStream->isAborted()) {
+        finishStream();
+        return;
+    }
+
+    // the stream keeps accumulating the data while the client is busy
+    if (m_socket->bytesToWrite() >= MAX_PENDING_OUTPUT)
+        return;
+
+    m_idleTimer.restart();
+
+    const QByteArray data = m_contentStream->takePendingData();
+    if (m_isStreamChunked)
+        sendChunk(data);
+    else if (!data.isEmpty())
+        m_socket->write(data);
+    if (!data.isEmpty())
+        emit m_contentStream->dataSent();
+
+    if (m_contentStream->isFinished())
+        finishStream();
+}
+
+void Connection::finishStream()
+{
+    m_contentStream->disconnect(this);
+    m_contentStream.reset();
+
+    if (!m_isStreamChunked) {
+        m_socket->disconnectFromHost();
+        return;
+    }
+
+    m_socket->write(QByteArray("0") + CRLF + CRLF);
+
+    // continue with the requests that have arrived in the meantime
+    if (m_readOffset < m_receivedData.size())
+        QMetaObject::invokeMethod(this, "processReceivedData", Qt::QueuedConnection);
 }
 
 bool Connection::hasExpired(const qint64 timeout) const
 {
+    // the stream is responsible for keeping the connection busy
+    if (m_contentStream)
+        return false;
+
     return m_idleTimer.hasExpired(timeout);
 }
 
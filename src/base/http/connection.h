@@ -31,13 +31,27 @@
 #ifndef HTTP_CONNECTION_H
 #define HTTP_CONNECTION_H
 
+#include <functional>
+#include <memory>
+
 #include <QElapsedTimer>
 #include <QObject>
 
+#include "requestparser.h"
+
 class QTcpSocket;
 
+namespace Utils
+{
+    namespace Gzip
+    {
+        class StreamCompressor;
+    }
+}
+
 namespace Http
 {
+    class ContentStream;
     class IRequestHandler;
     struct Response;
 
@@ -55,15 +69,31 @@ namespace Http
 
     private slots:
         void read();
+        void processReceivedData();
+        void sendContentChunks();
+        void sendStreamData();
 
     private:
         static bool acceptsGzipEncoding(QString codings);
-        void sendResponse(const Response &response) const;
+        void sendResponse(Response response, const Request &request);
+        void sendChunk(const QByteArray &data);
+        void finishStream();
 
         QTcpSocket *m_socket;
         IRequestHandler *m_requestHandler;
+        RequestParser m_requestParser;
         QByteArray m_receivedData;
+        // the data before this offset is already processed
+        int m_readOffset = 0;
         QElapsedTimer m_idleTimer;
+
+        // state of the response which content is being streamed
+        std::function<QByteArray ()> m_contentGenerator;
+        std::unique_ptr<Utils::Gzip::StreamCompressor> m_compressor;
+
+        // state of the response which content is pushed by the stream
+        std::shared_ptr<ContentStream> m_contentStream;
+        bool m_isStreamChunked = false;
     };
 }
 
@@ -0,0 +1,82 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QObject>
+
+namespace Http
+{
+    // Content which is produced over time and sent as soon as it is available
+    // (e.g. Server-Sent Events). The connection takes the pending data only when
+    // the client is able to receive it, so a producer can merge the updates
+    // accumulated meanwhile instead of queuing them.
+    class ContentStream : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(ContentStream)
+
+    public:
+        using QObject::QObject;
+
+        // Returns all the data accumulated since the last call
+        virtual QByteArray takePendingData() = 0;
+        virtual bool isFinished() const = 0;
+
+        // Ends the content regardless of the producer, e.g. when the client
+        // isn't authorized to receive it anymore. The pending data is dropped.
+        void abort()
+        {
+            if (m_isAborted)
+                return;
+
+            m_isAborted = true;
+            emit finished();
+        }
+
+        bool isAborted() const
+        {
+            return m_isAborted;
+        }
+
+    signals:
+        void dataAvailable();
+        // Emitted by the connection when the data is pushed to the client
+        void dataSent();
+        void finished();
+
+    private:
+        bool m_isAborted = false;
+    };
+}
+
+Q_DECLARE_METATYPE(std::shared_ptr<Http::ContentStream>)
@@ -74,37 +74,56 @@ namespace
     }
 }
 
-RequestParser::RequestParser()
+RequestParser::ParseResult RequestParser::parse(const QByteArray &data)
 {
+    // Warning! Header names are converted to lowercase
+    const ParseResult result = doParse(data);
+    if (result.status != ParseStatus::Incomplete)
+        reset();
+    return result;
 }
 
-RequestParser::ParseResult RequestParser::parse(const QByteArray &data)
+long RequestParser::expectedFrameSize() const
 {
-    // Warning! Header names are converted to lowercase
-    return RequestParser().doParse(data);
+    return ((m_headerLength > 0) ? (m_headerLength + m_contentLength) : 0);
+}
+
+void RequestParser::reset()
+{
+    m_request = {};
+    m_headerSearchPos = 0;
+    m_headerLength = 0;
+    m_contentLength = 0;
 }
 
 RequestParser::ParseResult RequestParser::doParse(const QByteArray &data)
 {
-    // we don't handle malformed requests which use double `LF` as delimiter
-    const int headerEnd = data.indexOf(EOH);
-    if (headerEnd < 0) {
-        qDebug() << Q_FUNC_INFO << "incomplete request";
-        return {ParseStatus::Incomplete, Request(), 0};
-    }
+    if (m_headerLength == 0) {
+        // we don't handle malformed requests which use double `LF` as delimiter
+        const int headerEnd = data.indexOf(EOH, m_headerSearchPos);
+        if (headerEnd < 0) {
+            // continue from here when more data arrives (the delimiter can be split between the reads)
+            m_headerSearchPos = std::max(0, (data.size() - EOH.size() + 1));
+            qDebug() << Q_FUNC_INFO << "incomplete request";
+            return {ParseStatus::Incomplete, Request(), 0};
+        }
 
-    const QString httpHeaders = QString::fromLatin1(data.constData(), headerEnd);
-    if (!parseStartLines(httpHeaders)) {
-        qWarning() << Q_FUNC_INFO << "header parsing error";
-        return {ParseStatus::BadRequest, Request(), 0};
-    }
+        const QString httpHeaders = QString::fromLatin1(data.constData(), headerEnd);
+        if (!parseStartLines(httpHeaders)) {
+            qWarning() << Q_FUNC_INFO << "header parsing error";
+            return {ParseStatus::BadRequest, Request(), 0};
+        }
+
+        m_headerLength = headerEnd + EOH.length();
 
-    const int headerLength = headerEnd + EOH.length();
+        // handle supported methods
+        if ((m_request.method == HEADER_REQUEST_METHOD_GET) || (m_request.method == HEADER_REQUEST_METHOD_HEAD))
+            return {ParseStatus::OK, m_request, m_headerLength};
+        if (m_request.method != HEADER_REQUEST_METHOD_POST) {
+            qWarning() << Q_FUNC_INFO << "unsupported request method: " << m_request.method;
+            return {ParseStatus::BadRequest, Request(), 0};  // TODO: SHOULD respond "501 Not Implemented"
+        }
 
-    // handle supported methods
-    if ((m_request.method == HEADER_REQUEST_METHOD_GET) || (m_request.method == HEADER_REQUEST_METHOD_HEAD))
-        return {ParseStatus::OK, m_request, headerLength};
-    if (m_request.method == HEADER_REQUEST_METHOD_POST) {
         bool ok = false;
         const int contentLength = m_request.headers[HEADER_CONTENT_LENGTH].toInt(&ok);
         if (!ok || (contentLength < 0)) {
@@ -116,24 +135,24 @@ RequestParser::ParseResult RequestParser::doParse(const QByteArray &data)
             return {ParseStatus::BadRequest, Request(), 0};
         }
 
-        if (contentLength > 0) {
-            const QByteArray httpBodyView = midView(data, headerLength, contentLength);
-            if (httpBodyView.length() < contentLength) {
-                qDebug() << Q_FUNC_INFO << "incomplete request";
-                return {ParseStatus::Incomplete, Request(), 0};
-            }
+        m_contentLength = contentLength;
+    }
 
-            if (!parsePostMessage(httpBodyView)) {
-                qWarning() << Q_FUNC_INFO << "message body parsing error";
-                return {ParseStatus::BadRequest, Request(), 0};
-            }
-        }
+    // the header is already parsed so just wait for the rest of the message body
+    if (data.size() < (m_headerLength + m_contentLength)) {
+        qDebug() << Q_FUNC_INFO << "incomplete request";
+        return {ParseStatus::Incomplete, Request(), 0};
+    }
 
-        return {ParseStatus::OK, m_request, (headerLength + contentLength)};
+    if (m_contentLength > 0) {
+        const QByteArray httpBodyView = midView(data, m_headerLength, m_contentLength);
+        if (!parsePostMessage(httpBodyView)) {
+            qWarning() << Q_FUNC_INFO << "message body parsing error";
+            return {ParseStatus::BadRequest, Request(), 0};
+        }
     }
 
-    qWarning() << Q_FUNC_INFO << "unsupported request method: " << m_request.method;
-    return {ParseStatus::BadRequest, Request(), 0};  // TODO: SHOULD respond "501 Not Implemented"
+    return {ParseStatus::OK, m_request, (m_headerLength + m_contentLength)};
 }
 
 bool RequestParser::parseStartLines(const QString &data)
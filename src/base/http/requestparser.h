@@ -53,13 +53,17 @@ namespace Http
             long frameSize;  // http request frame size (bytes)
         };
 
-        static ParseResult parse(const QByteArray &data);
+        // The parser keeps its state between the calls while the request is incomplete,
+        // so the data that has been already processed isn't scanned again.
+        // `data` is expected to be the same buffer extended with the newly received bytes.
+        ParseResult parse(const QByteArray &data);
+        // Size of the request being parsed, 0 if it isn't known yet
+        long expectedFrameSize() const;
+        void reset();
 
         static const long MAX_CONTENT_SIZE = 64 * 1024 * 1024;  // 64 MB
 
     private:
-        RequestParser();
-
         ParseResult doParse(const QByteArray &data);
         bool parseStartLines(const QString &data);
         bool parseRequestLine(const QString &line);
@@ -68,6 +72,9 @@ namespace Http
         bool parseFormData(const QByteArray &data);
 
         Request m_request;
+        int m_headerSearchPos = 0;
+        int m_headerLength = 0;  // 0 until the header is parsed
+        int m_contentLength = 0;
     };
 }
 
@@ -50,6 +50,24 @@ void ResponseBuilder::print(const QByteArray &data, const QString &type)
     print_impl(data, type);
 }
 
+void ResponseBuilder::printStream(const std::function<QByteArray ()> &generator, const QString &type)
+{
+    if (!m_response.headers.contains(HEADER_CONTENT_TYPE))
+        m_response.headers[HEADER_CONTENT_TYPE] = type;
+
+    m_response.content.clear();
+    m_response.contentGenerator = generator;
+}
+
+void ResponseBuilder::printStream(const std::shared_ptr<ContentStream> &stream, const QString &type)
+{
+    if (!m_response.headers.contains(HEADER_CONTENT_TYPE))
+        m_response.headers[HEADER_CONTENT_TYPE] = type;
+
+    m_response.content.clear();
+    m_response.contentStream = stream;
+}
+
 void ResponseBuilder::clear()
 {
     m_response = Response();
@@ -40,6 +40,10 @@ namespace Http
         void setHeader(const Header &header);
         void print(const QString &text, const QString &type = CONTENT_TYPE_HTML);
         void print(const QByteArray &data, const QString &type = CONTENT_TYPE_HTML);
+        // The content is produced piece by piece while it is being sent (see Response::contentGenerator)
+        void printStream(const std::function<QByteArray ()> &generator, const QString &type = CONTENT_TYPE_HTML);
+        // The content is pushed by the stream (see Response::contentStream)
+        void printStream(const std::shared_ptr<ContentStream> &stream, const QString &type);
         void clear();
 
         Response response() const;
@@ -39,6 +39,8 @@ namespace Http
     struct Response;
 
     QByteArray toByteArray(Response response);
+    // Status line and header fields (including the ending empty line)
+    QByteArray headersToByteArray(const Response &response);
     QString httpDate();
     void compressContent(Response &response);
 }
@@ -30,12 +30,17 @@
 #ifndef HTTP_TYPES_H
 #define HTTP_TYPES_H
 
+#include <functional>
+#include <memory>
+
 #include <QHostAddress>
 #include <QString>
 #include <QVector>
 
 namespace Http
 {
+    class ContentStream;
+
     const char METHOD_GET[] = "GET";
     const char METHOD_POST[] = "POST";
 
@@ -52,9 +57,11 @@ namespace Http
     const char HEADER_REFERER[] = "referer";
     const char HEADER_REFERRER_POLICY[] = "referrer-policy";
     const char HEADER_SET_COOKIE[] = "set-cookie";
+    const char HEADER_TRANSFER_ENCODING[] = "transfer-encoding";
     const char HEADER_X_CONTENT_TYPE_OPTIONS[] = "x-content-type-options";
     const char HEADER_X_FORWARDED_HOST[] = "x-forwarded-host";
     const char HEADER_X_FRAME_OPTIONS[] = "x-frame-options";
+    const char HEADER_X_RESULT_PENDING[] = "x-result-pending";
     const char HEADER_X_XSS_PROTECTION[] = "x-xss-protection";
 
     const char HEADER_REQUEST_METHOD_GET[] = "GET";
@@ -64,8 +71,10 @@ namespace Http
     const char CONTENT_TYPE_HTML[] = "text/html";
     const char CONTENT_TYPE_CSS[] = "text/css";
     const char CONTENT_TYPE_TXT[] = "text/plain";
+    const char CONTENT_TYPE_EVENT_STREAM[] = "text/event-stream";
     const char CONTENT_TYPE_JS[] = "application/javascript";
     const char CONTENT_TYPE_JSON[] = "application/json";
+    const char CONTENT_TYPE_OPENMETRICS[] = "application/openmetrics-text; version=1.0.0; charset=utf-8";
     const char CONTENT_TYPE_GIF[] = "image/gif";
     const char CONTENT_TYPE_PNG[] = "image/png";
     const char CONTENT_TYPE_FORM_ENCODED[] = "application/x-www-form-urlencoded";
@@ -120,6 +129,12 @@ namespace Http
         ResponseStatus status;
         HeaderMap headers;
         QByteArray content;
+        // If it is set the content is produced piece by piece (an empty piece marks the end)
+        // and it is sent using chunked transfer coding, `content` is ignored
+        std::function<QByteArray ()> contentGenerator;
+        // If it is set the content is sent as it is pushed by the stream until the stream
+        // is finished or the connection is closed, `content` is ignored
+        std::shared_ptr<ContentStream> contentStream;
 
         Response(uint code = 200, const QString &text = "OK")
             : status {code, text}
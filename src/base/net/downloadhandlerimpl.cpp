@@ -118,6 +118,16 @@ void DownloadHandlerImpl::processFinishedDownload()
         return;
     }
 
+    m_result.eTag = QString::fromLatin1(m_reply->rawHeader("ETag"));
+    m_result.lastModified = QString::fromLatin1(m_reply->rawHeader("Last-Modified"));
+
+    // The server confirmed that the content matching the request validators didn't change
+    if (m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+        m_result.status = Net::DownloadStatus::NotModified;
+        finish();
+        return;
+    }
+
     // Success
     m_result.data = (m_reply->rawHeader("Content-Encoding") == "gzip")
                     ? Utils::Gzip::decompress(m_reply->readAll())
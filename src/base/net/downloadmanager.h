@@ -58,6 +58,7 @@ namespace Net
     {
         Success,
         RedirectedToMagnet,
+        NotModified,
         Failed
     };
 
@@ -79,11 +80,21 @@ namespace Net
         bool saveToFile() const;
         DownloadRequest &saveToFile(bool value);
 
+        // Validators of a previously downloaded version for a conditional request.
+        // The result status is NotModified if the server reports it didn't change.
+        QString eTag() const;
+        DownloadRequest &eTag(const QString &value);
+
+        QString lastModified() const;
+        DownloadRequest &lastModified(const QString &value);
+
     private:
         QString m_url;
         QString m_userAgent;
         qint64 m_limit = 0;
         bool m_saveToFile = false;
+        QString m_eTag;
+        QString m_lastModified;
     };
 
     struct DownloadResult
@@ -94,6 +105,8 @@ namespace Net
         QByteArray data;
         QString filePath;
         QString magnet;
+        QString eTag;
+        QString lastModified;
     };
 
     class DownloadHandler : public QObject
@@ -72,72 +72,91 @@ struct DataFieldDescriptor
     };
 };
 
-GeoIPDatabase::GeoIPDatabase(const quint32 size)
+GeoIPDatabase::GeoIPDatabase()
     : m_ipVersion(0)
     , m_recordSize(0)
     , m_nodeCount(0)
     , m_nodeSize(0)
     , m_indexSize(0)
     , m_recordBytes(0)
-    , m_size(size)
-    , m_data(new uchar[size])
+    , m_size(0)
+    , m_data(nullptr)
+    , m_file(nullptr)
 {
 }
 
 GeoIPDatabase *GeoIPDatabase::load(const QString &filename, QString &error)
 {
-    GeoIPDatabase *db = nullptr;
-    QFile file(filename);
-    if (file.size() > MAX_FILE_SIZE) {
+    auto *file = new QFile(filename);
+    if (file->size() > MAX_FILE_SIZE) {
         error = tr("Unsupported database file size.");
+        delete file;
         return nullptr;
     }
 
-    if (!file.open(QFile::ReadOnly)) {
-        error = file.errorString();
+    if (!file->open(QFile::ReadOnly)) {
+        error = file->errorString();
+        delete file;
         return nullptr;
     }
 
-    db = new GeoIPDatabase(file.size());
-
-    if (file.read(reinterpret_cast<char *>(db->m_data), db->m_size) != db->m_size) {
-        error = file.errorString();
-        delete db;
-        return nullptr;
+    auto *db = new GeoIPDatabase;
+    db->m_size = file->size();
+    // The mapping stays valid as long as the file is kept open
+    db->m_data = file->map(0, db->m_size);
+    if (db->m_data) {
+        db->m_file = file;
     }
+    else {
+        // Some file systems don't support mapping, fall back to reading the whole file
+        db->m_buffer = file->readAll();
+        const bool ok = (db->m_buffer.size() == static_cast<int>(db->m_size));
+        if (!ok)
+            error = file->errorString();
+        delete file;
+
+        if (!ok) {
+            delete db;
+            return nullptr;
+        }
 
-
-    if (!db->parseMetadata(db->readMetadata(), error) || !db->loadDB(error)) {
-        delete db;
-        return nullptr;
+        db->m_data = reinterpret_cast<const uchar *>(db->m_buffer.constData());
     }
 
-    return db;
+    return init(db, error);
 }
 
 GeoIPDatabase *GeoIPDatabase::load(const QByteArray &data, QString &error)
 {
-    GeoIPDatabase *db = nullptr;
     if (data.size() > MAX_FILE_SIZE) {
         error = tr("Unsupported database file size.");
         return nullptr;
     }
 
-    db = new GeoIPDatabase(data.size());
+    auto *db = new GeoIPDatabase;
+    // Share the data instead of copying it
+    db->m_buffer = data;
+    db->m_size = data.size();
+    db->m_data = reinterpret_cast<const uchar *>(db->m_buffer.constData());
 
-    memcpy(reinterpret_cast<char *>(db->m_data), data.constData(), db->m_size);
+    return init(db, error);
+}
 
+GeoIPDatabase *GeoIPDatabase::init(GeoIPDatabase *db, QString &error)
+{
     if (!db->parseMetadata(db->readMetadata(), error) || !db->loadDB(error)) {
         delete db;
         return nullptr;
     }
 
+    db->loadCountries();
     return db;
 }
 
 GeoIPDatabase::~GeoIPDatabase()
 {
-    delete [] m_data;
+    // closing the file unmaps its data
+    delete m_file;
 }
 
 QString GeoIPDatabase::type() const
@@ -164,31 +183,15 @@ QString GeoIPDatabase::lookup(const QHostAddress &hostAddr) const
     for (int i = 0; i < 16; ++i) {
         for (int j = 0; j < 8; ++j) {
             const bool right = static_cast<bool>((addr[i] >> (7 - j)) & 1);
-            // Interpret the left/right record as number
+            // Select the left or right record
             if (right)
                 ptr += m_recordBytes;
 
-            quint32 id = 0;
-            auto *idPtr = reinterpret_cast<uchar *>(&id);
-            memcpy(&idPtr[4 - m_recordBytes], ptr, m_recordBytes);
-            fromBigEndian(idPtr, 4);
-
-            if (id == m_nodeCount) {
+            const quint32 id = readRecord(ptr);
+            if (id == m_nodeCount)
                 return {};
-            }
-            if (id > m_nodeCount) {
-                QString country = m_countries.value(id);
-                if (country.isEmpty()) {
-                    const quint32 offset = id - m_nodeCount - sizeof(DATA_SECTION_SEPARATOR);
-                    quint32 tmp = offset + m_indexSize + sizeof(DATA_SECTION_SEPARATOR);
-                    const QVariant val = readDataField(tmp);
-                    if (val.userType() == QMetaType::QVariantHash) {
-                        country = val.toHash()["country"].toHash()["iso_code"].toString();
-                        m_countries[id] = country;
-                    }
-                }
-                return country;
-            }
+            if (id > m_nodeCount)
+                return m_countries.value(id);
 
             ptr = m_data + (id * m_nodeSize);
         }
@@ -278,6 +281,39 @@ bool GeoIPDatabase::loadDB(QString &error) const
     return true;
 }
 
+void GeoIPDatabase::loadCountries()
+{
+    // Decode all data records referenced by the search tree once, so that
+    // lookups only walk the tree and never need to modify the database.
+    // Country databases reference just a few hundred distinct records.
+    for (quint32 node = 0; node < m_nodeCount; ++node) {
+        const uchar *ptr = m_data + (node * m_nodeSize);
+        for (int i = 0; i < 2; ++i, ptr += m_recordBytes) {
+            const quint32 id = readRecord(ptr);
+            if ((id <= m_nodeCount) || m_countries.contains(id))
+                continue;
+
+            QString country;
+            quint32 offset = id - m_nodeCount + m_indexSize;
+            if (offset < m_size) {
+                const QVariant val = readDataField(offset);
+                if (val.userType() == QMetaType::QVariantHash)
+                    country = val.toHash()["country"].toHash()["iso_code"].toString();
+            }
+            m_countries.insert(id, country);
+        }
+    }
+}
+
+quint32 GeoIPDatabase::readRecord(const uchar *ptr) const
+{
+    // Interpret the left/right record as number
+    quint32 id = 0;
+    for (int i = 0; i < m_recordBytes; ++i)
+        id = (id << 8) | ptr[i];
+    return id;
+}
+
 QVariantHash GeoIPDatabase::readMetadata() const
 {
     const char *ptr = reinterpret_cast<const char *>(m_data);
@@ -29,11 +29,13 @@
 #ifndef GEOIPDATABASE_H
 #define GEOIPDATABASE_H
 
+#include <QByteArray>
 #include <QCoreApplication>
+#include <QHash>
 #include <QtGlobal>
 
-class QByteArray;
 class QDateTime;
+class QFile;
 class QHostAddress;
 class QString;
 
@@ -52,15 +54,21 @@ public:
     QString type() const;
     quint16 ipVersion() const;
     QDateTime buildEpoch() const;
+    // Reentrant, it doesn't modify the database so it can be called from any thread
     QString lookup(const QHostAddress &hostAddr) const;
 
 private:
-    explicit GeoIPDatabase(quint32 size);
+    GeoIPDatabase();
+
+    static GeoIPDatabase *init(GeoIPDatabase *db, QString &error);
 
     bool parseMetadata(const QVariantHash &metadata, QString &error);
     bool loadDB(QString &error) const;
+    void loadCountries();
     QVariantHash readMetadata() const;
 
+    quint32 readRecord(const uchar *ptr) const;
+
     QVariant readDataField(quint32 &offset) const;
     bool readDataFieldDescriptor(quint32 &offset, DataFieldDescriptor &out) const;
     void fromBigEndian(uchar *buf, quint32 len) const;
@@ -95,9 +103,12 @@ private:
     QDateTime m_buildEpoch;
     QString m_dbType;
     // Search data
-    mutable QHash<quint32, QString> m_countries;
+    QHash<quint32, QString> m_countries;
     quint32 m_size;
-    uchar *m_data;
+    const uchar *m_data;
+    // Storage, either a mapped file or an in-memory buffer
+    QFile *m_file;
+    QByteArray m_buffer;
 };
 
 #endif // GEOIPDATABASE_H
@@ -46,6 +46,23 @@ static const QString DATABASE_URL = QStringLiteral("https://download.db-ip.com/f
 static const char GEODB_FOLDER[] = "GeoDB";
 static const char GEODB_FILENAME[] = "dbip-country-lite.mmdb";
 
+namespace
+{
+    const quint64 COUNTRY_CODE_MASK = 0xFFFF;
+
+    quint64 addressHash(const QHostAddress &hostAddr)
+    {
+        // FNV-1a
+        const Q_IPV6ADDR addr = hostAddr.toIPv6Address();
+        quint64 hash = 14695981039346656037ULL;
+        for (const quint8 byte : addr.c) {
+            hash ^= byte;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
 using namespace Net;
 
 // GeoIPManager
@@ -54,16 +71,15 @@ GeoIPManager *GeoIPManager::m_instance = nullptr;
 
 GeoIPManager::GeoIPManager()
     : m_enabled(false)
-    , m_geoIPDatabase(nullptr)
 {
+    for (std::atomic<quint64> &entry : m_countryCache)
+        entry.store(0, std::memory_order_relaxed);
+
     configure();
     connect(Preferences::instance(), &Preferences::changed, this, &GeoIPManager::configure);
 }
 
-GeoIPManager::~GeoIPManager()
-{
-    delete m_geoIPDatabase;
-}
+GeoIPManager::~GeoIPManager() = default;
 
 void GeoIPManager::initInstance()
 {
@@ -84,18 +100,19 @@ GeoIPManager *GeoIPManager::instance()
 
 void GeoIPManager::loadDatabase()
 {
-    delete m_geoIPDatabase;
-    m_geoIPDatabase = nullptr;
+    setDatabase(nullptr);
 
     const QString filepath = Utils::Fs::expandPathAbs(
         QString::fromLatin1("%1%2/%3").arg(specialFolderLocation(SpecialFolder::Data), GEODB_FOLDER, GEODB_FILENAME));
 
     QString error;
-    m_geoIPDatabase = GeoIPDatabase::load(filepath, error);
-    if (m_geoIPDatabase)
+    const std::shared_ptr<const GeoIPDatabase> geoIPDatabase {GeoIPDatabase::load(filepath, error)};
+    if (geoIPDatabase) {
+        setDatabase(geoIPDatabase);
         Logger::instance()->addMessage(tr("IP geolocation database loaded. Type: %1. Build time: %2.")
-            .arg(m_geoIPDatabase->type(), m_geoIPDatabase->buildEpoch().toString()),
+            .arg(geoIPDatabase->type(), geoIPDatabase->buildEpoch().toString()),
             Log::INFO);
+    }
     else
         Logger::instance()->addMessage(tr("Couldn't load IP geolocation database. Reason: %1").arg(error), Log::WARNING);
 
@@ -129,12 +146,70 @@ void GeoIPManager::downloadDatabaseFile()
     DownloadManager::instance()->download({curUrl}, this, &GeoIPManager::downloadFinished);
 }
 
+void GeoIPManager::setDatabase(const std::shared_ptr<const GeoIPDatabase> &db)
+{
+    std::atomic_store(&m_geoIPDatabase, db);
+
+    for (std::atomic<quint64> &entry : m_countryCache)
+        entry.store(0, std::memory_order_relaxed);
+}
+
 QString GeoIPManager::lookup(const QHostAddress &hostAddr) const
 {
-    if (m_enabled && m_geoIPDatabase)
-        return m_geoIPDatabase->lookup(hostAddr);
+    if (!m_enabled)
+        return {};
+
+    const std::shared_ptr<const GeoIPDatabase> db = std::atomic_load(&m_geoIPDatabase);
+    if (!db)
+        return {};
+
+    return lookup(*db, hostAddr);
+}
+
+QVector<QString> GeoIPManager::lookup(const QVector<QHostAddress> &hostAddrs) const
+{
+    if (!m_enabled)
+        return {};
+
+    // Hold the same database for the whole batch
+    const std::shared_ptr<const GeoIPDatabase> db = std::atomic_load(&m_geoIPDatabase);
+    if (!db)
+        return {};
+
+    QVector<QString> countries;
+    countries.reserve(hostAddrs.size());
+    for (const QHostAddress &hostAddr : hostAddrs)
+        countries.append(lookup(*db, hostAddr));
+    return countries;
+}
+
+QString GeoIPManager::lookup(const GeoIPDatabase &db, const QHostAddress &hostAddr) const
+{
+    const quint64 hash = addressHash(hostAddr);
+    std::atomic<quint64> &slot = m_countryCache[hash % m_countryCache.size()];
+    // The tag uses the hash bits not consumed by the slot index
+    // and is never zero so it can't match an empty slot
+    const quint64 tag = (hash & ~COUNTRY_CODE_MASK) | (COUNTRY_CODE_MASK + 1);
+
+    const quint64 entry = slot.load(std::memory_order_relaxed);
+    if ((entry & ~COUNTRY_CODE_MASK) == tag) {
+        const quint64 code = (entry & COUNTRY_CODE_MASK);
+        if (code == 0)
+            return {};
+
+        const char isoCode[] = {static_cast<char>(code >> 8), static_cast<char>(code & 0xFF)};
+        return QString::fromLatin1(isoCode, 2);
+    }
 
-    return {};
+    const QString country = db.lookup(hostAddr);
+    if (country.isEmpty()) {
+        slot.store(tag, std::memory_order_relaxed);
+    }
+    else if ((country.size() == 2) && (country[0].unicode() < 0x80) && (country[1].unicode() < 0x80)) {
+        slot.store((tag | (country[0].unicode() << 8) | country[1].unicode()), std::memory_order_relaxed);
+    }
+
+    return country;
 }
 
 QString GeoIPManager::CountryName(const QString &countryISOCode)
@@ -409,8 +484,7 @@ void GeoIPManager::configure()
             loadDatabase();
         }
         else if (!m_enabled) {
-            delete m_geoIPDatabase;
-            m_geoIPDatabase = nullptr;
+            setDatabase(nullptr);
         }
     }
 }
@@ -430,13 +504,13 @@ void GeoIPManager::downloadFinished(const DownloadResult &result)
     }
 
     QString error;
-    GeoIPDatabase *geoIPDatabase = GeoIPDatabase::load(data, error);
+    const std::shared_ptr<const GeoIPDatabase> geoIPDatabase {GeoIPDatabase::load(data, error)};
     if (geoIPDatabase) {
         if (!m_geoIPDatabase || (geoIPDatabase->buildEpoch() > m_geoIPDatabase->buildEpoch())) {
-            delete m_geoIPDatabase;
-            m_geoIPDatabase = geoIPDatabase;
+            if (m_enabled)
+                setDatabase(geoIPDatabase);
             LogMsg(tr("IP geolocation database loaded. Type: %1. Build time: %2.")
-                .arg(m_geoIPDatabase->type(), m_geoIPDatabase->buildEpoch().toString()),
+                .arg(geoIPDatabase->type(), geoIPDatabase->buildEpoch().toString()),
                 Log::INFO);
             const QString targetPath = Utils::Fs::expandPathAbs(
                         specialFolderLocation(SpecialFolder::Data) + GEODB_FOLDER);
@@ -448,9 +522,6 @@ void GeoIPManager::downloadFinished(const DownloadResult &result)
             else
                 LogMsg(tr("Successfully updated IP geolocation database."), Log::INFO);
         }
-        else {
-            delete geoIPDatabase;
-        }
     }
     else {
         LogMsg(tr("Couldn't load IP geolocation database. Reason: %1").arg(error), Log::WARNING);
@@ -30,7 +30,12 @@
 #ifndef NET_GEOIPMANAGER_H
 #define NET_GEOIPMANAGER_H
 
+#include <array>
+#include <atomic>
+#include <memory>
+
 #include <QObject>
+#include <QVector>
 
 class QHostAddress;
 class QString;
@@ -51,7 +56,10 @@ namespace Net
         static void freeInstance();
         static GeoIPManager *instance();
 
+        // Lookups are thread-safe and lock-free
         QString lookup(const QHostAddress &hostAddr) const;
+        // Returns an empty vector if the geolocation is disabled
+        QVector<QString> lookup(const QVector<QHostAddress> &hostAddrs) const;
 
         static QString CountryName(const QString &countryISOCode);
 
@@ -66,9 +74,16 @@ namespace Net
         void loadDatabase();
         void manageDatabaseUpdate();
         void downloadDatabaseFile();
+        void setDatabase(const std::shared_ptr<const GeoIPDatabase> &db);
+        QString lookup(const GeoIPDatabase &db, const QHostAddress &hostAddr) const;
 
-        bool m_enabled;
-        GeoIPDatabase *m_geoIPDatabase;
+        std::atomic_bool m_enabled;
+        // Replaced with std::atomic_store() on the main thread, lookups from
+        // other threads must take their reference with std::atomic_load()
+        std::shared_ptr<const GeoIPDatabase> m_geoIPDatabase;
+        // Direct-mapped cache of recent lookups, each slot packs
+        // an address tag with the two-letter country code
+        mutable std::array<std::atomic<quint64>, 4096> m_countryCache;
 
         static GeoIPManager *m_instance;
     };
@@ -28,8 +28,11 @@
 
 #include "rss_autodownloader.h"
 
+#include <algorithm>
+
 #include <QDataStream>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
@@ -203,6 +206,9 @@ bool AutoDownloader::renameRule(const QString &ruleName, const QString &newRuleN
     AutoDownloadRule rule = m_rules.take(ruleName);
     rule.setName(newRuleName);
     m_rules.insert(newRuleName, rule);
+    m_isRuleIndexDirty = true;
+    if (m_matchingStatistics.rules.contains(ruleName))
+        m_matchingStatistics.rules.insert(newRuleName, m_matchingStatistics.rules.take(ruleName));
     m_dirty = true;
     store();
     emit ruleRenamed(newRuleName, ruleName);
@@ -214,11 +220,18 @@ void AutoDownloader::removeRule(const QString &ruleName)
     if (m_rules.contains(ruleName)) {
         emit ruleAboutToBeRemoved(ruleName);
         m_rules.remove(ruleName);
+        m_isRuleIndexDirty = true;
+        m_matchingStatistics.rules.remove(ruleName);
         m_dirty = true;
         store();
     }
 }
 
+MatchingStatistics AutoDownloader::matchingStatistics() const
+{
+    return m_matchingStatistics;
+}
+
 QByteArray AutoDownloader::exportRules(AutoDownloader::RulesFileFormat format) const
 {
     switch (format) {
@@ -358,6 +371,7 @@ void AutoDownloader::handleNewArticle(const Article *article)
 void AutoDownloader::setRule_impl(const AutoDownloadRule &rule)
 {
     m_rules.insert(rule.name(), rule);
+    m_isRuleIndexDirty = true;
 }
 
 void AutoDownloader::addJobForArticle(const Article *article)
@@ -375,37 +389,79 @@ void AutoDownloader::addJobForArticle(const Article *article)
 
 void AutoDownloader::processJob(const QSharedPointer<ProcessingJob> &job)
 {
-    for (AutoDownloadRule &rule : m_rules) {
-        if (!rule.isEnabled()) continue;
-        if (!rule.feedURLs().contains(job->feedURL)) continue;
-        if (!rule.accepts(job->articleData)) continue;
-
-        m_dirty = true;
-        storeDeferred();
+    const AutoDownloadRule *rule = findMatchingRule(job);
+    if (!rule) return;
 
-        BitTorrent::AddTorrentParams params;
-        params.savePath = rule.savePath();
-        params.category = rule.assignedCategory();
-        params.addPaused = rule.addPaused();
-        params.createSubfolder = rule.createSubfolder();
-        if (!rule.savePath().isEmpty())
-            params.useAutoTMM = TriStateBool::False;
-        const auto torrentURL = job->articleData.value(Article::KeyTorrentURL).toString();
-        BitTorrent::Session::instance()->addTorrent(torrentURL, params);
-
-        if (BitTorrent::MagnetUri(torrentURL).isValid()) {
-            if (Feed *feed = Session::instance()->feedByURL(job->feedURL)) {
-                if (Article *article = feed->articleByGUID(job->articleData.value(Article::KeyId).toString()))
-                    article->markAsRead();
-            }
-        }
-        else {
-            // waiting for torrent file downloading
-            m_waitingJobs.insert(torrentURL, job);
+    m_dirty = true;
+    storeDeferred();
+
+    BitTorrent::AddTorrentParams params;
+    params.savePath = rule->savePath();
+    params.category = rule->assignedCategory();
+    params.addPaused = rule->addPaused();
+    params.createSubfolder = rule->createSubfolder();
+    if (!rule->savePath().isEmpty())
+        params.useAutoTMM = TriStateBool::False;
+    const auto torrentURL = job->articleData.value(Article::KeyTorrentURL).toString();
+    BitTorrent::Session::instance()->addTorrent(torrentURL, params);
+
+    if (BitTorrent::MagnetUri(torrentURL).isValid()) {
+        if (Feed *feed = Session::instance()->feedByURL(job->feedURL)) {
+            if (Article *article = feed->articleByGUID(job->articleData.value(Article::KeyId).toString()))
+                article->markAsRead();
         }
+    }
+    else {
+        // waiting for torrent file downloading
+        m_waitingJobs.insert(torrentURL, job);
+    }
+}
 
-        return;
+AutoDownloadRule *AutoDownloader::findMatchingRule(const QSharedPointer<ProcessingJob> &job)
+{
+    if (m_isRuleIndexDirty) {
+        m_ruleIndex.build(m_rules.values());
+        m_isRuleIndexDirty = false;
     }
+
+    QElapsedTimer articleTimer;
+    articleTimer.start();
+
+    // Only the rules that passed the index are evaluated completely
+    int skippedRuleCount = 0;
+    const QStringList candidates = m_ruleIndex.candidates(job->feedURL
+            , job->articleData.value(Article::KeyTitle).toString(), &skippedRuleCount);
+
+    AutoDownloadRule *matchingRule = nullptr;
+    for (const QString &ruleName : candidates) {
+        AutoDownloadRule &rule = m_rules[ruleName];
+
+        QElapsedTimer ruleTimer;
+        ruleTimer.start();
+        const bool isAccepted = rule.accepts(job->articleData);
+        const qint64 ruleTime = ruleTimer.nsecsElapsed();
+
+        RuleMatchingStatistics &ruleStatistics = m_matchingStatistics.rules[ruleName];
+        ++ruleStatistics.evaluationCount;
+        if (isAccepted)
+            ++ruleStatistics.matchCount;
+        ruleStatistics.totalTime += ruleTime;
+        ruleStatistics.maxTime = std::max(ruleStatistics.maxTime, ruleTime);
+        ++m_matchingStatistics.evaluatedRuleCount;
+
+        if (isAccepted) {
+            matchingRule = &rule;
+            break;
+        }
+    }
+
+    const qint64 articleTime = articleTimer.nsecsElapsed();
+    ++m_matchingStatistics.articleCount;
+    m_matchingStatistics.skippedRuleCount += skippedRuleCount;
+    m_matchingStatistics.totalTime += articleTime;
+    m_matchingStatistics.maxTime = std::max(m_matchingStatistics.maxTime, articleTime);
+
+    return matchingRule;
 }
 
 void AutoDownloader::load()
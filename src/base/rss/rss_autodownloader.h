@@ -38,6 +38,8 @@
 #include <QRegularExpression>
 #include <QSharedPointer>
 
+#include "rss_autodownloadruleindex.h"
+
 class QThread;
 class QTimer;
 
@@ -53,6 +55,27 @@ namespace RSS
 
     class AutoDownloadRule;
 
+    // All times are in nanoseconds
+    struct RuleMatchingStatistics
+    {
+        qint64 evaluationCount = 0;
+        qint64 matchCount = 0;
+        qint64 totalTime = 0;
+        qint64 maxTime = 0;
+    };
+
+    struct MatchingStatistics
+    {
+        qint64 articleCount = 0;
+        // Rules whose expressions were evaluated
+        qint64 evaluatedRuleCount = 0;
+        // Rules of the article feed ruled out by the index
+        qint64 skippedRuleCount = 0;
+        qint64 totalTime = 0;
+        qint64 maxTime = 0;
+        QHash<QString, RuleMatchingStatistics> rules;
+    };
+
     class ParsingError : public std::runtime_error
     {
     public:
@@ -97,6 +120,8 @@ namespace RSS
         bool renameRule(const QString &ruleName, const QString &newRuleName);
         void removeRule(const QString &ruleName);
 
+        MatchingStatistics matchingStatistics() const;
+
         QByteArray exportRules(RulesFileFormat format = RulesFileFormat::JSON) const;
         void importRules(const QByteArray &data, RulesFileFormat format = RulesFileFormat::JSON);
 
@@ -120,6 +145,7 @@ namespace RSS
         void startProcessing();
         void addJobForArticle(const Article *article);
         void processJob(const QSharedPointer<ProcessingJob> &job);
+        AutoDownloadRule *findMatchingRule(const QSharedPointer<ProcessingJob> &job);
         void load();
         void loadRules(const QByteArray &data);
         void loadRulesLegacy();
@@ -137,6 +163,9 @@ namespace RSS
         QThread *m_ioThread;
         AsyncFileStorage *m_fileStorage;
         QHash<QString, AutoDownloadRule> m_rules;
+        Private::AutoDownloadRuleIndex m_ruleIndex;
+        bool m_isRuleIndexDirty = true;
+        MatchingStatistics m_matchingStatistics;
         QList<QSharedPointer<ProcessingJob>> m_processingQueue;
         QHash<QString, QSharedPointer<ProcessingJob>> m_waitingJobs;
         bool m_dirty = false;
@@ -88,6 +88,28 @@ namespace
         default: return 0; // default
         }
     }
+
+    const QRegularExpression &whitespaceRegex()
+    {
+        static const QRegularExpression regex {"\\s+"};
+        return regex;
+    }
+
+    bool isWildcardLiteralChar(const QChar c)
+    {
+        // Non-ASCII characters are excluded since their case-insensitive
+        // matching isn't the same as comparing lowercase strings
+        switch (c.unicode()) {
+        case '*':
+        case '?':
+        case '[':
+        case ']':
+        case '\\':
+            return false;
+        default:
+            return (c.unicode() < 0x80);
+        }
+    }
 }
 
 const QString Str_Name(QStringLiteral("name"));
@@ -210,8 +232,6 @@ QRegularExpression AutoDownloadRule::cachedRegex(const QString &expression, cons
 
 bool AutoDownloadRule::matchesExpression(const QString &articleTitle, const QString &expression) const
 {
-    const QRegularExpression whitespace {"\\s+"};
-
     if (expression.isEmpty()) {
         // A regex of the form "expr|" will always match, so do the same for wildcards
         return true;
@@ -224,7 +244,7 @@ bool AutoDownloadRule::matchesExpression(const QString &articleTitle, const QStr
 
     // Only match if every wildcard token (separated by spaces) is present in the article name.
     // Order of wildcard tokens is unimportant (if order is important, they should have used *).
-    const QStringList wildcards {expression.split(whitespace, QString::SplitBehavior::SkipEmptyParts)};
+    const QStringList wildcards {expression.split(whitespaceRegex(), QString::SplitBehavior::SkipEmptyParts)};
     for (const QString &wildcard : wildcards) {
         const QRegularExpression reg {cachedRegex(wildcard, false)};
         if (!reg.match(articleTitle).hasMatch())
@@ -412,6 +432,54 @@ bool AutoDownloadRule::accepts(const QVariantHash &articleData)
     return true;
 }
 
+QStringList AutoDownloadRule::requiredLiterals() const
+{
+    // Regular expressions aren't analyzed so such rules may match any title
+    if (m_dataPtr->useRegex || m_dataPtr->mustContain.empty())
+        return {};
+
+    QStringList literals;
+    for (const QString &expression : asConst(m_dataPtr->mustContain)) {
+        // Every wildcard token of the expression must be present in the title,
+        // so the longest literal part of any of them is a necessary condition
+        QString longestLiteral;
+        for (const QString &wildcard : asConst(expression.split(whitespaceRegex(), QString::SkipEmptyParts))) {
+            int begin = 0;
+            for (int i = 0; i <= wildcard.size(); ++i) {
+                if ((i < wildcard.size()) && isWildcardLiteralChar(wildcard[i]))
+                    continue;
+
+                if ((i - begin) > longestLiteral.size())
+                    longestLiteral = wildcard.mid(begin, (i - begin));
+
+                if ((i < wildcard.size()) && (wildcard[i] == QLatin1Char('['))) {
+                    // Characters of a set (e.g. "[1-3]" or "[!a]") are alternatives so none
+                    // of them is required. "]" following the opening bracket belongs to the set.
+                    int setEnd = i + 1;
+                    if ((setEnd < wildcard.size()) && ((wildcard[setEnd] == QLatin1Char('!')) || (wildcard[setEnd] == QLatin1Char('^'))))
+                        ++setEnd;
+                    if ((setEnd < wildcard.size()) && (wildcard[setEnd] == QLatin1Char(']')))
+                        ++setEnd;
+                    while ((setEnd < wildcard.size()) && (wildcard[setEnd] != QLatin1Char(']')))
+                        ++setEnd;
+                    // the rest of the unterminated set isn't analyzed
+                    i = setEnd;
+                }
+                begin = i + 1;
+            }
+        }
+
+        // This expression may match any title
+        if (longestLiteral.isEmpty())
+            return {};
+
+        literals << longestLiteral.toLower();
+    }
+
+    literals.removeDuplicates();
+    return literals;
+}
+
 AutoDownloadRule &AutoDownloadRule::operator=(const AutoDownloadRule &other)
 {
     m_dataPtr = other.m_dataPtr;
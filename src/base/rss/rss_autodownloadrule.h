@@ -87,6 +87,10 @@ namespace RSS
         bool matches(const QVariantHash &articleData) const;
         bool accepts(const QVariantHash &articleData);
 
+        // Lowercase literals of which at least one is contained in the title
+        // of any matching article. Empty if the rule can match any title.
+        QStringList requiredLiterals() const;
+
         AutoDownloadRule &operator=(const AutoDownloadRule &other);
         bool operator==(const AutoDownloadRule &other) const;
         bool operator!=(const AutoDownloadRule &other) const;
@@ -0,0 +1,199 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "rss_autodownloadruleindex.h"
+
+#include <algorithm>
+
+#include <QQueue>
+
+#include "../global.h"
+#include "rss_autodownloadrule.h"
+
+using namespace RSS;
+using namespace RSS::Private;
+
+AutoDownloadRuleIndex::AutoDownloadRuleIndex()
+{
+    build({});
+}
+
+void AutoDownloadRuleIndex::build(const QList<AutoDownloadRule> &rules)
+{
+    m_ruleNames.clear();
+    m_alwaysCandidate.clear();
+    m_rulesByFeed.clear();
+    m_charClasses.fill(0);
+    m_charClassCount = 1; // class 0 is for characters that don't appear in any literal
+    m_transitions.clear();
+    m_failureLinks.clear();
+    m_outputLinks.clear();
+    m_stateRules.clear();
+
+    QList<AutoDownloadRule> enabledRules;
+    for (const AutoDownloadRule &rule : rules) {
+        if (rule.isEnabled())
+            enabledRules << rule;
+    }
+    std::sort(enabledRules.begin(), enabledRules.end()
+              , [](const AutoDownloadRule &left, const AutoDownloadRule &right)
+    {
+        return (left.name() < right.name());
+    });
+
+    QVector<QStringList> ruleLiterals;
+    ruleLiterals.reserve(enabledRules.size());
+    for (const AutoDownloadRule &rule : asConst(enabledRules)) {
+        const QStringList literals = rule.requiredLiterals();
+        for (const QString &literal : literals) {
+            for (const QChar c : literal) {
+                int &classId = m_charClasses[c.unicode()];
+                if (classId == 0)
+                    classId = m_charClassCount++;
+            }
+        }
+        ruleLiterals << literals;
+    }
+
+    addState(); // root
+    for (int i = 0; i < enabledRules.size(); ++i) {
+        const AutoDownloadRule &rule = enabledRules[i];
+        m_ruleNames << rule.name();
+        m_alwaysCandidate << ruleLiterals[i].isEmpty();
+        for (const QString &feedURL : asConst(rule.feedURLs()))
+            m_rulesByFeed[feedURL] << i;
+        for (const QString &literal : asConst(ruleLiterals[i]))
+            addLiteral(literal, i);
+    }
+
+    buildTransitions();
+}
+
+QStringList AutoDownloadRuleIndex::candidates(const QString &feedURL, const QString &articleTitle
+                                              , int *skippedCount) const
+{
+    const QVector<int> feedRules = m_rulesByFeed.value(feedURL);
+    const bool needsScan = std::any_of(feedRules.cbegin(), feedRules.cend(), [this](const int ruleIndex)
+    {
+        return !m_alwaysCandidate[ruleIndex];
+    });
+
+    QVector<bool> isMatched;
+    if (needsScan) {
+        isMatched.resize(m_ruleNames.size());
+
+        int state = 0;
+        for (const QChar c : articleTitle) {
+            state = m_transitions[(state * m_charClassCount) + charClass(c)];
+            for (int outputState = m_outputLinks[state]; outputState != -1
+                 ; outputState = m_outputLinks[m_failureLinks[outputState]]) {
+                for (const int ruleIndex : asConst(m_stateRules[outputState]))
+                    isMatched[ruleIndex] = true;
+            }
+        }
+    }
+
+    QStringList result;
+    for (const int ruleIndex : feedRules) {
+        if (m_alwaysCandidate[ruleIndex] || isMatched[ruleIndex])
+            result << m_ruleNames[ruleIndex];
+    }
+
+    if (skippedCount)
+        *skippedCount = feedRules.size() - result.size();
+    return result;
+}
+
+int AutoDownloadRuleIndex::addState()
+{
+    m_transitions.insert(m_transitions.size(), m_charClassCount, -1);
+    m_failureLinks << 0;
+    m_outputLinks << -1;
+    m_stateRules << QVector<int> {};
+    return (m_stateRules.size() - 1);
+}
+
+void AutoDownloadRuleIndex::addLiteral(const QString &literal, const int ruleIndex)
+{
+    int state = 0;
+    for (const QChar c : literal) {
+        const int transition = (state * m_charClassCount) + m_charClasses[c.unicode()];
+        if (m_transitions[transition] == -1) {
+            const int newState = addState();
+            m_transitions[transition] = newState;
+        }
+        state = m_transitions[transition];
+    }
+
+    if (!m_stateRules[state].contains(ruleIndex))
+        m_stateRules[state] << ruleIndex;
+}
+
+void AutoDownloadRuleIndex::buildTransitions()
+{
+    // Breadth-first traversal of the trie that turns it into a complete automaton.
+    // The failure link of each state points to the state of its longest proper suffix.
+    QQueue<int> queue;
+    queue.enqueue(0);
+    while (!queue.isEmpty()) {
+        const int state = queue.dequeue();
+        const int failureState = m_failureLinks[state];
+        for (int classId = 0; classId < m_charClassCount; ++classId) {
+            int &transition = m_transitions[(state * m_charClassCount) + classId];
+            const int failureTransition = (state == 0)
+                    ? 0 : m_transitions[(failureState * m_charClassCount) + classId];
+            if (transition == -1) {
+                transition = failureTransition;
+                continue;
+            }
+
+            const int nextState = transition;
+            m_failureLinks[nextState] = failureTransition;
+            m_outputLinks[nextState] = m_stateRules[nextState].isEmpty()
+                    ? m_outputLinks[failureTransition] : nextState;
+            queue.enqueue(nextState);
+        }
+    }
+}
+
+int AutoDownloadRuleIndex::charClass(const QChar c) const
+{
+    const ushort code = c.unicode();
+    if (code < 0x80)
+        return m_charClasses[QChar::toLower(code)];
+
+    // Non-ASCII characters that match ASCII letters case-insensitively
+    switch (code) {
+    case 0x017F: // LATIN SMALL LETTER LONG S
+        return m_charClasses['s'];
+    case 0x212A: // KELVIN SIGN
+        return m_charClasses['k'];
+    default:
+        return 0;
+    }
+}
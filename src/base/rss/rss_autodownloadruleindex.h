@@ -0,0 +1,81 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace RSS
+{
+    class AutoDownloadRule;
+
+    namespace Private
+    {
+        // Selects the rules that can match an article without running their
+        // expressions. Rules are indexed by feed URL and their required literals
+        // are combined in a single Aho-Corasick automaton, so the article title
+        // is scanned once regardless of the number of rules.
+        class AutoDownloadRuleIndex
+        {
+        public:
+            AutoDownloadRuleIndex();
+
+            void build(const QList<AutoDownloadRule> &rules);
+
+            // Names of the enabled rules of the feed that may match the title,
+            // in alphabetical order
+            QStringList candidates(const QString &feedURL, const QString &articleTitle
+                                   , int *skippedCount = nullptr) const;
+
+        private:
+            int addState();
+            void addLiteral(const QString &literal, int ruleIndex);
+            void buildTransitions();
+            int charClass(QChar c) const;
+
+            QStringList m_ruleNames;
+            QVector<bool> m_alwaysCandidate;
+            QHash<QString, QVector<int>> m_rulesByFeed;
+
+            std::array<int, 0x80> m_charClasses;
+            int m_charClassCount = 1;
+            QVector<int> m_transitions;
+            QVector<int> m_failureLinks;
+            // The nearest state on the failure chain (including itself)
+            // where some literal ends, -1 if there is none
+            QVector<int> m_outputLinks;
+            QVector<QVector<int>> m_stateRules;
+        };
+    }
+}
@@ -33,11 +33,14 @@
 #include <algorithm>
 #include <vector>
 
+#include <QCryptographicHash>
 #include <QDir>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QSaveFile>
+#include <QTimer>
 #include <QUrl>
 
 #include "base/asyncfilestorage.h"
@@ -47,7 +50,6 @@
 #include "base/profile.h"
 #include "base/utils/fs.h"
 #include "rss_article.h"
-#include "rss_parser.h"
 #include "rss_session.h"
 
 const QString KEY_UID(QStringLiteral("uid"));
@@ -58,6 +60,23 @@ const QString KEY_ISLOADING(QStringLiteral("isLoading"));
 const QString KEY_HASERROR(QStringLiteral("hasError"));
 const QString KEY_ARTICLES(QStringLiteral("articles"));
 
+// Journal records
+const QString KEY_ADD(QStringLiteral("add"));
+const QString KEY_READ(QStringLiteral("read"));
+const QString KEY_REMOVE(QStringLiteral("remove"));
+const QString KEY_UNREADCOUNT(QStringLiteral("unread"));
+const QString KEY_ENTRYCOUNT(QStringLiteral("entries"));
+const QString KEY_ETAG(QStringLiteral("etag"));
+const QString KEY_LASTMODIFIED(QStringLiteral("lastModified"));
+const QString KEY_CONTENTHASH(QStringLiteral("hash"));
+
+// The journal is compacted once it holds more than
+// JOURNAL_COMPACTION_RATIO entries per article (plus some slack)
+const int JOURNAL_COMPACTION_RATIO = 2;
+const int JOURNAL_COMPACTION_SLACK = 64;
+// The last line of the journal is a small state record
+const int JOURNAL_STATE_MAX_SIZE = 1024;
+
 using namespace RSS;
 
 Feed::Feed(const QUuid &uid, const QString &url, const QString &path, Session *session)
@@ -67,6 +86,7 @@ Feed::Feed(const QUuid &uid, const QString &url, const QString &path, Session *s
     , m_url(url)
 {
     m_dataFileName = QString::fromLatin1(m_uid.toRfc4122().toHex()) + QLatin1String(".json");
+    m_journalFileName = QString::fromLatin1(m_uid.toRfc4122().toHex()) + QLatin1String(".jsonl");
 
     // Move to new file naming scheme (since v4.1.2)
     const QString legacyFilename {Utils::Fs::toValidFileSystemName(m_url, false, QLatin1String("_"))
@@ -75,11 +95,6 @@ Feed::Feed(const QUuid &uid, const QString &url, const QString &path, Session *s
     if (!QFile::exists(storageDir.absoluteFilePath(m_dataFileName)))
         QFile::rename(storageDir.absoluteFilePath(legacyFilename), storageDir.absoluteFilePath(m_dataFileName));
 
-    m_parser = new Private::Parser(m_lastBuildDate);
-    m_parser->moveToThread(m_session->workingThread());
-    connect(this, &Feed::destroyed, m_parser, &Private::Parser::deleteLater);
-    connect(m_parser, &Private::Parser::finished, this, &Feed::handleParsingFinished);
-
     connect(m_session, &Session::maxArticlesPerFeedChanged, this, &Feed::handleMaxArticlesPerFeedChanged);
 
     if (m_session->isProcessingEnabled())
@@ -100,23 +115,27 @@ Feed::~Feed()
 
 QList<Article *> Feed::articles() const
 {
+    ensureLoaded();
     return m_articlesByDate;
 }
 
 void Feed::markAsRead()
 {
-    const int oldUnreadCount = m_unreadCount;
+    ensureLoaded();
+
+    QJsonArray readGUIDs;
     for (Article *article : asConst(m_articles)) {
         if (!article->isRead()) {
             article->disconnect(this);
             article->markAsRead();
             --m_unreadCount;
+            readGUIDs << article->guid();
             emit articleRead(article);
         }
     }
 
-    if (m_unreadCount != oldUnreadCount) {
-        m_dirty = true;
+    if (!readGUIDs.isEmpty()) {
+        addJournalRecord(KEY_READ, readGUIDs, readGUIDs.size());
         store();
         emit unreadCountChanged(this);
     }
@@ -126,10 +145,14 @@ void Feed::refresh()
 {
     if (m_downloadHandler)
         m_downloadHandler->cancel();
+    else if (m_isLoading)
+        return; // the previously downloaded data is still being parsed
 
     // NOTE: Should we allow manually refreshing for disabled session?
 
-    m_downloadHandler = Net::DownloadManager::instance()->download(m_url);
+    const auto request = Net::DownloadRequest(m_url)
+            .eTag(m_cacheValidators.eTag).lastModified(m_cacheValidators.lastModified);
+    m_downloadHandler = Net::DownloadManager::instance()->download(request);
     connect(m_downloadHandler, &Net::DownloadHandler::finished, this, &Feed::handleDownloadFinished);
 
     m_isLoading = true;
@@ -168,11 +191,18 @@ int Feed::unreadCount() const
 
 Article *Feed::articleByGUID(const QString &guid) const
 {
+    ensureLoaded();
     return m_articles.value(guid);
 }
 
+bool Feed::isLoaded() const
+{
+    return m_isLoaded;
+}
+
 void Feed::handleMaxArticlesPerFeedChanged(const int n)
 {
+    // Not loaded articles are limited once they are loaded
     while (m_articlesByDate.size() > n)
         removeOldestArticle();
     // We don't need store articles here
@@ -196,10 +226,24 @@ void Feed::handleDownloadFinished(const Net::DownloadResult &result)
     m_downloadHandler = nullptr; // will be deleted by DownloadManager later
 
     if (result.status == Net::DownloadStatus::Success) {
-        LogMsg(tr("RSS feed at '%1' is successfully downloaded. Starting to parse it.")
-                .arg(result.url));
-        // Parse the download RSS
-        m_parser->parse(result.data);
+        const QByteArray contentHash = QCryptographicHash::hash(result.data, QCryptographicHash::Sha1);
+        if (contentHash != m_cacheValidators.contentHash) {
+            LogMsg(tr("RSS feed at '%1' is successfully downloaded. Starting to parse it.")
+                    .arg(result.url));
+            // Parse the download RSS
+            m_pendingCacheValidators = {result.eTag, result.lastModified, contentHash};
+            m_session->parseFeed(this, result.data);
+            return;
+        }
+    }
+
+    if ((result.status == Net::DownloadStatus::Success) || (result.status == Net::DownloadStatus::NotModified)) {
+        m_isLoading = false;
+        m_hasError = false;
+
+        LogMsg(tr("RSS feed at '%1' is not modified since the last update.").arg(result.url));
+
+        emit stateChanged(this);
     }
     else {
         m_isLoading = false;
@@ -231,7 +275,16 @@ void Feed::handleParsingFinished(const RSS::Private::ParsingResult &result)
     // successfully parsed by the XML parser. We are still trying to load as many articles
     // as possible until we encounter corrupted data. So we can have some articles here
     // even in case of parsing error.
+    // The unchanged articles aren't reported so the stored ones are only loaded if needed.
+    m_articleHashes = result.articleHashes;
     const int newArticlesCount = updateArticles(result.articles);
+
+    // Partially parsed data must be processed again next time
+    if (!m_hasError && (m_pendingCacheValidators != m_cacheValidators)) {
+        m_cacheValidators = m_pendingCacheValidators;
+        m_isJournalStateChanged = true;
+        m_dirty = true;
+    }
     store();
 
     if (m_hasError) {
@@ -247,12 +300,19 @@ void Feed::handleParsingFinished(const RSS::Private::ParsingResult &result)
 
 void Feed::load()
 {
-    QFile file(m_session->dataFileStorage()->storageDir().absoluteFilePath(m_dataFileName));
+    const QDir storageDir {m_session->dataFileStorage()->storageDir()};
+
+    if (QFile::exists(storageDir.absoluteFilePath(m_journalFileName))) {
+        // Articles are loaded on demand, only the unread count is needed for now
+        if (!loadJournalState())
+            loadJournal();
+        return;
+    }
 
+    // Convert from the JSON or legacy formats
+    QFile file(storageDir.absoluteFilePath(m_dataFileName));
     if (!file.exists()) {
         loadArticlesLegacy();
-        m_dirty = true;
-        store(); // convert to new format
     }
     else if (file.open(QFile::ReadOnly)) {
         loadArticles(file.readAll());
@@ -262,41 +322,144 @@ void Feed::load()
         LogMsg(tr("Couldn't read RSS Session data from %1. Error: %2")
                .arg(m_dataFileName, file.errorString())
                , Log::WARNING);
+        return;
     }
+
+    QSaveFile journalFile(storageDir.absoluteFilePath(m_journalFileName));
+    if (journalFile.open(QIODevice::WriteOnly) && (journalFile.write(snapshot()) != -1) && journalFile.commit())
+        Utils::Fs::forceRemove(storageDir.absoluteFilePath(m_dataFileName));
+    else
+        LogMsg(tr("Couldn't save RSS feed data in %1. Error: %2").arg(m_journalFileName, journalFile.errorString()), Log::WARNING);
 }
 
-void Feed::loadArticles(const QByteArray &data)
+bool Feed::loadJournalState()
 {
-    QJsonParseError jsonError;
-    const QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &jsonError);
-    if (jsonError.error != QJsonParseError::NoError) {
-        LogMsg(tr("Couldn't parse RSS Session data. Error: %1").arg(jsonError.errorString())
+    QFile file(m_session->dataFileStorage()->storageDir().absoluteFilePath(m_journalFileName));
+    if (!file.open(QFile::ReadOnly))
+        return false;
+
+    const qint64 tailSize = std::min<qint64>(file.size(), JOURNAL_STATE_MAX_SIZE);
+    if (!file.seek(file.size() - tailSize))
+        return false;
+
+    // The journal may end with an incomplete record if writing it was interrupted
+    const QByteArray tail = file.read(tailSize);
+    if (!tail.endsWith('\n'))
+        return false;
+
+    const int lastLineStart = tail.lastIndexOf('\n', (tail.size() - 2)) + 1;
+    const QJsonObject state = QJsonDocument::fromJson(tail.mid(lastLineStart)).object();
+    if (!state.contains(KEY_UNREADCOUNT) || !state.contains(KEY_ENTRYCOUNT))
+        return false;
+
+    m_unreadCount = state.value(KEY_UNREADCOUNT).toInt();
+    m_journalEntryCount = state.value(KEY_ENTRYCOUNT).toInt();
+    loadCacheValidators(state);
+    return true;
+}
+
+void Feed::loadJournal()
+{
+    QFile file(m_session->dataFileStorage()->storageDir().absoluteFilePath(m_journalFileName));
+    if (!file.open(QFile::ReadOnly)) {
+        LogMsg(tr("Couldn't read RSS Session data from %1. Error: %2")
+               .arg(m_journalFileName, file.errorString())
                , Log::WARNING);
+        restoreArticles({});
         return;
     }
 
-    if (!jsonDoc.isArray()) {
-        LogMsg(tr("Couldn't load RSS Session data. Invalid data format."), Log::WARNING);
-        return;
+    // Replay the journal
+    QHash<QString, QJsonObject> articleData;
+    int entryCount = 0;
+    bool isTailTorn = false;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        isTailTorn = !line.endsWith('\n');
+        const QJsonObject record = QJsonDocument::fromJson(line).object();
+        if (record.isEmpty())
+            continue; // incomplete or corrupted record
+
+        ++entryCount;
+        if (record.contains(KEY_ADD)) {
+            const QJsonObject jsonObj = record.value(KEY_ADD).toObject();
+            articleData.insert(jsonObj.value(Article::KeyId).toString(), jsonObj);
+        }
+        else if (record.contains(KEY_READ)) {
+            for (const QJsonValue &guid : asConst(record.value(KEY_READ).toArray())) {
+                const auto it = articleData.find(guid.toString());
+                if (it != articleData.end())
+                    it->insert(Article::KeyIsRead, true);
+            }
+        }
+        else if (record.contains(KEY_REMOVE)) {
+            for (const QJsonValue &guid : asConst(record.value(KEY_REMOVE).toArray()))
+                articleData.remove(guid.toString());
+        }
+        else if (record.contains(KEY_ENTRYCOUNT)) {
+            // Nothing could change the validators before the articles are loaded
+            loadCacheValidators(record);
+        }
     }
+    m_journalEntryCount = entryCount;
 
-    const QJsonArray jsonArr = jsonDoc.array();
-    int i = -1;
-    for (const QJsonValue &jsonVal : jsonArr) {
-        ++i;
-        if (!jsonVal.isObject()) {
-            LogMsg(tr("Couldn't load RSS article '%1#%2'. Invalid data format.").arg(m_url).arg(i)
-                   , Log::WARNING);
-            continue;
-        }
+    // The incomplete last record would be merged with the next appended one,
+    // the line is terminated so it is skipped as a corrupted record instead
+    if (isTailTorn)
+        m_session->dataFileStorage()->append(m_journalFileName, QByteArray(1, '\n'));
 
+    QVector<Article *> articles;
+    articles.reserve(articleData.size());
+    for (const QJsonObject &jsonObj : asConst(articleData)) {
         try {
-            auto article = new Article(this, jsonVal.toObject());
-            if (!addArticle(article))
-                delete article;
+            articles << new Article(this, jsonObj);
         }
         catch (const std::runtime_error&) {}
     }
+
+    restoreArticles(articles);
+}
+
+void Feed::ensureLoaded() const
+{
+    // Loading doesn't emit signals or add journal records so it is safe for the getters,
+    // the unread count correction (if any) is notified asynchronously
+    if (!m_isLoaded)
+        const_cast<Feed *>(this)->loadJournal();
+}
+
+void Feed::loadArticles(const QByteArray &data)
+{
+    QVector<Article *> articles;
+
+    QJsonParseError jsonError;
+    const QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &jsonError);
+    if (jsonError.error != QJsonParseError::NoError) {
+        LogMsg(tr("Couldn't parse RSS Session data. Error: %1").arg(jsonError.errorString())
+               , Log::WARNING);
+    }
+    else if (!jsonDoc.isArray()) {
+        LogMsg(tr("Couldn't load RSS Session data. Invalid data format."), Log::WARNING);
+    }
+    else {
+        const QJsonArray jsonArr = jsonDoc.array();
+        int i = -1;
+        for (const QJsonValue &jsonVal : jsonArr) {
+            ++i;
+            if (!jsonVal.isObject()) {
+                LogMsg(tr("Couldn't load RSS article '%1#%2'. Invalid data format.").arg(m_url).arg(i)
+                       , Log::WARNING);
+                continue;
+            }
+
+            try {
+                articles << new Article(this, jsonVal.toObject());
+            }
+            catch (const std::runtime_error&) {}
+        }
+    }
+
+    restoreArticles(articles);
 }
 
 void Feed::loadArticlesLegacy()
@@ -304,6 +467,7 @@ void Feed::loadArticlesLegacy()
     const SettingsPtr qBTRSSFeeds = Profile::instance()->applicationSettings(QStringLiteral("qBittorrent-rss-feeds"));
     const QVariantHash allOldItems = qBTRSSFeeds->value("old_items").toHash();
 
+    QVector<Article *> articles;
     for (const QVariant &var : asConst(allOldItems.value(m_url).toList())) {
         auto hash = var.toHash();
         // update legacy keys
@@ -311,12 +475,50 @@ void Feed::loadArticlesLegacy()
         hash[Article::KeyTorrentURL] = hash.take(QLatin1String("torrent_url"));
         hash[Article::KeyIsRead] = hash.take(QLatin1String("read"));
         try {
-            auto article = new Article(this, hash);
-            if (!addArticle(article))
-                delete article;
+            articles << new Article(this, hash);
         }
         catch (const std::runtime_error&) {}
     }
+
+    restoreArticles(articles);
+}
+
+void Feed::restoreArticles(QVector<Article *> articles)
+{
+    Q_ASSERT(!m_isLoaded);
+
+    std::sort(articles.begin(), articles.end(), [](const Article *left, const Article *right)
+    {
+        return Article::articleDateRecentThan(left, right->date());
+    });
+
+    // The articles exceeding the limit are dropped from the journal when it is compacted
+    const int maxArticles = m_session->maxArticlesPerFeed();
+    int unreadCount = 0;
+    for (Article *article : asConst(articles)) {
+        if (m_articles.contains(article->guid()) || (m_articlesByDate.size() >= maxArticles)) {
+            delete article;
+            continue;
+        }
+
+        m_articles[article->guid()] = article;
+        m_articlesByDate.append(article);
+        if (!article->isRead()) {
+            ++unreadCount;
+            connect(article, &Article::read, this, &Feed::handleArticleRead);
+        }
+    }
+
+    m_isLoaded = true;
+
+    if (unreadCount != m_unreadCount) {
+        m_unreadCount = unreadCount;
+        // the stored state is corrected along with the next journal records
+        m_isJournalStateChanged = true;
+        // Articles can be loaded by the getters so the receivers
+        // mustn't be called back while the caller uses the feed
+        QTimer::singleShot(0, this, [this]() { emit unreadCountChanged(this); });
+    }
 }
 
 void Feed::store()
@@ -326,11 +528,22 @@ void Feed::store()
     m_dirty = false;
     m_savingTimer.stop();
 
-    QJsonArray jsonArr;
-    for (Article *article :asConst(m_articles))
-        jsonArr << article->toJsonObject();
+    if (m_pendingRecords.isEmpty() && !m_isJournalStateChanged)
+        return;
+
+    m_isJournalStateChanged = false;
 
-    m_session->dataFileStorage()->store(m_dataFileName, QJsonDocument(jsonArr).toJson());
+    const int maxEntryCount = (JOURNAL_COMPACTION_RATIO * m_articles.size()) + JOURNAL_COMPACTION_SLACK;
+    if (m_isLoaded && ((m_journalEntryCount + m_pendingEntryCount) > maxEntryCount)) {
+        m_session->dataFileStorage()->store(m_journalFileName, snapshot());
+    }
+    else {
+        // one more entry for the state record
+        m_journalEntryCount += m_pendingEntryCount + 1;
+        m_session->dataFileStorage()->append(m_journalFileName, (m_pendingRecords + journalState()));
+        m_pendingRecords.clear();
+        m_pendingEntryCount = 0;
+    }
 }
 
 void Feed::storeDeferred()
@@ -339,6 +552,49 @@ void Feed::storeDeferred()
         m_savingTimer.start(5 * 1000, this);
 }
 
+QByteArray Feed::snapshot()
+{
+    m_pendingRecords.clear();
+    m_pendingEntryCount = 0;
+    for (const Article *article : asConst(m_articlesByDate))
+        addJournalRecord(KEY_ADD, article->toJsonObject(), 1);
+
+    m_journalEntryCount = m_pendingEntryCount + 1;
+    const QByteArray data = m_pendingRecords + journalState();
+    m_pendingRecords.clear();
+    m_pendingEntryCount = 0;
+    return data;
+}
+
+QByteArray Feed::journalState() const
+{
+    QJsonObject state {
+        {KEY_UNREADCOUNT, m_unreadCount},
+        {KEY_ENTRYCOUNT, m_journalEntryCount}
+    };
+    if (!m_cacheValidators.eTag.isEmpty())
+        state.insert(KEY_ETAG, m_cacheValidators.eTag);
+    if (!m_cacheValidators.lastModified.isEmpty())
+        state.insert(KEY_LASTMODIFIED, m_cacheValidators.lastModified);
+    if (!m_cacheValidators.contentHash.isEmpty())
+        state.insert(KEY_CONTENTHASH, QString::fromLatin1(m_cacheValidators.contentHash.toHex()));
+    return QJsonDocument(state).toJson(QJsonDocument::Compact) + '\n';
+}
+
+void Feed::loadCacheValidators(const QJsonObject &state)
+{
+    m_cacheValidators.eTag = state.value(KEY_ETAG).toString();
+    m_cacheValidators.lastModified = state.value(KEY_LASTMODIFIED).toString();
+    m_cacheValidators.contentHash = QByteArray::fromHex(state.value(KEY_CONTENTHASH).toString().toLatin1());
+}
+
+void Feed::addJournalRecord(const QString &key, const QJsonValue &value, const int entryCount)
+{
+    m_pendingRecords += QJsonDocument(QJsonObject {{key, value}}).toJson(QJsonDocument::Compact) + '\n';
+    m_pendingEntryCount += entryCount;
+    m_dirty = true;
+}
+
 bool Feed::addArticle(Article *article)
 {
     Q_ASSERT(article);
@@ -358,7 +614,7 @@ bool Feed::addArticle(Article *article)
         connect(article, &Article::read, this, &Feed::handleArticleRead);
     }
 
-    m_dirty = true;
+    addJournalRecord(KEY_ADD, article->toJsonObject(), 1);
     emit newArticle(article);
 
     if (m_articlesByDate.size() > maxArticles)
@@ -374,6 +630,7 @@ void Feed::removeOldestArticle()
 
     m_articles.remove(oldestArticle->guid());
     m_articlesByDate.removeLast();
+    addJournalRecord(KEY_REMOVE, QJsonArray {oldestArticle->guid()}, 1);
     const bool isRead = oldestArticle->isRead();
     delete oldestArticle;
 
@@ -488,6 +745,8 @@ QJsonValue Feed::toJsonValue(const bool withData) const
         jsonObj.insert(KEY_ISLOADING, isLoading());
         jsonObj.insert(KEY_HASERROR, hasError());
 
+        ensureLoaded();
+
         QJsonArray jsonArr;
         for (Article *article : asConst(m_articles))
             jsonArr << article->toJsonObject();
@@ -512,13 +771,14 @@ void Feed::handleArticleRead(Article *article)
     decreaseUnreadCount();
     emit articleRead(article);
     // will be stored deferred
-    m_dirty = true;
+    addJournalRecord(KEY_READ, QJsonArray {article->guid()}, 1);
     storeDeferred();
 }
 
 void Feed::cleanup()
 {
     Utils::Fs::forceRemove(m_session->dataFileStorage()->storageDir().absoluteFilePath(m_dataFileName));
+    Utils::Fs::forceRemove(m_session->dataFileStorage()->storageDir().absoluteFilePath(m_journalFileName));
 }
 
 void Feed::timerEvent(QTimerEvent *event)
@@ -34,9 +34,12 @@
 #include <QHash>
 #include <QList>
 #include <QUuid>
+#include <QVector>
 
 #include "rss_item.h"
 
+class QJsonObject;
+
 class AsyncFileStorage;
 
 namespace Net
@@ -52,7 +55,6 @@ namespace RSS
 
     namespace Private
     {
-        class Parser;
         struct ParsingResult;
     }
 
@@ -80,6 +82,8 @@ namespace RSS
         bool isLoading() const;
         Article *articleByGUID(const QString &guid) const;
         QString iconPath() const;
+        // Articles are loaded from storage on first access
+        bool isLoaded() const;
 
         QJsonValue toJsonValue(bool withData = false) const override;
 
@@ -100,10 +104,18 @@ namespace RSS
         void timerEvent(QTimerEvent *event) override;
         void cleanup() override;
         void load();
+        bool loadJournalState();
+        void loadJournal();
+        void ensureLoaded() const;
         void loadArticles(const QByteArray &data);
         void loadArticlesLegacy();
+        void restoreArticles(QVector<Article *> articles);
         void store();
         void storeDeferred();
+        QByteArray snapshot();
+        QByteArray journalState() const;
+        void loadCacheValidators(const QJsonObject &state);
+        void addJournalRecord(const QString &key, const QJsonValue &value, int entryCount);
         bool addArticle(Article *article);
         void removeOldestArticle();
         void increaseUnreadCount();
@@ -111,8 +123,27 @@ namespace RSS
         void downloadIcon();
         int updateArticles(const QList<QVariantHash> &loadedArticles);
 
+        // Validators of the last successfully parsed feed data
+        struct CacheValidators
+        {
+            QString eTag;
+            QString lastModified;
+            QByteArray contentHash;
+
+            bool operator==(const CacheValidators &other) const
+            {
+                return (eTag == other.eTag)
+                        && (lastModified == other.lastModified)
+                        && (contentHash == other.contentHash);
+            }
+
+            bool operator!=(const CacheValidators &other) const
+            {
+                return !(*this == other);
+            }
+        };
+
         Session *m_session;
-        Private::Parser *m_parser;
         const QUuid m_uid;
         const QString m_url;
         QString m_title;
@@ -126,6 +157,19 @@ namespace RSS
         QString m_dataFileName;
         QBasicTimer m_savingTimer;
         bool m_dirty = false;
+        bool m_isLoaded = false;
+        // Articles are stored in an append-only journal which
+        // is rewritten when it has grown too much since the last time
+        QString m_journalFileName;
+        int m_journalEntryCount = 0;
+        QByteArray m_pendingRecords;
+        int m_pendingEntryCount = 0;
+        bool m_isJournalStateChanged = false;
+        CacheValidators m_cacheValidators;
+        CacheValidators m_pendingCacheValidators;
+        // Content hashes of the articles of the last parsed document by their GUIDs,
+        // the parser skips the unchanged articles
+        QHash<QString, QByteArray> m_articleHashes;
         Net::DownloadHandler *m_downloadHandler = nullptr;
     };
 }
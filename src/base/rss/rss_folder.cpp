@@ -37,9 +37,28 @@
 
 #include "base/global.h"
 #include "rss_article.h"
+#include "rss_feed.h"
 
 using namespace RSS;
 
+namespace
+{
+    // Articles that are already in memory. Feeds that are not loaded
+    // yet have nothing to announce, so there is no need to load them.
+    QList<Article *> loadedArticles(const Item *item)
+    {
+        if (const auto *feed = qobject_cast<const Feed *>(item))
+            return feed->isLoaded() ? feed->articles() : QList<Article *> {};
+
+        QList<Article *> articles;
+        if (const auto *folder = qobject_cast<const Folder *>(item)) {
+            for (const Item *childItem : asConst(folder->items()))
+                articles << loadedArticles(childItem);
+        }
+        return articles;
+    }
+}
+
 Folder::Folder(const QString &path)
     : Item(path)
 {
@@ -126,7 +145,7 @@ void Folder::addItem(Item *item)
     connect(item, &Item::articleAboutToBeRemoved, this, &Item::articleAboutToBeRemoved);
     connect(item, &Item::unreadCountChanged, this, &Folder::handleItemUnreadCountChanged);
 
-    for (auto article : asConst(item->articles()))
+    for (auto article : asConst(loadedArticles(item)))
         emit newArticle(article);
 
     if (item->unreadCount() > 0)
@@ -137,7 +156,7 @@ void Folder::removeItem(Item *item)
 {
     Q_ASSERT(m_items.contains(item));
 
-    for (auto article : asConst(item->articles()))
+    for (auto article : asConst(loadedArticles(item)))
         emit articleAboutToBeRemoved(article);
 
     item->disconnect(this);
@@ -29,17 +29,20 @@
 
 #include "rss_parser.h"
 
+#include <algorithm>
+
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QDebug>
 #include <QGlobalStatic>
 #include <QHash>
-#include <QMetaObject>
 #include <QRegExp>
 #include <QStringList>
 #include <QVariant>
 #include <QXmlStreamEntityResolver>
 #include <QXmlStreamReader>
 
+#include "base/global.h"
 #include "rss_article.h"
 
 namespace
@@ -524,24 +527,14 @@ using namespace RSS::Private;
 
 const int ParsingResultTypeId = qRegisterMetaType<ParsingResult>();
 
-Parser::Parser(const QString lastBuildDate)
+Parser::Parser(const QString lastBuildDate, const QHash<QString, QByteArray> knownArticleHashes)
+    : m_knownArticleHashes {knownArticleHashes}
 {
     m_result.lastBuildDate = lastBuildDate;
 }
 
-void Parser::parse(const QByteArray &feedData)
-{
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
-    QMetaObject::invokeMethod(this, [this, feedData]() { parse_impl(feedData); }
-                              , Qt::QueuedConnection);
-#else
-    QMetaObject::invokeMethod(this, "parse_impl", Qt::QueuedConnection
-                              , Q_ARG(QByteArray, feedData));
-#endif
-}
-
 // read and create items from a rss document
-void Parser::parse_impl(const QByteArray &feedData)
+ParsingResult Parser::parse(const QByteArray &feedData)
 {
     QXmlStreamReader xml(feedData);
     XmlStreamEntityResolver resolver;
@@ -582,9 +575,7 @@ void Parser::parse_impl(const QByteArray &feedData)
                 .arg(xml.columnNumber()).arg(xml.characterOffset());
     }
 
-    emit finished(m_result);
-    m_result.articles.clear(); // clear articles only
-    m_articleIDs.clear();
+    return m_result;
 }
 
 void Parser::parseRssArticle(QXmlStreamReader &xml)
@@ -791,5 +782,21 @@ void Parser::addArticle(QVariantHash article)
     }
 
     m_articleIDs.insert(localId.toString());
+
+    // The values are hashed in the order of their keys since the hash order isn't stable
+    QStringList keys = article.keys();
+    std::sort(keys.begin(), keys.end());
+    QCryptographicHash hash {QCryptographicHash::Sha1};
+    for (const QString &key : asConst(keys)) {
+        hash.addData(key.toUtf8());
+        hash.addData(QByteArray(1, '\0'));
+        hash.addData(article.value(key).toString().toUtf8());
+        hash.addData(QByteArray(1, '\0'));
+    }
+    const QByteArray contentHash = hash.result();
+    m_result.articleHashes.insert(localId.toString(), contentHash);
+    if (m_knownArticleHashes.value(localId.toString()) == contentHash)
+        return;
+
     m_result.articles.prepend(article);
 }
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <QByteArray>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QSet>
@@ -46,7 +48,10 @@ namespace RSS
             QString error;
             QString lastBuildDate;
             QString title;
+            // New and changed articles only
             QList<QVariantHash> articles;
+            // Content hashes of all the document articles by their GUIDs
+            QHash<QString, QByteArray> articleHashes;
         };
 
         class Parser : public QObject
@@ -54,14 +59,12 @@ namespace RSS
             Q_OBJECT
 
         public:
-            explicit Parser(QString lastBuildDate);
-            void parse(const QByteArray &feedData);
-
-        signals:
-            void finished(const RSS::Private::ParsingResult &result);
+            // The articles which hashes match the known ones are considered unchanged and skipped
+            Parser(QString lastBuildDate, QHash<QString, QByteArray> knownArticleHashes);
+            // Parses a single document synchronously in the calling thread
+            ParsingResult parse(const QByteArray &feedData);
 
         private:
-            Q_INVOKABLE void parse_impl(const QByteArray &feedData);
             void parseRssArticle(QXmlStreamReader &xml);
             void parseRSSChannel(QXmlStreamReader &xml);
             void parseAtomArticle(QXmlStreamReader &xml);
@@ -71,6 +74,7 @@ namespace RSS
             QString m_baseUrl;
             ParsingResult m_result;
             QSet<QString> m_articleIDs;
+            const QHash<QString, QByteArray> m_knownArticleHashes;
         };
     }
 }
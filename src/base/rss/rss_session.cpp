@@ -35,8 +35,10 @@
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QSaveFile>
+#include <QRunnable>
 #include <QString>
 #include <QThread>
+#include <QThreadPool>
 
 #include "../asyncfilestorage.h"
 #include "../global.h"
@@ -48,6 +50,7 @@
 #include "rss_feed.h"
 #include "rss_folder.h"
 #include "rss_item.h"
+#include "rss_parser.h"
 
 const int MsecsPerMin = 60000;
 const QString ConfFolderName(QStringLiteral("rss"));
@@ -57,6 +60,38 @@ const QString FeedsFileName(QStringLiteral("feeds.json"));
 const QString SettingsKey_ProcessingEnabled(QStringLiteral("RSS/Session/EnableProcessing"));
 const QString SettingsKey_RefreshInterval(QStringLiteral("RSS/Session/RefreshInterval"));
 const QString SettingsKey_MaxArticlesPerFeed(QStringLiteral("RSS/Session/MaxArticlesPerFeed"));
+namespace
+{
+    class ParsingTask final : public QRunnable
+    {
+    public:
+        ParsingTask(RSS::Session *session, const QUuid &feedUID, const QByteArray &feedData, const QString &lastBuildDate
+                    , const QHash<QString, QByteArray> &articleHashes)
+            : m_session {session}
+            , m_feedUID {feedUID}
+            , m_feedData {feedData}
+            , m_lastBuildDate {lastBuildDate}
+            , m_articleHashes {articleHashes}
+        {
+        }
+
+        void run() override
+        {
+            RSS::Private::Parser parser {m_lastBuildDate, m_articleHashes};
+            const RSS::Private::ParsingResult result = parser.parse(m_feedData);
+
+            QMetaObject::invokeMethod(m_session, "handleFeedParsingFinished", Qt::QueuedConnection
+                                      , Q_ARG(QUuid, m_feedUID), Q_ARG(RSS::Private::ParsingResult, result));
+        }
+
+    private:
+        RSS::Session *m_session;
+        const QUuid m_feedUID;
+        const QByteArray m_feedData;
+        const QString m_lastBuildDate;
+        const QHash<QString, QByteArray> m_articleHashes;
+    };
+}
 
 using namespace RSS;
 
@@ -65,6 +100,7 @@ QPointer<Session> Session::m_instance = nullptr;
 Session::Session()
     : m_processingEnabled(SettingsStorage::instance()->loadValue(SettingsKey_ProcessingEnabled, false).toBool())
     , m_workingThread(new QThread(this))
+    , m_parsingThreadPool(new QThreadPool(this))
     , m_refreshInterval(SettingsStorage::instance()->loadValue(SettingsKey_RefreshInterval, 30).toUInt())
     , m_maxArticlesPerFeed(SettingsStorage::instance()->loadValue(SettingsKey_MaxArticlesPerFeed, 50).toInt())
 {
@@ -128,6 +164,10 @@ Session::~Session()
 {
     qDebug() << "Deleting RSS Session...";
 
+    // Parsing tasks refer to the session
+    m_parsingThreadPool->clear();
+    m_parsingThreadPool->waitForDone();
+
     m_workingThread->quit();
     m_workingThread->wait();
 
@@ -494,6 +534,18 @@ QThread *Session::workingThread() const
     return m_workingThread;
 }
 
+void Session::parseFeed(const Feed *feed, const QByteArray &feedData)
+{
+    m_parsingThreadPool->start(new ParsingTask(this, feed->uid(), feedData, feed->lastBuildDate(), feed->m_articleHashes));
+}
+
+void Session::handleFeedParsingFinished(const QUuid &feedUID, const Private::ParsingResult &result)
+{
+    Feed *feed = m_feedsByUID.value(feedUID);
+    if (feed)
+        feed->handleParsingFinished(result);
+}
+
 void Session::handleItemAboutToBeDestroyed(Item *item)
 {
     m_itemsByPath.remove(item->path());
@@ -68,6 +68,7 @@
 #include <QTimer>
 
 class QThread;
+class QThreadPool;
 
 class Application;
 class AsyncFileStorage;
@@ -78,6 +79,11 @@ namespace RSS
     class Folder;
     class Item;
 
+    namespace Private
+    {
+        struct ParsingResult;
+    }
+
     class Session : public QObject
     {
         Q_OBJECT
@@ -98,6 +104,10 @@ namespace RSS
         AsyncFileStorage *confFileStorage() const;
         AsyncFileStorage *dataFileStorage() const;
 
+        // Feed data is parsed in a pool of worker threads.
+        // The result is passed to the feed unless it is removed meanwhile.
+        void parseFeed(const Feed *feed, const QByteArray &feedData);
+
         int maxArticlesPerFeed() const;
         void setMaxArticlesPerFeed(int n);
 
@@ -135,6 +145,7 @@ namespace RSS
         void handleFeedTitleChanged(Feed *feed);
 
     private:
+        Q_INVOKABLE void handleFeedParsingFinished(const QUuid &feedUID, const RSS::Private::ParsingResult &result);
         QUuid generateUID() const;
         void load();
         void loadFolder(const QJsonObject &jsonObj, Folder *folder);
@@ -149,6 +160,7 @@ namespace RSS
 
         bool m_processingEnabled;
         QThread *m_workingThread;
+        QThreadPool *m_parsingThreadPool;
         AsyncFileStorage *m_confFileStorage;
         AsyncFileStorage *m_dataFileStorage;
         QTimer m_refreshTimer;
@@ -28,7 +28,9 @@
 
 #include "torrentfilter.h"
 
+#include "base/global.h"
 #include "bittorrent/infohash.h"
+#include "bittorrent/session.h"
 #include "bittorrent/torrenthandle.h"
 
 const QString TorrentFilter::AnyCategory;
@@ -154,6 +156,58 @@ bool TorrentFilter::match(const TorrentHandle *const torrent) const
     return (matchState(torrent) && matchHash(torrent) && matchCategory(torrent) && matchTag(torrent));
 }
 
+QVector<TorrentHandle *> TorrentFilter::matchingTorrents(const int maxCount) const
+{
+    using BitTorrent::InfoHash;
+
+    const auto *session = BitTorrent::Session::instance();
+
+    bool isNarrowed = false;
+    QSet<InfoHash> candidates;
+    const auto narrow = [&isNarrowed, &candidates](const QSet<InfoHash> &hashes)
+    {
+        if (!isNarrowed || (hashes.size() < candidates.size())) {
+            candidates = hashes;
+            isNarrowed = true;
+        }
+    };
+
+    if (m_hashSet != AnyHash) {
+        QSet<InfoHash> hashes;
+        hashes.reserve(m_hashSet.size());
+        for (const QString &hash : asConst(m_hashSet))
+            hashes.insert(hash);
+        narrow(hashes);
+    }
+    if (!m_category.isNull())
+        narrow(session->torrentsByCategory(m_category));
+    if (!m_tag.isNull())
+        narrow(session->torrentsByTag(m_tag));
+
+    QVector<TorrentHandle *> result;
+    if (!isNarrowed) {
+        for (TorrentHandle *const torrent : asConst(session->torrents())) {
+            if (match(torrent)) {
+                result.append(torrent);
+                if (result.size() == maxCount)
+                    break;
+            }
+        }
+        return result;
+    }
+
+    for (const InfoHash &hash : asConst(candidates)) {
+        // Requested hashes can be unknown or belong to the torrents removed already
+        TorrentHandle *const torrent = session->findTorrent(hash);
+        if (torrent && match(torrent)) {
+            result.append(torrent);
+            if (result.size() == maxCount)
+                break;
+        }
+    }
+    return result;
+}
+
 bool TorrentFilter::matchState(const BitTorrent::TorrentHandle *const torrent) const
 {
     switch (m_type) {
@@ -31,6 +31,7 @@
 
 #include <QSet>
 #include <QString>
+#include <QVector>
 
 typedef QSet<QString> QStringSet;
 
@@ -88,6 +89,10 @@ public:
     bool setTag(const QString &tag);
 
     bool match(const BitTorrent::TorrentHandle *torrent) const;
+    // Returns the matching torrents of the session (at most maxCount of them when it is positive).
+    // The hashes, category and tag are looked up in the session indexes so only
+    // the torrents from the smallest of these sets are checked one by one.
+    QVector<BitTorrent::TorrentHandle *> matchingTorrents(int maxCount = -1) const;
 
 private:
     bool matchState(const BitTorrent::TorrentHandle *torrent) const;
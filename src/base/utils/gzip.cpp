@@ -149,3 +149,75 @@ QByteArray Utils::Gzip::decompress(const QByteArray &data, bool *ok)
     if (ok) *ok = true;
     return output;
 }
+
+Utils::Gzip::StreamCompressor::StreamCompressor(const int level)
+    : m_stream {new z_stream {}}
+{
+    m_stream->zalloc = Z_NULL;
+    m_stream->zfree = Z_NULL;
+    m_stream->opaque = Z_NULL;
+
+    // windowBits = 15 + 16 to enable gzip
+    m_isValid = (deflateInit2(m_stream.get(), level, Z_DEFLATED, (15 + 16), 9, Z_DEFAULT_STRATEGY) == Z_OK);
+}
+
+Utils::Gzip::StreamCompressor::~StreamCompressor()
+{
+    if (m_isValid)
+        deflateEnd(m_stream.get());
+}
+
+bool Utils::Gzip::StreamCompressor::isValid() const
+{
+    return m_isValid;
+}
+
+QByteArray Utils::Gzip::StreamCompressor::compress(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return {};
+    return deflate(data, Z_NO_FLUSH);
+}
+
+QByteArray Utils::Gzip::StreamCompressor::finish()
+{
+    return deflate({}, Z_FINISH);
+}
+
+QByteArray Utils::Gzip::StreamCompressor::deflate(const QByteArray &data, const int flush)
+{
+    if (!m_isValid)
+        return {};
+
+    const int BUFSIZE = 64 * 1024;
+    std::vector<char> tmpBuf(BUFSIZE);
+
+    m_stream->next_in = reinterpret_cast<const Bytef *>(data.constData());
+    m_stream->avail_in = uInt(data.size());
+
+    QByteArray output;
+    while (true) {
+        m_stream->next_out = reinterpret_cast<Bytef *>(tmpBuf.data());
+        m_stream->avail_out = BUFSIZE;
+
+        const int result = ::deflate(m_stream.get(), flush);
+        if ((result != Z_OK) && (result != Z_STREAM_END) && (result != Z_BUF_ERROR)) {
+            deflateEnd(m_stream.get());
+            m_isValid = false;
+            return {};
+        }
+
+        output.append(tmpBuf.data(), (BUFSIZE - m_stream->avail_out));
+
+        // all the input is consumed and no more output is pending
+        if ((m_stream->avail_out > 0) || (result == Z_STREAM_END))
+            break;
+    }
+
+    if (flush == Z_FINISH) {
+        deflateEnd(m_stream.get());
+        m_isValid = false;
+    }
+
+    return output;
+}
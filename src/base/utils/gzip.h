@@ -30,14 +30,41 @@
 #ifndef UTILS_GZIP_H
 #define UTILS_GZIP_H
 
+#include <memory>
+
+#include <QtGlobal>
+
 class QByteArray;
 
+struct z_stream_s;
+
 namespace Utils
 {
     namespace Gzip
     {
         QByteArray compress(const QByteArray &data, int level = 6, bool *ok = nullptr);
         QByteArray decompress(const QByteArray &data, bool *ok = nullptr);
+
+        // Compresses the data that is provided piece by piece,
+        // each call returns the part of the output that is ready
+        class StreamCompressor
+        {
+            Q_DISABLE_COPY(StreamCompressor)
+
+        public:
+            explicit StreamCompressor(int level = 6);
+            ~StreamCompressor();
+
+            bool isValid() const;
+            QByteArray compress(const QByteArray &data);
+            QByteArray finish();
+
+        private:
+            QByteArray deflate(const QByteArray &data, int flush);
+
+            std::unique_ptr<z_stream_s> m_stream;
+            bool m_isValid = false;
+        };
     }
 }
 
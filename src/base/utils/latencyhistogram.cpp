@@ -0,0 +1,79 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "latencyhistogram.h"
+
+#include <algorithm>
+
+namespace
+{
+    const std::array<qint64, Utils::LatencyHistogram::BUCKET_COUNT> BUCKET_BOUNDS {{
+        100000, 250000, 500000
+        , 1000000, 2500000, 5000000
+        , 10000000, 25000000, 50000000
+        , 100000000, 250000000, 500000000
+        , 1000000000, 2500000000, 5000000000, 10000000000
+    }};
+}
+
+qint64 Utils::LatencyHistogram::bucketBound(const int index)
+{
+    return BUCKET_BOUNDS[index];
+}
+
+void Utils::LatencyHistogram::addSample(const qint64 nsecs)
+{
+    const auto bucket = std::lower_bound(BUCKET_BOUNDS.cbegin(), BUCKET_BOUNDS.cend(), nsecs);
+    ++m_buckets[std::distance(BUCKET_BOUNDS.cbegin(), bucket)];
+    ++m_count;
+    m_sum += nsecs;
+    m_max = std::max(m_max, nsecs);
+}
+
+qint64 Utils::LatencyHistogram::cumulativeCount(const int index) const
+{
+    qint64 result = 0;
+    for (int i = 0; i <= index; ++i)
+        result += m_buckets[i];
+    return result;
+}
+
+qint64 Utils::LatencyHistogram::count() const
+{
+    return m_count;
+}
+
+qint64 Utils::LatencyHistogram::sum() const
+{
+    return m_sum;
+}
+
+qint64 Utils::LatencyHistogram::max() const
+{
+    return m_max;
+}
@@ -0,0 +1,64 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+
+#include <QtGlobal>
+
+namespace Utils
+{
+    // Distribution of the measured durations over the fixed buckets
+    // (from 100 microseconds to 10 seconds) in the way OpenMetrics histograms
+    // are exported. Adding a sample doesn't allocate so it can be done for every event.
+    class LatencyHistogram
+    {
+    public:
+        static const int BUCKET_COUNT = 16;
+
+        // Upper bound of the bucket in nanoseconds (inclusive)
+        static qint64 bucketBound(int index);
+
+        void addSample(qint64 nsecs);
+
+        // Number of the samples not exceeding the bucket bound,
+        // index BUCKET_COUNT can be used to get the total number of samples
+        qint64 cumulativeCount(int index) const;
+        qint64 count() const;
+        qint64 sum() const;
+        qint64 max() const;
+
+    private:
+        // the last one holds the samples exceeding all the bounds
+        std::array<qint64, BUCKET_COUNT + 1> m_buckets {};
+        qint64 m_count = 0;
+        qint64 m_sum = 0;
+        qint64 m_max = 0;
+    };
+}
@@ -0,0 +1,277 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#include "timeseriesstore.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QtEndian>
+
+namespace
+{
+    const quint32 MAGIC = 0x53544251;  // "QBTS"
+    const quint32 VERSION = 1;
+    const int LABEL_SIZE = 256;
+
+    struct FileHeader
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 valueCount;
+        quint32 archiveCount;
+        char label[LABEL_SIZE];  // UTF-8, zero padded
+    };
+
+    struct ArchiveHeader
+    {
+        quint32 resolution;
+        quint32 capacity;
+    };
+
+    // The record consists of the bucket start (qint64), the number of the samples
+    // in the bucket (quint32) and the average of each value (float).
+    // It is stored in the native byte order since the file isn't meant to be moved
+    // between the machines, the mismatching header just makes it recreated.
+    const int RECORD_HEADER_SIZE = sizeof(qint64) + sizeof(quint32);
+
+    qint64 bucketStart(const qint64 timestamp, const int resolution)
+    {
+        return timestamp - (timestamp % resolution);
+    }
+}
+
+Utils::TimeSeriesStore::TimeSeriesStore(const QString &path, const int valueCount, const QVector<Archive> &archives, const QString &label)
+    : m_file {path}
+    , m_valueCount {valueCount}
+    , m_archives {archives}
+    , m_label {label}
+    , m_recordSize {static_cast<int>(RECORD_HEADER_SIZE + (valueCount * sizeof(float)))}
+    , m_accumulators(archives.size())
+{
+    qint64 offset = sizeof(FileHeader) + (archives.size() * sizeof(ArchiveHeader));
+    for (const Archive &archive : archives) {
+        m_archiveOffsets.append(offset);
+        offset += static_cast<qint64>(archive.capacity) * m_recordSize;
+    }
+    m_fileSize = offset;
+
+    if (!open() && !create()) {
+        if (m_data) {
+            m_file.unmap(m_data);
+            m_data = nullptr;
+        }
+        m_file.close();
+    }
+}
+
+Utils::TimeSeriesStore::~TimeSeriesStore()
+{
+    if (m_data)
+        m_file.unmap(m_data);
+}
+
+QString Utils::TimeSeriesStore::readLabel(const QString &path)
+{
+    QFile file {path};
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    FileHeader header;
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header))
+        return {};
+    if ((header.magic != MAGIC) || (header.version != VERSION))
+        return {};
+
+    return QString::fromUtf8(header.label, static_cast<int>(qstrnlen(header.label, LABEL_SIZE)));
+}
+
+bool Utils::TimeSeriesStore::isValid() const
+{
+    return (m_data != nullptr);
+}
+
+QString Utils::TimeSeriesStore::path() const
+{
+    return m_file.fileName();
+}
+
+QString Utils::TimeSeriesStore::label() const
+{
+    return m_label;
+}
+
+int Utils::TimeSeriesStore::valueCount() const
+{
+    return m_valueCount;
+}
+
+QVector<Utils::TimeSeriesStore::Archive> Utils::TimeSeriesStore::archives() const
+{
+    return m_archives;
+}
+
+bool Utils::TimeSeriesStore::open()
+{
+    if (!m_file.open(QIODevice::ReadWrite) || (m_file.size() != m_fileSize))
+        return false;
+
+    m_data = m_file.map(0, m_fileSize);
+    if (!m_data)
+        return false;
+
+    FileHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    if ((header.magic != MAGIC) || (header.version != VERSION)
+        || (header.valueCount != static_cast<quint32>(m_valueCount))
+        || (header.archiveCount != static_cast<quint32>(m_archives.size())))
+        return false;
+
+    for (int i = 0; i < m_archives.size(); ++i) {
+        ArchiveHeader archiveHeader;
+        std::memcpy(&archiveHeader, (m_data + sizeof(FileHeader) + (i * sizeof(ArchiveHeader))), sizeof(archiveHeader));
+        if ((archiveHeader.resolution != static_cast<quint32>(m_archives[i].resolution))
+            || (archiveHeader.capacity != static_cast<quint32>(m_archives[i].capacity)))
+            return false;
+    }
+
+    return true;
+}
+
+bool Utils::TimeSeriesStore::create()
+{
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+
+    if (!m_file.isOpen() && !m_file.open(QIODevice::ReadWrite))
+        return false;
+
+    // drop the old contents, the file is extended with zeros
+    if (!m_file.resize(0) || !m_file.resize(m_fileSize))
+        return false;
+
+    m_data = m_file.map(0, m_fileSize);
+    if (!m_data)
+        return false;
+
+    FileHeader header {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.valueCount = m_valueCount;
+    header.archiveCount = m_archives.size();
+    const QByteArray label = m_label.toUtf8().left(LABEL_SIZE - 1);
+    std::memcpy(header.label, label.constData(), label.size());
+    std::memcpy(m_data, &header, sizeof(header));
+
+    for (int i = 0; i < m_archives.size(); ++i) {
+        const ArchiveHeader archiveHeader {static_cast<quint32>(m_archives[i].resolution), static_cast<quint32>(m_archives[i].capacity)};
+        std::memcpy((m_data + sizeof(FileHeader) + (i * sizeof(ArchiveHeader))), &archiveHeader, sizeof(archiveHeader));
+    }
+
+    return true;
+}
+
+uchar *Utils::TimeSeriesStore::record(const int archiveIndex, const qint64 bucket) const
+{
+    const Archive &archive = m_archives[archiveIndex];
+    qint64 slot = (bucket / archive.resolution) % archive.capacity;
+    // keep the slot within the archive even for the timestamps before the epoch
+    if (slot < 0)
+        slot += archive.capacity;
+    return m_data + m_archiveOffsets[archiveIndex] + (slot * m_recordSize);
+}
+
+void Utils::TimeSeriesStore::append(const qint64 timestamp, const QVector<double> &values)
+{
+    Q_ASSERT(values.size() == m_valueCount);
+    if (!m_data || (timestamp < 0))
+        return;
+
+    for (int i = 0; i < m_archives.size(); ++i) {
+        const qint64 bucket = bucketStart(timestamp, m_archives[i].resolution);
+        uchar *data = record(i, bucket);
+
+        Accumulator &accumulator = m_accumulators[i];
+        if (accumulator.bucket != bucket) {
+            accumulator.bucket = bucket;
+            accumulator.count = 0;
+            accumulator.sums.fill(0, m_valueCount);
+
+            // continue the bucket stored before the restart
+            if (qFromUnaligned<qint64>(data) == bucket) {
+                accumulator.count = qFromUnaligned<quint32>(data + sizeof(qint64));
+                for (int j = 0; j < m_valueCount; ++j)
+                    accumulator.sums[j] = static_cast<double>(qFromUnaligned<float>(data + RECORD_HEADER_SIZE + (j * sizeof(float)))) * accumulator.count;
+            }
+        }
+
+        ++accumulator.count;
+        for (int j = 0; j < m_valueCount; ++j) {
+            accumulator.sums[j] += values[j];
+            qToUnaligned(static_cast<float>(accumulator.sums[j] / accumulator.count), (data + RECORD_HEADER_SIZE + (j * sizeof(float))));
+        }
+        qToUnaligned(accumulator.count, (data + sizeof(qint64)));
+        qToUnaligned(bucket, data);
+    }
+}
+
+QVector<Utils::TimeSeriesStore::Sample> Utils::TimeSeriesStore::samples(const int resolution, const qint64 from, const qint64 to) const
+{
+    if (!m_data || (to < 0) || (from > to))
+        return {};
+
+    const auto archiveIter = std::find_if(m_archives.cbegin(), m_archives.cend()
+        , [resolution](const Archive &archive) { return (archive.resolution == resolution); });
+    if (archiveIter == m_archives.cend())
+        return {};
+
+    const int archiveIndex = static_cast<int>(std::distance(m_archives.cbegin(), archiveIter));
+    // the older buckets are overwritten already
+    const qint64 first = std::max({qint64 {0}, bucketStart(std::max<qint64>(from, 0), resolution)
+        , (bucketStart(to, resolution) - (static_cast<qint64>(archiveIter->capacity - 1) * resolution))});
+    // the number of the buckets is counted instead of comparing
+    // the bucket with 'to' so the iteration can't overflow near the limit
+    const int count = static_cast<int>(((bucketStart(to, resolution) - first) / resolution) + 1);
+
+    QVector<Sample> result;
+    result.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const qint64 bucket = first + (static_cast<qint64>(i) * resolution);
+        const uchar *data = record(archiveIndex, bucket);
+        if (qFromUnaligned<qint64>(data) != bucket)
+            continue;
+
+        Sample sample {bucket, QVector<float>(m_valueCount)};
+        for (int j = 0; j < m_valueCount; ++j)
+            sample.values[j] = qFromUnaligned<float>(data + RECORD_HEADER_SIZE + (j * sizeof(float)));
+        result.append(sample);
+    }
+
+    return result;
+}
@@ -0,0 +1,99 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+namespace Utils
+{
+    // Round-robin storage of the numeric samples in a fixed-size file.
+    // Every archive consolidates the samples into the buckets of its resolution
+    // (by averaging them) and keeps only the given number of the latest buckets,
+    // so the file never grows. The file is memory mapped: appending a sample
+    // updates the current bucket of each archive in place and the reads don't
+    // involve any I/O calls. The partially filled buckets are stored as well
+    // so they are continued after the restart.
+    class TimeSeriesStore
+    {
+        Q_DISABLE_COPY(TimeSeriesStore)
+
+    public:
+        struct Archive
+        {
+            int resolution;  // seconds per bucket
+            int capacity;  // number of buckets
+        };
+
+        struct Sample
+        {
+            qint64 timestamp;  // start of the bucket, seconds since epoch
+            QVector<float> values;
+        };
+
+        // The existing file is reused only if it has the same layout, otherwise it is recreated
+        TimeSeriesStore(const QString &path, int valueCount, const QVector<Archive> &archives, const QString &label = {});
+        ~TimeSeriesStore();
+
+        static QString readLabel(const QString &path);
+
+        bool isValid() const;
+        QString path() const;
+        QString label() const;
+        int valueCount() const;
+        QVector<Archive> archives() const;
+
+        void append(qint64 timestamp, const QVector<double> &values);
+        // Buckets of the archive having the given resolution which start within [from, to],
+        // the oldest first. The buckets without samples are skipped.
+        QVector<Sample> samples(int resolution, qint64 from, qint64 to) const;
+
+    private:
+        struct Accumulator
+        {
+            qint64 bucket = -1;
+            quint32 count = 0;
+            QVector<double> sums;
+        };
+
+        bool open();
+        bool create();
+        uchar *record(int archiveIndex, qint64 bucket) const;
+
+        QFile m_file;
+        const int m_valueCount;
+        const QVector<Archive> m_archives;
+        const QString m_label;
+        int m_recordSize;
+        QVector<qint64> m_archiveOffsets;
+        qint64 m_fileSize;
+        uchar *m_data = nullptr;
+        QVector<Accumulator> m_accumulators;
+    };
+}
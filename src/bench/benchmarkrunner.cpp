@@ -0,0 +1,141 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "benchmarkrunner.h"
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QTextStream>
+
+#include "base/global.h"
+
+namespace
+{
+    volatile qint64 sink = 0;
+
+    double itemsPerSecond(const BenchmarkRunner::Result &result)
+    {
+        if (result.medianTime <= 0)
+            return 0;
+        return ((result.itemCount * 1e9) / result.medianTime);
+    }
+}
+
+BenchmarkRunner::BenchmarkRunner(const int iterations, const QRegularExpression &filter)
+    : m_iterations {std::max(1, iterations)}
+    , m_filter {filter}
+{
+}
+
+bool BenchmarkRunner::isSelected(const QString &name) const
+{
+    return m_filter.match(name).hasMatch();
+}
+
+void BenchmarkRunner::run(const QString &name, const qint64 itemCount, const std::function<void ()> &body
+                          , const std::function<void ()> &setup)
+{
+    if (!isSelected(name))
+        return;
+
+    QVector<qint64> times;
+    times.reserve(m_iterations);
+
+    // the first run warms up the caches and isn't counted
+    for (int i = -1; i < m_iterations; ++i) {
+        if (setup)
+            setup();
+
+        QElapsedTimer timer;
+        timer.start();
+        body();
+        const qint64 elapsed = timer.nsecsElapsed();
+
+        if (i >= 0)
+            times.append(elapsed);
+    }
+
+    std::sort(times.begin(), times.end());
+
+    Result result;
+    result.name = name;
+    result.iterations = m_iterations;
+    result.itemCount = itemCount;
+    result.minTime = times.first();
+    result.medianTime = times[times.size() / 2];
+    qint64 total = 0;
+    for (const qint64 time : asConst(times))
+        total += time;
+    result.meanTime = (total / times.size());
+
+    m_results.append(result);
+    QTextStream(stderr) << name << ": " << (result.medianTime / 1000) << " us" << endl;
+}
+
+QVector<BenchmarkRunner::Result> BenchmarkRunner::results() const
+{
+    return m_results;
+}
+
+QJsonObject BenchmarkRunner::toJson() const
+{
+    QJsonArray benchmarks;
+    for (const Result &result : m_results) {
+        benchmarks << QJsonObject {
+            {"name", result.name},
+            {"iterations", result.iterations},
+            {"items", result.itemCount},
+            {"min_ns", result.minTime},
+            {"median_ns", result.medianTime},
+            {"mean_ns", result.meanTime},
+            {"items_per_second", itemsPerSecond(result)}
+        };
+    }
+
+    return {{"benchmarks", benchmarks}};
+}
+
+QString BenchmarkRunner::toText() const
+{
+    QString text;
+    QTextStream stream {&text};
+    for (const Result &result : m_results) {
+        stream << qSetFieldWidth(44) << left << result.name << qSetFieldWidth(0)
+               << " median " << (result.medianTime / 1000) << " us"
+               << ", min " << (result.minTime / 1000) << " us"
+               << ", " << qRound64(itemsPerSecond(result)) << " items/s" << endl;
+    }
+    return text;
+}
+
+void BenchmarkRunner::consume(const qint64 value)
+{
+    sink = sink + value;
+}
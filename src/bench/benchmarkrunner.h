@@ -0,0 +1,73 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <functional>
+
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+// Runs the benchmarks selected by the name filter and collects their timings.
+// Every benchmark is run once to warm up and then the requested number of times,
+// the reported figures are based on the individual iterations.
+class BenchmarkRunner
+{
+public:
+    struct Result
+    {
+        QString name;
+        int iterations = 0;
+        qint64 itemCount = 0;  // items processed by a single iteration
+        qint64 minTime = 0;  // nsecs
+        qint64 medianTime = 0;  // nsecs
+        qint64 meanTime = 0;  // nsecs
+    };
+
+    BenchmarkRunner(int iterations, const QRegularExpression &filter);
+
+    bool isSelected(const QString &name) const;
+
+    // `setup` is run before each iteration and isn't measured
+    void run(const QString &name, qint64 itemCount, const std::function<void ()> &body
+             , const std::function<void ()> &setup = {});
+
+    QVector<Result> results() const;
+    QJsonObject toJson() const;
+    QString toText() const;
+
+    // Makes the value observable so the computation of it isn't optimized out
+    static void consume(qint64 value);
+
+private:
+    const int m_iterations;
+    const QRegularExpression m_filter;
+    QVector<Result> m_results;
+};
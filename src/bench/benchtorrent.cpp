@@ -0,0 +1,796 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "benchtorrent.h"
+
+#include <algorithm>
+#include <random>
+
+#include <QCryptographicHash>
+#include <QStringList>
+#include <QUrl>
+#include <QVector>
+
+#include "base/bitfield.h"
+#include "base/bittorrent/downloadpriority.h"
+#include "base/bittorrent/peerinfo.h"
+#include "base/bittorrent/torrentinfo.h"
+#include "base/bittorrent/trackerentry.h"
+#include "base/types.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    const int CATEGORY_COUNT = 20;
+    const int TAG_COUNT = 50;
+    const int TRACKER_COUNT = 30;
+
+    const TorrentState STATES[] = {
+        TorrentState::Downloading,
+        TorrentState::StalledDownloading,
+        TorrentState::PausedDownloading,
+        TorrentState::QueuedDownloading,
+        TorrentState::Uploading,
+        TorrentState::StalledUploading,
+        TorrentState::PausedUploading,
+        TorrentState::QueuedUploading,
+        TorrentState::Error
+    };
+}
+
+BenchTorrent::BenchTorrent(const Data &data)
+    : m_data(data)
+{
+}
+
+std::vector<std::unique_ptr<BenchTorrent>> BenchTorrent::generate(const int count)
+{
+    std::mt19937 generator {static_cast<std::mt19937::result_type>(count)};
+    const auto random = [&generator](const int max) -> int
+    {
+        return std::uniform_int_distribution<int> {0, (max - 1)}(generator);
+    };
+
+    const QDateTime baseTime = QDateTime::fromSecsSinceEpoch(1577836800);  // 2020-01-01
+
+    std::vector<std::unique_ptr<BenchTorrent>> torrents;
+    torrents.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Data data;
+        data.hash = InfoHash {QString::fromLatin1(QCryptographicHash::hash(QByteArray::number(i), QCryptographicHash::Sha1).toHex())};
+        data.name = QString::fromLatin1("Synthetic.Torrent.%1.%2").arg(i).arg(random(1000000));
+        data.savePath = QString::fromLatin1("/data/torrents/%1").arg(i % 100);
+        data.category = (random(4) == 0) ? QString {} : QString::fromLatin1("category%1/sub%2").arg(random(CATEGORY_COUNT)).arg(random(3));
+        for (int tagCount = random(4); tagCount > 0; --tagCount)
+            data.tags.insert(QString::fromLatin1("tag%1").arg(random(TAG_COUNT)));
+        data.tracker = QString::fromLatin1("udp://tracker%1.example.org:6969/announce").arg(random(TRACKER_COUNT));
+        data.state = STATES[random(sizeof(STATES) / sizeof(STATES[0]))];
+        data.size = (static_cast<qlonglong>(random(64 * 1024)) + 1) * 1024 * 1024;
+        data.progress = random(1001) / 1000.0;
+        data.queuePosition = i;
+        data.uploadRate = random(4) * random(1024 * 1024);
+        data.downloadRate = random(4) * random(1024 * 1024);
+        data.addedTime = baseTime.addSecs(i * 60);
+
+        torrents.push_back(std::make_unique<BenchTorrent>(data));
+    }
+
+    return torrents;
+}
+
+void BenchTorrent::update(const std::vector<std::unique_ptr<BenchTorrent>> &torrents, const int round)
+{
+    // about a tenth of the torrents change on every round
+    for (std::size_t i = (round % 10); i < torrents.size(); i += 10) {
+        Data &data = torrents[i]->m_data;
+        data.progress = std::min<qreal>(1, (data.progress + 0.001));
+        data.uploadRate = ((data.uploadRate + 4096 * (round + 1)) % (1024 * 1024));
+        data.downloadRate = ((data.downloadRate + 8192 * (round + 1)) % (1024 * 1024));
+    }
+}
+
+InfoHash BenchTorrent::hash() const
+{
+    return m_data.hash;
+}
+
+QString BenchTorrent::name() const
+{
+    return m_data.name;
+}
+
+QDateTime BenchTorrent::creationDate() const
+{
+    return {};
+}
+
+QString BenchTorrent::creator() const
+{
+    return {};
+}
+
+QString BenchTorrent::comment() const
+{
+    return {};
+}
+
+bool BenchTorrent::isPrivate() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::totalSize() const
+{
+    return m_data.size;
+}
+
+qlonglong BenchTorrent::wantedSize() const
+{
+    return m_data.size;
+}
+
+qlonglong BenchTorrent::completedSize() const
+{
+    return static_cast<qlonglong>(m_data.size * m_data.progress);
+}
+
+qlonglong BenchTorrent::incompletedSize() const
+{
+    return (m_data.size - completedSize());
+}
+
+qlonglong BenchTorrent::pieceLength() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::wastedSize() const
+{
+    return {};
+}
+
+QString BenchTorrent::currentTracker() const
+{
+    return m_data.tracker;
+}
+
+QString BenchTorrent::savePath(const bool actual) const
+{
+    Q_UNUSED(actual);
+    return m_data.savePath;
+}
+
+QString BenchTorrent::rootPath(const bool actual) const
+{
+    Q_UNUSED(actual);
+    return {};
+}
+
+QString BenchTorrent::contentPath(const bool actual) const
+{
+    Q_UNUSED(actual);
+    return {};
+}
+
+bool BenchTorrent::useTempPath() const
+{
+    return {};
+}
+
+bool BenchTorrent::isAutoTMMEnabled() const
+{
+    return {};
+}
+
+void BenchTorrent::setAutoTMMEnabled(const bool enabled)
+{
+    Q_UNUSED(enabled);
+}
+
+QString BenchTorrent::category() const
+{
+    return m_data.category;
+}
+
+bool BenchTorrent::belongsToCategory(const QString &category) const
+{
+    return (m_data.category == category) || m_data.category.startsWith(category + QLatin1Char('/'));
+}
+
+bool BenchTorrent::setCategory(const QString &category)
+{
+    m_data.category = category;
+    return true;
+}
+
+QSet<QString> BenchTorrent::tags() const
+{
+    return m_data.tags;
+}
+
+QString BenchTorrent::tagsString() const
+{
+    QStringList tagsList = m_data.tags.values();
+    tagsList.sort();
+    return tagsList.join(", ");
+}
+
+bool BenchTorrent::hasTag(const QString &tag) const
+{
+    return m_data.tags.contains(tag);
+}
+
+bool BenchTorrent::addTag(const QString &tag)
+{
+    if (m_data.tags.contains(tag))
+        return false;
+    m_data.tags.insert(tag);
+    return true;
+}
+
+bool BenchTorrent::removeTag(const QString &tag)
+{
+    return m_data.tags.remove(tag);
+}
+
+void BenchTorrent::removeAllTags()
+{
+    m_data.tags.clear();
+}
+
+bool BenchTorrent::hasRootFolder() const
+{
+    return {};
+}
+
+int BenchTorrent::filesCount() const
+{
+    return 1;
+}
+
+int BenchTorrent::piecesCount() const
+{
+    return {};
+}
+
+int BenchTorrent::piecesHave() const
+{
+    return {};
+}
+
+qreal BenchTorrent::progress() const
+{
+    return m_data.progress;
+}
+
+QDateTime BenchTorrent::addedTime() const
+{
+    return m_data.addedTime;
+}
+
+qreal BenchTorrent::ratioLimit() const
+{
+    return USE_GLOBAL_RATIO;
+}
+
+int BenchTorrent::seedingTimeLimit() const
+{
+    return USE_GLOBAL_SEEDING_TIME;
+}
+
+QString BenchTorrent::filePath(const int index) const
+{
+    Q_UNUSED(index);
+    return {};
+}
+
+QString BenchTorrent::fileName(const int index) const
+{
+    Q_UNUSED(index);
+    return {};
+}
+
+qlonglong BenchTorrent::fileSize(const int index) const
+{
+    Q_UNUSED(index);
+    return {};
+}
+
+QStringList BenchTorrent::absoluteFilePaths() const
+{
+    return {};
+}
+
+QVector<DownloadPriority> BenchTorrent::filePriorities() const
+{
+    return {};
+}
+
+TorrentInfo BenchTorrent::info() const
+{
+    return TorrentInfo {};
+}
+
+bool BenchTorrent::isSeed() const
+{
+    return isCompleted();
+}
+
+bool BenchTorrent::isPaused() const
+{
+    return ((m_data.state == TorrentState::PausedDownloading) || (m_data.state == TorrentState::PausedUploading));
+}
+
+bool BenchTorrent::isResumed() const
+{
+    return !isPaused();
+}
+
+bool BenchTorrent::isQueued() const
+{
+    return ((m_data.state == TorrentState::QueuedDownloading) || (m_data.state == TorrentState::QueuedUploading));
+}
+
+bool BenchTorrent::isForced() const
+{
+    return ((m_data.state == TorrentState::ForcedDownloading) || (m_data.state == TorrentState::ForcedUploading));
+}
+
+bool BenchTorrent::isChecking() const
+{
+    return ((m_data.state == TorrentState::CheckingDownloading) || (m_data.state == TorrentState::CheckingUploading));
+}
+
+bool BenchTorrent::isDownloading() const
+{
+    switch (m_data.state) {
+    case TorrentState::Downloading:
+    case TorrentState::DownloadingMetadata:
+    case TorrentState::StalledDownloading:
+    case TorrentState::CheckingDownloading:
+    case TorrentState::PausedDownloading:
+    case TorrentState::QueuedDownloading:
+    case TorrentState::ForcedDownloading:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool BenchTorrent::isUploading() const
+{
+    switch (m_data.state) {
+    case TorrentState::Uploading:
+    case TorrentState::StalledUploading:
+    case TorrentState::CheckingUploading:
+    case TorrentState::QueuedUploading:
+    case TorrentState::ForcedUploading:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool BenchTorrent::isCompleted() const
+{
+    return isUploading() || (m_data.state == TorrentState::PausedUploading);
+}
+
+bool BenchTorrent::isActive() const
+{
+    return ((m_data.state == TorrentState::Downloading) || (m_data.state == TorrentState::ForcedDownloading)
+        || (m_data.state == TorrentState::Uploading) || (m_data.state == TorrentState::ForcedUploading));
+}
+
+bool BenchTorrent::isInactive() const
+{
+    return !isActive();
+}
+
+bool BenchTorrent::isErrored() const
+{
+    return ((m_data.state == TorrentState::MissingFiles) || (m_data.state == TorrentState::Error));
+}
+
+bool BenchTorrent::isSequentialDownload() const
+{
+    return {};
+}
+
+bool BenchTorrent::hasFirstLastPiecePriority() const
+{
+    return {};
+}
+
+TorrentState BenchTorrent::state() const
+{
+    return m_data.state;
+}
+
+bool BenchTorrent::hasMetadata() const
+{
+    return true;
+}
+
+bool BenchTorrent::hasMissingFiles() const
+{
+    return {};
+}
+
+bool BenchTorrent::hasError() const
+{
+    return (m_data.state == TorrentState::Error);
+}
+
+bool BenchTorrent::hasFilteredPieces() const
+{
+    return {};
+}
+
+int BenchTorrent::queuePosition() const
+{
+    return m_data.queuePosition;
+}
+
+QVector<TrackerEntry> BenchTorrent::trackers() const
+{
+    return {};
+}
+
+int BenchTorrent::trackersCount() const
+{
+    return 1;
+}
+
+QHash<QString, TrackerInfo> BenchTorrent::trackerInfos() const
+{
+    return {};
+}
+
+QVector<QUrl> BenchTorrent::urlSeeds() const
+{
+    return {};
+}
+
+QString BenchTorrent::error() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::totalDownload() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::totalUpload() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::activeTime() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::finishedTime() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::seedingTime() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::eta() const
+{
+    return MAX_ETA;
+}
+
+QVector<qreal> BenchTorrent::filesProgress() const
+{
+    return {};
+}
+
+int BenchTorrent::seedsCount() const
+{
+    return {};
+}
+
+int BenchTorrent::peersCount() const
+{
+    return {};
+}
+
+int BenchTorrent::leechsCount() const
+{
+    return {};
+}
+
+int BenchTorrent::totalSeedsCount() const
+{
+    return {};
+}
+
+int BenchTorrent::totalPeersCount() const
+{
+    return {};
+}
+
+int BenchTorrent::totalLeechersCount() const
+{
+    return {};
+}
+
+int BenchTorrent::completeCount() const
+{
+    return {};
+}
+
+int BenchTorrent::incompleteCount() const
+{
+    return {};
+}
+
+QDateTime BenchTorrent::lastSeenComplete() const
+{
+    return {};
+}
+
+QDateTime BenchTorrent::completedTime() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::timeSinceUpload() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::timeSinceDownload() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::timeSinceActivity() const
+{
+    return {};
+}
+
+int BenchTorrent::downloadLimit() const
+{
+    return {};
+}
+
+int BenchTorrent::uploadLimit() const
+{
+    return {};
+}
+
+bool BenchTorrent::superSeeding() const
+{
+    return {};
+}
+
+QVector<PeerInfo> BenchTorrent::peers() const
+{
+    return {};
+}
+
+Bitfield BenchTorrent::pieces() const
+{
+    return {};
+}
+
+Bitfield BenchTorrent::downloadingPieces() const
+{
+    return {};
+}
+
+QVector<int> BenchTorrent::pieceAvailability() const
+{
+    return {};
+}
+
+qreal BenchTorrent::distributedCopies() const
+{
+    return {};
+}
+
+qreal BenchTorrent::maxRatio() const
+{
+    return NO_RATIO_LIMIT;
+}
+
+int BenchTorrent::maxSeedingTime() const
+{
+    return NO_SEEDING_TIME_LIMIT;
+}
+
+qreal BenchTorrent::realRatio() const
+{
+    return {};
+}
+
+int BenchTorrent::uploadPayloadRate() const
+{
+    return m_data.uploadRate;
+}
+
+int BenchTorrent::downloadPayloadRate() const
+{
+    return m_data.downloadRate;
+}
+
+qlonglong BenchTorrent::totalPayloadUpload() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::totalPayloadDownload() const
+{
+    return {};
+}
+
+int BenchTorrent::connectionsCount() const
+{
+    return {};
+}
+
+int BenchTorrent::connectionsLimit() const
+{
+    return {};
+}
+
+qlonglong BenchTorrent::nextAnnounce() const
+{
+    return {};
+}
+
+QVector<qreal> BenchTorrent::availableFileFractions() const
+{
+    return {};
+}
+
+void BenchTorrent::setName(const QString &name)
+{
+    m_data.name = name;
+}
+
+void BenchTorrent::setSequentialDownload(const bool enable)
+{
+    Q_UNUSED(enable);
+}
+
+void BenchTorrent::setFirstLastPiecePriority(const bool enabled)
+{
+    Q_UNUSED(enabled);
+}
+
+void BenchTorrent::pause()
+{
+}
+
+void BenchTorrent::resume(const bool forced)
+{
+    Q_UNUSED(forced);
+}
+
+void BenchTorrent::move(const QString path)
+{
+    Q_UNUSED(path);
+}
+
+void BenchTorrent::forceReannounce(const int index)
+{
+    Q_UNUSED(index);
+}
+
+void BenchTorrent::forceDHTAnnounce()
+{
+}
+
+void BenchTorrent::forceRecheck()
+{
+}
+
+void BenchTorrent::renameFile(const int index, const QString &name)
+{
+    Q_UNUSED(index);
+    Q_UNUSED(name);
+}
+
+void BenchTorrent::prioritizeFiles(const QVector<DownloadPriority> &priorities)
+{
+    Q_UNUSED(priorities);
+}
+
+void BenchTorrent::setRatioLimit(const qreal limit)
+{
+    Q_UNUSED(limit);
+}
+
+void BenchTorrent::setSeedingTimeLimit(const int limit)
+{
+    Q_UNUSED(limit);
+}
+
+void BenchTorrent::setUploadLimit(const int limit)
+{
+    Q_UNUSED(limit);
+}
+
+void BenchTorrent::setDownloadLimit(const int limit)
+{
+    Q_UNUSED(limit);
+}
+
+void BenchTorrent::setSuperSeeding(const bool enable)
+{
+    Q_UNUSED(enable);
+}
+
+void BenchTorrent::flushCache() const
+{
+}
+
+void BenchTorrent::addTrackers(const QVector<TrackerEntry> &trackers)
+{
+    Q_UNUSED(trackers);
+}
+
+void BenchTorrent::replaceTrackers(const QVector<TrackerEntry> &trackers)
+{
+    Q_UNUSED(trackers);
+}
+
+void BenchTorrent::addUrlSeeds(const QVector<QUrl> &urlSeeds)
+{
+    Q_UNUSED(urlSeeds);
+}
+
+void BenchTorrent::removeUrlSeeds(const QVector<QUrl> &urlSeeds)
+{
+    Q_UNUSED(urlSeeds);
+}
+
+bool BenchTorrent::connectPeer(const PeerAddress &peerAddress)
+{
+    Q_UNUSED(peerAddress);
+    return {};
+}
+
+void BenchTorrent::clearPeers()
+{
+}
+
+QString BenchTorrent::createMagnetURI() const
+{
+    return QLatin1String("magnet:?xt=urn:btih:") + QString(m_data.hash);
+}
@@ -0,0 +1,204 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <QDateTime>
+#include <QSet>
+#include <QString>
+
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/torrenthandle.h"
+
+// Torrent that only holds the synthetic data the benchmarks need,
+// it isn't backed by libtorrent so any number of them can be created
+class BenchTorrent final : public BitTorrent::TorrentHandle
+{
+public:
+    struct Data
+    {
+        BitTorrent::InfoHash hash;
+        QString name;
+        QString savePath;
+        QString category;
+        QSet<QString> tags;
+        QString tracker;
+        BitTorrent::TorrentState state = BitTorrent::TorrentState::Unknown;
+        qlonglong size = 0;
+        qreal progress = 0;
+        int queuePosition = -1;
+        int uploadRate = 0;
+        int downloadRate = 0;
+        QDateTime addedTime;
+    };
+
+    explicit BenchTorrent(const Data &data);
+
+    // Generates the same set of torrents for the same count, so the results are comparable
+    static std::vector<std::unique_ptr<BenchTorrent>> generate(int count);
+
+    // Mutates some of the torrents like the periodic status updates would do
+    static void update(const std::vector<std::unique_ptr<BenchTorrent>> &torrents, int round);
+
+    BitTorrent::InfoHash hash() const override;
+    QString name() const override;
+    QDateTime creationDate() const override;
+    QString creator() const override;
+    QString comment() const override;
+    bool isPrivate() const override;
+    qlonglong totalSize() const override;
+    qlonglong wantedSize() const override;
+    qlonglong completedSize() const override;
+    qlonglong incompletedSize() const override;
+    qlonglong pieceLength() const override;
+    qlonglong wastedSize() const override;
+    QString currentTracker() const override;
+    QString savePath(bool actual = false) const override;
+    QString rootPath(bool actual = false) const override;
+    QString contentPath(bool actual = false) const override;
+    bool useTempPath() const override;
+    bool isAutoTMMEnabled() const override;
+    void setAutoTMMEnabled(bool enabled) override;
+    QString category() const override;
+    bool belongsToCategory(const QString &category) const override;
+    bool setCategory(const QString &category) override;
+    QSet<QString> tags() const override;
+    QString tagsString() const override;
+    bool hasTag(const QString &tag) const override;
+    bool addTag(const QString &tag) override;
+    bool removeTag(const QString &tag) override;
+    void removeAllTags() override;
+    bool hasRootFolder() const override;
+    int filesCount() const override;
+    int piecesCount() const override;
+    int piecesHave() const override;
+    qreal progress() const override;
+    QDateTime addedTime() const override;
+    qreal ratioLimit() const override;
+    int seedingTimeLimit() const override;
+    QString filePath(int index) const override;
+    QString fileName(int index) const override;
+    qlonglong fileSize(int index) const override;
+    QStringList absoluteFilePaths() const override;
+    QVector<BitTorrent::DownloadPriority> filePriorities() const override;
+    BitTorrent::TorrentInfo info() const override;
+    bool isSeed() const override;
+    bool isPaused() const override;
+    bool isResumed() const override;
+    bool isQueued() const override;
+    bool isForced() const override;
+    bool isChecking() const override;
+    bool isDownloading() const override;
+    bool isUploading() const override;
+    bool isCompleted() const override;
+    bool isActive() const override;
+    bool isInactive() const override;
+    bool isErrored() const override;
+    bool isSequentialDownload() const override;
+    bool hasFirstLastPiecePriority() const override;
+    BitTorrent::TorrentState state() const override;
+    bool hasMetadata() const override;
+    bool hasMissingFiles() const override;
+    bool hasError() const override;
+    bool hasFilteredPieces() const override;
+    int queuePosition() const override;
+    QVector<BitTorrent::TrackerEntry> trackers() const override;
+    int trackersCount() const override;
+    QHash<QString, BitTorrent::TrackerInfo> trackerInfos() const override;
+    QVector<QUrl> urlSeeds() const override;
+    QString error() const override;
+    qlonglong totalDownload() const override;
+    qlonglong totalUpload() const override;
+    qlonglong activeTime() const override;
+    qlonglong finishedTime() const override;
+    qlonglong seedingTime() const override;
+    qlonglong eta() const override;
+    QVector<qreal> filesProgress() const override;
+    int seedsCount() const override;
+    int peersCount() const override;
+    int leechsCount() const override;
+    int totalSeedsCount() const override;
+    int totalPeersCount() const override;
+    int totalLeechersCount() const override;
+    int completeCount() const override;
+    int incompleteCount() const override;
+    QDateTime lastSeenComplete() const override;
+    QDateTime completedTime() const override;
+    qlonglong timeSinceUpload() const override;
+    qlonglong timeSinceDownload() const override;
+    qlonglong timeSinceActivity() const override;
+    int downloadLimit() const override;
+    int uploadLimit() const override;
+    bool superSeeding() const override;
+    QVector<BitTorrent::PeerInfo> peers() const override;
+    Bitfield pieces() const override;
+    Bitfield downloadingPieces() const override;
+    QVector<int> pieceAvailability() const override;
+    qreal distributedCopies() const override;
+    qreal maxRatio() const override;
+    int maxSeedingTime() const override;
+    qreal realRatio() const override;
+    int uploadPayloadRate() const override;
+    int downloadPayloadRate() const override;
+    qlonglong totalPayloadUpload() const override;
+    qlonglong totalPayloadDownload() const override;
+    int connectionsCount() const override;
+    int connectionsLimit() const override;
+    qlonglong nextAnnounce() const override;
+    QVector<qreal> availableFileFractions() const override;
+    void setName(const QString &name) override;
+    void setSequentialDownload(bool enable) override;
+    void setFirstLastPiecePriority(bool enabled) override;
+    void pause() override;
+    void resume(bool forced = false) override;
+    void move(QString path) override;
+    void forceReannounce(int index = -1) override;
+    void forceDHTAnnounce() override;
+    void forceRecheck() override;
+    void renameFile(int index, const QString &name) override;
+    void prioritizeFiles(const QVector<BitTorrent::DownloadPriority> &priorities) override;
+    void setRatioLimit(qreal limit) override;
+    void setSeedingTimeLimit(int limit) override;
+    void setUploadLimit(int limit) override;
+    void setDownloadLimit(int limit) override;
+    void setSuperSeeding(bool enable) override;
+    void flushCache() const override;
+    void addTrackers(const QVector<BitTorrent::TrackerEntry> &trackers) override;
+    void replaceTrackers(const QVector<BitTorrent::TrackerEntry> &trackers) override;
+    void addUrlSeeds(const QVector<QUrl> &urlSeeds) override;
+    void removeUrlSeeds(const QVector<QUrl> &urlSeeds) override;
+    bool connectPeer(const BitTorrent::PeerAddress &peerAddress) override;
+    void clearPeers() override;
+    QString createMagnetURI() const override;
+
+private:
+    Data m_data;
+};
@@ -0,0 +1,140 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <algorithm>
+
+#include <QByteArray>
+#include <QVector>
+
+#include "base/http/requestparser.h"
+#include "benchmarkrunner.h"
+#include "benchmarks.h"
+
+namespace
+{
+    QByteArray makeGetRequest(const int rid)
+    {
+        return QByteArray("GET /api/v2/sync/maindata?rid=") + QByteArray::number(rid) + " HTTP/1.1\r\n"
+            "Host: localhost:8080\r\n"
+            "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:78.0) Gecko/20100101 Firefox/78.0\r\n"
+            "Accept: */*\r\n"
+            "Accept-Language: en-US,en;q=0.5\r\n"
+            "Accept-Encoding: gzip, deflate\r\n"
+            "Referer: http://localhost:8080/\r\n"
+            "Connection: keep-alive\r\n"
+            "Cookie: SID=Dd1lCvYwEYbZ3Y4jXSokRsLqDwVOmYgE\r\n"
+            "\r\n";
+    }
+
+    QByteArray makeFormPostRequest(const int hashCount)
+    {
+        QByteArray content = "hashes=";
+        for (int i = 0; i < hashCount; ++i) {
+            if (i > 0)
+                content += "%7C";
+            content += QByteArray::number((0x1000000000000000LL + i), 16).repeated(2).left(40);
+        }
+        content += "&deleteFiles=false";
+
+        return QByteArray("POST /api/v2/torrents/delete HTTP/1.1\r\n"
+            "Host: localhost:8080\r\n"
+            "Content-Type: application/x-www-form-urlencoded; charset=UTF-8\r\n"
+            "Content-Length: ") + QByteArray::number(content.size()) + "\r\n"
+            "Cookie: SID=Dd1lCvYwEYbZ3Y4jXSokRsLqDwVOmYgE\r\n"
+            "\r\n" + content;
+    }
+
+    QByteArray makeUploadRequest(const int fileCount, const int fileSize)
+    {
+        const QByteArray boundary = "----qbtBenchBoundary7MA4YWxkTrZu0gW";
+
+        QByteArray content;
+        for (int i = 0; i < fileCount; ++i) {
+            content += "--" + boundary + "\r\n"
+                "Content-Disposition: form-data; name=\"torrents\"; filename=\"file" + QByteArray::number(i) + ".torrent\"\r\n"
+                "Content-Type: application/x-bittorrent\r\n"
+                "\r\n";
+            content += QByteArray(fileSize, static_cast<char>('a' + (i % 26)));
+            content += "\r\n";
+        }
+        content += "--" + boundary + "\r\n"
+            "Content-Disposition: form-data; name=\"savepath\"\r\n"
+            "\r\n"
+            "/data/torrents\r\n"
+            "--" + boundary + "--\r\n";
+
+        return QByteArray("POST /api/v2/torrents/add HTTP/1.1\r\n"
+            "Host: localhost:8080\r\n"
+            "Content-Type: multipart/form-data; boundary=") + boundary + "\r\n"
+            "Content-Length: " + QByteArray::number(content.size()) + "\r\n"
+            "\r\n" + content;
+    }
+
+    void parseAll(const QVector<QByteArray> &requests)
+    {
+        for (const QByteArray &data : requests) {
+            Http::RequestParser parser;
+            const Http::RequestParser::ParseResult result = parser.parse(data);
+            BenchmarkRunner::consume(static_cast<qint64>(result.status) + result.frameSize);
+        }
+    }
+}
+
+void Benchmarks::runHttp(BenchmarkRunner &runner, const BenchmarkConfig &config)
+{
+    QVector<QByteArray> getRequests;
+    getRequests.reserve(config.scale);
+    for (int i = 0; i < config.scale; ++i)
+        getRequests.append(makeGetRequest(i));
+    runner.run(QLatin1String("http/parse/get"), getRequests.size(), [&getRequests]() { parseAll(getRequests); });
+
+    const int postCount = std::max(1, (config.scale / 10));
+    const QVector<QByteArray> postRequests(postCount, makeFormPostRequest(100));
+    runner.run(QLatin1String("http/parse/form_post"), postRequests.size(), [&postRequests]() { parseAll(postRequests); });
+
+    const int uploadCount = std::max(1, (config.scale / 1000));
+    const QVector<QByteArray> uploadRequests(uploadCount, makeUploadRequest(10, (100 * 1024)));
+    runner.run(QLatin1String("http/parse/multipart_upload"), uploadRequests.size(), [&uploadRequests]() { parseAll(uploadRequests); });
+
+    // large request arriving in pieces, as it is read from the socket
+    const QByteArray largeRequest = makeUploadRequest(4, (2 * 1024 * 1024));
+    const int pieceSize = 16 * 1024;
+    runner.run(QLatin1String("http/parse/incremental_8MiB"), 1, [&largeRequest, pieceSize]()
+    {
+        Http::RequestParser parser;
+        QByteArray buffer;
+        for (int received = 0; received < largeRequest.size(); received += pieceSize) {
+            buffer.append((largeRequest.constData() + received), std::min(pieceSize, (largeRequest.size() - received)));
+            const Http::RequestParser::ParseResult result = parser.parse(buffer);
+            if (result.status != Http::RequestParser::ParseStatus::Incomplete) {
+                BenchmarkRunner::consume(result.frameSize);
+                break;
+            }
+        }
+    });
+}
@@ -0,0 +1,110 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QFile>
+#include <QString>
+
+#include "base/bittorrent/filterparserthread.h"
+#include "benchmarkrunner.h"
+#include "benchmarks.h"
+
+namespace
+{
+    QByteArray ipv4Address(const quint32 address)
+    {
+        return QByteArray::number((address >> 24) & 0xFF) + '.' + QByteArray::number((address >> 16) & 0xFF)
+            + '.' + QByteArray::number((address >> 8) & 0xFF) + '.' + QByteArray::number(address & 0xFF);
+    }
+
+    bool writeFilterFile(const QString &path, const int ruleCount, const bool isDAT)
+    {
+        QFile file {path};
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        QByteArray data;
+        for (int i = 0; i < ruleCount; ++i) {
+            // non-overlapping ranges spread over the address space
+            const quint32 start = (0x01000000u + (static_cast<quint32>(i) * 0x400u));
+            const quint32 end = (start + 0xFFu);
+            if (isDAT)
+                data += ipv4Address(start) + " - " + ipv4Address(end) + " , 000 , Synthetic range " + QByteArray::number(i) + '\n';
+            else
+                data += "Synthetic range " + QByteArray::number(i) + ':' + ipv4Address(start) + '-' + ipv4Address(end) + '\n';
+
+            if (data.size() > (1024 * 1024)) {
+                file.write(data);
+                data.clear();
+            }
+        }
+        file.write(data);
+        return true;
+    }
+
+    void parse(FilterParserThread &parser, const QString &path)
+    {
+        // the parsing is done in the parser thread so it can't be optimized out
+        parser.processFilterFile(path);
+        parser.wait();
+    }
+
+    void runFormat(BenchmarkRunner &runner, const BenchmarkConfig &config, const bool isDAT)
+    {
+        const QString format = (isDAT ? QLatin1String("dat") : QLatin1String("p2p"));
+        const QString parseName = QLatin1String("ipfilter/parse/") + format;
+        const QString cachedName = QLatin1String("ipfilter/load_cached/") + format;
+        if (!runner.isSelected(parseName) && !runner.isSelected(cachedName))
+            return;
+
+        const int ruleCount = (config.scale * 20);
+        // The parsed ranges are cached for the last loaded file, the same content under
+        // two different names is loaded alternately to measure the parsing itself
+        const QString paths[] = {
+            (config.workDir + QLatin1String("/blocklist1.") + format),
+            (config.workDir + QLatin1String("/blocklist2.") + format)
+        };
+        for (const QString &path : paths) {
+            if (!writeFilterFile(path, ruleCount, isDAT))
+                return;
+        }
+
+        FilterParserThread parser;
+        int round = 0;
+        runner.run(parseName, ruleCount, [&parser, &paths, &round]() { parse(parser, paths[round++ % 2]); });
+        runner.run(cachedName, ruleCount, [&parser, &paths]() { parse(parser, paths[0]); });
+
+        for (const QString &path : paths)
+            QFile::remove(path);
+    }
+}
+
+void Benchmarks::runIPFilter(BenchmarkRunner &runner, const BenchmarkConfig &config)
+{
+    runFormat(runner, config, true);
+    runFormat(runner, config, false);
+}
@@ -0,0 +1,190 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include "base/logger.h"
+#include "base/profile.h"
+#include "benchmarkrunner.h"
+#include "benchmarks.h"
+#include "webuiloadgenerator.h"
+
+namespace
+{
+    bool writeResult(const QJsonObject &result, const QString &path)
+    {
+        const QByteArray data = QJsonDocument(result).toJson();
+        if (path == QLatin1String("-")) {
+            QTextStream(stdout) << data;
+            return true;
+        }
+
+        QFile file {path};
+        if (!file.open(QIODevice::WriteOnly) || (file.write(data) != data.size())) {
+            QTextStream(stderr) << "Couldn't write the results to " << path << endl;
+            return false;
+        }
+        return true;
+    }
+
+    QJsonObject environment()
+    {
+        return {
+            {"version", QBT_VERSION},
+            {"qt_version", qVersion()},
+            {"os", QSysInfo::prettyProductName()},
+            {"cpu", QSysInfo::currentCpuArchitecture()}
+        };
+    }
+
+    int runBenchmarks(const QCommandLineParser &parser, const QCommandLineOption &filterOption
+                      , const QCommandLineOption &iterationsOption, const QCommandLineOption &scaleOption
+                      , const QCommandLineOption &jsonOption)
+    {
+        const QRegularExpression filter {parser.value(filterOption)};
+        if (!filter.isValid()) {
+            QTextStream(stderr) << "Invalid filter: " << filter.errorString() << endl;
+            return EXIT_FAILURE;
+        }
+
+        QTemporaryDir workDir;
+        if (!workDir.isValid()) {
+            QTextStream(stderr) << "Couldn't create the temporary directory" << endl;
+            return EXIT_FAILURE;
+        }
+
+        // some of the benchmarked code stores its data in the profile
+        Profile::initInstance(workDir.path(), {}, false);
+        Logger::initInstance();
+
+        BenchmarkConfig config;
+        config.scale = std::max(1, parser.value(scaleOption).toInt());
+        config.workDir = workDir.path();
+
+        BenchmarkRunner runner {parser.value(iterationsOption).toInt(), filter};
+        Benchmarks::runHttp(runner, config);
+        Benchmarks::runTorrents(runner, config);
+        Benchmarks::runIPFilter(runner, config);
+        Benchmarks::runRSS(runner, config);
+        Benchmarks::runTracker(runner, config);
+        Benchmarks::runStorage(runner, config);
+
+        Logger::freeInstance();
+        Profile::freeInstance();
+
+        if (!parser.isSet(jsonOption)) {
+            QTextStream(stdout) << runner.toText();
+            return EXIT_SUCCESS;
+        }
+
+        QJsonObject result = runner.toJson();
+        result[QLatin1String("environment")] = environment();
+        result[QLatin1String("scale")] = config.scale;
+        return (writeResult(result, parser.value(jsonOption)) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app {argc, argv};
+    QCoreApplication::setApplicationName(QLatin1String("qbt-bench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QLatin1String(
+        "Runs the qBittorrent benchmarks on synthetic data or generates load on the Web API of a running instance."));
+    parser.addHelpOption();
+
+    const QCommandLineOption filterOption {QLatin1String("filter")
+        , QLatin1String("Runs only the benchmarks which names match the regular expression.")
+        , QLatin1String("regex"), QLatin1String(".*")};
+    const QCommandLineOption iterationsOption {QLatin1String("iterations")
+        , QLatin1String("Number of the measured runs of each benchmark."), QLatin1String("n"), QLatin1String("5")};
+    const QCommandLineOption scaleOption {QLatin1String("scale")
+        , QLatin1String("Base number of the synthetic items (torrents, requests, articles...)."), QLatin1String("n"), QLatin1String("10000")};
+    const QCommandLineOption jsonOption {QLatin1String("json")
+        , QLatin1String("Writes the results in JSON format to the file (\"-\" for standard output)."), QLatin1String("file")};
+    const QCommandLineOption webuiOption {QLatin1String("webui")
+        , QLatin1String("Generates load on the Web API at the URL instead of running the benchmarks."), QLatin1String("url")};
+    const QCommandLineOption usernameOption {QLatin1String("username")
+        , QLatin1String("Web UI username."), QLatin1String("name"), QLatin1String("admin")};
+    const QCommandLineOption passwordOption {QLatin1String("password")
+        , QLatin1String("Web UI password."), QLatin1String("password"), QLatin1String("adminadmin")};
+    const QCommandLineOption clientsOption {QLatin1String("clients")
+        , QLatin1String("Number of the concurrent Web API clients."), QLatin1String("n"), QLatin1String("4")};
+    const QCommandLineOption requestsOption {QLatin1String("requests")
+        , QLatin1String("Total number of the Web API requests."), QLatin1String("n"), QLatin1String("1000")};
+    const QCommandLineOption endpointsOption {QLatin1String("endpoints")
+        , QLatin1String("Comma separated Web API methods the clients request in turn.")
+        , QLatin1String("list"), QLatin1String("sync/maindata,torrents/info,transfer/info")};
+    parser.addOptions({filterOption, iterationsOption, scaleOption, jsonOption, webuiOption
+                       , usernameOption, passwordOption, clientsOption, requestsOption, endpointsOption});
+    parser.process(app);
+
+    if (!parser.isSet(webuiOption))
+        return runBenchmarks(parser, filterOption, iterationsOption, scaleOption, jsonOption);
+
+    WebUILoadGenerator::Options options;
+    options.url = QUrl {parser.value(webuiOption)};
+    options.username = parser.value(usernameOption);
+    options.password = parser.value(passwordOption);
+    options.clientCount = parser.value(clientsOption).toInt();
+    options.requestCount = parser.value(requestsOption).toInt();
+    options.endpoints = parser.value(endpointsOption).split(QLatin1Char(','), QString::SkipEmptyParts);
+    if (!options.url.isValid() || options.endpoints.isEmpty()) {
+        QTextStream(stderr) << "Invalid Web UI URL or endpoints" << endl;
+        return EXIT_FAILURE;
+    }
+
+    WebUILoadGenerator generator {options};
+    int exitCode = EXIT_FAILURE;
+    QObject::connect(&generator, &WebUILoadGenerator::finished, &app, [&](const bool success)
+    {
+        QJsonObject result = generator.result();
+        result[QLatin1String("environment")] = environment();
+
+        const QString path = parser.isSet(jsonOption) ? parser.value(jsonOption) : QLatin1String("-");
+        if (success && writeResult(result, path))
+            exitCode = EXIT_SUCCESS;
+        app.quit();
+    });
+    generator.start();
+    app.exec();
+
+    return exitCode;
+}
@@ -0,0 +1,113 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QByteArray>
+#include <QDateTime>
+
+#include "base/rss/rss_parser.h"
+#include "benchmarkrunner.h"
+#include "benchmarks.h"
+
+namespace
+{
+    QByteArray makeRSSDocument(const int articleCount)
+    {
+        const QDateTime baseTime = QDateTime::fromSecsSinceEpoch(1577836800);  // 2020-01-01
+
+        QByteArray data = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<rss version=\"2.0\" xmlns:torrent=\"http://xmlns.ezrss.it/0.1/\">\n"
+            "<channel>\n"
+            "<title>Synthetic feed</title>\n"
+            "<link>https://feed.example.org/</link>\n"
+            "<description>Generated by qbt-bench</description>\n"
+            "<lastBuildDate>" + baseTime.toString(Qt::RFC2822Date).toLatin1() + "</lastBuildDate>\n";
+        for (int i = 0; i < articleCount; ++i) {
+            const QByteArray id = QByteArray::number(i);
+            data += "<item>\n"
+                "<title>Synthetic.Show.S01E" + id + ".1080p.WEB.h264 &amp; more</title>\n"
+                "<guid isPermaLink=\"false\">synthetic-" + id + "</guid>\n"
+                "<link>https://feed.example.org/download/" + id + ".torrent</link>\n"
+                "<description><![CDATA[<p>Episode " + id + " of the <b>synthetic</b> show</p>]]></description>\n"
+                "<pubDate>" + baseTime.addSecs(i * 60).toString(Qt::RFC2822Date).toLatin1() + "</pubDate>\n"
+                "<category>TV</category>\n"
+                "<enclosure url=\"https://feed.example.org/download/" + id + ".torrent\" length=\"12345\" type=\"application/x-bittorrent\"/>\n"
+                "<torrent:contentLength>1073741824</torrent:contentLength>\n"
+                "</item>\n";
+        }
+        data += "</channel>\n</rss>\n";
+        return data;
+    }
+
+    QByteArray makeAtomDocument(const int articleCount)
+    {
+        const QDateTime baseTime = QDateTime::fromSecsSinceEpoch(1577836800);  // 2020-01-01
+
+        QByteArray data = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<feed xmlns=\"http://www.w3.org/2005/Atom\">\n"
+            "<title>Synthetic feed</title>\n"
+            "<updated>" + baseTime.toString(Qt::ISODate).toLatin1() + "</updated>\n";
+        for (int i = 0; i < articleCount; ++i) {
+            const QByteArray id = QByteArray::number(i);
+            data += "<entry>\n"
+                "<title>Synthetic.Show.S01E" + id + ".1080p.WEB.h264</title>\n"
+                "<id>urn:synthetic:" + id + "</id>\n"
+                "<link rel=\"enclosure\" href=\"https://feed.example.org/download/" + id + ".torrent\"/>\n"
+                "<updated>" + baseTime.addSecs(i * 60).toString(Qt::ISODate).toLatin1() + "</updated>\n"
+                "<summary type=\"html\">Episode " + id + " of the &lt;b&gt;synthetic&lt;/b&gt; show</summary>\n"
+                "<author><name>qbt-bench</name></author>\n"
+                "</entry>\n";
+        }
+        data += "</feed>\n";
+        return data;
+    }
+}
+
+void Benchmarks::runRSS(BenchmarkRunner &runner, const BenchmarkConfig &config)
+{
+    const int articleCount = config.scale;
+
+    const QString rssName = QLatin1String("rss/parse/rss2");
+    if (runner.isSelected(rssName)) {
+        const QByteArray document = makeRSSDocument(articleCount);
+        runner.run(rssName, articleCount, [&document]()
+        {
+            RSS::Private::Parser parser {QString {}};
+            BenchmarkRunner::consume(parser.parse(document).articles.size());
+        });
+    }
+
+    const QString atomName = QLatin1String("rss/parse/atom");
+    if (runner.isSelected(atomName)) {
+        const QByteArray document = makeAtomDocument(articleCount);
+        runner.run(atomName, articleCount, [&document]()
+        {
+            RSS::Private::Parser parser {QString {}};
+            BenchmarkRunner::consume(parser.parse(document).articles.size());
+        });
+    }
+}
@@ -0,0 +1,164 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <libtorrent/download_priority.hpp>
+#include <libtorrent/file_pool.hpp>
+#include <libtorrent/file_storage.hpp>
+#include <libtorrent/sha1_hash.hpp>
+#include <libtorrent/storage.hpp>
+#include <libtorrent/storage_defs.hpp>
+
+#include <QDir>
+#include <QStringList>
+
+#include "base/bittorrent/customstorage.h"
+#include "benchmarkrunner.h"
+#include "benchmarks.h"
+
+#ifdef QBT_USES_IO_URING
+#include "base/bittorrent/iouringstorage.h"
+#endif
+
+namespace
+{
+    // libtorrent reads and writes the data in blocks of this size
+    const int BLOCK_SIZE = 16 * 1024;
+    const int PIECE_SIZE = 1024 * 1024;
+    const int FILE_COUNT = 16;
+
+    using StorageConstructor = std::function<lt::storage_interface *(const lt::storage_params &params, lt::file_pool &pool)>;
+
+    struct Block
+    {
+        lt::piece_index_t piece;
+        int offset;
+    };
+
+    void runBackend(BenchmarkRunner &runner, const BenchmarkConfig &config, const QString &backend
+                    , const StorageConstructor &constructor)
+    {
+        const QString prefix = QLatin1String("storage/") + backend + QLatin1Char('/');
+        const QStringList names {
+            QLatin1String("write_blocks"), QLatin1String("read_blocks")
+            , QLatin1String("read_random_blocks"), QLatin1String("write_pieces"), QLatin1String("read_pieces")};
+        const bool isAnySelected = std::any_of(names.cbegin(), names.cend(), [&runner, &prefix](const QString &name)
+        {
+            return runner.isSelected(prefix + name);
+        });
+        if (!isAnySelected)
+            return;
+
+        const std::int64_t totalSize = static_cast<std::int64_t>(config.scale) * BLOCK_SIZE;
+        lt::file_storage fileStorage;
+        for (int i = 0; i < FILE_COUNT; ++i)
+            fileStorage.add_file(("bench/file" + std::to_string(i)), ((totalSize / FILE_COUNT) + i));
+        fileStorage.set_piece_length(PIECE_SIZE);
+        fileStorage.set_num_pieces(static_cast<int>((fileStorage.total_size() + PIECE_SIZE - 1) / PIECE_SIZE));
+
+        const QString savePath = config.workDir + QLatin1String("/storage-") + backend;
+        QDir().mkpath(savePath);
+
+        const lt::aux::vector<lt::download_priority_t, lt::file_index_t> priorities;
+        const lt::storage_params params {fileStorage, nullptr, savePath.toStdString(), lt::storage_mode_sparse, priorities, lt::sha1_hash {}};
+        lt::file_pool filePool {64};
+        const std::unique_ptr<lt::storage_interface> storage {constructor(params, filePool)};
+
+        lt::storage_error error;
+        storage->initialize(error);
+
+        std::vector<Block> blocks;
+        for (const lt::piece_index_t piece : fileStorage.piece_range()) {
+            for (int offset = 0; offset < fileStorage.piece_size(piece); offset += BLOCK_SIZE)
+                blocks.push_back({piece, offset});
+        }
+        std::vector<Block> randomBlocks = blocks;
+        std::shuffle(randomBlocks.begin(), randomBlocks.end(), std::mt19937 {static_cast<std::mt19937::result_type>(blocks.size())});
+
+        std::vector<char> buffer(PIECE_SIZE, 'x');
+        const auto transferBlocks = [&storage, &buffer](const std::vector<Block> &blocks, const bool isWrite)
+        {
+            qint64 transferred = 0;
+            for (const Block &block : blocks) {
+                const lt::iovec_t buf {buffer.data(), BLOCK_SIZE};
+                lt::storage_error ec;
+                transferred += (isWrite ? storage->writev(buf, block.piece, block.offset, {}, ec)
+                                        : storage->readv(buf, block.piece, block.offset, {}, ec));
+            }
+            BenchmarkRunner::consume(transferred);
+        };
+        // libtorrent flushes the contiguous blocks of a piece with a single call
+        const auto transferPieces = [&storage, &buffer, &fileStorage](const bool isWrite)
+        {
+            qint64 transferred = 0;
+            std::vector<lt::iovec_t> bufs;
+            for (const lt::piece_index_t piece : fileStorage.piece_range()) {
+                bufs.clear();
+                for (int offset = 0; offset < fileStorage.piece_size(piece); offset += BLOCK_SIZE)
+                    bufs.emplace_back((buffer.data() + offset), std::min(BLOCK_SIZE, (fileStorage.piece_size(piece) - offset)));
+                lt::storage_error ec;
+                transferred += (isWrite ? storage->writev(bufs, piece, 0, {}, ec)
+                                        : storage->readv(bufs, piece, 0, {}, ec));
+            }
+            BenchmarkRunner::consume(transferred);
+        };
+
+        // The data is mostly served from the page cache, the figures show
+        // the overhead of the storage rather than the speed of the drive
+        const qint64 blockCount = static_cast<qint64>(blocks.size());
+        runner.run((prefix + QLatin1String("write_blocks")), blockCount, [&]() { transferBlocks(blocks, true); });
+        runner.run((prefix + QLatin1String("read_blocks")), blockCount, [&]() { transferBlocks(blocks, false); });
+        runner.run((prefix + QLatin1String("read_random_blocks")), blockCount, [&]() { transferBlocks(randomBlocks, false); });
+        runner.run((prefix + QLatin1String("write_pieces")), fileStorage.num_pieces(), [&]() { transferPieces(true); });
+        runner.run((prefix + QLatin1String("read_pieces")), fileStorage.num_pieces(), [&]() { transferPieces(false); });
+
+        storage->release_files(error);
+        QDir(savePath).removeRecursively();
+    }
+}
+
+void Benchmarks::runStorage(BenchmarkRunner &runner, const BenchmarkConfig &config)
+{
+    runBackend(runner, config, QLatin1String("default"), [](const lt::storage_params &params, lt::file_pool &pool)
+    {
+        return new CustomStorage {params, pool};
+    });
+
+#ifdef QBT_USES_IO_URING
+    runBackend(runner, config, QLatin1String("io_uring"), [](const lt::storage_params &params, lt::file_pool &pool)
+    {
+        return new IOUringStorage {params, pool};
+    });
+#endif
+}
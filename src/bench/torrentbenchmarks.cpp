@@ -0,0 +1,129 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <algorithm>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QStringList>
+#include <QVariantMap>
+
+#include "base/torrentfilter.h"
+#include "benchmarkrunner.h"
+#include "benchmarks.h"
+#include "benchtorrent.h"
+
+#ifndef DISABLE_WEBUI
+#include "webui/api/serialize/serialize_torrent.h"
+#endif
+
+namespace
+{
+    using Torrents = std::vector<std::unique_ptr<BenchTorrent>>;
+
+    void runFilter(BenchmarkRunner &runner, const QString &name, const Torrents &torrents, const TorrentFilter &filter)
+    {
+        runner.run(name, torrents.size(), [&torrents, &filter]()
+        {
+            qint64 matched = 0;
+            for (const std::unique_ptr<BenchTorrent> &torrent : torrents) {
+                if (filter.match(torrent.get()))
+                    ++matched;
+            }
+            BenchmarkRunner::consume(matched);
+        });
+    }
+}
+
+void Benchmarks::runTorrents(BenchmarkRunner &runner, const BenchmarkConfig &config)
+{
+    for (const int count : {config.scale, (config.scale * 10)}) {
+        const QString suffix = QLatin1Char('/') + QString::number(count);
+
+        // generating the torrents takes a while so it is skipped when none of them is needed
+        const QStringList names {
+            QLatin1String("filter/all"), QLatin1String("filter/downloading"), QLatin1String("filter/stalled")
+            , QLatin1String("filter/category"), QLatin1String("filter/tag"), QLatin1String("filter/hashes")
+            , QLatin1String("sort/name"), QLatin1String("serialize"), QLatin1String("serialize_json")};
+        const bool isAnySelected = std::any_of(names.cbegin(), names.cend(), [&runner, &suffix](const QString &name)
+        {
+            return runner.isSelected(QLatin1String("torrents/") + name + suffix);
+        });
+        if (!isAnySelected)
+            continue;
+
+        const Torrents torrents = BenchTorrent::generate(count);
+
+        runFilter(runner, (QLatin1String("torrents/filter/all") + suffix), torrents, TorrentFilter {TorrentFilter::All});
+        runFilter(runner, (QLatin1String("torrents/filter/downloading") + suffix), torrents, TorrentFilter {TorrentFilter::Downloading});
+        runFilter(runner, (QLatin1String("torrents/filter/stalled") + suffix), torrents, TorrentFilter {TorrentFilter::Stalled});
+        runFilter(runner, (QLatin1String("torrents/filter/category") + suffix), torrents
+                  , TorrentFilter {TorrentFilter::All, TorrentFilter::AnyHash, QLatin1String("category7")});
+        runFilter(runner, (QLatin1String("torrents/filter/tag") + suffix), torrents
+                  , TorrentFilter {TorrentFilter::All, TorrentFilter::AnyHash, TorrentFilter::AnyCategory, QLatin1String("tag13")});
+
+        QStringSet hashes;
+        for (std::size_t i = 0; i < torrents.size(); i += 10)
+            hashes.insert(torrents[i]->hash());
+        runFilter(runner, (QLatin1String("torrents/filter/hashes") + suffix), torrents, TorrentFilter {TorrentFilter::All, hashes});
+
+        runner.run((QLatin1String("torrents/sort/name") + suffix), count, [&torrents]()
+        {
+            std::vector<const BenchTorrent *> sorted;
+            sorted.reserve(torrents.size());
+            for (const std::unique_ptr<BenchTorrent> &torrent : torrents)
+                sorted.push_back(torrent.get());
+            std::sort(sorted.begin(), sorted.end(), [](const BenchTorrent *left, const BenchTorrent *right)
+            {
+                return (QString::localeAwareCompare(left->name(), right->name()) < 0);
+            });
+            BenchmarkRunner::consume(sorted.front()->queuePosition());
+        });
+
+#ifndef DISABLE_WEBUI
+        int round = 0;
+        runner.run((QLatin1String("torrents/serialize") + suffix), count, [&torrents]()
+        {
+            qint64 size = 0;
+            for (const std::unique_ptr<BenchTorrent> &torrent : torrents)
+                size += serialize(*torrent).size();
+            BenchmarkRunner::consume(size);
+        }
+        , [&torrents, &round]() { BenchTorrent::update(torrents, round++); });
+
+        runner.run((QLatin1String("torrents/serialize_json") + suffix), count, [&torrents]()
+        {
+            QJsonObject result;
+            for (const std::unique_ptr<BenchTorrent> &torrent : torrents)
+                result[torrent->hash()] = QJsonObject::fromVariantMap(serialize(*torrent));
+            BenchmarkRunner::consume(QJsonDocument(result).toJson(QJsonDocument::Compact).size());
+        });
+#endif
+    }
+}
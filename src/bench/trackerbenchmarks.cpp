@@ -0,0 +1,112 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <algorithm>
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QHostAddress>
+#include <QVector>
+
+#include "base/bittorrent/tracker.h"
+#include "base/http/irequesthandler.h"
+#include "base/http/types.h"
+#include "benchmarkrunner.h"
+#include "benchmarks.h"
+
+namespace
+{
+    struct Announce
+    {
+        Http::Request request;
+        Http::Environment env;
+    };
+
+    QVector<Announce> makeAnnounces(const int torrentCount, const int peerCount)
+    {
+        QVector<Announce> announces;
+        announces.reserve(torrentCount * peerCount);
+
+        for (int peer = 0; peer < peerCount; ++peer) {
+            const QByteArray peerID = QByteArray("-qB4300-") + QByteArray::number(peer).rightJustified(12, '0');
+            const QHostAddress address {static_cast<quint32>(0x0A000000u + peer)};  // 10.x.x.x
+
+            for (int torrent = 0; torrent < torrentCount; ++torrent) {
+                Announce announce;
+                announce.request.method = QLatin1String(Http::HEADER_REQUEST_METHOD_GET);
+                announce.request.path = QLatin1String("/announce");
+                announce.request.query = {
+                    {QLatin1String("info_hash"), QCryptographicHash::hash(QByteArray::number(torrent), QCryptographicHash::Sha1)},
+                    {QLatin1String("peer_id"), peerID},
+                    {QLatin1String("port"), QByteArray::number(6881 + (peer % 1000))},
+                    {QLatin1String("left"), ((peer % 4) == 0) ? QByteArray("0") : QByteArray("1048576")},
+                    {QLatin1String("compact"), "1"},
+                    {QLatin1String("numwant"), "50"},
+                    {QLatin1String("event"), "started"}
+                };
+                announce.env = {QHostAddress::LocalHost, 9000, address, static_cast<quint16>(50000 + (peer % 10000))};
+                announces.append(announce);
+            }
+        }
+
+        return announces;
+    }
+}
+
+void Benchmarks::runTracker(BenchmarkRunner &runner, const BenchmarkConfig &config)
+{
+    const QString announceName = QLatin1String("tracker/announce");
+    const QString scrapeName = QLatin1String("tracker/scrape_all");
+    if (!runner.isSelected(announceName) && !runner.isSelected(scrapeName))
+        return;
+
+    const int torrentCount = std::max(1, (config.scale / 10));
+    const int peerCount = 100;
+    const QVector<Announce> announces = makeAnnounces(torrentCount, peerCount);
+
+    // the tracker isn't started, the requests are passed to it directly
+    BitTorrent::Tracker tracker;
+    Http::IRequestHandler &handler = tracker;
+
+    runner.run(announceName, announces.size(), [&handler, &announces]()
+    {
+        qint64 size = 0;
+        for (const Announce &announce : announces)
+            size += handler.processRequest(announce.request, announce.env).content.size();
+        BenchmarkRunner::consume(size);
+    });
+
+    Http::Request scrapeRequest;
+    scrapeRequest.method = QLatin1String(Http::HEADER_REQUEST_METHOD_GET);
+    scrapeRequest.path = QLatin1String("/scrape");
+    const Http::Environment scrapeEnv {QHostAddress::LocalHost, 9000, QHostAddress::LocalHost, 50000};
+    runner.run(scrapeName, torrentCount, [&handler, &scrapeRequest, &scrapeEnv]()
+    {
+        BenchmarkRunner::consume(handler.processRequest(scrapeRequest, scrapeEnv).content.size());
+    });
+}
@@ -0,0 +1,201 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "webuiloadgenerator.h"
+
+#include <algorithm>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTextStream>
+#include <QUrlQuery>
+
+namespace
+{
+    const char LOGIN_ENDPOINT[] = "auth/login";
+    const char SYNC_ENDPOINT[] = "sync/maindata";
+
+    qint64 percentile(const QVector<qint64> &sortedValues, const int percent)
+    {
+        if (sortedValues.isEmpty())
+            return 0;
+
+        const int index = std::min((sortedValues.size() - 1), ((sortedValues.size() * percent) / 100));
+        return sortedValues[index];
+    }
+}
+
+WebUILoadGenerator::WebUILoadGenerator(const Options &options, QObject *parent)
+    : QObject {parent}
+    , m_options {options}
+    , m_clients(std::max(1, options.clientCount))
+{
+}
+
+void WebUILoadGenerator::start()
+{
+    m_timer.start();
+
+    // every client has its own connection and session
+    for (Client &client : m_clients) {
+        client.manager = new QNetworkAccessManager {this};
+        login(client);
+    }
+}
+
+QUrl WebUILoadGenerator::endpointUrl(const QString &endpoint) const
+{
+    QUrl url = m_options.url;
+    url.setPath(url.path() + QLatin1String("/api/v2/") + endpoint);
+    return url;
+}
+
+void WebUILoadGenerator::login(Client &client)
+{
+    QUrlQuery form;
+    form.addQueryItem(QLatin1String("username"), m_options.username);
+    form.addQueryItem(QLatin1String("password"), m_options.password);
+
+    QNetworkRequest request {endpointUrl(QLatin1String(LOGIN_ENDPOINT))};
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QLatin1String("application/x-www-form-urlencoded"));
+
+    QNetworkReply *reply = client.manager->post(request, form.toString(QUrl::FullyEncoded).toLatin1());
+    connect(reply, &QNetworkReply::finished, this, [this, &client, reply]()
+    {
+        reply->deleteLater();
+
+        if ((reply->error() != QNetworkReply::NoError) || (reply->readAll() != "Ok.")) {
+            QTextStream(stderr) << "Login failed: " << reply->errorString() << endl;
+            finish(false);
+            return;
+        }
+
+        sendNextRequest(client);
+    });
+}
+
+void WebUILoadGenerator::sendNextRequest(Client &client)
+{
+    if (m_isFinished)
+        return;
+
+    if (m_sentCount >= m_options.requestCount) {
+        if (m_pendingCount == 0)
+            finish(true);
+        return;
+    }
+
+    const QString endpoint = m_options.endpoints[client.endpointIndex];
+    client.endpointIndex = ((client.endpointIndex + 1) % m_options.endpoints.size());
+
+    QUrl url = endpointUrl(endpoint);
+    if (endpoint == QLatin1String(SYNC_ENDPOINT))
+        url.setQuery(QLatin1String("rid=") + QString::fromLatin1(client.rid.isEmpty() ? QByteArray("0") : client.rid));
+
+    ++m_sentCount;
+    ++m_pendingCount;
+
+    QElapsedTimer timer;
+    timer.start();
+    QNetworkReply *reply = client.manager->get(QNetworkRequest {url});
+    connect(reply, &QNetworkReply::finished, this, [this, &client, endpoint, reply, timer]()
+    {
+        handleReply(client, endpoint, reply, timer.nsecsElapsed());
+    });
+}
+
+void WebUILoadGenerator::handleReply(Client &client, const QString &endpoint, QNetworkReply *reply, const qint64 latency)
+{
+    reply->deleteLater();
+    --m_pendingCount;
+
+    const QByteArray data = reply->readAll();
+
+    EndpointStats &stats = m_stats[endpoint];
+    stats.latencies.append(latency);
+    stats.bytes += data.size();
+    if (reply->error() != QNetworkReply::NoError) {
+        ++stats.errors;
+    }
+    else if (endpoint == QLatin1String(SYNC_ENDPOINT)) {
+        // continue with the incremental updates as the WebUI does
+        const QJsonObject object = QJsonDocument::fromJson(data).object();
+        client.rid = QByteArray::number(object.value(QLatin1String("rid")).toInt());
+    }
+
+    sendNextRequest(client);
+}
+
+void WebUILoadGenerator::finish(const bool success)
+{
+    if (m_isFinished)
+        return;
+
+    m_isFinished = true;
+    m_duration = m_timer.nsecsElapsed();
+    emit finished(success);
+}
+
+QJsonObject WebUILoadGenerator::result() const
+{
+    QJsonArray endpoints;
+    int requestCount = 0;
+    for (auto iter = m_stats.cbegin(); iter != m_stats.cend(); ++iter) {
+        QVector<qint64> latencies = iter->latencies;
+        std::sort(latencies.begin(), latencies.end());
+
+        qint64 total = 0;
+        for (const qint64 latency : latencies)
+            total += latency;
+        requestCount += latencies.size();
+
+        endpoints << QJsonObject {
+            {"endpoint", iter.key()},
+            {"requests", latencies.size()},
+            {"errors", iter->errors},
+            {"bytes", iter->bytes},
+            {"mean_us", (latencies.isEmpty() ? 0 : (total / latencies.size() / 1000))},
+            {"p50_us", (percentile(latencies, 50) / 1000)},
+            {"p90_us", (percentile(latencies, 90) / 1000)},
+            {"p99_us", (percentile(latencies, 99) / 1000)},
+            {"max_us", (latencies.isEmpty() ? 0 : (latencies.last() / 1000))}
+        };
+    }
+
+    return {
+        {"url", m_options.url.toString()},
+        {"clients", m_clients.size()},
+        {"requests", requestCount},
+        {"duration_ms", (m_duration / 1000000)},
+        {"requests_per_second", ((m_duration > 0) ? ((requestCount * 1e9) / m_duration) : 0.0)},
+        {"endpoints", endpoints}
+    };
+}
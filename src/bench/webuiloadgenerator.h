@@ -0,0 +1,98 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QStringList>
+#include <QUrl>
+#include <QVector>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Drives the Web API of a running qBittorrent instance with a number of concurrent
+// clients, each of them logs in and then sends the requests one after another
+// (cycling through the endpoints) until the requested number of requests is sent.
+class WebUILoadGenerator final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(WebUILoadGenerator)
+
+public:
+    struct Options
+    {
+        QUrl url;
+        QString username;
+        QString password;
+        int clientCount = 4;
+        int requestCount = 1000;
+        QStringList endpoints;
+    };
+
+    explicit WebUILoadGenerator(const Options &options, QObject *parent = nullptr);
+
+    void start();
+    QJsonObject result() const;
+
+signals:
+    void finished(bool success);
+
+private:
+    struct Client
+    {
+        QNetworkAccessManager *manager = nullptr;
+        int endpointIndex = 0;
+        QByteArray rid;
+    };
+
+    struct EndpointStats
+    {
+        QVector<qint64> latencies;  // nsecs
+        int errors = 0;
+        qint64 bytes = 0;
+    };
+
+    QUrl endpointUrl(const QString &endpoint) const;
+    void login(Client &client);
+    void sendNextRequest(Client &client);
+    void handleReply(Client &client, const QString &endpoint, QNetworkReply *reply, qint64 latency);
+    void finish(bool success);
+
+    const Options m_options;
+    QVector<Client> m_clients;
+    QHash<QString, EndpointStats> m_stats;
+    QElapsedTimer m_timer;
+    qint64 m_duration = 0;
+    int m_sentCount = 0;
+    int m_pendingCount = 0;
+    bool m_isFinished = false;
+};
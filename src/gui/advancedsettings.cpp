@@ -70,6 +70,8 @@ enum AdvSettingsRows
     NETWORK_IFACE_ADDRESS,
     // behavior
     SAVE_RESUME_DATA_INTERVAL,
+    RESUME_DATA_STORAGE,
+    MOVE_STORAGE_CONCURRENCY,
     CONFIRM_RECHECK_TORRENT,
     RECHECK_COMPLETED,
     // UI related
@@ -207,6 +209,10 @@ void AdvancedSettings::saveAdvancedSettings()
     session->setSocketBacklogSize(m_spinBoxSocketBacklogSize.value());
     // Save resume data interval
     session->setSaveResumeDataInterval(m_spinBoxSaveResumeDataInterval.value());
+    // Resume data storage
+    session->setResumeDataStorageType(static_cast<BitTorrent::ResumeDataStorageType>(m_comboBoxResumeDataStorage.currentIndex()));
+    // Move storage concurrency
+    session->setMoveStorageConcurrency(m_spinBoxMoveStorageConcurrency.value());
     // Outgoing ports
     session->setOutgoingPortsMin(m_spinBoxOutgoingPortsMin.value());
     session->setOutgoingPortsMax(m_spinBoxOutgoingPortsMax.value());
@@ -477,6 +483,15 @@ void AdvancedSettings::loadAdvancedSettings()
     m_spinBoxSaveResumeDataInterval.setValue(session->saveResumeDataInterval());
     updateSaveResumeDataIntervalSuffix(m_spinBoxSaveResumeDataInterval.value());
     addRow(SAVE_RESUME_DATA_INTERVAL, tr("Save resume data interval", "How often the fastresume file is saved."), &m_spinBoxSaveResumeDataInterval);
+    // Resume data storage
+    m_comboBoxResumeDataStorage.addItems({tr("Fastresume files"), tr("Single journal file")});
+    m_comboBoxResumeDataStorage.setCurrentIndex(static_cast<int>(session->resumeDataStorageType()));
+    addRow(RESUME_DATA_STORAGE, tr("Resume data storage type (requires restart)"), &m_comboBoxResumeDataStorage);
+    // Move storage concurrency
+    m_spinBoxMoveStorageConcurrency.setMinimum(1);
+    m_spinBoxMoveStorageConcurrency.setMaximum(64);
+    m_spinBoxMoveStorageConcurrency.setValue(session->moveStorageConcurrency());
+    addRow(MOVE_STORAGE_CONCURRENCY, tr("Simultaneous torrent moves between the same pair of drives"), &m_spinBoxMoveStorageConcurrency);
     // Outgoing port Min
     m_spinBoxOutgoingPortsMin.setMinimum(0);
     m_spinBoxOutgoingPortsMin.setMaximum(65535);
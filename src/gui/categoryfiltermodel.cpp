@@ -385,45 +385,34 @@ void CategoryFilterModel::populate()
     m_rootItem->clear();
 
     const auto *session = BitTorrent::Session::instance();
-    const auto torrents = session->torrents();
     m_isSubcategoriesEnabled = session->isSubcategoriesEnabled();
 
     const QString UID_ALL;
     const QString UID_UNCATEGORIZED(QChar(1));
 
     // All torrents
-    m_rootItem->addChild(UID_ALL, new CategoryModelItem(nullptr, tr("All"), torrents.count()));
+    m_rootItem->addChild(UID_ALL, new CategoryModelItem(nullptr, tr("All"), session->torrents().count()));
 
     // Uncategorized torrents
-    using Torrent = BitTorrent::TorrentHandle;
     m_rootItem->addChild(
                 UID_UNCATEGORIZED
-                , new CategoryModelItem(
-                    nullptr, tr("Uncategorized")
-                    , std::count_if(torrents.begin(), torrents.end()
-                                    , [](Torrent *torrent) { return torrent->category().isEmpty(); })));
+                , new CategoryModelItem(nullptr, tr("Uncategorized"), session->torrentsCountByCategory("")));
 
-    using Torrent = BitTorrent::TorrentHandle;
-    for (auto i = session->categories().cbegin(); i != session->categories().cend(); ++i) {
+    const QStringMap categories = session->categories();
+    for (auto i = categories.cbegin(); i != categories.cend(); ++i) {
         const QString &category = i.key();
         if (m_isSubcategoriesEnabled) {
+            // parent items sum up the torrents of their children
             CategoryModelItem *parent = m_rootItem;
             for (const QString &subcat : asConst(session->expandCategory(category))) {
                 const QString subcatName = shortName(subcat);
-                if (!parent->hasChild(subcatName)) {
-                    new CategoryModelItem(
-                                parent, subcatName
-                                , std::count_if(torrents.cbegin(), torrents.cend()
-                                                , [subcat](Torrent *torrent) { return torrent->category() == subcat; }));
-                }
+                if (!parent->hasChild(subcatName))
+                    new CategoryModelItem(parent, subcatName, session->torrentsCountByCategory(subcat, true));
                 parent = parent->child(subcatName);
             }
         }
         else {
-            new CategoryModelItem(
-                        m_rootItem, category
-                        , std::count_if(torrents.begin(), torrents.end()
-                                        , [category](Torrent *torrent) { return torrent->belongsToCategory(category); }));
+            new CategoryModelItem(m_rootItem, category, session->torrentsCountByCategory(category));
         }
     }
 }
@@ -38,7 +38,7 @@ DownloadedPiecesBar::DownloadedPiecesBar(QWidget *parent)
 {
 }
 
-QVector<float> DownloadedPiecesBar::bitfieldToFloatVector(const QBitArray &vecin, int reqSize)
+QVector<float> DownloadedPiecesBar::bitfieldToFloatVector(const Bitfield &vecin, int reqSize)
 {
     QVector<float> result(reqSize, 0.0);
     if (vecin.isEmpty()) return result;
@@ -72,7 +72,7 @@ QVector<float> DownloadedPiecesBar::bitfieldToFloatVector(const QBitArray &vecin
 
         // case when calculated range is (15.2 >= x < 15.7)
         if (x2 == toCMinusOne) {
-            if (vecin[x2])
+            if (vecin.testBit(x2))
                 value += ratio;
             ++x2;
         }
@@ -80,19 +80,20 @@ QVector<float> DownloadedPiecesBar::bitfieldToFloatVector(const QBitArray &vecin
         else {
             // subcase (15.2 >= x < 16)
             if (x2 != fromR) {
-                if (vecin[x2])
+                if (vecin.testBit(x2))
                     value += 1.0 - (fromR - fromC);
                 ++x2;
             }
 
             // subcase (16 >= x < 17)
-            for (; x2 < toCMinusOne; ++x2)
-                if (vecin[x2])
-                    value += 1.0;
+            if (x2 < toCMinusOne) {
+                value += vecin.count(x2, toCMinusOne);
+                x2 = toCMinusOne;
+            }
 
             // subcase (17 >= x < 17.8)
             if (x2 == toCMinusOne) {
-                if (vecin[x2])
+                if (vecin.testBit(x2))
                     value += 1.0 - (toC - toR);
                 ++x2;
             }
@@ -149,7 +150,7 @@ bool DownloadedPiecesBar::updateImage(QImage &image)
     return true;
 }
 
-void DownloadedPiecesBar::setProgress(const QBitArray &pieces, const QBitArray &downloadedPieces)
+void DownloadedPiecesBar::setProgress(const Bitfield &pieces, const Bitfield &downloadedPieces)
 {
     m_pieces = pieces;
     m_downloadedPieces = downloadedPieces;
@@ -159,8 +160,8 @@ void DownloadedPiecesBar::setProgress(const QBitArray &pieces, const QBitArray &
 
 void DownloadedPiecesBar::clear()
 {
-    m_pieces.clear();
-    m_downloadedPieces.clear();
+    m_pieces = {};
+    m_downloadedPieces = {};
     base::clear();
 }
 
@@ -29,9 +29,9 @@
 #ifndef DOWNLOADEDPIECESBAR_H
 #define DOWNLOADEDPIECESBAR_H
 
-#include <QBitArray>
 #include <QVector>
 
+#include "base/bitfield.h"
 #include "piecesbar.h"
 
 class QWidget;
@@ -45,14 +45,14 @@ class DownloadedPiecesBar final : public PiecesBar
 public:
     DownloadedPiecesBar(QWidget *parent);
 
-    void setProgress(const QBitArray &pieces, const QBitArray &downloadedPieces);
+    void setProgress(const Bitfield &pieces, const Bitfield &downloadedPieces);
 
     // PiecesBar interface
     void clear() override;
 
 private:
     // scale bitfield vector to float vector
-    QVector<float> bitfieldToFloatVector(const QBitArray &vecin, int reqSize);
+    QVector<float> bitfieldToFloatVector(const Bitfield &vecin, int reqSize);
     virtual bool updateImage(QImage &image) override;
     QString simpleToolTipText() const override;
 
@@ -60,8 +60,8 @@ private:
     QColor m_dlPieceColor;
     // last used bitfields, uses to better resize redraw
     // TODO: make a diff pieces to new pieces and update only changed pixels, speedup when update > 20x faster
-    QBitArray m_pieces;
-    QBitArray m_downloadedPieces;
+    Bitfield m_pieces;
+    Bitfield m_downloadedPieces;
 };
 
 #endif // DOWNLOADEDPIECESBAR_H
@@ -46,6 +46,7 @@
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/torrentdetailscache.h"
 #include "base/bittorrent/torrenthandle.h"
 #include "base/global.h"
 #include "base/logger.h"
@@ -349,7 +350,7 @@ void PeerListWidget::loadPeers(const BitTorrent::TorrentHandle *torrent)
 {
     if (!torrent) return;
 
-    const QVector<BitTorrent::PeerInfo> peers = torrent->peers();
+    const QVector<BitTorrent::PeerInfo> peers = BitTorrent::Session::instance()->torrentDetailsCache()->peers(torrent, BitTorrent::TorrentDetailsCache::RequestMode::NonBlocking);
     QSet<PeerEndpoint> existingPeers;
     for (auto i = m_peerItems.cbegin(); i != m_peerItems.cend(); ++i)
         existingPeers << i.key();
@@ -45,6 +45,7 @@
 #include "base/bittorrent/downloadpriority.h"
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/torrentdetailscache.h"
 #include "base/bittorrent/torrenthandle.h"
 #include "base/preferences.h"
 #include "base/unicodestrings.h"
@@ -105,6 +106,13 @@ PropertiesWidget::PropertiesWidget(QWidget *parent)
     connect(m_ui->stackedProperties, &QStackedWidget::currentChanged, this, &PropertiesWidget::loadDynamicData);
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentSavePathChanged, this, &PropertiesWidget::updateSavePath);
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentMetadataLoaded, this, &PropertiesWidget::updateTorrentInfos);
+    // the details which weren't available yet are shown as soon as they arrive
+    connect(BitTorrent::Session::instance()->torrentDetailsCache(), &BitTorrent::TorrentDetailsCache::detailsUpdated
+            , this, [this](BitTorrent::TorrentHandle *const torrent)
+    {
+        if (torrent == m_torrent)
+            loadDynamicData();
+    });
     connect(m_ui->filesList, &QAbstractItemView::clicked
             , m_ui->filesList, qOverload<const QModelIndex &>(&QAbstractItemView::edit));
     connect(m_ui->filesList, &QWidget::customContextMenuRequested, this, &PropertiesWidget::displayFilesListMenu);
@@ -462,7 +470,7 @@ void PropertiesWidget::loadDynamicData()
                 if (!m_torrent->isSeed() && !m_torrent->isPaused() && !m_torrent->isQueued() && !m_torrent->isChecking()) {
                     // Pieces availability
                     showPiecesAvailability(true);
-                    m_piecesAvailability->setAvailability(m_torrent->pieceAvailability());
+                    m_piecesAvailability->setAvailability(BitTorrent::Session::instance()->torrentDetailsCache()->pieceAvailability(m_torrent, BitTorrent::TorrentDetailsCache::RequestMode::NonBlocking));
                     m_ui->labelAverageAvailabilityVal->setText(Utils::String::fromDouble(m_torrent->distributedCopies(), 3));
                 }
                 else {
@@ -472,7 +480,7 @@ void PropertiesWidget::loadDynamicData()
                 // Progress
                 qreal progress = m_torrent->progress() * 100.;
                 m_ui->labelProgressVal->setText(Utils::String::fromDouble(progress, 1) + '%');
-                m_downloadedPieces->setProgress(m_torrent->pieces(), m_torrent->downloadingPieces());
+                m_downloadedPieces->setProgress(m_torrent->pieces(), BitTorrent::Session::instance()->torrentDetailsCache()->downloadingPieces(m_torrent, BitTorrent::TorrentDetailsCache::RequestMode::NonBlocking));
             }
             else {
                 showPiecesAvailability(false);
@@ -492,7 +500,10 @@ void PropertiesWidget::loadDynamicData()
         if (m_torrent->hasMetadata()) {
             qDebug("Updating priorities in files tab");
             m_ui->filesList->setUpdatesEnabled(false);
-            m_propListModel->model()->updateFilesProgress(m_torrent->filesProgress());
+            // the progress is shown once it is obtained, the data is reloaded then
+            const QVector<qreal> filesProgress = BitTorrent::Session::instance()->torrentDetailsCache()->filesProgress(m_torrent, BitTorrent::TorrentDetailsCache::RequestMode::NonBlocking);
+            if (!filesProgress.isEmpty())
+                m_propListModel->model()->updateFilesProgress(filesProgress);
             m_propListModel->model()->updateFilesAvailability(m_torrent->availableFileFractions());
             // XXX: We don't update file priorities regularly for performance
             // reasons. This means that priorities will not be updated if
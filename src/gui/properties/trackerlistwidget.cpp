@@ -45,6 +45,7 @@
 
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/torrentdetailscache.h"
 #include "base/bittorrent/torrenthandle.h"
 #include "base/bittorrent/trackerentry.h"
 #include "base/global.h"
@@ -304,7 +305,7 @@ void TrackerListWidget::loadStickyItems(const BitTorrent::TorrentHandle *torrent
     // XXX: libtorrent should provide this info...
     // Count peers from DHT, PeX, LSD
     uint seedsDHT = 0, seedsPeX = 0, seedsLSD = 0, peersDHT = 0, peersPeX = 0, peersLSD = 0;
-    for (const BitTorrent::PeerInfo &peer : asConst(torrent->peers())) {
+    for (const BitTorrent::PeerInfo &peer : asConst(BitTorrent::Session::instance()->torrentDetailsCache()->peers(torrent, BitTorrent::TorrentDetailsCache::RequestMode::NonBlocking))) {
         if (peer.isConnecting()) continue;
 
         if (peer.fromDHT()) {
@@ -347,7 +348,7 @@ void TrackerListWidget::loadTrackers()
     const QHash<QString, BitTorrent::TrackerInfo> trackerData = torrent->trackerInfos();
     QStringList oldTrackerURLs = m_trackerItems.keys();
 
-    for (const BitTorrent::TrackerEntry &entry : asConst(torrent->trackers())) {
+    for (const BitTorrent::TrackerEntry &entry : asConst(BitTorrent::Session::instance()->torrentDetailsCache()->trackers(torrent, BitTorrent::TorrentDetailsCache::RequestMode::NonBlocking))) {
         const QString trackerURL = entry.url();
 
         QTreeWidgetItem *item = m_trackerItems.value(trackerURL, nullptr);
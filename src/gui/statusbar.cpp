@@ -148,6 +148,13 @@ StatusBar::StatusBar(QWidget *parent)
     m_DHTLbl->setVisible(session->isDHTEnabled());
     refresh();
     connect(session, &BitTorrent::Session::statsUpdated, this, &StatusBar::refresh);
+
+    // Torrents restored on startup
+    m_startupProgressLbl = new QLabel(this);
+    m_startupProgressLbl->setText(tr("Restoring torrents..."));
+    m_startupProgressLbl->setVisible(session->isRestoringTorrents());
+    addWidget(m_startupProgressLbl);
+    connect(session, &BitTorrent::Session::startupProgressUpdated, this, &StatusBar::updateStartupProgress);
 }
 
 StatusBar::~StatusBar()
@@ -228,6 +235,12 @@ void StatusBar::refresh()
     updateSpeedLabels();
 }
 
+void StatusBar::updateStartupProgress(const int restoredCount, const int totalCount)
+{
+    m_startupProgressLbl->setVisible(BitTorrent::Session::instance()->isRestoringTorrents());
+    m_startupProgressLbl->setText(tr("Restoring torrents: %1/%2").arg(restoredCount).arg(totalCount));
+}
+
 void StatusBar::updateAltSpeedsBtn(bool alternative)
 {
     if (alternative) {
@@ -58,6 +58,7 @@ public slots:
 private slots:
     void refresh();
     void updateAltSpeedsBtn(bool alternative);
+    void updateStartupProgress(int restoredCount, int totalCount);
     void capDownloadSpeed();
     void capUploadSpeed();
 
@@ -71,6 +72,7 @@ private:
     QLabel *m_DHTLbl;
     QPushButton *m_connecStatusLblIcon;
     QPushButton *m_altSpeedsBtn;
+    QLabel *m_startupProgressLbl;
 };
 
 #endif // STATUSBAR_H
@@ -263,23 +263,14 @@ QString TagFilterModel::tagDisplayName(const QString &tag)
 
 void TagFilterModel::populate()
 {
-    using Torrent = BitTorrent::TorrentHandle;
-
     const auto *session = BitTorrent::Session::instance();
-    const auto torrents = session->torrents();
 
     // All torrents
-    addToModel(getSpecialAllTag(), torrents.count());
-
-    const int untaggedCount = std::count_if(torrents.cbegin(), torrents.cend(),
-                                             [](Torrent *torrent) { return torrent->tags().isEmpty(); });
-    addToModel(getSpecialUntaggedTag(), untaggedCount);
+    addToModel(getSpecialAllTag(), session->torrents().count());
+    addToModel(getSpecialUntaggedTag(), session->torrentsCountByTag(""));
 
-    for (const QString &tag : asConst(session->tags())) {
-        const int count = std::count_if(torrents.cbegin(), torrents.cend(),
-                                        [tag](Torrent *torrent) { return torrent->hasTag(tag); });
-        addToModel(tag, count);
-    }
+    for (const QString &tag : asConst(session->tags()))
+        addToModel(tag, session->torrentsCountByTag(tag));
 }
 
 void TagFilterModel::addToModel(const QString &tag, int count)
@@ -65,6 +65,9 @@ namespace
         WARNING_ROW
     };
 
+    // URL of one of the trackers of the item host, the favicon is requested using its scheme
+    const int TRACKER_URL_ROLE = Qt::UserRole + 1;
+
     QString getScheme(const QString &tracker)
     {
         const QUrl url {tracker};
@@ -74,6 +77,12 @@ namespace
         return scheme;
     }
 
+    QString getFaviconUrl(const QString &host, const QString &trackerUrl)
+    {
+        const QString scheme = getScheme(trackerUrl);
+        return QString::fromLatin1("%1://%2/favicon.ico").arg((scheme.startsWith("http") ? scheme : "http"), host);
+    }
+
     class ArrowCheckBox final : public QCheckBox
     {
     public:
@@ -292,7 +301,6 @@ TrackerFiltersList::TrackerFiltersList(QWidget *parent, TransferListWidget *tran
     auto *warningTracker = new QListWidgetItem(this);
     warningTracker->setData(Qt::DisplayRole, tr("Warning (0)"));
     warningTracker->setData(Qt::DecorationRole, style()->standardIcon(QStyle::SP_MessageBoxWarning));
-    m_trackers.insert("", QStringList());
 
     setCurrentRow(0, QItemSelectionModel::SelectCurrent);
     toggleFilter(Preferences::instance()->getTrackerFilterState());
@@ -304,50 +312,68 @@ TrackerFiltersList::~TrackerFiltersList()
         Utils::Fs::forceRemove(iconPath);
 }
 
-void TrackerFiltersList::addItem(const QString &tracker, const QString &hash)
+void TrackerFiltersList::addTrackers(const QVector<BitTorrent::TrackerEntry> &trackers)
 {
-    QStringList tmp;
-    QListWidgetItem *trackerItem = nullptr;
-    QString host = getHost(tracker);
-    bool exists = m_trackers.contains(host);
-
-    if (exists) {
-        tmp = m_trackers.value(host);
-        if (tmp.contains(hash))
-            return;
+    for (const BitTorrent::TrackerEntry &tracker : trackers)
+        updateTrackerItem(BitTorrent::Session::trackerHost(tracker.url()), tracker.url());
+}
 
-        if (host != "") {
-            trackerItem = item(rowFromTracker(host));
-        }
-        else {
-            trackerItem = item(TRACKERLESS_ROW);
-        }
+void TrackerFiltersList::removeTrackers(const QString &hash, const QVector<BitTorrent::TrackerEntry> &trackers)
+{
+    for (const BitTorrent::TrackerEntry &tracker : trackers) {
+        // Remove from 'Error' and 'Warning' view
+        trackerSuccess(hash, tracker.url());
+        updateTrackerItem(BitTorrent::Session::trackerHost(tracker.url()));
     }
-    else {
-        trackerItem = new QListWidgetItem();
-        trackerItem->setData(Qt::DecorationRole, UIThemeManager::instance()->getIcon("network-server"));
+}
 
-        const QString scheme = getScheme(tracker);
-        downloadFavicon(QString::fromLatin1("%1://%2/favicon.ico").arg((scheme.startsWith("http") ? scheme : "http"), host));
-    }
-    if (!trackerItem) return;
-
-    tmp.append(hash);
-    m_trackers.insert(host, tmp);
-    if (host == "") {
-        trackerItem->setText(tr("Trackerless (%1)").arg(tmp.size()));
-        if (currentRow() == TRACKERLESS_ROW)
-            applyFilter(TRACKERLESS_ROW);
+void TrackerFiltersList::updateTrackerlessItem()
+{
+    const int torrentsCount = BitTorrent::Session::instance()->torrentsCountByTrackerHost({});
+    item(TRACKERLESS_ROW)->setText(tr("Trackerless (%1)").arg(torrentsCount));
+    if (currentRow() == TRACKERLESS_ROW)
+        applyFilter(TRACKERLESS_ROW);
+}
+
+void TrackerFiltersList::updateTrackerItem(const QString &host, const QString &trackerUrl)
+{
+    if (host.isEmpty())
+        return;
+
+    // the torrents are counted by the session so the item only reflects the current number
+    const int torrentsCount = BitTorrent::Session::instance()->torrentsCountByTrackerHost(host);
+    QListWidgetItem *trackerItem = m_trackerItems.value(host);
+
+    if (torrentsCount == 0) {
+        if (!trackerItem)
+            return;
+
+        if (currentItem() == trackerItem)
+            setCurrentRow(0, QItemSelectionModel::SelectCurrent);
+        m_trackerItems.remove(host);
+        delete trackerItem;
+        updateGeometry();
         return;
     }
 
-    trackerItem->setText(QString::fromLatin1("%1 (%2)").arg(host, QString::number(tmp.size())));
-    if (exists) {
-        if (currentRow() == rowFromTracker(host))
+    const QString text = QString::fromLatin1("%1 (%2)").arg(host, QString::number(torrentsCount));
+    if (trackerItem) {
+        if (!trackerUrl.isEmpty() && trackerItem->data(TRACKER_URL_ROLE).toString().isEmpty())
+            trackerItem->setData(TRACKER_URL_ROLE, trackerUrl);
+        if (trackerItem->text() == text)
+            return;
+
+        trackerItem->setText(text);
+        if (currentItem() == trackerItem)
             applyFilter(currentRow());
         return;
     }
 
+    trackerItem = new QListWidgetItem(text);
+    trackerItem->setData(Qt::UserRole, host);
+    trackerItem->setData(TRACKER_URL_ROLE, trackerUrl);
+    trackerItem->setData(Qt::DecorationRole, UIThemeManager::instance()->getIcon("network-server"));
+
     Q_ASSERT(count() >= 4);
     int insPos = count();
     for (int i = 4; i < count(); ++i) {
@@ -357,53 +383,10 @@ void TrackerFiltersList::addItem(const QString &tracker, const QString &hash)
         }
     }
     QListWidget::insertItem(insPos, trackerItem);
+    m_trackerItems.insert(host, trackerItem);
     updateGeometry();
-}
-
-void TrackerFiltersList::removeItem(const QString &tracker, const QString &hash)
-{
-    QString host = getHost(tracker);
-    QListWidgetItem *trackerItem = nullptr;
-    QStringList tmp = m_trackers.value(host);
-    int row = 0;
-
-    if (tmp.empty())
-        return;
-    tmp.removeAll(hash);
 
-    if (!host.isEmpty()) {
-        // Remove from 'Error' and 'Warning' view
-        trackerSuccess(hash, tracker);
-        row = rowFromTracker(host);
-        trackerItem = item(row);
-        if (tmp.empty()) {
-            if (currentRow() == row)
-                setCurrentRow(0, QItemSelectionModel::SelectCurrent);
-            delete trackerItem;
-            m_trackers.remove(host);
-            updateGeometry();
-            return;
-        }
-        if (trackerItem)
-            trackerItem->setText(QString::fromLatin1("%1 (%2)").arg(host, QString::number(tmp.size())));
-    }
-    else {
-        row = 1;
-        trackerItem = item(TRACKERLESS_ROW);
-        trackerItem->setText(tr("Trackerless (%1)").arg(tmp.size()));
-    }
-
-    m_trackers.insert(host, tmp);
-    if (currentRow() == row)
-        applyFilter(row);
-}
-
-void TrackerFiltersList::changeTrackerless(bool trackerless, const QString &hash)
-{
-    if (trackerless)
-        addItem("", hash);
-    else
-        removeItem("", hash);
+    downloadFavicon(getFaviconUrl(host, trackerUrl));
 }
 
 void TrackerFiltersList::setDownloadTrackerFavicon(bool value)
@@ -412,24 +395,17 @@ void TrackerFiltersList::setDownloadTrackerFavicon(bool value)
     m_downloadTrackerFavicon = value;
 
     if (m_downloadTrackerFavicon) {
-        for (auto i = m_trackers.cbegin(); i != m_trackers.cend(); ++i) {
-            const QString &tracker = i.key();
-            if (!tracker.isEmpty()) {
-                const QString scheme = getScheme(tracker);
-                downloadFavicon(QString("%1://%2/favicon.ico")
-                                .arg((scheme.startsWith("http") ? scheme : "http"), getHost(tracker)));
-             }
-        }
+        for (auto i = m_trackerItems.cbegin(); i != m_trackerItems.cend(); ++i)
+            downloadFavicon(getFaviconUrl(i.key(), i.value()->data(TRACKER_URL_ROLE).toString()));
     }
 }
 
 void TrackerFiltersList::trackerSuccess(const QString &hash, const QString &tracker)
 {
-    QStringList errored = m_errors.value(hash);
-    QStringList warned = m_warnings.value(hash);
+    QSet<QString> errored = m_errors.value(hash);
+    QSet<QString> warned = m_warnings.value(hash);
 
-    if (errored.contains(tracker)) {
-        errored.removeAll(tracker);
+    if (errored.remove(tracker)) {
         if (errored.empty()) {
             m_errors.remove(hash);
             item(ERROR_ROW)->setText(tr("Error (%1)").arg(m_errors.size()));
@@ -441,8 +417,7 @@ void TrackerFiltersList::trackerSuccess(const QString &hash, const QString &trac
         }
     }
 
-    if (warned.contains(tracker)) {
-        warned.removeAll(tracker);
+    if (warned.remove(tracker)) {
         if (warned.empty()) {
             m_warnings.remove(hash);
             item(WARNING_ROW)->setText(tr("Warning (%1)").arg(m_warnings.size()));
@@ -457,13 +432,11 @@ void TrackerFiltersList::trackerSuccess(const QString &hash, const QString &trac
 
 void TrackerFiltersList::trackerError(const QString &hash, const QString &tracker)
 {
-    QStringList trackers = m_errors.value(hash);
-
+    QSet<QString> &trackers = m_errors[hash];
     if (trackers.contains(tracker))
         return;
 
-    trackers.append(tracker);
-    m_errors.insert(hash, trackers);
+    trackers.insert(tracker);
     item(ERROR_ROW)->setText(tr("Error (%1)").arg(m_errors.size()));
 
     if (currentRow() == ERROR_ROW)
@@ -472,13 +445,11 @@ void TrackerFiltersList::trackerError(const QString &hash, const QString &tracke
 
 void TrackerFiltersList::trackerWarning(const QString &hash, const QString &tracker)
 {
-    QStringList trackers = m_warnings.value(hash);
-
+    QSet<QString> &trackers = m_warnings[hash];
     if (trackers.contains(tracker))
         return;
 
-    trackers.append(tracker);
-    m_warnings.insert(hash, trackers);
+    trackers.insert(tracker);
     item(WARNING_ROW)->setText(tr("Warning (%1)").arg(m_warnings.size()));
 
     if (currentRow() == WARNING_ROW)
@@ -501,16 +472,12 @@ void TrackerFiltersList::handleFavicoDownloadFinished(const Net::DownloadResult
         return;
     }
 
-    const QString host = getHost(result.url);
-
-    if (!m_trackers.contains(host)) {
+    QListWidgetItem *trackerItem = m_trackerItems.value(BitTorrent::Session::trackerHost(result.url));
+    if (!trackerItem) {
         Utils::Fs::forceRemove(result.filePath);
         return;
     }
 
-    QListWidgetItem *trackerItem = item(rowFromTracker(host));
-    if (!trackerItem) return;
-
     QIcon icon(result.filePath);
     //Detect a non-decodable icon
     QList<QSize> sizes = icon.availableSizes();
@@ -553,74 +520,48 @@ void TrackerFiltersList::applyFilter(const int row)
 
 void TrackerFiltersList::handleNewTorrent(BitTorrent::TorrentHandle *const torrent)
 {
-    QString hash = torrent->hash();
     const QVector<BitTorrent::TrackerEntry> trackers = torrent->trackers();
-    for (const BitTorrent::TrackerEntry &tracker : trackers)
-        addItem(tracker.url(), hash);
+    addTrackers(trackers);
 
     //Check for trackerless torrent
     if (trackers.isEmpty())
-        addItem("", hash);
+        updateTrackerlessItem();
 
     item(ALL_ROW)->setText(tr("All (%1)", "this is for the tracker filter").arg(++m_totalTorrents));
 }
 
 void TrackerFiltersList::torrentAboutToBeDeleted(BitTorrent::TorrentHandle *const torrent)
 {
-    QString hash = torrent->hash();
     const QVector<BitTorrent::TrackerEntry> trackers = torrent->trackers();
-    for (const BitTorrent::TrackerEntry &tracker : trackers)
-        removeItem(tracker.url(), hash);
+    removeTrackers(torrent->hash(), trackers);
 
     //Check for trackerless torrent
     if (trackers.isEmpty())
-        removeItem("", hash);
+        updateTrackerlessItem();
 
     item(ALL_ROW)->setText(tr("All (%1)", "this is for the tracker filter").arg(--m_totalTorrents));
 }
 
-QString TrackerFiltersList::trackerFromRow(int row) const
-{
-    Q_ASSERT(row > 1);
-    const QString tracker = item(row)->text();
-    QStringList parts = tracker.split(' ');
-    Q_ASSERT(parts.size() >= 2);
-    parts.removeLast(); // Remove trailing number
-    return parts.join(' ');
-}
-
-int TrackerFiltersList::rowFromTracker(const QString &tracker) const
-{
-    Q_ASSERT(!tracker.isEmpty());
-    for (int i = 4; i<count(); ++i)
-        if (tracker == trackerFromRow(i)) return i;
-    return -1;
-}
-
-QString TrackerFiltersList::getHost(const QString &tracker) const
+QStringSet TrackerFiltersList::getHashes(const int row) const
 {
-    // We want the domain + tld. Subdomains should be disregarded
-    const QUrl url {tracker};
-    const QString host {url.host()};
-
-    // host is in IP format
-    if (!QHostAddress(host).isNull())
-        return host;
-
-    return host.section('.', -2, -1);
-}
+    const auto toStringSet = [](const QSet<BitTorrent::InfoHash> &hashes) -> QStringSet
+    {
+        QStringSet result;
+        result.reserve(hashes.size());
+        for (const BitTorrent::InfoHash &hash : hashes)
+            result.insert(hash);
+        return result;
+    };
 
-QStringList TrackerFiltersList::getHashes(const int row) const
-{
     switch (row) {
     case TRACKERLESS_ROW:
-        return m_trackers.value("");
+        return toStringSet(BitTorrent::Session::instance()->torrentsByTrackerHost({}));
     case ERROR_ROW:
-        return m_errors.keys();
+        return List::toSet(m_errors.keys());
     case WARNING_ROW:
-        return m_warnings.keys();
+        return List::toSet(m_warnings.keys());
     default:
-        return m_trackers.value(trackerFromRow(row));
+        return toStringSet(BitTorrent::Session::instance()->torrentsByTrackerHost(item(row)->data(Qt::UserRole).toString()));
     }
 }
 
@@ -727,19 +668,20 @@ void TransferListFiltersWidget::setDownloadTrackerFavicon(bool value)
 
 void TransferListFiltersWidget::addTrackers(BitTorrent::TorrentHandle *const torrent, const QVector<BitTorrent::TrackerEntry> &trackers)
 {
-    for (const BitTorrent::TrackerEntry &tracker : trackers)
-        m_trackerFilters->addItem(tracker.url(), torrent->hash());
+    Q_UNUSED(torrent);
+    m_trackerFilters->addTrackers(trackers);
 }
 
 void TransferListFiltersWidget::removeTrackers(BitTorrent::TorrentHandle *const torrent, const QVector<BitTorrent::TrackerEntry> &trackers)
 {
-    for (const BitTorrent::TrackerEntry &tracker : trackers)
-        m_trackerFilters->removeItem(tracker.url(), torrent->hash());
+    m_trackerFilters->removeTrackers(torrent->hash(), trackers);
 }
 
 void TransferListFiltersWidget::changeTrackerless(BitTorrent::TorrentHandle *const torrent, bool trackerless)
 {
-    m_trackerFilters->changeTrackerless(trackerless, torrent->hash());
+    Q_UNUSED(torrent);
+    Q_UNUSED(trackerless);
+    m_trackerFilters->updateTrackerlessItem();
 }
 
 void TransferListFiltersWidget::trackerSuccess(BitTorrent::TorrentHandle *const torrent, const QString &tracker)
@@ -32,6 +32,8 @@
 #include <QFrame>
 #include <QListWidget>
 
+#include "base/torrentfilter.h"
+
 class QCheckBox;
 class QResizeEvent;
 
@@ -102,10 +104,9 @@ public:
     TrackerFiltersList(QWidget *parent, TransferListWidget *transferList, bool downloadFavicon);
     ~TrackerFiltersList() override;
 
-    // Redefine addItem() to make sure the list stays sorted
-    void addItem(const QString &tracker, const QString &hash);
-    void removeItem(const QString &tracker, const QString &hash);
-    void changeTrackerless(bool trackerless, const QString &hash);
+    void addTrackers(const QVector<BitTorrent::TrackerEntry> &trackers);
+    void removeTrackers(const QString &hash, const QVector<BitTorrent::TrackerEntry> &trackers);
+    void updateTrackerlessItem();
     void setDownloadTrackerFavicon(bool value);
 
 public slots:
@@ -123,15 +124,14 @@ private:
     void applyFilter(int row) override;
     void handleNewTorrent(BitTorrent::TorrentHandle *const torrent) override;
     void torrentAboutToBeDeleted(BitTorrent::TorrentHandle *const torrent) override;
-    QString trackerFromRow(int row) const;
-    int rowFromTracker(const QString &tracker) const;
-    QString getHost(const QString &tracker) const;
-    QStringList getHashes(int row) const;
+    // Keeps the sorted list of the items in sync with the number of the torrents of the host
+    void updateTrackerItem(const QString &host, const QString &trackerUrl = {});
+    QStringSet getHashes(int row) const;
     void downloadFavicon(const QString &url);
 
-    QHash<QString, QStringList> m_trackers;
-    QHash<QString, QStringList> m_errors;
-    QHash<QString, QStringList> m_warnings;
+    QHash<QString, QListWidgetItem *> m_trackerItems;
+    QHash<QString, QSet<QString>> m_errors;
+    QHash<QString, QSet<QString>> m_warnings;
     QStringList m_iconPaths;
     int m_totalTorrents;
     bool m_downloadTrackerFavicon;
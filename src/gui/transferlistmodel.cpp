@@ -304,13 +304,6 @@ QString TransferListModel::displayValue(const BitTorrent::TorrentHandle *torrent
                      , Utils::Misc::userFriendlyDuration(seedingTime));
     };
 
-    const auto tagsString = [](const QSet<QString> &tags) -> QString
-    {
-        QStringList tagsList = tags.values();
-        tagsList.sort();
-        return tagsList.join(", ");
-    };
-
     const auto progressString = [](qreal progress) -> QString
     {
         progress *= 100;
@@ -354,7 +347,7 @@ QString TransferListModel::displayValue(const BitTorrent::TorrentHandle *torrent
     case TR_CATEGORY:
         return torrent->category();
     case TR_TAGS:
-        return tagsString(torrent->tags());
+        return torrent->tagsString();
     case TR_ADD_DATE:
         return torrent->addedTime().toLocalTime().toString(Qt::DefaultLocaleShortDate);
     case TR_SEED_DATE:
@@ -31,8 +31,6 @@
 #include <QSortFilterProxyModel>
 #include "base/torrentfilter.h"
 
-class QStringList;
-
 class TransferListSortModel final : public QSortFilterProxyModel
 {
     Q_OBJECT
@@ -46,7 +44,7 @@ public:
     void disableCategoryFilter();
     void setTagFilter(const QString &tag);
     void disableTagFilter();
-    void setTrackerFilter(const QStringList &hashes);
+    void setTrackerFilter(const QStringSet &hashes);
     void disableTrackerFilter();
 
 private:
@@ -338,44 +338,58 @@ void TransferListWidget::setSelectedTorrentsLocation()
 
 void TransferListWidget::pauseAllTorrents()
 {
-    for (BitTorrent::TorrentHandle *const torrent : asConst(BitTorrent::Session::instance()->torrents()))
+    BitTorrent::Session::instance()->applyToTorrents(BitTorrent::Session::instance()->torrents(), [](BitTorrent::TorrentHandle *const torrent)
+    {
         torrent->pause();
+    });
 }
 
 void TransferListWidget::resumeAllTorrents()
 {
-    for (BitTorrent::TorrentHandle *const torrent : asConst(BitTorrent::Session::instance()->torrents()))
+    BitTorrent::Session::instance()->applyToTorrents(BitTorrent::Session::instance()->torrents(), [](BitTorrent::TorrentHandle *const torrent)
+    {
         torrent->resume();
+    });
 }
 
 void TransferListWidget::startSelectedTorrents()
 {
-    for (BitTorrent::TorrentHandle *const torrent : asConst(getSelectedTorrents()))
+    BitTorrent::Session::instance()->applyToTorrents(getSelectedTorrents(), [](BitTorrent::TorrentHandle *const torrent)
+    {
         torrent->resume();
+    });
 }
 
 void TransferListWidget::forceStartSelectedTorrents()
 {
-    for (BitTorrent::TorrentHandle *const torrent : asConst(getSelectedTorrents()))
+    BitTorrent::Session::instance()->applyToTorrents(getSelectedTorrents(), [](BitTorrent::TorrentHandle *const torrent)
+    {
         torrent->resume(true);
+    });
 }
 
 void TransferListWidget::startVisibleTorrents()
 {
-    for (BitTorrent::TorrentHandle *const torrent : asConst(getVisibleTorrents()))
+    BitTorrent::Session::instance()->applyToTorrents(getVisibleTorrents(), [](BitTorrent::TorrentHandle *const torrent)
+    {
         torrent->resume();
+    });
 }
 
 void TransferListWidget::pauseSelectedTorrents()
 {
-    for (BitTorrent::TorrentHandle *const torrent : asConst(getSelectedTorrents()))
+    BitTorrent::Session::instance()->applyToTorrents(getSelectedTorrents(), [](BitTorrent::TorrentHandle *const torrent)
+    {
         torrent->pause();
+    });
 }
 
 void TransferListWidget::pauseVisibleTorrents()
 {
-    for (BitTorrent::TorrentHandle *const torrent : asConst(getVisibleTorrents()))
+    BitTorrent::Session::instance()->applyToTorrents(getVisibleTorrents(), [](BitTorrent::TorrentHandle *const torrent)
+    {
         torrent->pause();
+    });
 }
 
 void TransferListWidget::softDeleteSelectedTorrents()
@@ -695,20 +709,26 @@ void TransferListWidget::setSelectedTorrentsSuperSeeding(const bool enabled) con
 
 void TransferListWidget::setSelectedTorrentsSequentialDownload(const bool enabled) const
 {
-    for (BitTorrent::TorrentHandle *const torrent : asConst(getSelectedTorrents()))
+    BitTorrent::Session::instance()->applyToTorrents(getSelectedTorrents(), [enabled](BitTorrent::TorrentHandle *const torrent)
+    {
         torrent->setSequentialDownload(enabled);
+    });
 }
 
 void TransferListWidget::setSelectedFirstLastPiecePrio(const bool enabled) const
 {
-    for (BitTorrent::TorrentHandle *const torrent : asConst(getSelectedTorrents()))
+    BitTorrent::Session::instance()->applyToTorrents(getSelectedTorrents(), [enabled](BitTorrent::TorrentHandle *const torrent)
+    {
         torrent->setFirstLastPiecePriority(enabled);
+    });
 }
 
 void TransferListWidget::setSelectedAutoTMMEnabled(const bool enabled) const
 {
-    for (BitTorrent::TorrentHandle *const torrent : asConst(getSelectedTorrents()))
+    BitTorrent::Session::instance()->applyToTorrents(getSelectedTorrents(), [enabled](BitTorrent::TorrentHandle *const torrent)
+    {
         torrent->setAutoTMMEnabled(enabled);
+    });
 }
 
 void TransferListWidget::askNewCategoryForSelection()
@@ -793,11 +813,7 @@ QStringList TransferListWidget::askTagsForSelection(const QString &dialogTitle)
 
 void TransferListWidget::applyToSelectedTorrents(const std::function<void (BitTorrent::TorrentHandle *const)> &fn)
 {
-    for (const QModelIndex &index : asConst(selectionModel()->selectedRows())) {
-        BitTorrent::TorrentHandle *const torrent = m_listModel->torrentHandle(mapToSource(index));
-        Q_ASSERT(torrent);
-        fn(torrent);
-    }
+    BitTorrent::Session::instance()->applyToTorrents(getSelectedTorrents(), fn);
 }
 
 void TransferListWidget::renameSelectedTorrent()
@@ -1161,7 +1177,7 @@ void TransferListWidget::applyTrackerFilterAll()
     m_sortFilterModel->disableTrackerFilter();
 }
 
-void TransferListWidget::applyTrackerFilter(const QStringList &hashes)
+void TransferListWidget::applyTrackerFilter(const QSet<QString> &hashes)
 {
     m_sortFilterModel->setTrackerFilter(hashes);
 }
@@ -30,6 +30,7 @@
 #define TRANSFERLISTWIDGET_H
 
 #include <functional>
+#include <QSet>
 #include <QTreeView>
 #include <QVector>
 
@@ -90,7 +91,7 @@ public slots:
     void applyCategoryFilter(const QString &category);
     void applyTagFilter(const QString &tag);
     void applyTrackerFilterAll();
-    void applyTrackerFilter(const QStringList &hashes);
+    void applyTrackerFilter(const QSet<QString> &hashes);
     void previewFile(const QString &filePath);
     void renameSelectedTorrent();
 
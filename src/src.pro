@@ -34,6 +34,11 @@ nowebui {
     DEFINES += DISABLE_WEBUI
 }
 
+io_uring {
+    DEFINES += QBT_USES_IO_URING
+    LIBS += -luring
+}
+
 stacktrace {
     DEFINES += STACKTRACE
     win32 {
@@ -33,8 +33,29 @@
 #include <QJsonDocument>
 #include <QMetaObject>
 
+#include "base/http/contentstream.h"
 #include "apierror.h"
 
+void StreamedJsonObject::insert(const QString &name, const QJsonValue &value)
+{
+    m_members.append({name, value, {}, {}});
+}
+
+void StreamedJsonObject::insertArray(const QString &name, const JsonArrayGenerator &generator)
+{
+    m_members.append({name, {}, generator, {}});
+}
+
+void StreamedJsonObject::insertObject(const QString &name, const JsonObjectGenerator &generator)
+{
+    m_members.append({name, {}, {}, generator});
+}
+
+QVector<StreamedJsonObject::Member> StreamedJsonObject::members() const
+{
+    return m_members;
+}
+
 APIController::APIController(ISessionManager *sessionManager, QObject *parent)
     : QObject {parent}
     , m_sessionManager {sessionManager}
@@ -44,6 +65,7 @@ APIController::APIController(ISessionManager *sessionManager, QObject *parent)
 QVariant APIController::run(const QString &action, const StringMap &params, const DataMap &data)
 {
     m_result.clear(); // clear result
+    m_isResultPending = false;
     m_params = params;
     m_data = data;
 
@@ -59,6 +81,11 @@ ISessionManager *APIController::sessionManager() const
     return m_sessionManager;
 }
 
+bool APIController::isResultPending() const
+{
+    return m_isResultPending;
+}
+
 const StringMap &APIController::params() const
 {
     return m_params;
@@ -95,3 +122,23 @@ void APIController::setResult(const QJsonObject &result)
 {
     m_result = QJsonDocument(result);
 }
+
+void APIController::setResult(const JsonArrayGenerator &result)
+{
+    m_result = QVariant::fromValue(result);
+}
+
+void APIController::setResult(const StreamedJsonObject &result)
+{
+    m_result = QVariant::fromValue(result);
+}
+
+void APIController::setResult(const std::shared_ptr<Http::ContentStream> &result)
+{
+    m_result = QVariant::fromValue(result);
+}
+
+void APIController::setResultPending(const bool pending)
+{
+    m_isResultPending = pending;
+}
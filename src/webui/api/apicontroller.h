@@ -28,17 +28,58 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+
 #include <QHash>
+#include <QJsonValue>
+#include <QMetaType>
 #include <QObject>
+#include <QPair>
+#include <QString>
 #include <QVariant>
 #include <QVector>
 
-class QString;
+namespace Http
+{
+    class ContentStream;
+}
 
 struct ISessionManager;
 
 using DataMap = QHash<QString, QByteArray>;
 using StringMap = QHash<QString, QString>;
+// Produces the elements of JSON array result one by one, the undefined value ends the array.
+// The elements are serialized and sent as they are produced so the large results
+// aren't held in memory at once.
+using JsonArrayGenerator = std::function<QJsonValue ()>;
+Q_DECLARE_METATYPE(JsonArrayGenerator)
+// Produces the members (name and value) of JSON object one by one, the null name ends the object.
+using JsonObjectGenerator = std::function<QPair<QString, QJsonValue> ()>;
+
+// JSON object result which members are serialized in order they are inserted.
+// Its large members are produced by the generators while the response is sent.
+class StreamedJsonObject
+{
+public:
+    struct Member
+    {
+        QString name;
+        QJsonValue value;
+        JsonArrayGenerator arrayGenerator;
+        JsonObjectGenerator objectGenerator;
+    };
+
+    void insert(const QString &name, const QJsonValue &value);
+    void insertArray(const QString &name, const JsonArrayGenerator &generator);
+    void insertObject(const QString &name, const JsonObjectGenerator &generator);
+
+    QVector<Member> members() const;
+
+private:
+    QVector<Member> m_members;
+};
+Q_DECLARE_METATYPE(StreamedJsonObject)
 
 class APIController : public QObject
 {
@@ -56,6 +97,8 @@ public:
     QVariant run(const QString &action, const StringMap &params, const DataMap &data = {});
 
     ISessionManager *sessionManager() const;
+    // The result contains the data which isn't actual yet, the client should repeat the request soon
+    bool isResultPending() const;
 
 protected:
     const StringMap &params() const;
@@ -65,10 +108,15 @@ protected:
     void setResult(const QString &result);
     void setResult(const QJsonArray &result);
     void setResult(const QJsonObject &result);
+    void setResult(const JsonArrayGenerator &result);
+    void setResult(const StreamedJsonObject &result);
+    void setResult(const std::shared_ptr<Http::ContentStream> &result);
+    void setResultPending(bool pending);
 
 private:
     ISessionManager *m_sessionManager;
     StringMap m_params;
     DataMap m_data;
     QVariant m_result;
+    bool m_isResultPending = false;
 };
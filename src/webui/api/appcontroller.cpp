@@ -269,6 +269,10 @@ void AppController::preferencesAction()
     data["current_interface_address"] = BitTorrent::Session::instance()->networkInterfaceAddress();
     // Save resume data interval
     data["save_resume_data_interval"] = static_cast<double>(session->saveResumeDataInterval());
+    // Resume data storage
+    data["resume_data_storage_type"] = static_cast<int>(session->resumeDataStorageType());
+    // Move storage concurrency
+    data["move_storage_concurrency"] = session->moveStorageConcurrency();
     // Recheck completed torrents
     data["recheck_completed_torrents"] = pref->recheckTorrentsOnCompletion();
     // Resolve peer countries
@@ -684,6 +688,12 @@ void AppController::setPreferencesAction()
     // Save resume data interval
     if (hasKey("save_resume_data_interval"))
         session->setSaveResumeDataInterval(it.value().toInt());
+    // Resume data storage
+    if (hasKey("resume_data_storage_type"))
+        session->setResumeDataStorageType(static_cast<BitTorrent::ResumeDataStorageType>(it.value().toInt()));
+    // Move storage concurrency
+    if (hasKey("move_storage_concurrency"))
+        session->setMoveStorageConcurrency(it.value().toInt());
     // Recheck completed torrents
     if (hasKey("recheck_completed_torrents"))
         pref->recheckTorrentsOnCompletion(it.value().toBool());
@@ -778,6 +788,36 @@ void AppController::defaultSavePathAction()
     setResult(BitTorrent::Session::instance()->defaultSavePath());
 }
 
+void AppController::alertStatisticsAction()
+{
+    // Times are reported in microseconds
+    const BitTorrent::AlertStatistics &stats = BitTorrent::Session::instance()->alertStatistics();
+
+    QJsonObject typesObj;
+    for (const BitTorrent::AlertTypeStatistics &typeStats : stats.types) {
+        if ((typeStats.handledCount == 0) && (typeStats.droppedCount == 0))
+            continue;
+
+        typesObj.insert(typeStats.name, QJsonObject {
+            {"handled", typeStats.handledCount},
+            {"dropped", typeStats.droppedCount},
+            {"total_time", (typeStats.handlingTime.sum() / 1000)},
+            {"max_time", (typeStats.handlingTime.max() / 1000)}
+        });
+    }
+
+    setResult(QJsonObject {
+        {"last_batch_size", stats.lastBatchSize},
+        {"max_batch_size", stats.maxBatchSize},
+        {"pending", stats.pendingCount},
+        {"sliced_batches", stats.slicedBatchCount},
+        {"slices", stats.sliceHandlingTime.count()},
+        {"total_time", (stats.sliceHandlingTime.sum() / 1000)},
+        {"max_time", (stats.sliceHandlingTime.max() / 1000)},
+        {"types", typesObj}
+    });
+}
+
 void AppController::networkInterfaceListAction()
 {
     QJsonArray ifaceList;
@@ -28,10 +28,8 @@
 
 #include "logcontroller.h"
 
-#include <QJsonArray>
 #include <QJsonObject>
 
-#include "base/global.h"
 #include "base/logger.h"
 #include "base/utils/string.h"
 
@@ -70,25 +68,28 @@ void LogController::mainAction()
     if (!ok)
         lastKnownId = -1;
 
-    Logger *const logger = Logger::instance();
-    QJsonArray msgList;
-
-    for (const Log::Msg &msg : asConst(logger->getMessages(lastKnownId))) {
-        if (!((msg.type == Log::NORMAL && isNormal)
-              || (msg.type == Log::INFO && isInfo)
-              || (msg.type == Log::WARNING && isWarning)
-              || (msg.type == Log::CRITICAL && isCritical)))
-            continue;
-
-        msgList.append(QJsonObject {
-            {KEY_LOG_ID, msg.id},
-            {KEY_LOG_TIMESTAMP, msg.timestamp},
-            {KEY_LOG_MSG_TYPE, msg.type},
-            {KEY_LOG_MSG_MESSAGE, msg.message}
-        });
-    }
-
-    setResult(msgList);
+    // Messages are serialized one by one while the response is sent
+    const QVector<Log::Msg> messages = Logger::instance()->getMessages(lastKnownId);
+    int index = 0;
+    setResult([messages, index, isNormal, isInfo, isWarning, isCritical]() mutable -> QJsonValue
+    {
+        while (index < messages.size()) {
+            const Log::Msg &msg = messages.at(index++);
+            if (!((msg.type == Log::NORMAL && isNormal)
+                  || (msg.type == Log::INFO && isInfo)
+                  || (msg.type == Log::WARNING && isWarning)
+                  || (msg.type == Log::CRITICAL && isCritical)))
+                continue;
+
+            return QJsonObject {
+                {KEY_LOG_ID, msg.id},
+                {KEY_LOG_TIMESTAMP, msg.timestamp},
+                {KEY_LOG_MSG_TYPE, msg.type},
+                {KEY_LOG_MSG_MESSAGE, msg.message}
+            };
+        }
+        return QJsonValue(QJsonValue::Undefined);
+    });
 }
 
 // Returns the peer log in JSON format.
@@ -110,18 +111,21 @@ void LogController::peersAction()
     if (!ok)
         lastKnownId = -1;
 
-    Logger *const logger = Logger::instance();
-    QJsonArray peerList;
+    // Entries are serialized one by one while the response is sent
+    const QVector<Log::Peer> peers = Logger::instance()->getPeers(lastKnownId);
+    int index = 0;
+    setResult([peers, index]() mutable -> QJsonValue
+    {
+        if (index == peers.size())
+            return QJsonValue(QJsonValue::Undefined);
 
-    for (const Log::Peer &peer : asConst(logger->getPeers(lastKnownId))) {
-        peerList.append(QJsonObject {
+        const Log::Peer &peer = peers.at(index++);
+        return QJsonObject {
             {KEY_LOG_ID, peer.id},
             {KEY_LOG_TIMESTAMP, peer.timestamp},
             {KEY_LOG_PEER_IP, peer.ip},
             {KEY_LOG_PEER_BLOCKED, peer.blocked},
             {KEY_LOG_PEER_REASON, peer.reason}
-        });
-    }
-
-    setResult(peerList);
+        };
+    });
 }
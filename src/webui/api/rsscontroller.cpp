@@ -189,3 +189,28 @@ void RSSController::matchingArticlesAction()
 
     setResult(jsonObj);
 }
+
+void RSSController::matchingStatisticsAction()
+{
+    // Times are reported in microseconds
+    const RSS::MatchingStatistics stats = RSS::AutoDownloader::instance()->matchingStatistics();
+
+    QJsonObject rulesObj;
+    for (auto it = stats.rules.cbegin(); it != stats.rules.cend(); ++it) {
+        rulesObj.insert(it.key(), QJsonObject {
+            {"evaluations", it->evaluationCount},
+            {"matches", it->matchCount},
+            {"total_time", (it->totalTime / 1000)},
+            {"max_time", (it->maxTime / 1000)}
+        });
+    }
+
+    setResult(QJsonObject {
+        {"articles", stats.articleCount},
+        {"evaluated_rules", stats.evaluatedRuleCount},
+        {"skipped_rules", stats.skippedRuleCount},
+        {"total_time", (stats.totalTime / 1000)},
+        {"max_time", (stats.maxTime / 1000)},
+        {"rules", rulesObj}
+    });
+}
@@ -51,4 +51,5 @@ private slots:
     void removeRuleAction();
     void rulesAction();
     void matchingArticlesAction();
+    void matchingStatisticsAction();
 };
@@ -316,6 +316,7 @@ int SearchController::generateSearchId() const
  * Returns the search results in JSON format.
  *
  * The return value is an object with a status and an array of dictionaries.
+ * The results are serialized one by one while the response is sent.
  * The dictionary keys are:
  *   - "fileName"
  *   - "fileUrl"
@@ -325,11 +326,16 @@ int SearchController::generateSearchId() const
  *   - "siteUrl"
  *   - "descrLink"
  */
-QJsonObject SearchController::getResults(const QList<SearchResult> &searchResults, const bool isSearchActive, const int totalResults) const
+StreamedJsonObject SearchController::getResults(const QList<SearchResult> &searchResults, const bool isSearchActive, const int totalResults) const
 {
-    QJsonArray searchResultsArray;
-    for (const SearchResult &searchResult : searchResults) {
-        searchResultsArray << QJsonObject {
+    int index = 0;
+    const JsonArrayGenerator resultsGenerator = [searchResults, index]() mutable -> QJsonValue
+    {
+        if (index == searchResults.size())
+            return QJsonValue(QJsonValue::Undefined);
+
+        const SearchResult &searchResult = searchResults.at(index++);
+        return QJsonObject {
             {"fileName", searchResult.fileName},
             {"fileUrl", searchResult.fileUrl},
             {"fileSize", searchResult.fileSize},
@@ -338,14 +344,12 @@ QJsonObject SearchController::getResults(const QList<SearchResult> &searchResult
             {"siteUrl", searchResult.siteUrl},
             {"descrLink", searchResult.descrLink}
         };
-    }
-
-    const QJsonObject result = {
-        {"status", isSearchActive ? "Running" : "Stopped"},
-        {"results", searchResultsArray},
-        {"total", totalResults}
     };
 
+    StreamedJsonObject result;
+    result.insertArray("results", resultsGenerator);
+    result.insert("status", (isSearchActive ? "Running" : "Stopped"));
+    result.insert("total", totalResults);
     return result;
 }
 
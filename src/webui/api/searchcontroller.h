@@ -69,6 +69,6 @@ private:
     void searchFinished(ISession *session, int id);
     void searchFailed(ISession *session, int id);
     int generateSearchId() const;
-    QJsonObject getResults(const QList<SearchResult> &searchResults, bool isSearchActive, int totalResults) const;
+    StreamedJsonObject getResults(const QList<SearchResult> &searchResults, bool isSearchActive, int totalResults) const;
     QJsonArray getPluginsInfo(const QStringList &plugins) const;
 };
@@ -29,119 +29,145 @@
 #include "serialize_torrent.h"
 
 #include <QDateTime>
+#include <QHash>
 
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/torrenthandle.h"
 #include "base/bittorrent/trackerentry.h"
 #include "base/utils/fs.h"
 
-namespace
+QString torrentStateToString(const BitTorrent::TorrentState state)
 {
-    QString torrentStateToString(const BitTorrent::TorrentState state)
-    {
-        switch (state) {
-        case BitTorrent::TorrentState::Error:
-            return QLatin1String("error");
-        case BitTorrent::TorrentState::MissingFiles:
-            return QLatin1String("missingFiles");
-        case BitTorrent::TorrentState::Uploading:
-            return QLatin1String("uploading");
-        case BitTorrent::TorrentState::PausedUploading:
-            return QLatin1String("pausedUP");
-        case BitTorrent::TorrentState::QueuedUploading:
-            return QLatin1String("queuedUP");
-        case BitTorrent::TorrentState::StalledUploading:
-            return QLatin1String("stalledUP");
-        case BitTorrent::TorrentState::CheckingUploading:
-            return QLatin1String("checkingUP");
-        case BitTorrent::TorrentState::ForcedUploading:
-            return QLatin1String("forcedUP");
-        case BitTorrent::TorrentState::Allocating:
-            return QLatin1String("allocating");
-        case BitTorrent::TorrentState::Downloading:
-            return QLatin1String("downloading");
-        case BitTorrent::TorrentState::DownloadingMetadata:
-            return QLatin1String("metaDL");
-        case BitTorrent::TorrentState::PausedDownloading:
-            return QLatin1String("pausedDL");
-        case BitTorrent::TorrentState::QueuedDownloading:
-            return QLatin1String("queuedDL");
-        case BitTorrent::TorrentState::StalledDownloading:
-            return QLatin1String("stalledDL");
-        case BitTorrent::TorrentState::CheckingDownloading:
-            return QLatin1String("checkingDL");
-        case BitTorrent::TorrentState::ForcedDownloading:
-            return QLatin1String("forcedDL");
-        case BitTorrent::TorrentState::CheckingResumeData:
-            return QLatin1String("checkingResumeData");
-        case BitTorrent::TorrentState::Moving:
-            return QLatin1String("moving");
-        default:
-            return QLatin1String("unknown");
-        }
+    switch (state) {
+    case BitTorrent::TorrentState::Error:
+        return QLatin1String("error");
+    case BitTorrent::TorrentState::MissingFiles:
+        return QLatin1String("missingFiles");
+    case BitTorrent::TorrentState::Uploading:
+        return QLatin1String("uploading");
+    case BitTorrent::TorrentState::PausedUploading:
+        return QLatin1String("pausedUP");
+    case BitTorrent::TorrentState::QueuedUploading:
+        return QLatin1String("queuedUP");
+    case BitTorrent::TorrentState::StalledUploading:
+        return QLatin1String("stalledUP");
+    case BitTorrent::TorrentState::CheckingUploading:
+        return QLatin1String("checkingUP");
+    case BitTorrent::TorrentState::ForcedUploading:
+        return QLatin1String("forcedUP");
+    case BitTorrent::TorrentState::Allocating:
+        return QLatin1String("allocating");
+    case BitTorrent::TorrentState::Downloading:
+        return QLatin1String("downloading");
+    case BitTorrent::TorrentState::DownloadingMetadata:
+        return QLatin1String("metaDL");
+    case BitTorrent::TorrentState::PausedDownloading:
+        return QLatin1String("pausedDL");
+    case BitTorrent::TorrentState::QueuedDownloading:
+        return QLatin1String("queuedDL");
+    case BitTorrent::TorrentState::StalledDownloading:
+        return QLatin1String("stalledDL");
+    case BitTorrent::TorrentState::CheckingDownloading:
+        return QLatin1String("checkingDL");
+    case BitTorrent::TorrentState::ForcedDownloading:
+        return QLatin1String("forcedDL");
+    case BitTorrent::TorrentState::CheckingResumeData:
+        return QLatin1String("checkingResumeData");
+    case BitTorrent::TorrentState::Moving:
+        return QLatin1String("moving");
+    default:
+        return QLatin1String("unknown");
     }
 }
 
-QVariantMap serialize(const BitTorrent::TorrentHandle &torrent)
+namespace
 {
-    QVariantMap ret = {
-        {KEY_TORRENT_HASH, QString(torrent.hash())},
-        {KEY_TORRENT_NAME, torrent.name()},
-        {KEY_TORRENT_MAGNET_URI, torrent.createMagnetURI()},
-        {KEY_TORRENT_SIZE, torrent.wantedSize()},
-        {KEY_TORRENT_PROGRESS, torrent.progress()},
-        {KEY_TORRENT_DLSPEED, torrent.downloadPayloadRate()},
-        {KEY_TORRENT_UPSPEED, torrent.uploadPayloadRate()},
-        {KEY_TORRENT_QUEUE_POSITION, torrent.queuePosition()},
-        {KEY_TORRENT_SEEDS, torrent.seedsCount()},
-        {KEY_TORRENT_NUM_COMPLETE, torrent.totalSeedsCount()},
-        {KEY_TORRENT_LEECHS, torrent.leechsCount()},
-        {KEY_TORRENT_NUM_INCOMPLETE, torrent.totalLeechersCount()},
+    using BitTorrent::TorrentHandle;
+    using ValueSerializer = QVariant (*)(const TorrentHandle &torrent);
 
-        {KEY_TORRENT_STATE, torrentStateToString(torrent.state())},
-        {KEY_TORRENT_ETA, torrent.eta()},
-        {KEY_TORRENT_SEQUENTIAL_DOWNLOAD, torrent.isSequentialDownload()},
-        {KEY_TORRENT_FIRST_LAST_PIECE_PRIO, torrent.hasFirstLastPiecePriority()},
+    const QHash<QString, ValueSerializer> &valueSerializers()
+    {
+        static const QHash<QString, ValueSerializer> serializers = {
+            {KEY_TORRENT_HASH, [](const TorrentHandle &torrent) -> QVariant { return QString(torrent.hash()); }},
+            {KEY_TORRENT_NAME, [](const TorrentHandle &torrent) -> QVariant { return torrent.name(); }},
+            {KEY_TORRENT_MAGNET_URI, [](const TorrentHandle &torrent) -> QVariant { return torrent.createMagnetURI(); }},
+            {KEY_TORRENT_SIZE, [](const TorrentHandle &torrent) -> QVariant { return torrent.wantedSize(); }},
+            {KEY_TORRENT_PROGRESS, [](const TorrentHandle &torrent) -> QVariant { return torrent.progress(); }},
+            {KEY_TORRENT_DLSPEED, [](const TorrentHandle &torrent) -> QVariant { return torrent.downloadPayloadRate(); }},
+            {KEY_TORRENT_UPSPEED, [](const TorrentHandle &torrent) -> QVariant { return torrent.uploadPayloadRate(); }},
+            {KEY_TORRENT_QUEUE_POSITION, [](const TorrentHandle &torrent) -> QVariant { return torrent.queuePosition(); }},
+            {KEY_TORRENT_SEEDS, [](const TorrentHandle &torrent) -> QVariant { return torrent.seedsCount(); }},
+            {KEY_TORRENT_NUM_COMPLETE, [](const TorrentHandle &torrent) -> QVariant { return torrent.totalSeedsCount(); }},
+            {KEY_TORRENT_LEECHS, [](const TorrentHandle &torrent) -> QVariant { return torrent.leechsCount(); }},
+            {KEY_TORRENT_NUM_INCOMPLETE, [](const TorrentHandle &torrent) -> QVariant { return torrent.totalLeechersCount(); }},
 
-        {KEY_TORRENT_CATEGORY, torrent.category()},
-        {KEY_TORRENT_TAGS, torrent.tags().values().join(", ")},
-        {KEY_TORRENT_SUPER_SEEDING, torrent.superSeeding()},
-        {KEY_TORRENT_FORCE_START, torrent.isForced()},
-        {KEY_TORRENT_SAVE_PATH, Utils::Fs::toNativePath(torrent.savePath())},
-        {KEY_TORRENT_ADDED_ON, torrent.addedTime().toSecsSinceEpoch()},
-        {KEY_TORRENT_COMPLETION_ON, torrent.completedTime().toSecsSinceEpoch()},
-        {KEY_TORRENT_TRACKER, torrent.currentTracker()},
-        {KEY_TORRENT_TRACKERS_COUNT, torrent.trackers().size()},
-        {KEY_TORRENT_DL_LIMIT, torrent.downloadLimit()},
-        {KEY_TORRENT_UP_LIMIT, torrent.uploadLimit()},
-        {KEY_TORRENT_AMOUNT_DOWNLOADED, torrent.totalDownload()},
-        {KEY_TORRENT_AMOUNT_UPLOADED, torrent.totalUpload()},
-        {KEY_TORRENT_AMOUNT_DOWNLOADED_SESSION, torrent.totalPayloadDownload()},
-        {KEY_TORRENT_AMOUNT_UPLOADED_SESSION, torrent.totalPayloadUpload()},
-        {KEY_TORRENT_AMOUNT_LEFT, torrent.incompletedSize()},
-        {KEY_TORRENT_AMOUNT_COMPLETED, torrent.completedSize()},
-        {KEY_TORRENT_MAX_RATIO, torrent.maxRatio()},
-        {KEY_TORRENT_MAX_SEEDING_TIME, torrent.maxSeedingTime()},
-        {KEY_TORRENT_RATIO_LIMIT, torrent.ratioLimit()},
-        {KEY_TORRENT_SEEDING_TIME_LIMIT, torrent.seedingTimeLimit()},
-        {KEY_TORRENT_LAST_SEEN_COMPLETE_TIME, torrent.lastSeenComplete().toSecsSinceEpoch()},
-        {KEY_TORRENT_AUTO_TORRENT_MANAGEMENT, torrent.isAutoTMMEnabled()},
-        {KEY_TORRENT_TIME_ACTIVE, torrent.activeTime()},
-        {KEY_TORRENT_AVAILABILITY, torrent.distributedCopies()},
+            {KEY_TORRENT_STATE, [](const TorrentHandle &torrent) -> QVariant { return torrentStateToString(torrent.state()); }},
+            {KEY_TORRENT_ETA, [](const TorrentHandle &torrent) -> QVariant { return torrent.eta(); }},
+            {KEY_TORRENT_SEQUENTIAL_DOWNLOAD, [](const TorrentHandle &torrent) -> QVariant { return torrent.isSequentialDownload(); }},
+            {KEY_TORRENT_FIRST_LAST_PIECE_PRIO, [](const TorrentHandle &torrent) -> QVariant { return torrent.hasFirstLastPiecePriority(); }},
 
-        {KEY_TORRENT_TOTAL_SIZE, torrent.totalSize()}
-    };
+            {KEY_TORRENT_CATEGORY, [](const TorrentHandle &torrent) -> QVariant { return torrent.category(); }},
+            {KEY_TORRENT_TAGS, [](const TorrentHandle &torrent) -> QVariant { return torrent.tagsString(); }},
+            {KEY_TORRENT_SUPER_SEEDING, [](const TorrentHandle &torrent) -> QVariant { return torrent.superSeeding(); }},
+            {KEY_TORRENT_FORCE_START, [](const TorrentHandle &torrent) -> QVariant { return torrent.isForced(); }},
+            {KEY_TORRENT_SAVE_PATH, [](const TorrentHandle &torrent) -> QVariant { return Utils::Fs::toNativePath(torrent.savePath()); }},
+            {KEY_TORRENT_ADDED_ON, [](const TorrentHandle &torrent) -> QVariant { return torrent.addedTime().toSecsSinceEpoch(); }},
+            {KEY_TORRENT_COMPLETION_ON, [](const TorrentHandle &torrent) -> QVariant { return torrent.completedTime().toSecsSinceEpoch(); }},
+            {KEY_TORRENT_TRACKER, [](const TorrentHandle &torrent) -> QVariant { return torrent.currentTracker(); }},
+            {KEY_TORRENT_TRACKERS_COUNT, [](const TorrentHandle &torrent) -> QVariant { return torrent.trackersCount(); }},
+            {KEY_TORRENT_DL_LIMIT, [](const TorrentHandle &torrent) -> QVariant { return torrent.downloadLimit(); }},
+            {KEY_TORRENT_UP_LIMIT, [](const TorrentHandle &torrent) -> QVariant { return torrent.uploadLimit(); }},
+            {KEY_TORRENT_AMOUNT_DOWNLOADED, [](const TorrentHandle &torrent) -> QVariant { return torrent.totalDownload(); }},
+            {KEY_TORRENT_AMOUNT_UPLOADED, [](const TorrentHandle &torrent) -> QVariant { return torrent.totalUpload(); }},
+            {KEY_TORRENT_AMOUNT_DOWNLOADED_SESSION, [](const TorrentHandle &torrent) -> QVariant { return torrent.totalPayloadDownload(); }},
+            {KEY_TORRENT_AMOUNT_UPLOADED_SESSION, [](const TorrentHandle &torrent) -> QVariant { return torrent.totalPayloadUpload(); }},
+            {KEY_TORRENT_AMOUNT_LEFT, [](const TorrentHandle &torrent) -> QVariant { return torrent.incompletedSize(); }},
+            {KEY_TORRENT_AMOUNT_COMPLETED, [](const TorrentHandle &torrent) -> QVariant { return torrent.completedSize(); }},
+            {KEY_TORRENT_MAX_RATIO, [](const TorrentHandle &torrent) -> QVariant { return torrent.maxRatio(); }},
+            {KEY_TORRENT_MAX_SEEDING_TIME, [](const TorrentHandle &torrent) -> QVariant { return torrent.maxSeedingTime(); }},
+            {KEY_TORRENT_RATIO_LIMIT, [](const TorrentHandle &torrent) -> QVariant { return torrent.ratioLimit(); }},
+            {KEY_TORRENT_SEEDING_TIME_LIMIT, [](const TorrentHandle &torrent) -> QVariant { return torrent.seedingTimeLimit(); }},
+            {KEY_TORRENT_LAST_SEEN_COMPLETE_TIME, [](const TorrentHandle &torrent) -> QVariant { return torrent.lastSeenComplete().toSecsSinceEpoch(); }},
+            {KEY_TORRENT_AUTO_TORRENT_MANAGEMENT, [](const TorrentHandle &torrent) -> QVariant { return torrent.isAutoTMMEnabled(); }},
+            {KEY_TORRENT_TIME_ACTIVE, [](const TorrentHandle &torrent) -> QVariant { return torrent.activeTime(); }},
+            {KEY_TORRENT_AVAILABILITY, [](const TorrentHandle &torrent) -> QVariant { return torrent.distributedCopies(); }},
 
-    const qreal ratio = torrent.realRatio();
-    ret[KEY_TORRENT_RATIO] = (ratio > BitTorrent::TorrentHandle::MAX_RATIO) ? -1 : ratio;
+            {KEY_TORRENT_TOTAL_SIZE, [](const TorrentHandle &torrent) -> QVariant { return torrent.totalSize(); }},
 
-    if (torrent.isPaused() || torrent.isChecking()) {
-        ret[KEY_TORRENT_LAST_ACTIVITY_TIME] = 0;
+            {KEY_TORRENT_RATIO, [](const TorrentHandle &torrent) -> QVariant
+                {
+                    const qreal ratio = torrent.realRatio();
+                    return (ratio > TorrentHandle::MAX_RATIO) ? -1 : ratio;
+                }},
+            {KEY_TORRENT_LAST_ACTIVITY_TIME, [](const TorrentHandle &torrent) -> QVariant
+                {
+                    if (torrent.isPaused() || torrent.isChecking())
+                        return 0;
+                    return (QDateTime::currentDateTime().toSecsSinceEpoch() - torrent.timeSinceActivity());
+                }}
+        };
+        return serializers;
     }
-    else {
-        const qint64 dt = (QDateTime::currentDateTime().toSecsSinceEpoch()
-            - torrent.timeSinceActivity());
-        ret[KEY_TORRENT_LAST_ACTIVITY_TIME] = dt;
+}
+
+QVariantMap serialize(const BitTorrent::TorrentHandle &torrent)
+{
+    QVariantMap ret;
+    const QHash<QString, ValueSerializer> &serializers = valueSerializers();
+    for (auto iter = serializers.cbegin(); iter != serializers.cend(); ++iter)
+        ret[iter.key()] = iter.value()(torrent);
+
+    return ret;
+}
+
+QVariantMap serialize(const BitTorrent::TorrentHandle &torrent, const QStringList &keys)
+{
+    QVariantMap ret;
+    const QHash<QString, ValueSerializer> &serializers = valueSerializers();
+    for (const QString &key : keys) {
+        const ValueSerializer serializer = serializers.value(key);
+        if (serializer)
+            ret[key] = serializer(torrent);
     }
 
     return ret;
@@ -28,11 +28,13 @@
 
 #pragma once
 
+#include <QStringList>
 #include <QVariantMap>
 
 namespace BitTorrent
 {
     class TorrentHandle;
+    enum class TorrentState;
 }
 
 // Torrent keys
@@ -81,4 +83,7 @@ const char KEY_TORRENT_AUTO_TORRENT_MANAGEMENT[] = "auto_tmm";
 const char KEY_TORRENT_TIME_ACTIVE[] = "time_active";
 const char KEY_TORRENT_AVAILABILITY[] = "availability";
 
+QString torrentStateToString(BitTorrent::TorrentState state);
 QVariantMap serialize(const BitTorrent::TorrentHandle &torrent);
+// Serializes the values of given keys only, it is cheaper when few values are needed
+QVariantMap serialize(const BitTorrent::TorrentHandle &torrent, const QStringList &keys);
@@ -29,17 +29,19 @@
 #include "synccontroller.h"
 
 #include <algorithm>
+#include <memory>
 
 #include <QJsonObject>
 #include <QMetaObject>
 #include <QThread>
+#include <QTimer>
 
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/torrentdetailscache.h"
 #include "base/bittorrent/torrenthandle.h"
-#include "base/bittorrent/trackerentry.h"
 #include "base/global.h"
 #include "base/net/geoipmanager.h"
 #include "base/preferences.h"
@@ -48,14 +50,19 @@
 #include "freediskspacechecker.h"
 #include "isessionmanager.h"
 #include "serialize/serialize_torrent.h"
+#include "synceventstream.h"
+#include "synctorrentsjournal.h"
 
 namespace
 {
     const int FREEDISKSPACE_CHECK_TIMEOUT = 30000;
+    // Torrents journal is discarded when no client uses it during this period
+    const int TORRENTS_JOURNAL_RETENTION_PERIOD = 5 * 60 * 1000; // ms
 
     // Sync main data keys
     const char KEY_SYNC_MAINDATA_QUEUEING[] = "queueing";
     const char KEY_SYNC_MAINDATA_REFRESH_INTERVAL[] = "refresh_interval";
+    const char KEY_SYNC_MAINDATA_RESTORING_TORRENTS[] = "restoring_torrents";
     const char KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS[] = "use_alt_speed_limits";
 
     // Sync torrent peers keys
@@ -157,6 +164,31 @@ namespace
         return map;
     }
 
+    // The dictionaries (e.g. "torrents") are serialized item by item while the response is sent
+    StreamedJsonObject toStreamedJsonObject(const QVariantMap &data)
+    {
+        StreamedJsonObject result;
+        for (auto iter = data.cbegin(); iter != data.cend(); ++iter) {
+            if (iter.value().type() != QVariant::Hash) {
+                result.insert(iter.key(), QJsonValue::fromVariant(iter.value()));
+                continue;
+            }
+
+            const QVariantHash items = iter.value().toHash();
+            const QStringList keys = items.keys();
+            int index = 0;
+            result.insertObject(iter.key(), [items, keys, index]() mutable -> QPair<QString, QJsonValue>
+            {
+                if (index == keys.size())
+                    return {};
+
+                const QString &key = keys.at(index++);
+                return {key, QJsonValue::fromVariant(items.value(key))};
+            });
+        }
+        return result;
+    }
+
     // Compare two structures (prevData, data) and calculate difference (syncData).
     // Structures encoded as map.
     void processMap(const QVariantMap &prevData, const QVariantMap &data, QVariantMap &syncData)
@@ -355,6 +387,10 @@ SyncController::SyncController(ISessionManager *sessionManager, QObject *parent)
     m_freeDiskSpaceThread->start();
     invokeChecker();
     m_freeDiskSpaceElapsedTimer.start();
+
+    m_torrentsJournalReleaseTimer = new QTimer(this);
+    m_torrentsJournalReleaseTimer->setInterval(TORRENTS_JOURNAL_RETENTION_PERIOD / 5);
+    connect(m_torrentsJournalReleaseTimer, &QTimer::timeout, this, &SyncController::releaseUnusedTorrentsJournal);
 }
 
 SyncController::~SyncController()
@@ -422,86 +458,30 @@ SyncController::~SyncController()
 //  - "up_rate_limit: upload speed limit
 //  - "queueing": queue system usage flag
 //  - "refresh_interval": torrents table refresh interval
+//  - "restoring_torrents": torrents of the previous session are still being restored
 //  - "free_space_on_disk": Free space on the default save path
 // GET param:
 //   - rid (int): last response id
 void SyncController::maindataAction()
 {
-    const auto *session = BitTorrent::Session::instance();
-
-    QVariantMap data;
-
-    QVariantMap lastResponse = sessionManager()->session()->getData(QLatin1String("syncMainDataLastResponse")).toMap();
-    QVariantMap lastAcceptedResponse = sessionManager()->session()->getData(QLatin1String("syncMainDataLastAcceptedResponse")).toMap();
-
-    QVariantHash torrents;
-    QHash<QString, QStringList> trackers;
-    for (const BitTorrent::TorrentHandle *torrent : asConst(session->torrents())) {
-        const BitTorrent::InfoHash torrentHash = torrent->hash();
-
-        QVariantMap map = serialize(*torrent);
-        map.remove(KEY_TORRENT_HASH);
-
-        // Calculated last activity time can differ from actual value by up to 10 seconds (this is a libtorrent issue).
-        // So we don't need unnecessary updates of last activity time in response.
-        const auto iterTorrents = lastResponse.find("torrents");
-        if (iterTorrents != lastResponse.end()) {
-            const QVariantHash lastResponseTorrents = iterTorrents->toHash();
-            const auto iterHash = lastResponseTorrents.find(torrentHash);
-
-            if (iterHash != lastResponseTorrents.end()) {
-                const QVariantMap torrentData = iterHash->toMap();
-                const auto iterLastActivity = torrentData.find(KEY_TORRENT_LAST_ACTIVITY_TIME);
+    SyncTorrentsJournal *journal = torrentsJournal();
+    // Free disk space could be updated since the last statistics update
+    journal->updateServerState(serverState());
 
-                if (iterLastActivity != torrentData.end()) {
-                    const int lastValue = iterLastActivity->toInt();
-                    if (qAbs(lastValue - map[KEY_TORRENT_LAST_ACTIVITY_TIME].toInt()) < 15)
-                        map[KEY_TORRENT_LAST_ACTIVITY_TIME] = lastValue;
-                }
-            }
-        }
-
-        for (const BitTorrent::TrackerEntry &tracker : asConst(torrent->trackers()))
-            trackers[tracker.url()] << torrentHash;
-
-        torrents[torrentHash] = map;
-    }
-    data["torrents"] = torrents;
-
-    QVariantHash categories;
-    const QStringMap categoriesList = session->categories();
-    for (auto it = categoriesList.cbegin(); it != categoriesList.cend(); ++it) {
-        const QString &key = it.key();
-        categories[key] = QVariantMap {
-            {"name", key},
-            {"savePath", it.value()}
-        };
-    }
-    data["categories"] = categories;
-
-    QVariantList tags;
-    for (const QString &tag : asConst(session->tags()))
-        tags << tag;
-    data["tags"] = tags;
-
-    QVariantHash trackersHash;
-    for (auto i = trackers.constBegin(); i != trackers.constEnd(); ++i) {
-        trackersHash[i.key()] = i.value();
-    }
-    data["trackers"] = trackersHash;
+    const int acceptedResponseId {params()["rid"].toInt()};
+    const bool fullUpdate = (acceptedResponseId <= 0) || !journal->canProvideChangesSince(acceptedResponseId);
 
-    QVariantMap serverState = getTransferInfo();
-    serverState[KEY_TRANSFER_FREESPACEONDISK] = getFreeDiskSpace();
-    serverState[KEY_SYNC_MAINDATA_QUEUEING] = session->isQueueingSystemEnabled();
-    serverState[KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS] = session->isAltGlobalSpeedLimitEnabled();
-    serverState[KEY_SYNC_MAINDATA_REFRESH_INTERVAL] = session->refreshInterval();
-    data["server_state"] = serverState;
+    QVariantMap syncData;
+    journal->collectChanges((fullUpdate ? 0 : acceptedResponseId), syncData);
+    if (fullUpdate)
+        syncData[KEY_FULL_UPDATE] = true;
 
-    const int acceptedResponseId {params()["rid"].toInt()};
-    setResult(QJsonObject::fromVariantMap(generateSyncData(acceptedResponseId, data, lastAcceptedResponse, lastResponse)));
+    // Response ID is the journal revision so the next request
+    // gets only the changes made after this response
+    const int responseId = journal->commitRevision();
+    syncData[KEY_RESPONSE_ID] = responseId;
 
-    sessionManager()->session()->setData(QLatin1String("syncMainDataLastResponse"), lastResponse);
-    sessionManager()->session()->setData(QLatin1String("syncMainDataLastAcceptedResponse"), lastAcceptedResponse);
+    setResult(toStreamedJsonObject(syncData));
 }
 
 // GET param:
@@ -520,7 +500,9 @@ void SyncController::torrentPeersAction()
     QVariantMap data;
     QVariantHash peers;
 
-    const QVector<BitTorrent::PeerInfo> peersList = torrent->peers();
+    bool isPending = false;
+    const QVector<BitTorrent::PeerInfo> peersList = BitTorrent::Session::instance()->torrentDetailsCache()->peers(torrent
+        , BitTorrent::TorrentDetailsCache::RequestMode::NonBlocking, &isPending);
 
     bool resolvePeerCountries = Preferences::instance()->resolvePeerCountries();
 
@@ -556,11 +538,48 @@ void SyncController::torrentPeersAction()
 
     const int acceptedResponseId {params()["rid"].toInt()};
     setResult(QJsonObject::fromVariantMap(generateSyncData(acceptedResponseId, data, lastAcceptedResponse, lastResponse)));
+    setResultPending(isPending);
 
     sessionManager()->session()->setData(QLatin1String("syncTorrentPeersLastResponse"), lastResponse);
     sessionManager()->session()->setData(QLatin1String("syncTorrentPeersLastAcceptedResponse"), lastAcceptedResponse);
 }
 
+// Opens Server-Sent Events stream. It starts with "maindata" event containing
+// full update and then pushes the following events as soon as changes occur:
+//  - "maindata": data changes in "sync/maindata" format (including "rid")
+//  - "transfer": global transfer info in "transfer/info" format
+//  - "log": array of new log messages in "log/main" format
+//  - "peers": array of new peer log entries in "log/peers" format
+// The session is kept alive while the stream pushes the events (the heartbeats
+// included), the stream is closed when the session ends (logout) or expires.
+void SyncController::eventsAction()
+{
+    const auto stream = std::make_shared<SyncEventStream>(torrentsJournal(), getTransferInfo);
+
+    // Torrents journal is kept while the stream is open
+    ++m_activeEventStreams;
+    connect(stream.get(), &QObject::destroyed, this, [this]()
+    {
+        --m_activeEventStreams;
+        m_torrentsJournalLastUsed.start();
+    });
+
+    setResult(stream);
+}
+
+QVariantMap SyncController::serverState()
+{
+    const auto *session = BitTorrent::Session::instance();
+
+    QVariantMap serverState = getTransferInfo();
+    serverState[KEY_TRANSFER_FREESPACEONDISK] = getFreeDiskSpace();
+    serverState[KEY_SYNC_MAINDATA_QUEUEING] = session->isQueueingSystemEnabled();
+    serverState[KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS] = session->isAltGlobalSpeedLimitEnabled();
+    serverState[KEY_SYNC_MAINDATA_REFRESH_INTERVAL] = session->refreshInterval();
+    serverState[KEY_SYNC_MAINDATA_RESTORING_TORRENTS] = session->isRestoringTorrents();
+    return serverState;
+}
+
 qint64 SyncController::getFreeDiskSpace()
 {
     if (m_freeDiskSpaceElapsedTimer.hasExpired(FREEDISKSPACE_CHECK_TIMEOUT)) {
@@ -576,6 +595,35 @@ void SyncController::freeDiskSpaceSizeUpdated(qint64 freeSpaceSize)
     m_freeDiskSpace = freeSpaceSize;
 }
 
+SyncTorrentsJournal *SyncController::torrentsJournal()
+{
+    // Torrents data is tracked only when there is a client interested in it
+    if (!m_torrentsJournal) {
+        m_torrentsJournal = new SyncTorrentsJournal {m_nextTorrentsRevision, this};
+        m_torrentsJournal->updateServerState(serverState());
+        connect(BitTorrent::Session::instance(), &BitTorrent::Session::statsUpdated, m_torrentsJournal, [this]()
+        {
+            m_torrentsJournal->updateServerState(serverState());
+        });
+        m_torrentsJournalReleaseTimer->start();
+    }
+
+    m_torrentsJournalLastUsed.start();
+    return m_torrentsJournal;
+}
+
+void SyncController::releaseUnusedTorrentsJournal()
+{
+    if ((m_activeEventStreams > 0) || !m_torrentsJournalLastUsed.hasExpired(TORRENTS_JOURNAL_RETENTION_PERIOD))
+        return;
+
+    // Clients polling again later get the full update
+    m_nextTorrentsRevision = m_torrentsJournal->revision();
+    delete m_torrentsJournal;
+    m_torrentsJournal = nullptr;
+    m_torrentsJournalReleaseTimer->stop();
+}
+
 void SyncController::invokeChecker() const
 {
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
@@ -35,8 +35,10 @@
 struct ISessionManager;
 
 class QThread;
+class QTimer;
 
 class FreeDiskSpaceChecker;
+class SyncTorrentsJournal;
 
 class SyncController : public APIController
 {
@@ -52,14 +54,23 @@ public:
 private slots:
     void maindataAction();
     void torrentPeersAction();
+    void eventsAction();
     void freeDiskSpaceSizeUpdated(qint64 freeSpaceSize);
 
 private:
+    QVariantMap serverState();
     qint64 getFreeDiskSpace();
     void invokeChecker() const;
+    SyncTorrentsJournal *torrentsJournal();
+    void releaseUnusedTorrentsJournal();
 
     qint64 m_freeDiskSpace = 0;
     FreeDiskSpaceChecker *m_freeDiskSpaceChecker = nullptr;
     QThread *m_freeDiskSpaceThread = nullptr;
     QElapsedTimer m_freeDiskSpaceElapsedTimer;
+    SyncTorrentsJournal *m_torrentsJournal = nullptr;
+    QTimer *m_torrentsJournalReleaseTimer = nullptr;
+    QElapsedTimer m_torrentsJournalLastUsed;
+    int m_nextTorrentsRevision = 1;
+    int m_activeEventStreams = 0;
 };
@@ -0,0 +1,206 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "synceventstream.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+
+#include "base/bittorrent/session.h"
+#include "base/global.h"
+#include "synctorrentsjournal.h"
+
+namespace
+{
+    // Updates arriving within this interval are sent together
+    const int FLUSH_DELAY = 100; // ms
+    // Keeps the connection alive through the proxies closing idle connections
+    const int HEARTBEAT_INTERVAL = 15000; // ms
+    // Older log entries are dropped if the client doesn't receive the data,
+    // it can still request them using "log/main" and "log/peers"
+    const int MAX_PENDING_LOG_ENTRIES = 500;
+
+    const char EVENT_MAINDATA[] = "maindata";
+    const char EVENT_TRANSFER[] = "transfer";
+    const char EVENT_LOG[] = "log";
+    const char EVENT_PEERS[] = "peers";
+
+    const char KEY_FULL_UPDATE[] = "full_update";
+    const char KEY_RESPONSE_ID[] = "rid";
+
+    const char KEY_LOG_ID[] = "id";
+    const char KEY_LOG_TIMESTAMP[] = "timestamp";
+    const char KEY_LOG_MSG_TYPE[] = "type";
+    const char KEY_LOG_MSG_MESSAGE[] = "message";
+    const char KEY_LOG_PEER_IP[] = "ip";
+    const char KEY_LOG_PEER_BLOCKED[] = "blocked";
+    const char KEY_LOG_PEER_REASON[] = "reason";
+
+    QByteArray serializeEvent(const char *name, const QJsonDocument &data)
+    {
+        // Compact JSON never contains line breaks so it fits single "data" field
+        return QByteArray("event: ") + name + "\ndata: "
+            + data.toJson(QJsonDocument::Compact) + "\n\n";
+    }
+
+    template <typename T>
+    void appendBounded(QVector<T> &entries, const T &entry)
+    {
+        if (entries.size() >= MAX_PENDING_LOG_ENTRIES)
+            entries.removeFirst();
+        entries.append(entry);
+    }
+}
+
+SyncEventStream::SyncEventStream(SyncTorrentsJournal *torrentsJournal, const TransferInfoProvider &transferInfoProvider
+                                 , QObject *parent)
+    : Http::ContentStream {parent}
+    , m_torrentsJournal {torrentsJournal}
+    , m_transferInfoProvider {transferInfoProvider}
+    , m_flushTimer {new QTimer {this}}
+    , m_heartbeatTimer {new QTimer {this}}
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FLUSH_DELAY);
+    connect(m_flushTimer, &QTimer::timeout, this, &ContentStream::dataAvailable);
+
+    m_heartbeatTimer->setInterval(HEARTBEAT_INTERVAL);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, [this]()
+    {
+        m_isHeartbeatPending = true;
+        emit dataAvailable();
+    });
+    m_heartbeatTimer->start();
+
+    connect(torrentsJournal, &SyncTorrentsJournal::changed, this, [this]()
+    {
+        m_isTorrentsChanged = true;
+        scheduleFlush();
+    });
+    connect(torrentsJournal, &QObject::destroyed, this, &ContentStream::finished);
+    connect(BitTorrent::Session::instance(), &BitTorrent::Session::statsUpdated, this, [this]()
+    {
+        m_isTransferInfoChanged = true;
+        scheduleFlush();
+    });
+
+    const Logger *logger = Logger::instance();
+    connect(logger, &Logger::newLogMessage, this, &SyncEventStream::handleNewLogMessage);
+    connect(logger, &Logger::newLogPeer, this, &SyncEventStream::handleNewLogPeer);
+}
+
+QByteArray SyncEventStream::takePendingData()
+{
+    QByteArray data;
+
+    if (m_isTorrentsChanged && m_torrentsJournal) {
+        m_isTorrentsChanged = false;
+
+        // Initial event (or the one following the changes which are no longer
+        // available) contains all the data like "sync/maindata" full update does
+        const bool fullUpdate = !m_torrentsJournal->canProvideChangesSince(m_torrentsRevision);
+        QVariantMap syncData;
+        m_torrentsJournal->collectChanges((fullUpdate ? 0 : m_torrentsRevision), syncData);
+        if (fullUpdate || !syncData.isEmpty()) {
+            m_torrentsRevision = m_torrentsJournal->commitRevision();
+            // Client can switch to polling "sync/maindata" using this response ID
+            syncData[KEY_RESPONSE_ID] = m_torrentsRevision;
+            if (fullUpdate)
+                syncData[KEY_FULL_UPDATE] = true;
+            data += serializeEvent(EVENT_MAINDATA, QJsonDocument::fromVariant(syncData));
+        }
+    }
+
+    if (m_isTransferInfoChanged) {
+        m_isTransferInfoChanged = false;
+        data += serializeEvent(EVENT_TRANSFER, QJsonDocument::fromVariant(m_transferInfoProvider()));
+    }
+
+    if (!m_pendingMessages.isEmpty()) {
+        QJsonArray msgList;
+        for (const Log::Msg &msg : asConst(m_pendingMessages)) {
+            msgList.append(QJsonObject {
+                {KEY_LOG_ID, msg.id},
+                {KEY_LOG_TIMESTAMP, msg.timestamp},
+                {KEY_LOG_MSG_TYPE, msg.type},
+                {KEY_LOG_MSG_MESSAGE, msg.message}
+            });
+        }
+        m_pendingMessages.clear();
+        data += serializeEvent(EVENT_LOG, QJsonDocument(msgList));
+    }
+
+    if (!m_pendingPeers.isEmpty()) {
+        QJsonArray peerList;
+        for (const Log::Peer &peer : asConst(m_pendingPeers)) {
+            peerList.append(QJsonObject {
+                {KEY_LOG_ID, peer.id},
+                {KEY_LOG_TIMESTAMP, peer.timestamp},
+                {KEY_LOG_PEER_IP, peer.ip},
+                {KEY_LOG_PEER_BLOCKED, peer.blocked},
+                {KEY_LOG_PEER_REASON, peer.reason}
+            });
+        }
+        m_pendingPeers.clear();
+        data += serializeEvent(EVENT_PEERS, QJsonDocument(peerList));
+    }
+
+    if (m_isHeartbeatPending) {
+        m_isHeartbeatPending = false;
+        // Comment line is ignored by the clients
+        if (data.isEmpty())
+            data = ": ping\n\n";
+    }
+
+    return data;
+}
+
+bool SyncEventStream::isFinished() const
+{
+    return !m_torrentsJournal;
+}
+
+void SyncEventStream::scheduleFlush()
+{
+    if (!m_flushTimer->isActive())
+        m_flushTimer->start();
+}
+
+void SyncEventStream::handleNewLogMessage(const Log::Msg &message)
+{
+    appendBounded(m_pendingMessages, message);
+    scheduleFlush();
+}
+
+void SyncEventStream::handleNewLogPeer(const Log::Peer &peer)
+{
+    appendBounded(m_pendingPeers, peer);
+    scheduleFlush();
+}
@@ -0,0 +1,76 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <functional>
+
+#include <QPointer>
+#include <QVariantMap>
+#include <QVector>
+
+#include "base/http/contentstream.h"
+#include "base/logger.h"
+
+class QTimer;
+
+class SyncTorrentsJournal;
+
+// Pushes the "sync/maindata" torrent changes, transfer info and new log entries
+// to the client as Server-Sent Events. The changes made while the client isn't
+// able to receive data are merged, so the stream never falls behind the session.
+class SyncEventStream final : public Http::ContentStream
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(SyncEventStream)
+
+public:
+    using TransferInfoProvider = std::function<QVariantMap ()>;
+
+    SyncEventStream(SyncTorrentsJournal *torrentsJournal, const TransferInfoProvider &transferInfoProvider
+                    , QObject *parent = nullptr);
+
+    QByteArray takePendingData() override;
+    bool isFinished() const override;
+
+private:
+    void scheduleFlush();
+    void handleNewLogMessage(const Log::Msg &message);
+    void handleNewLogPeer(const Log::Peer &peer);
+
+    QPointer<SyncTorrentsJournal> m_torrentsJournal;
+    TransferInfoProvider m_transferInfoProvider;
+    int m_torrentsRevision = 0;
+    bool m_isTorrentsChanged = true;
+    bool m_isTransferInfoChanged = true;
+    bool m_isHeartbeatPending = false;
+    QVector<Log::Msg> m_pendingMessages;
+    QVector<Log::Peer> m_pendingPeers;
+    QTimer *m_flushTimer = nullptr;
+    QTimer *m_heartbeatTimer = nullptr;
+};
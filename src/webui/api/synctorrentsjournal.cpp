@@ -0,0 +1,455 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#include "synctorrentsjournal.h"
+
+#include <algorithm>
+
+#include <QTimer>
+
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/session.h"
+#include "base/bittorrent/torrenthandle.h"
+#include "base/global.h"
+#include "serialize/serialize_torrent.h"
+
+namespace
+{
+    // Some values can be changed without any notification (e.g. speed limits)
+    // so all the torrents are periodically checked for changes during this period
+    const int REVALIDATION_PERIOD = 60; // sec
+
+    // Records of removed items are discarded when they exceed this number
+    const int MAX_REMOVAL_RECORDS = 1000;
+
+    const char KEY_CATEGORIES[] = "categories";
+    const char KEY_CATEGORY_NAME[] = "name";
+    const char KEY_CATEGORY_SAVE_PATH[] = "savePath";
+    const char KEY_SERVER_STATE[] = "server_state";
+    const char KEY_TAGS[] = "tags";
+    const char KEY_TORRENTS[] = "torrents";
+    const char KEY_TRACKERS[] = "trackers";
+
+    // Values reported by the torrent status updates, the rest of them
+    // are changed by the notified actions (or checked by the revalidation)
+    const QStringList STATUS_KEYS {
+        KEY_TORRENT_SIZE, KEY_TORRENT_PROGRESS, KEY_TORRENT_DLSPEED, KEY_TORRENT_UPSPEED
+        , KEY_TORRENT_QUEUE_POSITION, KEY_TORRENT_SEEDS, KEY_TORRENT_NUM_COMPLETE, KEY_TORRENT_LEECHS
+        , KEY_TORRENT_NUM_INCOMPLETE, KEY_TORRENT_RATIO, KEY_TORRENT_ETA, KEY_TORRENT_STATE
+        , KEY_TORRENT_SEQUENTIAL_DOWNLOAD, KEY_TORRENT_FIRST_LAST_PIECE_PRIO, KEY_TORRENT_SUPER_SEEDING
+        , KEY_TORRENT_FORCE_START, KEY_TORRENT_COMPLETION_ON, KEY_TORRENT_TRACKER
+        , KEY_TORRENT_AMOUNT_DOWNLOADED, KEY_TORRENT_AMOUNT_UPLOADED, KEY_TORRENT_AMOUNT_DOWNLOADED_SESSION
+        , KEY_TORRENT_AMOUNT_UPLOADED_SESSION, KEY_TORRENT_AMOUNT_LEFT, KEY_TORRENT_AMOUNT_COMPLETED
+        , KEY_TORRENT_LAST_SEEN_COMPLETE_TIME, KEY_TORRENT_LAST_ACTIVITY_TIME, KEY_TORRENT_TIME_ACTIVE
+        , KEY_TORRENT_AVAILABILITY, KEY_TORRENT_TOTAL_SIZE
+    };
+
+    const QStringList SHARE_LIMIT_KEYS {
+        KEY_TORRENT_MAX_RATIO, KEY_TORRENT_MAX_SEEDING_TIME, KEY_TORRENT_RATIO_LIMIT, KEY_TORRENT_SEEDING_TIME_LIMIT
+    };
+
+    bool isSameValue(const QString &key, const QVariant &oldValue, const QVariant &newValue)
+    {
+        // Calculated last activity time can differ from actual value by up to 10 seconds (this is a libtorrent issue).
+        // So we don't need unnecessary updates of last activity time in response.
+        if (key == QLatin1String(KEY_TORRENT_LAST_ACTIVITY_TIME))
+            return (qAbs(oldValue.toLongLong() - newValue.toLongLong()) < 15);
+
+        return (oldValue == newValue);
+    }
+}
+
+SyncTorrentsJournal::SyncTorrentsJournal(const int firstRevision, QObject *parent)
+    : QObject {parent}
+    , m_revision {std::max(firstRevision, 1)}
+    , m_firstAvailableRevision {m_revision}
+    , m_revalidationTimer {new QTimer {this}}
+{
+    const auto *session = BitTorrent::Session::instance();
+    for (BitTorrent::TorrentHandle *const torrent : asConst(session->torrents()))
+        addTorrent(torrent);
+
+    connect(session, &BitTorrent::Session::torrentLoaded, this, &SyncTorrentsJournal::addTorrent);
+    connect(session, &BitTorrent::Session::torrentAboutToBeRemoved, this, &SyncTorrentsJournal::removeTorrent);
+    connect(session, &BitTorrent::Session::torrentsUpdated, this, &SyncTorrentsJournal::updateTorrents);
+    connect(session, &BitTorrent::Session::torrentMetadataLoaded, this, &SyncTorrentsJournal::updateTorrent);
+
+    // Changes that aren't reported by the status updates
+    const auto connectValuesUpdate = [this, session](const auto signal, const QStringList &keys)
+    {
+        connect(session, signal, this, [this, keys](const BitTorrent::TorrentHandle *torrent)
+        {
+            updateTorrentValues(torrent, keys);
+        });
+    };
+    connectValuesUpdate(&BitTorrent::Session::torrentCategoryChanged, {KEY_TORRENT_CATEGORY, KEY_TORRENT_SAVE_PATH});
+    connectValuesUpdate(&BitTorrent::Session::torrentFinished, STATUS_KEYS);
+    connectValuesUpdate(&BitTorrent::Session::torrentNameChanged, {KEY_TORRENT_NAME});
+    connectValuesUpdate(&BitTorrent::Session::torrentPaused, STATUS_KEYS);
+    connectValuesUpdate(&BitTorrent::Session::torrentResumed, STATUS_KEYS);
+    connectValuesUpdate(&BitTorrent::Session::torrentSavePathChanged, {KEY_TORRENT_SAVE_PATH});
+    connectValuesUpdate(&BitTorrent::Session::torrentSavingModeChanged, {KEY_TORRENT_AUTO_TORRENT_MANAGEMENT, KEY_TORRENT_SAVE_PATH});
+    connectValuesUpdate(&BitTorrent::Session::torrentShareLimitChanged, SHARE_LIMIT_KEYS);
+    connectValuesUpdate(&BitTorrent::Session::torrentTagAdded, {KEY_TORRENT_TAGS});
+    connectValuesUpdate(&BitTorrent::Session::torrentTagRemoved, {KEY_TORRENT_TAGS});
+    connectValuesUpdate(&BitTorrent::Session::trackerError, {KEY_TORRENT_TRACKER});
+    connectValuesUpdate(&BitTorrent::Session::trackerSuccess, {KEY_TORRENT_TRACKER});
+    connectValuesUpdate(&BitTorrent::Session::trackerWarning, {KEY_TORRENT_TRACKER});
+    connect(session, &BitTorrent::Session::trackersAdded, this, &SyncTorrentsJournal::updateTorrentTrackers);
+    connect(session, &BitTorrent::Session::trackersChanged, this, &SyncTorrentsJournal::updateTorrentTrackers);
+    connect(session, &BitTorrent::Session::trackersRemoved, this, &SyncTorrentsJournal::updateTorrentTrackers);
+
+    updateCategories();
+    connect(session, &BitTorrent::Session::categoryAdded, this, &SyncTorrentsJournal::updateCategories);
+    connect(session, &BitTorrent::Session::categoryRemoved, this, &SyncTorrentsJournal::updateCategories);
+    connect(session, &BitTorrent::Session::categorySavePathChanged, this, &SyncTorrentsJournal::updateCategories);
+    connect(session, &BitTorrent::Session::subcategoriesSupportChanged, this, &SyncTorrentsJournal::updateCategories);
+
+    for (const QString &tag : asConst(session->tags()))
+        m_tags[tag] = m_revision;
+    connect(session, &BitTorrent::Session::tagAdded, this, &SyncTorrentsJournal::addTag);
+    connect(session, &BitTorrent::Session::tagRemoved, this, &SyncTorrentsJournal::removeTag);
+
+    connect(m_revalidationTimer, &QTimer::timeout, this, &SyncTorrentsJournal::revalidateTorrents);
+    m_revalidationTimer->start(1000);
+}
+
+int SyncTorrentsJournal::revision() const
+{
+    return m_revision;
+}
+
+int SyncTorrentsJournal::commitRevision()
+{
+    return m_revision++;
+}
+
+bool SyncTorrentsJournal::canProvideChangesSince(const int revision) const
+{
+    return ((revision >= m_firstAvailableRevision) && (revision < m_revision));
+}
+
+void SyncTorrentsJournal::collectChanges(const int sinceRevision, QVariantMap &syncData) const
+{
+    const bool isFullUpdate = (sinceRevision == 0);
+
+    const auto changedValues = [sinceRevision, isFullUpdate](const ValuesData &data)
+    {
+        if (isFullUpdate)
+            return data.values;
+
+        QVariantMap values;
+        int valueIndex = 0;
+        for (auto valueIter = data.values.cbegin(); valueIter != data.values.cend(); ++valueIter, ++valueIndex) {
+            if (data.valueRevisions[valueIndex] > sinceRevision)
+                values[valueIter.key()] = valueIter.value();
+        }
+        return values;
+    };
+
+    QVariantHash torrents;
+    for (auto iter = m_torrents.cbegin(); iter != m_torrents.cend(); ++iter) {
+        if (iter->revision > sinceRevision)
+            torrents[iter.key()] = changedValues(iter.value());
+    }
+
+    QVariantHash trackers;
+    for (auto iter = m_trackers.cbegin(); iter != m_trackers.cend(); ++iter) {
+        if (iter->revision > sinceRevision)
+            trackers[iter.key()] = QStringList(iter->torrents.values());
+    }
+
+    QVariantHash categories;
+    for (auto iter = m_categories.cbegin(); iter != m_categories.cend(); ++iter) {
+        if (iter->revision > sinceRevision) {
+            categories[iter.key()] = QVariantMap {
+                {KEY_CATEGORY_NAME, iter.key()},
+                {KEY_CATEGORY_SAVE_PATH, iter->savePath}
+            };
+        }
+    }
+
+    QVariantList tags;
+    for (auto iter = m_tags.cbegin(); iter != m_tags.cend(); ++iter) {
+        if (iter.value() > sinceRevision)
+            tags << iter.key();
+    }
+
+    if (isFullUpdate || !torrents.isEmpty())
+        syncData[KEY_TORRENTS] = torrents;
+    if (isFullUpdate || !trackers.isEmpty())
+        syncData[KEY_TRACKERS] = trackers;
+    if (isFullUpdate || !categories.isEmpty())
+        syncData[KEY_CATEGORIES] = categories;
+    if (isFullUpdate || !tags.isEmpty())
+        syncData[KEY_TAGS] = tags;
+    if (m_serverState.revision > sinceRevision)
+        syncData[KEY_SERVER_STATE] = changedValues(m_serverState);
+
+    if (isFullUpdate)
+        return;
+
+    const auto collectRemoved = [sinceRevision](const QVector<QPair<int, QString>> &records, const auto &items)
+    {
+        QVariantList removedItems;
+        for (auto iter = records.crbegin(); (iter != records.crend()) && (iter->first > sinceRevision); ++iter) {
+            // Item could be added again after it was removed
+            if (!items.contains(iter->second))
+                removedItems << iter->second;
+        }
+        return removedItems;
+    };
+
+    const QVariantList removedTorrents = collectRemoved(m_removedTorrents, m_torrents);
+    if (!removedTorrents.isEmpty())
+        syncData[QLatin1String("torrents_removed")] = removedTorrents;
+    const QVariantList removedTrackers = collectRemoved(m_removedTrackers, m_trackers);
+    if (!removedTrackers.isEmpty())
+        syncData[QLatin1String("trackers_removed")] = removedTrackers;
+    const QVariantList removedCategories = collectRemoved(m_removedCategories, m_categories);
+    if (!removedCategories.isEmpty())
+        syncData[QLatin1String("categories_removed")] = removedCategories;
+    const QVariantList removedTags = collectRemoved(m_removedTags, m_tags);
+    if (!removedTags.isEmpty())
+        syncData[QLatin1String("tags_removed")] = removedTags;
+}
+
+void SyncTorrentsJournal::updateServerState(const QVariantMap &serverState)
+{
+    if (updateValues(m_serverState, serverState))
+        emit changed();
+}
+
+void SyncTorrentsJournal::addTorrent(BitTorrent::TorrentHandle *const torrent)
+{
+    const QString hash = torrent->hash();
+
+    // Drop data of the torrent removed earlier so it is sent to clients entirely
+    m_torrents.remove(hash);
+    updateTorrentTrackers(torrent);
+}
+
+void SyncTorrentsJournal::removeTorrent(BitTorrent::TorrentHandle *const torrent)
+{
+    const QString hash = torrent->hash();
+
+    const auto iter = m_torrents.find(hash);
+    if (iter == m_torrents.end())
+        return;
+
+    for (const QString &trackerURL : asConst(iter->trackers)) {
+        const auto trackerIter = m_trackers.find(trackerURL);
+        if (trackerIter == m_trackers.end())
+            continue;
+
+        trackerIter->torrents.remove(hash);
+        trackerIter->revision = m_revision;
+        if (trackerIter->torrents.isEmpty()) {
+            m_trackers.erase(trackerIter);
+            addRemovalRecord(m_removedTrackers, trackerURL);
+        }
+    }
+
+    m_torrents.erase(iter);
+    addRemovalRecord(m_removedTorrents, hash);
+    emit changed();
+}
+
+void SyncTorrentsJournal::updateTorrent(const BitTorrent::TorrentHandle *torrent)
+{
+    QVariantMap values = serialize(*torrent);
+    const QString hash = values.take(KEY_TORRENT_HASH).toString();
+
+    if (updateValues(m_torrents[hash], values))
+        emit changed();
+}
+
+void SyncTorrentsJournal::updateTorrentValues(const BitTorrent::TorrentHandle *torrent, const QStringList &keys)
+{
+    const auto iter = m_torrents.find(torrent->hash());
+    if (iter == m_torrents.end()) {
+        // New torrent is collected entirely
+        updateTorrent(torrent);
+        return;
+    }
+
+    if (updateValues(iter.value(), serialize(*torrent, keys)))
+        emit changed();
+}
+
+void SyncTorrentsJournal::updateTorrents(const QVector<BitTorrent::TorrentHandle *> &torrents)
+{
+    for (const BitTorrent::TorrentHandle *torrent : torrents)
+        updateTorrent(torrent);
+}
+
+void SyncTorrentsJournal::updateTorrentTrackers(const BitTorrent::TorrentHandle *torrent)
+{
+    // Trackers count is changed as well
+    updateTorrentValues(torrent, {KEY_TORRENT_TRACKER, KEY_TORRENT_TRACKERS_COUNT});
+
+    const QString hash = torrent->hash();
+    const auto iter = m_torrents.find(hash);
+    const QStringList oldTrackers = iter->trackers;
+    const QStringList newTrackers = BitTorrent::Session::instance()->torrentTrackerURLs(torrent->hash());
+    iter->trackers = newTrackers;
+
+    for (const QString &trackerURL : oldTrackers) {
+        if (newTrackers.contains(trackerURL))
+            continue;
+
+        const auto trackerIter = m_trackers.find(trackerURL);
+        if (trackerIter == m_trackers.end())
+            continue;
+
+        trackerIter->torrents.remove(hash);
+        trackerIter->revision = m_revision;
+        if (trackerIter->torrents.isEmpty()) {
+            m_trackers.erase(trackerIter);
+            addRemovalRecord(m_removedTrackers, trackerURL);
+        }
+    }
+
+    for (const QString &trackerURL : newTrackers) {
+        if (oldTrackers.contains(trackerURL))
+            continue;
+
+        TrackerData &trackerData = m_trackers[trackerURL];
+        trackerData.torrents.insert(hash);
+        trackerData.revision = m_revision;
+    }
+
+    if (oldTrackers != newTrackers)
+        emit changed();
+}
+
+void SyncTorrentsJournal::revalidateTorrents()
+{
+    if (m_revalidationQueue.isEmpty())
+        m_revalidationQueue = m_torrents.keys();
+
+    const auto *session = BitTorrent::Session::instance();
+    const int count = std::min(m_revalidationQueue.size()
+        , ((m_torrents.size() / REVALIDATION_PERIOD) + 1));
+    for (int i = 0; i < count; ++i) {
+        const BitTorrent::TorrentHandle *torrent = session->findTorrent(BitTorrent::InfoHash {m_revalidationQueue.takeLast()});
+        if (torrent)
+            updateTorrent(torrent);
+    }
+}
+
+void SyncTorrentsJournal::updateCategories()
+{
+    const QStringMap categories = BitTorrent::Session::instance()->categories();
+    bool isChanged = false;
+
+    for (auto iter = m_categories.begin(); iter != m_categories.end();) {
+        if (categories.contains(iter.key())) {
+            ++iter;
+            continue;
+        }
+
+        addRemovalRecord(m_removedCategories, iter.key());
+        iter = m_categories.erase(iter);
+        isChanged = true;
+    }
+
+    for (auto iter = categories.cbegin(); iter != categories.cend(); ++iter) {
+        CategoryData &data = m_categories[iter.key()];
+        if ((data.revision > 0) && (data.savePath == iter.value()))
+            continue;
+
+        data.savePath = iter.value();
+        data.revision = m_revision;
+        isChanged = true;
+    }
+
+    if (isChanged)
+        emit changed();
+}
+
+void SyncTorrentsJournal::addTag(const QString &tag)
+{
+    m_tags[tag] = m_revision;
+    emit changed();
+}
+
+void SyncTorrentsJournal::removeTag(const QString &tag)
+{
+    if (m_tags.remove(tag) == 0)
+        return;
+
+    addRemovalRecord(m_removedTags, tag);
+    emit changed();
+}
+
+bool SyncTorrentsJournal::updateValues(ValuesData &data, const QVariantMap &values)
+{
+    if (data.values.isEmpty()) {
+        // New item
+        data.values = values;
+        data.valueRevisions.fill(m_revision, values.size());
+        data.revision = m_revision;
+        return true;
+    }
+
+    // Both maps are sorted by keys so the stored values are looked up in a single pass
+    bool isChanged = false;
+    int valueIndex = 0;
+    auto oldValueIter = data.values.begin();
+    for (auto valueIter = values.cbegin(); valueIter != values.cend(); ++valueIter) {
+        while ((oldValueIter != data.values.end()) && (oldValueIter.key() < valueIter.key())) {
+            ++oldValueIter;
+            ++valueIndex;
+        }
+        if ((oldValueIter == data.values.end()) || (oldValueIter.key() != valueIter.key()))
+            continue;
+
+        if (isSameValue(valueIter.key(), oldValueIter.value(), valueIter.value()))
+            continue;
+
+        oldValueIter.value() = valueIter.value();
+        data.valueRevisions[valueIndex] = m_revision;
+        data.revision = m_revision;
+        isChanged = true;
+    }
+
+    return isChanged;
+}
+
+void SyncTorrentsJournal::addRemovalRecord(QVector<QPair<int, QString>> &records, const QString &key)
+{
+    records.append({m_revision, key});
+    if (records.size() <= MAX_REMOVAL_RECORDS)
+        return;
+
+    // Discard the older half of records. Clients which don't
+    // know about the remaining changes will get the full update.
+    const int discardedCount = records.size() / 2;
+    m_firstAvailableRevision = std::max(m_firstAvailableRevision, records[discardedCount - 1].first);
+    records.remove(0, discardedCount);
+}
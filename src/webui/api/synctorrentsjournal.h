@@ -0,0 +1,133 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+class QTimer;
+
+namespace BitTorrent
+{
+    class TorrentHandle;
+}
+
+// Keeps track of the data provided by "sync/maindata" API method (torrents, their
+// trackers, categories, tags and server state). Every changed value is marked with
+// the revision of the response it first appears in, so changes made since the revision
+// known by the client can be collected directly without keeping and comparing the previous responses.
+class SyncTorrentsJournal final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(SyncTorrentsJournal)
+
+public:
+    // Revisions start from firstRevision so the ones provided by
+    // the previous journal instance aren't confused with the new ones
+    explicit SyncTorrentsJournal(int firstRevision = 1, QObject *parent = nullptr);
+
+    int revision() const;
+    // Completes current revision. Returns the revision
+    // that contains all the changes made so far.
+    int commitRevision();
+
+    bool canProvideChangesSince(int revision) const;
+    // Adds the data changed since given revision to syncData.
+    // Adds all the data if revision is 0.
+    void collectChanges(int sinceRevision, QVariantMap &syncData) const;
+
+    // Server state isn't notified about its changes so it is provided by the caller
+    void updateServerState(const QVariantMap &serverState);
+
+signals:
+    void changed();
+
+private:
+    struct ValuesData
+    {
+        QVariantMap values;
+        // revisions of the values in the same order as they are stored
+        QVector<int> valueRevisions;
+        int revision = 0;
+    };
+
+    struct TorrentData : ValuesData
+    {
+        QStringList trackers;
+    };
+
+    struct TrackerData
+    {
+        QSet<QString> torrents;
+        int revision = 0;
+    };
+
+    struct CategoryData
+    {
+        QString savePath;
+        int revision = 0;
+    };
+
+    void addTorrent(BitTorrent::TorrentHandle *const torrent);
+    void removeTorrent(BitTorrent::TorrentHandle *const torrent);
+    void updateTorrent(const BitTorrent::TorrentHandle *torrent);
+    // Updates only the values of given keys, the change notifications affect few values
+    void updateTorrentValues(const BitTorrent::TorrentHandle *torrent, const QStringList &keys);
+    void updateTorrents(const QVector<BitTorrent::TorrentHandle *> &torrents);
+    void updateTorrentTrackers(const BitTorrent::TorrentHandle *torrent);
+    void revalidateTorrents();
+    void updateCategories();
+    void addTag(const QString &tag);
+    void removeTag(const QString &tag);
+    // Returns true if any of the values is changed
+    bool updateValues(ValuesData &data, const QVariantMap &values);
+    void addRemovalRecord(QVector<QPair<int, QString>> &records, const QString &key);
+
+    int m_revision = 1;
+    // Changes made before this revision can't be provided
+    // since the records of removed items are discarded
+    int m_firstAvailableRevision = 1;
+    QHash<QString, TorrentData> m_torrents;
+    QHash<QString, TrackerData> m_trackers;
+    QHash<QString, CategoryData> m_categories;
+    // Revisions of the tags
+    QHash<QString, int> m_tags;
+    ValuesData m_serverState;
+    QVector<QPair<int, QString>> m_removedTorrents;
+    QVector<QPair<int, QString>> m_removedTrackers;
+    QVector<QPair<int, QString>> m_removedCategories;
+    QVector<QPair<int, QString>> m_removedTags;
+
+    QStringList m_revalidationQueue;
+    QTimer *m_revalidationTimer = nullptr;
+};
@@ -0,0 +1,175 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "torrentcreatorcontroller.h"
+
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QRegularExpression>
+
+#include "base/bittorrent/torrentcreationmanager.h"
+#include "base/global.h"
+#include "base/utils/fs.h"
+#include "base/utils/string.h"
+#include "apierror.h"
+
+namespace
+{
+    const char KEY_TASK_ID[] = "taskID";
+    const char KEY_SOURCE_PATH[] = "sourcePath";
+    const char KEY_TORRENT_FILE_PATH[] = "torrentFilePath";
+    const char KEY_PIECE_SIZE[] = "pieceSize";
+    const char KEY_PRIVATE[] = "private";
+    const char KEY_STATUS[] = "status";
+    const char KEY_PROGRESS[] = "progress";
+    const char KEY_ERROR_MESSAGE[] = "errorMessage";
+    const char KEY_TIME_ADDED[] = "timeAdded";
+    const char KEY_TIME_STARTED[] = "timeStarted";
+    const char KEY_TIME_FINISHED[] = "timeFinished";
+
+    QString statusToString(const BitTorrent::TorrentCreationStatus status)
+    {
+        switch (status) {
+        case BitTorrent::TorrentCreationStatus::Queued:
+            return QLatin1String("Queued");
+        case BitTorrent::TorrentCreationStatus::Running:
+            return QLatin1String("Running");
+        case BitTorrent::TorrentCreationStatus::Finished:
+            return QLatin1String("Finished");
+        case BitTorrent::TorrentCreationStatus::Failed:
+            return QLatin1String("Failed");
+        }
+        return {};
+    }
+
+    QJsonObject serialize(const BitTorrent::TorrentCreationTask &task)
+    {
+        QJsonObject obj {
+            {KEY_TASK_ID, task.id},
+            {KEY_SOURCE_PATH, Utils::Fs::toNativePath(task.params.inputPath)},
+            {KEY_TORRENT_FILE_PATH, Utils::Fs::toNativePath(task.params.savePath)},
+            {KEY_PIECE_SIZE, task.params.pieceSize},
+            {KEY_PRIVATE, task.params.isPrivate},
+            {KEY_STATUS, statusToString(task.status)},
+            {KEY_PROGRESS, task.progress},
+            {KEY_TIME_ADDED, task.timeAdded.toSecsSinceEpoch()}
+        };
+        if (!task.errorMessage.isEmpty())
+            obj[KEY_ERROR_MESSAGE] = task.errorMessage;
+        if (task.timeStarted.isValid())
+            obj[KEY_TIME_STARTED] = task.timeStarted.toSecsSinceEpoch();
+        if (task.timeFinished.isValid())
+            obj[KEY_TIME_FINISHED] = task.timeFinished.toSecsSinceEpoch();
+        return obj;
+    }
+}
+
+TorrentCreatorController::TorrentCreatorController(ISessionManager *sessionManager, QObject *parent)
+    : APIController {sessionManager, parent}
+    , m_creationManager {new BitTorrent::TorrentCreationManager {this}}
+{
+}
+
+// Adds torrent creation task to the queue. The tasks are processed one by one.
+// POST params:
+//   - sourcePath (string): file or folder to create torrent of
+//   - torrentFilePath (string): where to save the created torrent
+//   - pieceSize (int): piece size in bytes, 0 to choose it automatically
+//   - private (bool)
+//   - optimizeAlignment (bool)
+//   - paddedFileSizeLimit (int): -1 to add padding for all the files
+//   - comment, source (string)
+//   - trackers (string): tracker URLs separated by new lines, empty line starts the next tier
+//   - urlSeeds (string): web seed URLs separated by new lines
+//   - hashingThreads (int): number of threads hashing pieces (up to 1024), 0 to use all the CPU cores
+void TorrentCreatorController::addTaskAction()
+{
+    requireParams({KEY_SOURCE_PATH, KEY_TORRENT_FILE_PATH});
+
+    const QString sourcePath = Utils::Fs::toUniformPath(params()[KEY_SOURCE_PATH].trimmed());
+    const QString torrentFilePath = Utils::Fs::toUniformPath(params()[KEY_TORRENT_FILE_PATH].trimmed());
+    if (!QFileInfo::exists(sourcePath))
+        throw APIError(APIErrorType::BadParams, tr("Source path doesn't exist"));
+    if (QFileInfo(torrentFilePath).isDir())
+        throw APIError(APIErrorType::BadParams, tr("Torrent file path is a directory"));
+
+    const QStringList trackers = params()["trackers"].trimmed()
+        .replace(QRegularExpression("\n\n[\n]+"), "\n\n").split('\n');
+    const BitTorrent::TorrentCreatorParams createParams {
+        Utils::String::parseBool(params()[KEY_PRIVATE], false)
+        , Utils::String::parseBool(params()["optimizeAlignment"], false)
+        , params()[KEY_PIECE_SIZE].toInt()
+        , (params().contains("paddedFileSizeLimit") ? params()["paddedFileSizeLimit"].toInt() : -1)
+        , sourcePath, torrentFilePath
+        , params()["comment"]
+        , params()["source"]
+        , trackers
+        , params()["urlSeeds"].split('\n', QString::SkipEmptyParts)
+        , qBound(0, params()["hashingThreads"].toInt(), 1024)
+    };
+
+    const QString taskID = m_creationManager->addTask(createParams);
+    if (taskID.isEmpty())
+        throw APIError(APIErrorType::Conflict, tr("Too many torrent creation tasks"));
+
+    setResult(QJsonObject {{KEY_TASK_ID, taskID}});
+}
+
+// Returns the list of tasks (or the given one) and their state.
+// GET param:
+//   - taskID (string): optional
+void TorrentCreatorController::statusAction()
+{
+    const QString taskID = params()[KEY_TASK_ID];
+
+    QJsonArray tasksArray;
+    if (!taskID.isEmpty()) {
+        const BitTorrent::TorrentCreationTask *task = m_creationManager->task(taskID);
+        if (!task)
+            throw APIError(APIErrorType::NotFound);
+        tasksArray << serialize(*task);
+    }
+    else {
+        for (const BitTorrent::TorrentCreationTask &task : asConst(m_creationManager->tasks()))
+            tasksArray << serialize(task);
+    }
+
+    setResult(tasksArray);
+}
+
+// Deletes the task canceling it if it is running
+// POST param:
+//   - taskID (string)
+void TorrentCreatorController::deleteTaskAction()
+{
+    requireParams({KEY_TASK_ID});
+
+    if (!m_creationManager->deleteTask(params()[KEY_TASK_ID]))
+        throw APIError(APIErrorType::NotFound);
+}
@@ -28,10 +28,14 @@
 
 #include "torrentscontroller.h"
 
+#include <algorithm>
 #include <functional>
+#include <utility>
+#include <vector>
 
-#include <QBitArray>
+#include <QDateTime>
 #include <QDir>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QList>
@@ -39,12 +43,14 @@
 #include <QRegularExpression>
 #include <QUrl>
 
+#include "base/bitfield.h"
 #include "base/bittorrent/common.h"
 #include "base/bittorrent/downloadpriority.h"
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/torrentdetailscache.h"
 #include "base/bittorrent/torrenthandle.h"
 #include "base/bittorrent/torrentinfo.h"
 #include "base/bittorrent/trackerentry.h"
@@ -119,25 +125,82 @@ namespace
     using Utils::String::parseBool;
     using Utils::String::parseTriStateBool;
 
-    void applyToTorrents(const QStringList &hashes, const std::function<void (BitTorrent::TorrentHandle *torrent)> &func)
+    // The filters of torrents/info accepted by the "state:" selector
+    const QStringList STATE_SELECTORS {
+        QLatin1String("all"), QLatin1String("downloading"), QLatin1String("seeding"), QLatin1String("completed")
+        , QLatin1String("paused"), QLatin1String("resumed"), QLatin1String("active"), QLatin1String("inactive")
+        , QLatin1String("stalled"), QLatin1String("stalled_uploading"), QLatin1String("stalled_downloading")
+        , QLatin1String("errored")
+    };
+
+    // Besides the hashes the torrents can be selected with the expressions "all",
+    // "category:<name>", "tag:<name>" and "state:<filter>" (the filters of torrents/info)
+    // which are resolved on the server. Unlike the plain hashes, which are united
+    // ("hash1|hash2" selects both torrents), the expressions narrow down the selection:
+    // "category:Movies|state:paused" selects the paused torrents of the category and
+    // "state:paused|hash1|hash2" selects those of the given torrents which are paused.
+    // Unknown selectors and states are rejected so a typo can't select every torrent.
+    QVector<BitTorrent::TorrentHandle *> selectTorrents(const QStringList &hashes)
     {
-        if ((hashes.size() == 1) && (hashes[0] == QLatin1String("all"))) {
-            for (BitTorrent::TorrentHandle *const torrent : asConst(BitTorrent::Session::instance()->torrents()))
-                func(torrent);
-        }
-        else {
-            for (const QString &hash : hashes) {
-                BitTorrent::TorrentHandle *const torrent = BitTorrent::Session::instance()->findTorrent(hash);
-                if (torrent)
-                    func(torrent);
+        const auto *session = BitTorrent::Session::instance();
+
+        TorrentFilter filter;
+        QStringSet hashSet;
+        bool hasSelectors = false;
+        for (const QString &item : hashes) {
+            if (item == QLatin1String("all")) {
+                hasSelectors = true;
+                continue;
+            }
+
+            const int separatorPos = item.indexOf(':');
+            if (separatorPos < 0) {
+                hashSet.insert(item);
+                continue;
             }
+
+            hasSelectors = true;
+            const QStringRef selector = item.leftRef(separatorPos);
+            const QString value = item.mid(separatorPos + 1);
+            if (selector == QLatin1String("category"))
+                filter.setCategory(value);
+            else if (selector == QLatin1String("tag"))
+                filter.setTag(value);
+            else if ((selector == QLatin1String("state")) && STATE_SELECTORS.contains(value))
+                filter.setTypeByName(value);
+            else
+                throw APIError(APIErrorType::BadParams, TorrentsController::tr("Unknown torrent selector: %1").arg(item));
+        }
+
+        if (hasSelectors) {
+            if (!hashSet.isEmpty())
+                filter.setHashSet(hashSet);
+            return filter.matchingTorrents();
         }
+
+        QVector<BitTorrent::TorrentHandle *> torrents;
+        torrents.reserve(hashSet.size());
+        for (const QString &hash : asConst(hashSet)) {
+            BitTorrent::TorrentHandle *const torrent = session->findTorrent(hash);
+            if (torrent)
+                torrents << torrent;
+        }
+        return torrents;
     }
 
-    QJsonArray getStickyTrackers(const BitTorrent::TorrentHandle *const torrent)
+    // The change is applied in bulk so the session saves the resume data
+    // and notifies about the changed torrents once
+    void applyToTorrents(const QStringList &hashes, const std::function<void (BitTorrent::TorrentHandle *torrent)> &func)
+    {
+        BitTorrent::Session::instance()->applyToTorrents(selectTorrents(hashes), func);
+    }
+
+    QJsonArray getStickyTrackers(const BitTorrent::TorrentHandle *const torrent, bool *isPending)
     {
         int seedsDHT = 0, seedsPeX = 0, seedsLSD = 0, leechesDHT = 0, leechesPeX = 0, leechesLSD = 0;
-        for (const BitTorrent::PeerInfo &peer : asConst(torrent->peers())) {
+        const QVector<BitTorrent::PeerInfo> peers = BitTorrent::Session::instance()->torrentDetailsCache()->peers(torrent
+            , BitTorrent::TorrentDetailsCache::RequestMode::NonBlocking, isPending);
+        for (const BitTorrent::PeerInfo &peer : peers) {
             if (peer.isConnecting()) continue;
 
             if (peer.isSeed()) {
@@ -202,12 +265,112 @@ namespace
 
     QVector<BitTorrent::InfoHash> toInfoHashes(const QStringList &hashes)
     {
+        const QVector<BitTorrent::TorrentHandle *> torrents = selectTorrents(hashes);
+
         QVector<BitTorrent::InfoHash> infoHashes;
-        infoHashes.reserve(hashes.size());
-        for (const QString &hash : hashes)
-            infoHashes << hash;
+        infoHashes.reserve(torrents.size());
+        for (const BitTorrent::TorrentHandle *torrent : torrents)
+            infoHashes << torrent->hash();
         return infoHashes;
     }
+
+    // Sorts torrents by the key extracted once per torrent.
+    // Only the first "count" torrents are guaranteed to be in order.
+    template <typename T, typename KeyFunc>
+    void sortTorrentsByKey(QVector<BitTorrent::TorrentHandle *> &torrents, const KeyFunc &keyFunc, const bool reverse, const int count)
+    {
+        using SortItem = std::pair<T, BitTorrent::TorrentHandle *>;
+
+        std::vector<SortItem> items;
+        items.reserve(torrents.size());
+        for (BitTorrent::TorrentHandle *const torrent : asConst(torrents))
+            items.emplace_back(keyFunc(torrent), torrent);
+
+        const auto lessThan = [reverse](const SortItem &left, const SortItem &right)
+        {
+            return reverse ? (right.first < left.first) : (left.first < right.first);
+        };
+
+        if (count < torrents.size())
+            std::partial_sort(items.begin(), (items.begin() + count), items.end(), lessThan);
+        else
+            std::sort(items.begin(), items.end(), lessThan);
+
+        for (int i = 0; i < torrents.size(); ++i)
+            torrents[i] = items[i].second;
+    }
+
+    void sortTorrents(QVector<BitTorrent::TorrentHandle *> &torrents, const QString &column, const bool reverse, const int count)
+    {
+        using BitTorrent::TorrentHandle;
+
+        // Frequently used columns are sorted by the typed values
+        // obtained directly from torrent handle
+        using IntegerKeyFunc = std::function<qint64 (const TorrentHandle *)>;
+        static const QHash<QString, IntegerKeyFunc> integerKeys {
+            {KEY_TORRENT_SIZE, [](const TorrentHandle *torrent) { return torrent->wantedSize(); }},
+            {KEY_TORRENT_DLSPEED, [](const TorrentHandle *torrent) { return torrent->downloadPayloadRate(); }},
+            {KEY_TORRENT_UPSPEED, [](const TorrentHandle *torrent) { return torrent->uploadPayloadRate(); }},
+            {KEY_TORRENT_QUEUE_POSITION, [](const TorrentHandle *torrent) { return torrent->queuePosition(); }},
+            {KEY_TORRENT_SEEDS, [](const TorrentHandle *torrent) { return torrent->seedsCount(); }},
+            {KEY_TORRENT_NUM_COMPLETE, [](const TorrentHandle *torrent) { return torrent->totalSeedsCount(); }},
+            {KEY_TORRENT_LEECHS, [](const TorrentHandle *torrent) { return torrent->leechsCount(); }},
+            {KEY_TORRENT_NUM_INCOMPLETE, [](const TorrentHandle *torrent) { return torrent->totalLeechersCount(); }},
+            {KEY_TORRENT_ETA, [](const TorrentHandle *torrent) { return torrent->eta(); }},
+            {KEY_TORRENT_ADDED_ON, [](const TorrentHandle *torrent) { return torrent->addedTime().toSecsSinceEpoch(); }},
+            {KEY_TORRENT_COMPLETION_ON, [](const TorrentHandle *torrent) { return torrent->completedTime().toSecsSinceEpoch(); }},
+            {KEY_TORRENT_AMOUNT_DOWNLOADED, [](const TorrentHandle *torrent) { return torrent->totalDownload(); }},
+            {KEY_TORRENT_AMOUNT_UPLOADED, [](const TorrentHandle *torrent) { return torrent->totalUpload(); }},
+            {KEY_TORRENT_AMOUNT_DOWNLOADED_SESSION, [](const TorrentHandle *torrent) { return torrent->totalPayloadDownload(); }},
+            {KEY_TORRENT_AMOUNT_UPLOADED_SESSION, [](const TorrentHandle *torrent) { return torrent->totalPayloadUpload(); }},
+            {KEY_TORRENT_AMOUNT_LEFT, [](const TorrentHandle *torrent) { return torrent->incompletedSize(); }},
+            {KEY_TORRENT_AMOUNT_COMPLETED, [](const TorrentHandle *torrent) { return torrent->completedSize(); }},
+            {KEY_TORRENT_TOTAL_SIZE, [](const TorrentHandle *torrent) { return torrent->totalSize(); }},
+            {KEY_TORRENT_TIME_ACTIVE, [](const TorrentHandle *torrent) { return torrent->activeTime(); }}
+        };
+        using RealKeyFunc = std::function<qreal (const TorrentHandle *)>;
+        static const QHash<QString, RealKeyFunc> realKeys {
+            {KEY_TORRENT_PROGRESS, [](const TorrentHandle *torrent) { return torrent->progress(); }},
+            {KEY_TORRENT_RATIO, [](const TorrentHandle *torrent)
+                {
+                    const qreal ratio = torrent->realRatio();
+                    return (ratio > TorrentHandle::MAX_RATIO) ? -1 : ratio;
+                }},
+            {KEY_TORRENT_AVAILABILITY, [](const TorrentHandle *torrent) { return torrent->distributedCopies(); }}
+        };
+        using StringKeyFunc = std::function<QString (const TorrentHandle *)>;
+        static const QHash<QString, StringKeyFunc> stringKeys {
+            {KEY_TORRENT_HASH, [](const TorrentHandle *torrent) { return QString(torrent->hash()); }},
+            {KEY_TORRENT_NAME, [](const TorrentHandle *torrent) { return torrent->name(); }},
+            {KEY_TORRENT_CATEGORY, [](const TorrentHandle *torrent) { return torrent->category(); }},
+            {KEY_TORRENT_TRACKER, [](const TorrentHandle *torrent) { return torrent->currentTracker(); }},
+            {KEY_TORRENT_SAVE_PATH, [](const TorrentHandle *torrent) { return Utils::Fs::toNativePath(torrent->savePath()); }}
+        };
+
+        const auto integerKeyIter = integerKeys.constFind(column);
+        if (integerKeyIter != integerKeys.cend()) {
+            sortTorrentsByKey<qint64>(torrents, *integerKeyIter, reverse, count);
+            return;
+        }
+
+        const auto realKeyIter = realKeys.constFind(column);
+        if (realKeyIter != realKeys.cend()) {
+            sortTorrentsByKey<qreal>(torrents, *realKeyIter, reverse, count);
+            return;
+        }
+
+        const auto stringKeyIter = stringKeys.constFind(column);
+        if (stringKeyIter != stringKeys.cend()) {
+            sortTorrentsByKey<QString>(torrents, *stringKeyIter, reverse, count);
+            return;
+        }
+
+        // Other columns are sorted by the serialized values
+        sortTorrentsByKey<QVariant>(torrents, [&column](const TorrentHandle *torrent)
+        {
+            return serialize(*torrent).value(column);
+        }, reverse, count);
+    }
 }
 
 // Returns all the torrents in JSON format.
@@ -234,6 +397,7 @@ namespace
 // GET params:
 //   - filter (string): all, downloading, seeding, completed, paused, resumed, active, inactive, stalled, stalled_uploading, stalled_downloading
 //   - category (string): torrent category for filtering by it (empty string means "uncategorized"; no "category" param presented means "any category")
+//   - tag (string): torrent tag for filtering by it (empty string means "untagged"; no "tag" param presented means "any tag")
 //   - hashes (string): filter by hashes, can contain multiple hashes separated by |
 //   - sort (string): name of column for sorting by its value
 //   - reverse (bool): enable reverse sorting
@@ -243,41 +407,51 @@ void TorrentsController::infoAction()
 {
     const QString filter {params()["filter"]};
     const QString category {params()["category"]};
+    const QString tag {params()["tag"]};
     const QString sortedColumn {params()["sort"]};
     const bool reverse {parseBool(params()["reverse"], false)};
     int limit {params()["limit"].toInt()};
     int offset {params()["offset"].toInt()};
     const QStringSet hashSet {List::toSet(params()["hashes"].split('|', QString::SkipEmptyParts))};
 
-    QVariantList torrentList;
-    TorrentFilter torrentFilter(filter, (hashSet.isEmpty() ? TorrentFilter::AnyHash : hashSet), category);
-    for (BitTorrent::TorrentHandle *const torrent : asConst(BitTorrent::Session::instance()->torrents())) {
-        if (torrentFilter.match(torrent))
-            torrentList.append(serialize(*torrent));
-    }
+    // Without sorting we don't need to look further than the requested page
+    const bool isSorted = !sortedColumn.isEmpty();
+    const int maxCount = (!isSorted && (limit > 0) && (offset >= 0)) ? (offset + limit) : -1;
 
-    std::sort(torrentList.begin(), torrentList.end()
-              , [sortedColumn, reverse](const QVariant &torrent1, const QVariant &torrent2)
-    {
-        return reverse
-                ? (torrent1.toMap().value(sortedColumn) > torrent2.toMap().value(sortedColumn))
-                : (torrent1.toMap().value(sortedColumn) < torrent2.toMap().value(sortedColumn));
-    });
+    const TorrentFilter torrentFilter(filter, (hashSet.isEmpty() ? TorrentFilter::AnyHash : hashSet), category, tag);
+    QVector<BitTorrent::TorrentHandle *> torrents = torrentFilter.matchingTorrents(maxCount);
 
-    const int size = torrentList.size();
+    const int size = torrents.size();
     // normalize offset
     if (offset < 0)
         offset = size + offset;
     if ((offset >= size) || (offset < 0))
         offset = 0;
     // normalize limit
-    if (limit <= 0)
-        limit = -1; // unlimited
-
-    if ((limit > 0) || (offset > 0))
-        torrentList = torrentList.mid(offset, limit);
-
-    setResult(QJsonArray::fromVariantList(torrentList));
+    if ((limit <= 0) || (limit > (size - offset)))
+        limit = size - offset;
+
+    // Only the torrents on requested page need to be in order
+    if (isSorted)
+        sortTorrents(torrents, sortedColumn, reverse, (offset + limit));
+
+    // Only the requested page is serialized, torrent by torrent while the response is sent.
+    // The torrents removed meanwhile are skipped.
+    QVector<BitTorrent::InfoHash> hashes;
+    hashes.reserve(limit);
+    for (int i = offset; i < (offset + limit); ++i)
+        hashes.append(torrents[i]->hash());
+
+    int index = 0;
+    setResult([hashes, index]() mutable -> QJsonValue
+    {
+        while (index < hashes.size()) {
+            const BitTorrent::TorrentHandle *torrent = BitTorrent::Session::instance()->findTorrent(hashes[index++]);
+            if (torrent)
+                return QJsonObject::fromVariantMap(serialize(*torrent));
+        }
+        return QJsonValue(QJsonValue::Undefined);
+    });
 }
 
 // Returns the properties for a torrent in JSON format.
@@ -394,10 +568,14 @@ void TorrentsController::trackersAction()
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
 
-    QJsonArray trackerList = getStickyTrackers(torrent);
+    bool isPeersPending = false;
+    QJsonArray trackerList = getStickyTrackers(torrent, &isPeersPending);
 
+    bool isTrackersPending = false;
+    const QVector<BitTorrent::TrackerEntry> trackers = BitTorrent::Session::instance()->torrentDetailsCache()->trackers(torrent
+        , BitTorrent::TorrentDetailsCache::RequestMode::NonBlocking, &isTrackersPending);
     QHash<QString, BitTorrent::TrackerInfo> trackersData = torrent->trackerInfos();
-    for (const BitTorrent::TrackerEntry &tracker : asConst(torrent->trackers())) {
+    for (const BitTorrent::TrackerEntry &tracker : trackers) {
         const BitTorrent::TrackerInfo data = trackersData.value(tracker.url());
 
         trackerList << QJsonObject {
@@ -413,6 +591,7 @@ void TorrentsController::trackersAction()
     }
 
     setResult(trackerList);
+    setResultPending(isPeersPending || isTrackersPending);
 }
 
 // Returns the web seeds for a torrent in JSON format.
@@ -458,14 +637,16 @@ void TorrentsController::filesAction()
         throw APIError(APIErrorType::NotFound);
 
     QJsonArray fileList;
+    bool isPending = false;
     if (torrent->hasMetadata()) {
         const QVector<BitTorrent::DownloadPriority> priorities = torrent->filePriorities();
-        const QVector<qreal> fp = torrent->filesProgress();
+        const QVector<qreal> fp = BitTorrent::Session::instance()->torrentDetailsCache()->filesProgress(torrent
+            , BitTorrent::TorrentDetailsCache::RequestMode::NonBlocking, &isPending);
         const QVector<qreal> fileAvailability = torrent->availableFileFractions();
         const BitTorrent::TorrentInfo info = torrent->info();
         for (int i = 0; i < torrent->filesCount(); ++i) {
             QJsonObject fileDict = {
-                {KEY_FILE_PROGRESS, fp[i]},
+                {KEY_FILE_PROGRESS, fp.value(i)},
                 {KEY_FILE_PRIORITY, static_cast<int>(priorities[i])},
                 {KEY_FILE_SIZE, torrent->fileSize(i)},
                 {KEY_FILE_AVAILABILITY, fileAvailability[i]}
@@ -487,6 +668,7 @@ void TorrentsController::filesAction()
     }
 
     setResult(fileList);
+    setResultPending(isPending);
 }
 
 // Returns an array of hashes (of each pieces respectively) for a torrent in JSON format.
@@ -522,18 +704,23 @@ void TorrentsController::pieceStatesAction()
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
 
-    QJsonArray pieceStates;
-    const QBitArray states = torrent->pieces();
-    for (int i = 0; i < states.size(); ++i)
-        pieceStates.append(static_cast<int>(states[i]) * 2);
+    const Bitfield states = torrent->pieces();
+    bool isPending = false;
+    const Bitfield dlstates = BitTorrent::Session::instance()->torrentDetailsCache()->downloadingPieces(torrent
+        , BitTorrent::TorrentDetailsCache::RequestMode::NonBlocking, &isPending);
+    const bool hasDownloading = (dlstates.size() == states.size()) && (dlstates.count() > 0);
 
-    const QBitArray dlstates = torrent->downloadingPieces();
+    // 0 = not downloaded, 1 = downloading, 2 = downloaded
+    QJsonArray pieceStates;
     for (int i = 0; i < states.size(); ++i) {
-        if (dlstates[i])
-            pieceStates[i] = 1;
+        if (hasDownloading && dlstates.testBit(i))
+            pieceStates.append(1);
+        else
+            pieceStates.append(states.testBit(i) ? 2 : 0);
     }
 
     setResult(pieceStates);
+    setResultPending(isPending);
 }
 
 void TorrentsController::addAction()
@@ -1198,3 +1385,41 @@ void TorrentsController::renameFileAction()
 
     torrent->renameFile(fileIndex, newFilePath);
 }
+
+// Returns the storage move jobs in order they are processed.
+// The return value is a JSON-formatted array of dictionaries:
+//   - "hash": Torrent hash
+//   - "name": Torrent name
+//   - "source_path": Current location of the torrent content
+//   - "destination_path": New location of the torrent content
+//   - "state": "moving" or "queued"
+//   - "same_device": Whether the content is moved within the same filesystem
+//   - "total_size": Size of the moved content (active jobs only)
+//   - "moved_size": Estimated amount of data moved (active jobs only)
+//   - "progress": Estimated progress of the job
+//   - "elapsed": Seconds since the job was started
+//   - "speed": Average moving speed in bytes/second
+void TorrentsController::storageMoveJobsAction()
+{
+    QJsonArray result;
+    for (const BitTorrent::MoveStorageJobInfo &job : asConst(BitTorrent::Session::instance()->moveStorageJobs())) {
+        const qreal progress = ((job.totalSize > 0) ? (static_cast<qreal>(job.movedSize) / job.totalSize) : 0);
+        const qint64 speed = ((job.elapsedTime > 0) ? ((job.movedSize * 1000) / job.elapsedTime) : 0);
+
+        result << QJsonObject {
+            {"hash", job.hash},
+            {"name", job.name},
+            {"source_path", Utils::Fs::toNativePath(job.sourcePath)},
+            {"destination_path", Utils::Fs::toNativePath(job.destinationPath)},
+            {"state", (job.isActive ? QLatin1String("moving") : QLatin1String("queued"))},
+            {"same_device", job.isSameDevice},
+            {"total_size", job.totalSize},
+            {"moved_size", job.movedSize},
+            {"progress", progress},
+            {"elapsed", (job.elapsedTime / 1000)},
+            {"speed", speed}
+        };
+    }
+
+    setResult(result);
+}
@@ -28,12 +28,17 @@
 
 #include "transfercontroller.h"
 
+#include <algorithm>
+
+#include <QDateTime>
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QVector>
 
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/transferhistory.h"
 #include "base/global.h"
 #include "apierror.h"
 
@@ -46,6 +51,12 @@ const char KEY_TRANSFER_UPRATELIMIT[] = "up_rate_limit";
 const char KEY_TRANSFER_DHT_NODES[] = "dht_nodes";
 const char KEY_TRANSFER_CONNECTION_STATUS[] = "connection_status";
 
+// History keys
+const char KEY_HISTORY_RESOLUTION[] = "resolution";
+const char KEY_HISTORY_FIELDS[] = "fields";
+const char KEY_HISTORY_SAMPLES[] = "samples";
+const char KEY_HISTORY_CATEGORIES[] = "categories";
+
 // Returns the global transfer information in JSON format.
 // The return value is a JSON-formatted dictionary.
 // The dictionary keys are:
@@ -78,6 +89,79 @@ void TransferController::infoAction()
     setResult(dict);
 }
 
+// Returns the recorded history of the transfer rates in JSON format.
+// The return value is a JSON-formatted dictionary.
+// The dictionary keys are:
+//   - "resolution": Seconds covered by each sample
+//   - "fields": Names of the sample values
+//   - "samples": Array of the samples, each one is an array of the bucket start
+//                (seconds since epoch) followed by the averages of the fields
+//   - "categories": Categories having the history (only if "category" isn't requested)
+// GET params:
+//   - category (string): get the payload rates of the category instead of the session
+//                        (empty string selects the uncategorized torrents)
+//   - from (int64): seconds since epoch (default: an hour ago), limited to [0, now]
+//   - to (int64): seconds since epoch (default: now), limited to [0, now]
+//   - resolution (int): one of 5, 60, 900 or 3600 (default: the finest one covering "from")
+void TransferController::historyAction()
+{
+    const BitTorrent::TransferHistory *history = BitTorrent::Session::instance()->transferHistory();
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    bool ok = false;
+    qint64 to = params()["to"].toLongLong(&ok);
+    if (!ok)
+        to = now;
+    qint64 from = params()["from"].toLongLong(&ok);
+    if (!ok)
+        from = qBound<qint64>(0, to, now) - 3600;
+    if (from > to)
+        throw APIError(APIErrorType::BadParams, tr("'from' must not be greater than 'to'"));
+    // nothing is recorded outside of this range
+    to = qBound<qint64>(0, to, now);
+    from = qBound<qint64>(0, from, to);
+
+    int resolution = params()["resolution"].toInt(&ok);
+    if (!ok) {
+        resolution = BitTorrent::TransferHistory::resolutionFor(from, now);
+    }
+    else {
+        const QVector<Utils::TimeSeriesStore::Archive> archives = BitTorrent::TransferHistory::archives();
+        const bool isKnownResolution = std::any_of(archives.cbegin(), archives.cend()
+            , [resolution](const Utils::TimeSeriesStore::Archive &archive) { return (archive.resolution == resolution); });
+        if (!isKnownResolution)
+            throw APIError(APIErrorType::BadParams, tr("Unsupported resolution"));
+    }
+
+    const bool isCategoryRequested = params().contains(QLatin1String("category"));
+    const QString category = params()["category"];
+    if (isCategoryRequested && !history->categories().contains(category))
+        throw APIError(APIErrorType::NotFound);
+
+    const QVector<Utils::TimeSeriesStore::Sample> samples = isCategoryRequested
+        ? history->categorySamples(category, resolution, from, to)
+        : history->sessionSamples(resolution, from, to);
+
+    QJsonArray sampleList;
+    for (const Utils::TimeSeriesStore::Sample &sample : samples) {
+        QJsonArray values {sample.timestamp};
+        for (const float value : sample.values)
+            values.append(static_cast<double>(value));
+        sampleList.append(values);
+    }
+
+    QJsonObject dict {
+        {KEY_HISTORY_RESOLUTION, resolution},
+        {KEY_HISTORY_FIELDS, QJsonArray::fromStringList(isCategoryRequested
+            ? BitTorrent::TransferHistory::categoryFields() : BitTorrent::TransferHistory::sessionFields())},
+        {KEY_HISTORY_SAMPLES, sampleList}
+    };
+    if (!isCategoryRequested)
+        dict[KEY_HISTORY_CATEGORIES] = QJsonArray::fromStringList(history->categories());
+
+    setResult(dict);
+}
+
 void TransferController::uploadLimitAction()
 {
     setResult(QString::number(BitTorrent::Session::instance()->uploadSpeedLimit()));
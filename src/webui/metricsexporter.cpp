@@ -0,0 +1,208 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2020  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "metricsexporter.h"
+
+#include <algorithm>
+
+#include "base/bittorrent/session.h"
+#include "base/bittorrent/torrenthandle.h"
+#include "base/bittorrent/tracker.h"
+#include "base/global.h"
+#include "api/serialize/serialize_torrent.h"
+
+namespace
+{
+    const char METRIC_TORRENTS[] = "qbittorrent_torrents";
+    const char METRIC_ALERT_HANDLING_TIME[] = "qbittorrent_alert_handling_duration_seconds";
+    const char METRIC_ALERT_TYPE_HANDLING_TIME[] = "qbittorrent_alert_duration_seconds";
+    const char METRIC_ALERTS_HANDLED[] = "qbittorrent_alerts_handled";
+    const char METRIC_ALERTS_DROPPED[] = "qbittorrent_alerts_dropped";
+    const char METRIC_ALERT_BATCH_SIZE[] = "qbittorrent_alert_batch_size";
+    const char METRIC_ALERT_BATCH_MAX_SIZE[] = "qbittorrent_alert_batch_max_size";
+    const char METRIC_ALERTS_PENDING[] = "qbittorrent_alerts_pending";
+    const char METRIC_ALERT_SLICED_BATCHES[] = "qbittorrent_alert_sliced_batches";
+    const char METRIC_RESUME_DATA_REQUEST_TIME[] = "qbittorrent_resume_data_request_duration_seconds";
+    const char METRIC_WEBUI_REQUEST_TIME[] = "qbittorrent_webui_request_duration_seconds";
+    const char METRIC_TRACKER_TORRENTS[] = "qbittorrent_tracker_torrents";
+    const char METRIC_TRACKER_PEERS[] = "qbittorrent_tracker_peers";
+    const char METRIC_TRACKER_ANNOUNCES[] = "qbittorrent_tracker_announces";
+    const char METRIC_TRACKER_ANNOUNCE_RATE[] = "qbittorrent_tracker_announces_per_second";
+    const char METRIC_TRACKER_SCRAPES[] = "qbittorrent_tracker_scrapes";
+    const char METRIC_TRACKER_UDP_REQUESTS[] = "qbittorrent_tracker_udp_requests";
+    const char METRIC_TRACKER_EXPIRED_PEERS[] = "qbittorrent_tracker_expired_peers";
+
+    QByteArray toSeconds(const qint64 nsecs)
+    {
+        return QByteArray::number((nsecs / 1e9), 'g', 10);
+    }
+
+    QByteArray labelSet(const QByteArray &labels)
+    {
+        return (labels.isEmpty() ? QByteArray() : QByteArray('{' + labels + '}'));
+    }
+
+    void appendFamily(QByteArray &data, const char *name, const char *type, const char *help)
+    {
+        data.append("# TYPE ").append(name).append(' ').append(type).append('\n');
+        if (qstrcmp(type, "histogram") == 0)
+            data.append("# UNIT ").append(name).append(" seconds\n");
+        data.append("# HELP ").append(name).append(' ').append(help).append('\n');
+    }
+
+    void appendSample(QByteArray &data, const QByteArray &name, const QByteArray &labels, const qint64 value)
+    {
+        data.append(name).append(labelSet(labels)).append(' ').append(QByteArray::number(value)).append('\n');
+    }
+
+    void appendHistogram(QByteArray &data, const char *name, const QByteArray &labels
+                         , const Utils::LatencyHistogram &histogram)
+    {
+        const QByteArray bucketLabelPrefix = (labels.isEmpty() ? QByteArray() : QByteArray(labels + ','));
+        for (int i = 0; i < Utils::LatencyHistogram::BUCKET_COUNT; ++i) {
+            data.append(name).append("_bucket{").append(bucketLabelPrefix)
+                .append("le=\"").append(toSeconds(Utils::LatencyHistogram::bucketBound(i))).append("\"} ")
+                .append(QByteArray::number(histogram.cumulativeCount(i))).append('\n');
+        }
+        data.append(name).append("_bucket{").append(bucketLabelPrefix).append("le=\"+Inf\"} ")
+            .append(QByteArray::number(histogram.count())).append('\n');
+        data.append(name).append("_sum").append(labelSet(labels)).append(' ')
+            .append(toSeconds(histogram.sum())).append('\n');
+        data.append(name).append("_count").append(labelSet(labels)).append(' ')
+            .append(QByteArray::number(histogram.count())).append('\n');
+    }
+}
+
+MetricsExporter::MetricsExporter()
+{
+    const QVector<BitTorrent::SessionStatsMetric> &metrics = BitTorrent::Session::sessionStatsMetrics();
+    m_sessionStatsPrefixes.reserve(metrics.size());
+    for (const BitTorrent::SessionStatsMetric &metric : metrics) {
+        if (metric.name.isEmpty()) {
+            m_sessionStatsPrefixes.append(QByteArray());
+            continue;
+        }
+
+        // libtorrent names look like "net.sent_bytes"
+        const QByteArray name = "libtorrent_" + metric.name.toLatin1().replace('.', '_');
+        const bool isCounter = (metric.type == BitTorrent::SessionStatsMetric::Type::Counter);
+        m_sessionStatsPrefixes.append("# TYPE " + name + (isCounter ? " counter\n" : " gauge\n")
+                                      + name + (isCounter ? "_total " : " "));
+    }
+}
+
+void MetricsExporter::addRequestTime(const QString &scope, const qint64 nsecs)
+{
+    m_requestTimes[scope].addSample(nsecs);
+}
+
+QByteArray MetricsExporter::exportMetrics() const
+{
+    const BitTorrent::Session *session = BitTorrent::Session::instance();
+
+    QByteArray data;
+    data.reserve(64 * 1024);
+
+    const QVector<qint64> &values = session->sessionStatsValues();
+    const int valueCount = std::min(values.size(), m_sessionStatsPrefixes.size());
+    for (int i = 0; i < valueCount; ++i) {
+        if (!m_sessionStatsPrefixes[i].isEmpty())
+            data.append(m_sessionStatsPrefixes[i]).append(QByteArray::number(values[i])).append('\n');
+    }
+
+    QMap<QString, int> torrentCounts;
+    for (const BitTorrent::TorrentHandle *torrent : asConst(session->torrents()))
+        ++torrentCounts[torrentStateToString(torrent->state())];
+    appendFamily(data, METRIC_TORRENTS, "gauge", "Number of torrents by state");
+    for (auto iter = torrentCounts.cbegin(); iter != torrentCounts.cend(); ++iter) {
+        data.append(METRIC_TORRENTS).append("{state=\"").append(iter.key().toLatin1()).append("\"} ")
+            .append(QByteArray::number(iter.value())).append('\n');
+    }
+
+    const BitTorrent::AlertStatistics &alertStatistics = session->alertStatistics();
+    appendFamily(data, METRIC_ALERT_HANDLING_TIME, "histogram", "Time spent handling libtorrent alerts in one event loop iteration");
+    appendHistogram(data, METRIC_ALERT_HANDLING_TIME, {}, alertStatistics.sliceHandlingTime);
+    appendFamily(data, METRIC_ALERT_BATCH_SIZE, "gauge", "Number of alerts in the last batch read from libtorrent");
+    appendSample(data, METRIC_ALERT_BATCH_SIZE, {}, alertStatistics.lastBatchSize);
+    appendFamily(data, METRIC_ALERT_BATCH_MAX_SIZE, "gauge", "Maximum number of alerts read from libtorrent at once");
+    appendSample(data, METRIC_ALERT_BATCH_MAX_SIZE, {}, alertStatistics.maxBatchSize);
+    appendFamily(data, METRIC_ALERTS_PENDING, "gauge", "Number of read alerts which aren't handled yet");
+    appendSample(data, METRIC_ALERTS_PENDING, {}, alertStatistics.pendingCount);
+    appendFamily(data, METRIC_ALERT_SLICED_BATCHES, "counter", "Number of alert batches handled in several event loop iterations");
+    appendSample(data, (METRIC_ALERT_SLICED_BATCHES + QByteArray("_total")), {}, alertStatistics.slicedBatchCount);
+
+    appendFamily(data, METRIC_ALERTS_HANDLED, "counter", "Number of handled alerts by type");
+    for (const BitTorrent::AlertTypeStatistics &typeStatistics : alertStatistics.types) {
+        if (typeStatistics.handledCount > 0) {
+            appendSample(data, (METRIC_ALERTS_HANDLED + QByteArray("_total"))
+                         , ("type=\"" + typeStatistics.name.toLatin1() + '"'), typeStatistics.handledCount);
+        }
+    }
+    appendFamily(data, METRIC_ALERTS_DROPPED, "counter", "Number of alerts dropped by libtorrent because of the full queue by type");
+    for (const BitTorrent::AlertTypeStatistics &typeStatistics : alertStatistics.types) {
+        if (typeStatistics.droppedCount > 0) {
+            appendSample(data, (METRIC_ALERTS_DROPPED + QByteArray("_total"))
+                         , ("type=\"" + typeStatistics.name.toLatin1() + '"'), typeStatistics.droppedCount);
+        }
+    }
+    appendFamily(data, METRIC_ALERT_TYPE_HANDLING_TIME, "histogram", "Time spent handling single alert by type");
+    for (const BitTorrent::AlertTypeStatistics &typeStatistics : alertStatistics.types) {
+        if (typeStatistics.handledCount > 0) {
+            appendHistogram(data, METRIC_ALERT_TYPE_HANDLING_TIME
+                            , ("type=\"" + typeStatistics.name.toLatin1() + '"'), typeStatistics.handlingTime);
+        }
+    }
+
+    appendFamily(data, METRIC_RESUME_DATA_REQUEST_TIME, "histogram", "Time from requesting torrent resume data until it is ready to be saved");
+    appendHistogram(data, METRIC_RESUME_DATA_REQUEST_TIME, {}, session->resumeDataRequestTime());
+
+    appendFamily(data, METRIC_WEBUI_REQUEST_TIME, "histogram", "Time spent processing WebUI API requests");
+    for (auto iter = m_requestTimes.cbegin(); iter != m_requestTimes.cend(); ++iter)
+        appendHistogram(data, METRIC_WEBUI_REQUEST_TIME, ("scope=\"" + iter.key().toLatin1() + '"'), iter.value());
+
+    if (const BitTorrent::Tracker *tracker = session->tracker()) {
+        const BitTorrent::Tracker::Counters counters = tracker->counters();
+        appendFamily(data, METRIC_TRACKER_TORRENTS, "gauge", "Number of torrents known to the embedded tracker");
+        appendSample(data, METRIC_TRACKER_TORRENTS, {}, counters.torrents);
+        appendFamily(data, METRIC_TRACKER_PEERS, "gauge", "Number of peers registered in the embedded tracker");
+        appendSample(data, METRIC_TRACKER_PEERS, {}, counters.peers);
+        appendFamily(data, METRIC_TRACKER_ANNOUNCES, "counter", "Number of announces handled by the embedded tracker");
+        appendSample(data, (METRIC_TRACKER_ANNOUNCES + QByteArray("_total")), {}, counters.announces);
+        appendFamily(data, METRIC_TRACKER_ANNOUNCE_RATE, "gauge", "Number of announces handled by the embedded tracker during the last second");
+        appendSample(data, METRIC_TRACKER_ANNOUNCE_RATE, {}, counters.announcesPerSecond);
+        appendFamily(data, METRIC_TRACKER_SCRAPES, "counter", "Number of scrapes handled by the embedded tracker");
+        appendSample(data, (METRIC_TRACKER_SCRAPES + QByteArray("_total")), {}, counters.scrapes);
+        appendFamily(data, METRIC_TRACKER_UDP_REQUESTS, "counter", "Number of UDP requests received by the embedded tracker");
+        appendSample(data, (METRIC_TRACKER_UDP_REQUESTS + QByteArray("_total")), {}, counters.udpRequests);
+        appendFamily(data, METRIC_TRACKER_EXPIRED_PEERS, "counter", "Number of peers dropped by the embedded tracker because they stopped announcing");
+        appendSample(data, (METRIC_TRACKER_EXPIRED_PEERS + QByteArray("_total")), {}, counters.expiredPeers);
+    }
+
+    data.append("# EOF\n");
+    return data;
+}
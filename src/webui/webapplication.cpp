@@ -34,15 +34,21 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
+#include <QJsonArray>
 #include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLocale>
 #include <QMimeDatabase>
 #include <QMimeType>
 #include <QNetworkCookie>
 #include <QRegExp>
+#include <QTimer>
 #include <QUrl>
 
 #include "base/algorithm.h"
 #include "base/global.h"
+#include "base/http/contentstream.h"
 #include "base/http/httperror.h"
 #include "base/logger.h"
 #include "base/preferences.h"
@@ -59,10 +65,12 @@
 #include "api/rsscontroller.h"
 #include "api/searchcontroller.h"
 #include "api/synccontroller.h"
+#include "api/torrentcreatorcontroller.h"
 #include "api/torrentscontroller.h"
 #include "api/transfercontroller.h"
 
 constexpr int MAX_ALLOWED_FILESIZE = 10 * 1024 * 1024;
+constexpr int SESSION_EXPIRATION_CHECK_INTERVAL = 10000; // ms
 
 const QString PATH_PREFIX_ICONS {QStringLiteral("/icons/")};
 const QString WWW_FOLDER {QStringLiteral(":/www")};
@@ -111,18 +119,189 @@ namespace
 
         return QLatin1String("no-store");
     }
+
+    // Serializes the JSON array elements or the object members as they are produced by the generators,
+    // so the large API responses are sent piece by piece and the whole document is never held in memory.
+    class JsonStreamWriter
+    {
+    public:
+        static const int PIECE_SIZE = 64 * 1024;
+
+        explicit JsonStreamWriter(const JsonArrayGenerator &generator)
+            : m_arrayGenerator {generator}
+        {
+        }
+
+        explicit JsonStreamWriter(const StreamedJsonObject &object)
+            : m_members {object.members()}
+            , m_isObject {true}
+        {
+        }
+
+        QByteArray operator()()
+        {
+            if (m_isFinished)
+                return {};
+
+            QByteArray piece;
+            piece.reserve(PIECE_SIZE + 1024);
+            if (!m_isStarted) {
+                piece.append(m_isObject ? '{' : '[');
+                m_isStarted = true;
+            }
+
+            while (!m_isFinished && (piece.size() < PIECE_SIZE))
+                writeNext(piece);
+
+            return piece;
+        }
+
+    private:
+        void writeNext(QByteArray &out)
+        {
+            if (m_arrayGenerator) {
+                const QJsonValue value = m_arrayGenerator();
+                if (value.isUndefined()) {
+                    out.append(']');
+                    m_arrayGenerator = nullptr;
+                    m_isFinished = !m_isObject;
+                    return;
+                }
+
+                if (m_elementCount++ > 0)
+                    out.append(',');
+                serialize(value, out);
+                return;
+            }
+
+            if (m_objectGenerator) {
+                const QPair<QString, QJsonValue> member = m_objectGenerator();
+                if (member.first.isNull()) {
+                    out.append('}');
+                    m_objectGenerator = nullptr;
+                    return;
+                }
+
+                if (m_elementCount++ > 0)
+                    out.append(',');
+                serializeString(member.first, out);
+                out.append(':');
+                serialize(member.second, out);
+                return;
+            }
+
+            if (m_memberIndex == m_members.size()) {
+                out.append('}');
+                m_isFinished = true;
+                return;
+            }
+
+            const StreamedJsonObject::Member &member = m_members.at(m_memberIndex);
+            if (m_memberIndex++ > 0)
+                out.append(',');
+            serializeString(member.name, out);
+            out.append(':');
+
+            m_elementCount = 0;
+            if (member.arrayGenerator) {
+                out.append('[');
+                m_arrayGenerator = member.arrayGenerator;
+            }
+            else if (member.objectGenerator) {
+                out.append('{');
+                m_objectGenerator = member.objectGenerator;
+            }
+            else {
+                serialize(member.value, out);
+            }
+        }
+
+        static void serialize(const QJsonValue &value, QByteArray &out)
+        {
+            switch (value.type()) {
+            case QJsonValue::Object:
+                out.append(QJsonDocument(value.toObject()).toJson(QJsonDocument::Compact));
+                break;
+            case QJsonValue::Array:
+                out.append(QJsonDocument(value.toArray()).toJson(QJsonDocument::Compact));
+                break;
+            case QJsonValue::Bool:
+                out.append(value.toBool() ? "true" : "false");
+                break;
+            case QJsonValue::Double:
+                out.append(QByteArray::number(value.toDouble(), 'g', QLocale::FloatingPointShortest));
+                break;
+            case QJsonValue::String:
+                serializeString(value.toString(), out);
+                break;
+            default:
+                out.append("null");
+                break;
+            }
+        }
+
+        static void serializeString(const QString &str, QByteArray &out)
+        {
+            // [rfc8259] 7. Strings
+            out.append('"');
+            for (const char c : str.toUtf8()) {
+                switch (c) {
+                case '"':
+                case '\\':
+                    out.append('\\').append(c);
+                    break;
+                case '\b':
+                    out.append("\\b");
+                    break;
+                case '\f':
+                    out.append("\\f");
+                    break;
+                case '\n':
+                    out.append("\\n");
+                    break;
+                case '\r':
+                    out.append("\\r");
+                    break;
+                case '\t':
+                    out.append("\\t");
+                    break;
+                default:
+                    if ((c >= 0) && (c < 0x20))
+                        out.append("\\u00").append(QByteArray::number(c, 16).rightJustified(2, '0'));
+                    else
+                        out.append(c);
+                    break;
+                }
+            }
+            out.append('"');
+        }
+
+        JsonArrayGenerator m_arrayGenerator;
+        JsonObjectGenerator m_objectGenerator;
+        QVector<StreamedJsonObject::Member> m_members;
+        int m_memberIndex = 0;
+        int m_elementCount = 0;
+        bool m_isObject = false;
+        bool m_isStarted = false;
+        bool m_isFinished = false;
+    };
 }
 
 WebApplication::WebApplication(QObject *parent)
     : QObject(parent)
     , m_cacheID {QString::number(Utils::Random::rand(), 36)}
+    , m_sessionExpirationTimer {new QTimer {this}}
 {
+    m_sessionExpirationTimer->setInterval(SESSION_EXPIRATION_CHECK_INTERVAL);
+    connect(m_sessionExpirationTimer, &QTimer::timeout, this, &WebApplication::removeExpiredSessions);
+
     registerAPIController(QLatin1String("app"), new AppController(this, this));
     registerAPIController(QLatin1String("auth"), new AuthController(this, this));
     registerAPIController(QLatin1String("log"), new LogController(this, this));
     registerAPIController(QLatin1String("rss"), new RSSController(this, this));
     registerAPIController(QLatin1String("search"), new SearchController(this, this));
     registerAPIController(QLatin1String("sync"), new SyncController(this, this));
+    registerAPIController(QLatin1String("torrentcreator"), new TorrentCreatorController(this, this));
     registerAPIController(QLatin1String("torrents"), new TorrentsController(this, this));
     registerAPIController(QLatin1String("transfer"), new TransferController(this, this));
 
@@ -245,6 +424,14 @@ const Http::Environment &WebApplication::env() const
 
 void WebApplication::doProcessRequest()
 {
+    if (request().path == QLatin1String("/metrics")) {
+        if (!session())
+            throw ForbiddenHTTPError();
+
+        print(m_metricsExporter.exportMetrics(), Http::CONTENT_TYPE_OPENMETRICS);
+        return;
+    }
+
     const QRegularExpressionMatch match = m_apiPathPattern.match(request().path);
     if (!match.hasMatch()) {
         sendWebUIFile();
@@ -267,6 +454,36 @@ void WebApplication::doProcessRequest()
 
     try {
         const QVariant result = controller->run(action, m_params, data);
+        if (controller->isResultPending())
+            setHeader({QLatin1String(Http::HEADER_X_RESULT_PENDING), QLatin1String("true")});
+        if (result.userType() == qMetaTypeId<std::shared_ptr<Http::ContentStream>>()) {
+            const auto stream = result.value<std::shared_ptr<Http::ContentStream>>();
+            // the stream must not outlive the session which is authorized to receive it
+            if (session()) {
+                session()->addStream(stream);
+                m_sessionExpirationTimer->start();
+
+                // the client receiving the events is active even though it sends no requests
+                const QString sessionId = session()->id();
+                connect(stream.get(), &Http::ContentStream::dataSent, this, [this, sessionId]()
+                {
+                    WebSession *session = m_sessions.value(sessionId);
+                    if (session)
+                        session->updateTimestamp();
+                });
+            }
+            printStream(stream, Http::CONTENT_TYPE_EVENT_STREAM);
+            return;
+        }
+        if (result.userType() == qMetaTypeId<JsonArrayGenerator>()) {
+            printStream(JsonStreamWriter(result.value<JsonArrayGenerator>()), Http::CONTENT_TYPE_JSON);
+            return;
+        }
+        if (result.userType() == qMetaTypeId<StreamedJsonObject>()) {
+            printStream(JsonStreamWriter(result.value<StreamedJsonObject>()), Http::CONTENT_TYPE_JSON);
+            return;
+        }
+
         switch (result.userType()) {
         case QMetaType::QJsonDocument:
             print(result.toJsonDocument().toJson(QJsonDocument::Compact), Http::CONTENT_TYPE_JSON);
@@ -454,6 +671,9 @@ Http::Response WebApplication::processRequest(const Http::Request &request, cons
     // clear response
     clear();
 
+    QElapsedTimer processingTimer;
+    processingTimer.start();
+
     try {
         // block suspicious requests
         if ((m_isCSRFProtectionEnabled && isCrossSiteRequest(m_request))
@@ -469,6 +689,14 @@ Http::Response WebApplication::processRequest(const Http::Request &request, cons
         print((!error.message().isEmpty() ? error.message() : error.statusText()), Http::CONTENT_TYPE_TXT);
     }
 
+    const QRegularExpressionMatch apiPathMatch = m_apiPathPattern.match(m_request.path);
+    if (apiPathMatch.hasMatch()) {
+        // only the known scopes are tracked to keep the number of exported series bounded
+        const QString scope = apiPathMatch.captured(QLatin1String("scope"));
+        if (m_apiControllers.contains(scope))
+            m_metricsExporter.addRequestTime(scope, processingTimer.nsecsElapsed());
+    }
+
     for (const Http::Header &prebuiltHeader : asConst(m_prebuiltHeaders))
         setHeader(prebuiltHeader);
 
@@ -541,16 +769,7 @@ void WebApplication::sessionStart()
 {
     Q_ASSERT(!m_currentSession);
 
-    // remove outdated sessions
-    Algorithm::removeIf(m_sessions, [this](const QString &, const WebSession *session)
-    {
-        if (session->hasExpired(m_sessionTimeout)) {
-            delete session;
-            return true;
-        }
-
-        return false;
-    });
+    removeExpiredSessions();
 
     m_currentSession = new WebSession(generateSid());
     m_sessions[m_currentSession->id()] = m_currentSession;
@@ -565,6 +784,26 @@ void WebApplication::sessionStart()
     setHeader({Http::HEADER_SET_COOKIE, cookieRawForm});
 }
 
+void WebApplication::removeExpiredSessions()
+{
+    bool hasStreams = false;
+    Algorithm::removeIf(m_sessions, [this, &hasStreams](const QString &, const WebSession *session)
+    {
+        if (session->hasExpired(m_sessionTimeout)) {
+            if (session == m_currentSession)
+                m_currentSession = nullptr;
+            delete session;
+            return true;
+        }
+
+        hasStreams = hasStreams || session->hasStreams();
+        return false;
+    });
+
+    if (!hasStreams)
+        m_sessionExpirationTimer->stop();
+}
+
 void WebApplication::sessionEnd()
 {
     Q_ASSERT(m_currentSession);
@@ -665,6 +904,14 @@ WebSession::WebSession(const QString &sid)
     updateTimestamp();
 }
 
+WebSession::~WebSession()
+{
+    for (const std::weak_ptr<Http::ContentStream> &stream : asConst(m_streams)) {
+        if (const std::shared_ptr<Http::ContentStream> activeStream = stream.lock())
+            activeStream->abort();
+    }
+}
+
 QString WebSession::id() const
 {
     return m_sid;
@@ -682,6 +929,21 @@ void WebSession::updateTimestamp()
     m_timer.start();
 }
 
+void WebSession::addStream(const std::shared_ptr<Http::ContentStream> &stream)
+{
+    // forget the streams which are already closed
+    m_streams.erase(std::remove_if(m_streams.begin(), m_streams.end()
+        , [](const std::weak_ptr<Http::ContentStream> &item) { return item.expired(); })
+        , m_streams.end());
+    m_streams.append(stream);
+}
+
+bool WebSession::hasStreams() const
+{
+    return std::any_of(m_streams.cbegin(), m_streams.cend()
+        , [](const std::weak_ptr<Http::ContentStream> &item) { return !item.expired(); });
+}
+
 QVariant WebSession::getData(const QString &id) const
 {
     return m_data.value(id);
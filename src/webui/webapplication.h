@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QDateTime>
 #include <QElapsedTimer>
 #include <QHash>
@@ -35,6 +37,7 @@
 #include <QRegularExpression>
 #include <QSet>
 #include <QTranslator>
+#include <QVector>
 
 #include "api/isessionmanager.h"
 #include "base/http/irequesthandler.h"
@@ -42,24 +45,36 @@
 #include "base/http/types.h"
 #include "base/utils/net.h"
 #include "base/utils/version.h"
+#include "metricsexporter.h"
 
-constexpr Utils::Version<int, 3, 2> API_VERSION {2, 6, 0};
+constexpr Utils::Version<int, 3, 2> API_VERSION {2, 6, 11};
 
 class APIController;
+class QTimer;
 class WebApplication;
 
+namespace Http
+{
+    class ContentStream;
+}
+
 constexpr char C_SID[] = "SID"; // name of session id cookie
 
 class WebSession final : public ISession
 {
 public:
     explicit WebSession(const QString &sid);
+    ~WebSession() override;
 
     QString id() const override;
 
     bool hasExpired(qint64 seconds) const;
     void updateTimestamp();
 
+    // The streams opened in this session are aborted when it ends
+    void addStream(const std::shared_ptr<Http::ContentStream> &stream);
+    bool hasStreams() const;
+
     QVariant getData(const QString &id) const override;
     void setData(const QString &id, const QVariant &data) override;
 
@@ -67,6 +82,7 @@ private:
     const QString m_sid;
     QElapsedTimer m_timer;  // timestamp
     QVariantHash m_data;
+    QVector<std::weak_ptr<Http::ContentStream>> m_streams;
 };
 
 class WebApplication final
@@ -110,6 +126,7 @@ private:
     // Session management
     QString generateSid() const;
     void sessionInitialize();
+    void removeExpiredSessions();
     bool isAuthNeeded();
     bool isPublicAPI(const QString &scope, const QString &action) const;
 
@@ -130,6 +147,7 @@ private:
 
     QHash<QString, APIController *> m_apiControllers;
     QSet<QString> m_publicAPIs;
+    MetricsExporter m_metricsExporter;
     bool m_isAltUIUsed = false;
     QString m_rootFolder;
 
@@ -148,6 +166,9 @@ private:
     bool m_isAuthSubnetWhitelistEnabled;
     QVector<Utils::Net::Subnet> m_authSubnetWhitelist;
     int m_sessionTimeout;
+    // the sessions don't receive any requests while they are kept busy by the streams
+    // so their expiration has to be checked meanwhile
+    QTimer *m_sessionExpirationTimer = nullptr;
 
     // security related
     QStringList m_domainList;
@@ -9,9 +9,13 @@ HEADERS += \
     $$PWD/api/rsscontroller.h \
     $$PWD/api/searchcontroller.h \
     $$PWD/api/synccontroller.h \
+    $$PWD/api/synceventstream.h \
+    $$PWD/api/synctorrentsjournal.h \
+    $$PWD/api/torrentcreatorcontroller.h \
     $$PWD/api/torrentscontroller.h \
     $$PWD/api/transfercontroller.h \
     $$PWD/api/serialize/serialize_torrent.h \
+    $$PWD/metricsexporter.h \
     $$PWD/webapplication.h \
     $$PWD/webui.h
 
@@ -25,9 +29,13 @@ SOURCES += \
     $$PWD/api/rsscontroller.cpp \
     $$PWD/api/searchcontroller.cpp \
     $$PWD/api/synccontroller.cpp \
+    $$PWD/api/synceventstream.cpp \
+    $$PWD/api/synctorrentsjournal.cpp \
+    $$PWD/api/torrentcreatorcontroller.cpp \
     $$PWD/api/torrentscontroller.cpp \
     $$PWD/api/transfercontroller.cpp \
     $$PWD/api/serialize/serialize_torrent.cpp \
+    $$PWD/metricsexporter.cpp \
     $$PWD/webapplication.cpp \
     $$PWD/webui.cpp
 
@@ -726,6 +726,14 @@ window.addEvent('load', function() {
             document.title = ("qBittorrent " + qbtVersion() + " QBT_TR(Web UI)QBT_TR[CONTEXT=OptionsDialog]");
         $('freeSpaceOnDisk').set('html', 'QBT_TR(Free space: %1)QBT_TR[CONTEXT=HttpServer]'.replace("%1", window.qBittorrent.Misc.friendlyUnit(serverState.free_space_on_disk)));
         $('DHTNodes').set('html', 'QBT_TR(DHT: %1 nodes)QBT_TR[CONTEXT=StatusBar]'.replace("%1", serverState.dht_nodes));
+        if (serverState.restoring_torrents) {
+            $('restoringTorrents').removeClass('invisible');
+            $('restoringTorrentsSeparator').removeClass('invisible');
+        }
+        else {
+            $('restoringTorrents').addClass('invisible');
+            $('restoringTorrentsSeparator').addClass('invisible');
+        }
 
         // Statistics dialog
         if (document.getElementById("statisticsContent")) {
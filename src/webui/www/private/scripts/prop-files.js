@@ -363,7 +363,9 @@ window.qBittorrent.PropFiles = (function() {
             method: 'get',
             onComplete: function() {
                 clearTimeout(loadTorrentFilesDataTimer);
-                loadTorrentFilesDataTimer = loadTorrentFilesData.delay(5000);
+                // the actual data is still being obtained, ask for it again soon
+                const isPending = (this.getHeader('X-Result-Pending') === 'true');
+                loadTorrentFilesDataTimer = loadTorrentFilesData.delay(isPending ? 1000 : 5000);
             },
             onSuccess: function(files) {
                 clearTimeout(torrentFilesFilterInputTimer);
@@ -68,7 +68,9 @@ window.qBittorrent.PropPeers = (function() {
             method: 'get',
             onComplete: function() {
                 clearTimeout(loadTorrentPeersTimer);
-                loadTorrentPeersTimer = loadTorrentPeersData.delay(getSyncMainDataInterval());
+                // the actual data is still being obtained, ask for it again soon
+                const isPending = (this.getHeader('X-Result-Pending') === 'true');
+                loadTorrentPeersTimer = loadTorrentPeersData.delay(isPending ? 1000 : getSyncMainDataInterval());
             },
             onSuccess: function(response) {
                 $('error_div').set('html', '');
@@ -68,7 +68,9 @@ window.qBittorrent.PropTrackers = (function() {
             method: 'get',
             onComplete: function() {
                 clearTimeout(loadTrackersDataTimer);
-                loadTrackersDataTimer = loadTrackersData.delay(10000);
+                // the actual data is still being obtained, ask for it again soon
+                const isPending = (this.getHeader('X-Result-Pending') === 'true');
+                loadTrackersDataTimer = loadTrackersData.delay(isPending ? 1000 : 10000);
             },
             onSuccess: function(trackers) {
                 const selectedTrackers = torrentTrackersTable.selectedRowsIds();